@@ -15,7 +15,19 @@
         "src/audio_preprocessor.cpp",
         "src/compressed_fingerprint.cpp",
         "src/audio_memory_pool.cpp",
-        "src/streaming_audio_loader.cpp"
+        "src/streaming_audio_loader.cpp",
+        "src/streaming_resampler.cpp",
+        "src/pcm_decoder.cpp",
+        "src/wav_file.cpp",
+        "src/fingerprint_pipeline.cpp",
+        "src/file_prefetcher.cpp",
+        "src/disk_order.cpp",
+        "src/self_join.cpp",
+        "src/similarity_join.cpp",
+        "src/fingerprint_store.cpp",
+        "src/mapped_file.cpp",
+        "src/identical_files.cpp",
+        "src/two_tier_scan.cpp"
       ],
       "include_dirs": [
         "<!@(node -p \"require('node-addon-api').include\")"
@@ -73,8 +85,12 @@
           "cflags": [
             "<!@(pkg-config --cflags libchromaprint sndfile)"
           ],
+          "defines": [
+            "<!@(pkg-config --exists liburing && echo AUDIO_DUPLICATES_HAVE_LIBURING || true)"
+          ],
           "ldflags": [
-            "<!@(pkg-config --libs libchromaprint sndfile)"
+            "<!@(pkg-config --libs libchromaprint sndfile)",
+            "<!@(pkg-config --libs liburing 2>/dev/null || true)"
           ]
         }]
       ]
@@ -13,6 +13,98 @@ export interface Fingerprint {
   filePath: string;
 }
 
+/**
+ * Coarse fingerprint of a few short spans of a file, stored back to back
+ */
+export interface SampledFingerprint {
+  data: number[];
+  /** Start of each span in data, followed by data.length */
+  spanOffsets: number[];
+  /** Start of each span in the file, in seconds */
+  spanStarts: number[];
+  /** Fingerprint items per second of audio */
+  itemsPerSecond: number;
+  sampleRate: number;
+  /** Duration of the whole file in seconds */
+  duration: number;
+  /** Audio actually decoded for the spans, in seconds */
+  decodedSeconds: number;
+  filePath: string;
+  isSampled: true;
+}
+
+/**
+ * Options for generateSampledFingerprint
+ */
+export interface SampleOptions {
+  /** Span centres as fractions of the duration (default: [0.15, 0.5, 0.85]) */
+  positions?: number[];
+  /** Audio decoded per span in seconds (default: 12) */
+  spanSeconds?: number;
+}
+
+/**
+ * Compression and decode throughput of one fingerprint codec
+ */
+export interface CodecBenchmarkResult {
+  codec: 'lz4' | 'xor-delta';
+  compressedSize: number;
+  originalSize: number;
+  compressionRatio: number;
+  decodeGBps: number;
+  /** Whether decoding returned the input frames exactly */
+  lossless: boolean;
+  /** Whether every block decoded alone matches the full decode */
+  blocksMatch: boolean;
+  /** Whether ranges across block boundaries, in the last block and past the end match the full decode */
+  rangesMatch: boolean;
+  /** Whether moving the blob (owned or a view) leaves the source invalid and the destination decoding the same frames */
+  movesLeaveSourceEmpty: boolean;
+  /** Whether a blob compressed against a dictionary trained on this fingerprint decodes through a view; null when no dictionary could be trained */
+  dictionaryLossless: boolean | null;
+}
+
+/**
+ * Decode throughput of one PCM reader over a set of files
+ */
+export interface PcmReaderBenchmarkResult {
+  reader: 'mapped' | 'sndfile';
+  files: number;
+  mappedFiles: number;
+  evictedFiles: number;
+  bytes: number;
+  seconds: number;
+  MBps: number;
+}
+
+/**
+ * Options for decodePcm
+ */
+export interface DecodePcmOptions {
+  /** Output rate in Hz (default: 11025) */
+  sampleRate?: number;
+  /** Seconds to decode from the start (default: 0, the whole file) */
+  maxDuration?: number;
+  /** Bytes read per chunk (default: 1 MiB) */
+  chunkBytes?: number;
+  /** Downmix and resample integer PCM in fixed point (default: true) */
+  integerPath?: boolean;
+  /** Read 16-bit and float WAV/RF64 through a memory map (default: true) */
+  mappedReader?: boolean;
+}
+
+/**
+ * Decoded mono PCM and the path that produced it
+ */
+export interface DecodedPcm {
+  samples: Int16Array;
+  sampleRate: number;
+  sourceRate: number;
+  channels: number;
+  integerPath: boolean;
+  mapped: boolean;
+}
+
 /**
  * Result of fingerprint comparison
  */
@@ -84,6 +176,38 @@ export interface DuplicateGroup {
   avgSimilarity: number;
 }
 
+/**
+ * Verified match found when inserting a file with addFileAndMatch
+ */
+export interface InsertMatch {
+  fileId: number;
+  filePath: string;
+  similarityScore: number;
+  bitErrorRate: number;
+  bestOffset: number;
+}
+
+/**
+ * Result of inserting a file with online duplicate matching
+ */
+export interface InsertMatchResult {
+  fileId: number;
+  groupId: number;
+  isDuplicate: boolean;
+  matches: InsertMatch[];
+}
+
+/**
+ * Scored match returned by queryTopK
+ */
+export interface TopKMatch {
+  fileId: number;
+  filePath: string;
+  similarity: number;
+  bitErrorRate: number;
+  offset: number;
+}
+
 /**
  * Index statistics
  */
@@ -91,6 +215,242 @@ export interface IndexStats {
   fileCount: number;
   indexSize: number;
   loadFactor: number;
+  /** Size in bytes of the shared compression dictionary (0 when none is trained) */
+  dictionarySize: number;
+  bulkJoin: BulkJoinStats;
+  prefixJoin: PrefixJoinStats;
+  exactDuplicates: ExactDuplicateStats;
+  durationFilter: DurationFilterStats;
+  storage: StorageStats;
+}
+
+/**
+ * Work skipped by the duration-ratio window since setDurationRatioWindow
+ */
+export interface DurationFilterStats {
+  /** 0 when the window is disabled */
+  minRatio: number;
+  queries: number;
+  /** Posting entries skipped during vote accumulation */
+  votesPruned: number;
+  /** Candidates that would have been decoded and compared */
+  comparisonsPruned: number;
+}
+
+/**
+ * Bit-identical fingerprints collapsed by the last findAllDuplicates* run
+ */
+export interface ExactDuplicateStats {
+  files: number;
+  /** Sets of two or more files with identical fingerprints */
+  exactSets: number;
+  /** Files verified through their set's representative instead of directly */
+  filesCollapsed: number;
+}
+
+/**
+ * Fingerprint store memory usage
+ */
+export interface StorageStats {
+  /** Compressed fingerprint bytes in the contiguous slab */
+  slabBytes: number;
+  slabCapacity: number;
+  /** Per-file metadata columns (offset, length, duration, sample rate, path id, content hash) */
+  metadataBytes: number;
+  uniquePaths: number;
+  /** Front-coded path table size */
+  pathBytes: number;
+  /** Size the interned paths would take as plain strings */
+  rawPathBytes: number;
+  /** Files kept decoded in the hot tier and the bytes their frames take */
+  hotFiles: number;
+  hotBytes: number;
+  /** Files held LZ4-compressed in the slab */
+  warmFiles: number;
+  /** Files only in the memory-mapped cold file, and that file's size */
+  coldFiles: number;
+  coldBytes: number;
+  promotions: number;
+  demotions: number;
+  /** Tiering epochs run so far */
+  tierEpochs: number;
+  /** Background tiering epochs that failed and were skipped, and the last failure's message */
+  tierErrors: number;
+  lastTierError: string;
+}
+
+/**
+ * Options for configureTiering
+ */
+export interface TierOptions {
+  /** Set to false to stop background tiering (default: true) */
+  enabled?: boolean;
+  /** Memory for decoded hot fingerprints in MB (default: 64) */
+  hotBudgetMB?: number;
+  /** Decayed access count a file needs to become hot (default: 4) */
+  hotMinAccesses?: number;
+  /** Epochs without access before a file moves to the cold file (default: 8) */
+  coldAfterEpochs?: number;
+  /** Directory for the cold file; the cold tier is disabled when omitted */
+  coldDirectory?: string;
+  /** Cap on the cold file size in MB; demotions past it fail and the files stay warm (default: unlimited) */
+  maxColdMB?: number;
+  /** Time between tiering epochs in milliseconds (default: 5000) */
+  intervalMs?: number;
+}
+
+/**
+ * Options for configureSegmentedFingerprinting
+ */
+export interface SegmentedFingerprintOptions {
+  /** Set to false to fingerprint every file sequentially again (default: true) */
+  enabled?: boolean;
+  /** Files shorter than this are fingerprinted sequentially (default: 600) */
+  minFileSeconds?: number;
+  /** Audio per segment between seams in seconds (default: 120) */
+  segmentSeconds?: number;
+  /** Extra audio decoded on each side of a seam in seconds (default: 8) */
+  overlapSeconds?: number;
+  /** Worker threads per file; 0 uses the hardware concurrency (default: 0) */
+  maxThreads?: number;
+}
+
+/**
+ * Statistics from the streaming loader's last file
+ */
+export interface StreamingStats {
+  totalBytesProcessed: number;
+  peakMemoryUsage: number;
+  compressionRatio: number;
+  processingTimeSeconds: number;
+  /** 1 unless the file was fingerprinted in segments */
+  segments: number;
+  /** Mean bit error between neighbouring segments where they were stitched */
+  seamBitError: number;
+}
+
+/**
+ * Statistics from the last findAllDuplicatesBulk run
+ */
+export interface BulkJoinStats {
+  tuplesEmitted: number;
+  bytesSpilled: number;
+  runsSkipped: number;
+  pairVotes: number;
+  candidatePairs: number;
+  pairsVerified: number;
+  /** Fingerprint blocks decoded while verifying; rejected pairs stop early */
+  blocksDecoded: number;
+  /** Blocks that full decodes of every verified pair would have touched */
+  blocksTotal: number;
+}
+
+/**
+ * Statistics from the last findQuickFilterPairs('prefix') run
+ */
+export interface PrefixJoinStats {
+  records: number;
+  prefixEntries: number;
+  candidates: number;
+  verifiedPairs: number;
+}
+
+/**
+ * File pair accepted by the quick filter
+ */
+export interface QuickFilterPair {
+  fileA: number;
+  fileB: number;
+  overlap: number;
+}
+
+/**
+ * Compression totals for files in one duration range
+ */
+export interface CompressionBucket {
+  label: string;
+  files: number;
+  originalBytes: number;
+  bytesBefore: number;
+  bytesAfter: number;
+  ratioBefore: number;
+  ratioAfter: number;
+}
+
+/**
+ * Result of trainCompressionDictionary
+ */
+export interface DictionaryReport {
+  dictionarySize: number;
+  samples: number;
+  buckets: CompressionBucket[];
+}
+
+/**
+ * Options for findAllDuplicatesBulk
+ */
+export interface BulkDuplicateOptions {
+  numThreads?: number;
+  /** Spill tuple partitions and per-partition vote runs here (default: in memory) */
+  spillDirectory?: string;
+  /** Tuples buffered per partition before spilling (default: 65536) */
+  spillBufferTuples?: number;
+  maxRunLength?: number;
+}
+
+/**
+ * Candidate pair from the bulk self-join
+ */
+export interface BulkCandidatePair {
+  fileA: number;
+  fileB: number;
+  /** Hash matches at any accepted offset */
+  votes: number;
+  /** Most voted offset: position in fileB minus position in fileA */
+  offsetHint: number;
+}
+
+/**
+ * Options for findDuplicatesTwoTier
+ */
+export interface TwoTierOptions {
+  /** Audio fingerprinted for every file in the first tier, in seconds (default: 30) */
+  prefixSeconds?: number;
+  /** Prefix hash matches for a pair to become a candidate (default: 5) */
+  minVotes?: number;
+  /** Skip prefix hashes shared by more than this many frames (default: 4096) */
+  maxRunLength?: number;
+  /** Threads to use; 0 uses the OpenMP default (default: 0) */
+  numThreads?: number;
+  similarityThreshold?: number;
+  bitErrorThreshold?: number;
+  /** Alignment window in fingerprint items; copies offset further at their start are missed (default: 360) */
+  maxAlignmentOffset?: number;
+}
+
+/**
+ * Result of findDuplicatesTwoTier
+ */
+export interface TwoTierResult {
+  /** fileIds are positions in the input array */
+  groups: DuplicateGroup[];
+  errors: Array<{ filePath: string; stage: 'prefix' | 'full'; error: string }>;
+  stats: {
+    files: number;
+    prefixCandidatePairs: number;
+    /** Files with a prefix candidate, fingerprinted in full */
+    completedFiles: number;
+    verifiedPairs: number;
+    /** Whole-file duration summed over readable files */
+    audioSeconds: number;
+    prefixDecodedSeconds: number;
+    /** Audio decoded to complete candidates, including the re-decoded seam overlap */
+    fullDecodedSeconds: number;
+    /** audioSeconds minus everything decoded */
+    decodeSecondsSaved: number;
+    wallSeconds: number;
+    join: { tuplesEmitted: number; runsSkipped: number; pairVotes: number };
+  };
 }
 
 /**
@@ -107,9 +467,136 @@ export interface ScanProgress {
  */
 export interface ScanOptions {
   threshold?: number;
+  /** Fingerprint only one file per set of byte-identical files (default: false) */
+  exactFilePrepass?: boolean;
+  /** Decode files in on-disk order rather than walk order (default: false) */
+  diskOrder?: boolean;
   onProgress?: (progress: ScanProgress) => void;
 }
 
+/**
+ * Result of findIdenticalFiles
+ */
+export interface IdenticalFilesResult {
+  /** Byte-identical paths; the first path of each group is its representative */
+  groups: string[][];
+  stats: IdenticalFileStats;
+}
+
+export interface IdenticalFileStats {
+  files: number;
+  /** Files sharing their size with another file */
+  sizeMatches: number;
+  sampledHashes: number;
+  /** Files hashed in full because their sampled blocks collided */
+  fullHashes: number;
+  bytesRead: number;
+  groups: number;
+  /** Files whose hashes matched a group but whose bytes did not */
+  hashCollisions: number;
+  /** Files besides the representatives (decodes that can be skipped) */
+  identicalFiles: number;
+  unreadable: number;
+}
+
+export interface DiskOrderStats {
+  files: number;
+  /** Ordered by the physical offset of their first extent */
+  extentFiles: number;
+  /** Ordered by inode number (no usable extent) */
+  inodeFiles: number;
+  /** Could not be stat'ed; kept last in input order */
+  unknownFiles: number;
+  seconds: number;
+}
+
+/**
+ * Options for addFilesToIndexPipeline; stage thread counts left unset split the remaining cores
+ */
+export interface PipelineOptions {
+  ioThreads?: number;
+  decodeThreads?: number;
+  dspThreads?: number;
+  fingerprintThreads?: number;
+  /** Files in flight between two stages (rounded up to a power of two) */
+  queueCapacity?: number;
+  /** Read and decoded megabytes held between the stages before the I/O stage waits (default: 512) */
+  maxBufferedMB?: number;
+  /** Seconds fingerprinted per file (default: whole file) */
+  maxDuration?: number;
+  /** Files read ahead of the I/O stage (default: 0 = no prefetcher) */
+  prefetchDepth?: number;
+  /** 'io_uring' needs a build linked against liburing; falls back to threads otherwise */
+  prefetchBackend?: 'auto' | 'io_uring' | 'threads';
+  /** Read files in on-disk order instead of input order (default: false) */
+  diskOrder?: boolean;
+}
+
+export interface PrefetchStats {
+  /** Backend actually used */
+  backend: 'io_uring' | 'threads';
+  files: number;
+  bytes: number;
+  readRequests: number;
+  /** Times the I/O stage found no file ready */
+  consumerWaits: number;
+  consumerWaitSeconds: number;
+}
+
+export interface PipelineStageStats {
+  name: 'io' | 'decode' | 'dsp' | 'fingerprint';
+  threads: number;
+  items: number;
+  /** Processing time summed over the stage's threads, excluding queue waits */
+  busySeconds: number;
+  /** busySeconds / (threads * wallSeconds) */
+  utilisation: number;
+}
+
+export interface PipelineQueueStats {
+  name: string;
+  capacity: number;
+  maxDepth: number;
+  /** Time-averaged depth */
+  meanDepth: number;
+  /** Fraction of samples with the queue full (its consumer is the bottleneck) */
+  fullRatio: number;
+}
+
+/**
+ * Result of addFilesToIndexPipeline
+ */
+export interface PipelineResult {
+  /** Index file id per input path, null when the file failed */
+  fileIds: Array<number | null>;
+  errors: Array<{ filePath: string; stage: string; error: string }>;
+  stats: {
+    wallSeconds: number;
+    bytesRead: number;
+    /** Most read and decoded bytes held between the stages at once */
+    peakBufferedBytes: number;
+    stages: PipelineStageStats[];
+    queues: PipelineQueueStats[];
+    /** Present when prefetchDepth > 0 */
+    prefetch?: PrefetchStats;
+    /** Present when diskOrder is set */
+    diskOrder?: DiskOrderStats;
+  };
+}
+
+/**
+ * Duplicate groups returned by the directory scans
+ */
+export type ScanResult = DuplicateGroup[] & {
+  /** Present when exactFilePrepass was enabled */
+  exactFilePrepass?: IdenticalFileStats & {
+    /** Copies indexed from their representative's fingerprint instead of being decoded */
+    skippedDecodes: number;
+  };
+  /** Present when diskOrder was enabled */
+  diskOrder?: DiskOrderStats;
+};
+
 /**
  * Enhanced options for directory scanning with silence padding handling
  */
@@ -142,6 +629,30 @@ export function generateFingerprint(filePath: string): Promise<Fingerprint>;
  */
 export function generateFingerprintLimited(filePath: string, maxDuration: number): Promise<Fingerprint>;
 
+/**
+ * Fingerprint long recordings as overlapping segments on several threads
+ * @param options Segmenting thresholds and thread count
+ * @returns Promise resolving to true
+ */
+export function configureSegmentedFingerprinting(options?: SegmentedFingerprintOptions): Promise<boolean>;
+
+/**
+ * Fingerprint only short spans around fixed positions for coarse triage;
+ * files too short to hold the spans apart are fingerprinted whole as one span
+ * @param filePath Path to audio file
+ * @param options Span positions and length
+ * @returns Promise resolving to the sampled fingerprint
+ */
+export function generateSampledFingerprint(filePath: string, options?: SampleOptions): Promise<SampledFingerprint>;
+
+/**
+ * Compare two sampled fingerprints span by span; isDuplicate needs at least half the spans to match
+ * @param fingerprint1 First sampled fingerprint
+ * @param fingerprint2 Second sampled fingerprint
+ * @returns Promise resolving to comparison result with per-span matches
+ */
+export function compareSampledFingerprints(fingerprint1: SampledFingerprint, fingerprint2: SampledFingerprint): Promise<MatchResult>;
+
 /**
  * Generate audio fingerprint with preprocessing
  * @param filePath Path to audio file
@@ -168,6 +679,17 @@ export function testPreprocessing(filePath: string, config?: PreprocessConfig):
  */
 export function compareFingerprints(fingerprint1: Fingerprint, fingerprint2: Fingerprint): Promise<MatchResult>;
 
+/**
+ * Compare two fingerprints near a known alignment instead of searching every offset
+ * @param fingerprint1 First fingerprint
+ * @param fingerprint2 Second fingerprint
+ * @param offsetHint Expected offset of fingerprint2 relative to fingerprint1, in fingerprint items
+ * @param options compressed: compare block-compressed copies and stop once no offset can match (default: false)
+ * @returns Promise resolving to comparison result
+ */
+export function compareFingerprintsAtOffset(fingerprint1: Fingerprint, fingerprint2: Fingerprint, offsetHint: number,
+                                            options?: { compressed?: boolean }): Promise<MatchResult & { blocksDecoded?: number }>;
+
 /**
  * Compare two fingerprints using sliding window approach for better silence padding handling
  * @param fingerprint1 First fingerprint
@@ -176,6 +698,30 @@ export function compareFingerprints(fingerprint1: Fingerprint, fingerprint2: Fin
  */
 export function compareFingerprintsSlidingWindow(fingerprint1: Fingerprint, fingerprint2: Fingerprint): Promise<MatchResult>;
 
+/**
+ * Benchmark the fingerprint codecs on one fingerprint
+ * @param fingerprint Fingerprint to encode
+ * @param iterations Decode repetitions for the throughput measurement (default: 100)
+ * @returns Promise resolving to per-codec size and decode throughput
+ */
+export function benchmarkFingerprintCodecs(fingerprint: Fingerprint, iterations?: number): Promise<CodecBenchmarkResult[]>;
+
+/**
+ * Benchmark PCM decoding through the memory-mapped WAV reader against libsndfile
+ * @param filePaths Files to decode
+ * @param coldCache Drop each file from the page cache before decoding it (Linux)
+ * @returns Promise resolving to per-reader throughput
+ */
+export function benchmarkPcmReaders(filePaths: string[], coldCache?: boolean): Promise<PcmReaderBenchmarkResult[]>;
+
+/**
+ * Decode a file to 16-bit mono PCM the way fingerprinting does
+ * @param filePath Path to audio file
+ * @param options Output rate, duration limit, chunk size and decode path
+ * @returns Promise resolving to the samples and the decode path taken
+ */
+export function decodePcm(filePath: string, options?: DecodePcmOptions): Promise<DecodedPcm>;
+
 // Index management functions
 
 /**
@@ -192,12 +738,139 @@ export function initializeIndex(): Promise<boolean>;
  */
 export function addFileToIndex(filePath: string): Promise<number>;
 
+/**
+ * Add a file that is byte-identical to an indexed file, without decoding it
+ * @param filePath Path to the copy
+ * @param sourceFileId File ID of the indexed original
+ * @returns Promise resolving to file ID in the index
+ */
+export function addIdenticalFileToIndex(filePath: string, sourceFileId: number): Promise<number>;
+
+/**
+ * Fingerprint files through a staged pipeline and add them to the index: I/O,
+ * decode, DSP and fingerprint stages run their own thread pools connected by
+ * bounded lock-free queues
+ * @param filePaths Files to add
+ * @param options Stage thread counts, queue capacity, duration limit and read-ahead
+ * @returns Promise resolving to file ids, errors and per-stage utilisation and queue depths
+ */
+export function addFilesToIndexPipeline(filePaths: string[], options?: PipelineOptions): Promise<PipelineResult>;
+
+/**
+ * Find byte-identical files without decoding them: files are grouped by size,
+ * then by a hash of sampled blocks, and hashed in full only on collisions
+ * @param filePaths Files to check
+ * @param options sampleBlockBytes (default: 65536) and numThreads (default: auto)
+ */
+export function findIdenticalFiles(filePaths: string[], options?: { sampleBlockBytes?: number; numThreads?: number }): Promise<IdenticalFilesResult>;
+
+/**
+ * Order files by their location on disk: physical offset of the first extent
+ * (FIEMAP, Linux), falling back to inode number
+ * @param filePaths Files to order
+ * @param options useExtents (default: true) and numThreads (default: auto)
+ */
+export function orderFilesByDiskLayout(filePaths: string[], options?: { useExtents?: boolean; numThreads?: number }): Promise<{ files: string[]; stats: DiskOrderStats }>;
+
+/**
+ * Drop files from the page cache so the next read comes from the device (for cold-cache benchmarks)
+ * @returns Promise resolving to the number of files evicted
+ */
+export function evictPageCache(filePaths: string[]): Promise<number>;
+
+/**
+ * Add file to the index and verify it against already indexed files in one step
+ * @param filePath Path to audio file
+ * @returns Promise resolving to the new file ID, its group and verified matches
+ * @throws Error if file not found or cannot be processed
+ */
+export function addFileAndMatch(filePath: string): Promise<InsertMatchResult>;
+
+/**
+ * Get the duplicate groups maintained incrementally by addFileAndMatch
+ * @returns Promise resolving to array of duplicate groups
+ */
+export function getOnlineDuplicateGroups(): Promise<DuplicateGroup[]>;
+
+/**
+ * Find the k best verified matches for a fingerprint or audio file
+ * @param query Fingerprint object or path to audio file
+ * @param k Maximum number of matches to return (default: 10)
+ * @param minSimilarity Minimum similarity score to report (default: 0.0)
+ * @param voteCutoff 0 for an exact result (default); a fraction such as 0.5 stops verifying candidates
+ *   with fewer than that share of the k-th match's hash votes, which is faster but may miss matches
+ * @returns Promise resolving to matches sorted by similarity (best first)
+ */
+export function queryTopK(query: Fingerprint | string, k?: number, minSimilarity?: number, voteCutoff?: number): Promise<TopKMatch[]>;
+
+/**
+ * Read an indexed file's fingerprint back from the index
+ * @param fileId Id returned when the file was indexed
+ * @returns Promise resolving to the stored frames and the tier they were read from, or null for an unknown id
+ */
+export function getIndexedFingerprint(fileId: number): Promise<(Fingerprint & { tier: 'hot' | 'warm' | 'cold' }) | null>;
+
+/**
+ * Candidate file ids the index votes for, per fingerprint, before any comparison
+ * @param fingerprints Fingerprints to look up
+ * @param options batched (default: true) votes for all fingerprints in one posting-major pass;
+ *   false looks each one up separately. Both return the same candidates
+ * @returns Promise resolving to candidate file ids for each fingerprint, most votes first
+ */
+export function findCandidates(fingerprints: Fingerprint[], options?: { batched?: boolean }): Promise<number[][]>;
+
 /**
  * Find all duplicate groups in the index
  * @returns Promise resolving to array of duplicate groups
  */
 export function findAllDuplicates(): Promise<DuplicateGroup[]>;
 
+/**
+ * Find all duplicate groups with the bulk sort-merge self-join instead of
+ * per-file index queries; intended for full-library batch jobs
+ * @param options Thread count, spill directory and stop-word run length
+ * @returns Promise resolving to array of duplicate groups
+ */
+export function findAllDuplicatesBulk(options?: BulkDuplicateOptions): Promise<DuplicateGroup[]>;
+
+/**
+ * Candidate pairs the bulk self-join emits, before verification
+ * @param options Same options as findAllDuplicatesBulk
+ * @returns Promise resolving to pairs sorted by fileA, fileB
+ */
+export function findBulkCandidatePairs(options?: BulkDuplicateOptions): Promise<BulkCandidatePair[]>;
+
+/**
+ * Two-tier duplicate scan over a list of files, without the index: prefixes of
+ * every file are fingerprinted and joined, and only files with a prefix
+ * candidate are fingerprinted in full and verified
+ * @param filePaths Files to scan
+ * @param options Prefix length, candidate votes, threads and comparator thresholds
+ * @returns Promise resolving to duplicate groups and decode statistics
+ */
+export function findDuplicatesTwoTier(filePaths: string[], options?: TwoTierOptions): Promise<TwoTierResult>;
+
+/**
+ * Find every file pair whose hash-set overlap passes the quick filter
+ * @param method 'prefix' (prefix-filtering join, default), 'indexed' (per-file index queries) or 'all' (every file pair)
+ * @returns Promise resolving to pairs sorted by fileA, fileB
+ */
+export function findQuickFilterPairs(method?: 'prefix' | 'indexed' | 'all'): Promise<QuickFilterPair[]>;
+
+/**
+ * Train a shared compression dictionary from indexed fingerprints and recompress the index
+ * @param maxSamples Maximum number of fingerprints to sample (default: 1000)
+ * @returns Promise resolving to per-duration compression ratios before and after
+ */
+export function trainCompressionDictionary(maxSamples?: number): Promise<DictionaryReport>;
+
+/**
+ * Start, reconfigure or stop background hot/warm/cold tiering of indexed fingerprints
+ * @param options Tier budgets and thresholds; { enabled: false } stops tiering
+ * @returns Promise resolving to true
+ */
+export function configureTiering(options?: TierOptions): Promise<boolean>;
+
 /**
  * Get index statistics
  * @returns Promise resolving to index statistics
@@ -236,6 +909,21 @@ export function setMaxAlignmentOffset(maxOffset: number): Promise<boolean>;
  */
 export function setBitErrorThreshold(threshold: number): Promise<boolean>;
 
+/**
+ * Restrict candidates to files of similar length for whole-file duplicate detection
+ * @param minRatio Minimum shorter/longer frame-count ratio (0 disables the window, default)
+ * @returns Promise resolving to success status
+ * @throws Error if ratio is out of range
+ */
+export function setDurationRatioWindow(minRatio: number): Promise<boolean>;
+
+/**
+ * Collapse bit-identical fingerprints to one representative before pairwise verification
+ * @param enabled true to collapse (default), false to verify every file directly
+ * @returns Promise resolving to success status
+ */
+export function setExactDuplicateCollapse(enabled: boolean): Promise<boolean>;
+
 /**
  * Create default preprocessing configuration for silence handling
  * @param overrides Optional overrides for default config
@@ -243,6 +931,14 @@ export function setBitErrorThreshold(threshold: number): Promise<boolean>;
  */
 export function createSilenceHandlingConfig(overrides?: Partial<PreprocessConfig>): PreprocessConfig;
 
+// Memory monitoring functions
+
+/**
+ * Get statistics for the last file fingerprinted by the streaming loader
+ * @returns Promise resolving to streaming statistics
+ */
+export function getStreamingStats(): Promise<StreamingStats>;
+
 // High-level utility functions
 
 /**
@@ -252,7 +948,7 @@ export function createSilenceHandlingConfig(overrides?: Partial<PreprocessConfig
  * @returns Promise resolving to array of duplicate groups
  * @throws Error if directory not found
  */
-export function scanDirectoryForDuplicates(directoryPath: string, options?: ScanOptions): Promise<DuplicateGroup[]>;
+export function scanDirectoryForDuplicates(directoryPath: string, options?: ScanOptions): Promise<ScanResult>;
 
 /**
  * Scan multiple directories for audio files and find duplicates across all directories
@@ -261,7 +957,7 @@ export function scanDirectoryForDuplicates(directoryPath: string, options?: Scan
  * @returns Promise resolving to array of duplicate groups
  * @throws Error if any directory not found
  */
-export function scanMultipleDirectoriesForDuplicates(directoryPaths: string[], options?: ScanOptions): Promise<DuplicateGroup[]>;
+export function scanMultipleDirectoriesForDuplicates(directoryPaths: string[], options?: ScanOptions): Promise<ScanResult>;
 
 /**
  * Scan directory for audio files and find duplicates with enhanced silence padding handling
@@ -270,4 +966,4 @@ export function scanMultipleDirectoriesForDuplicates(directoryPaths: string[], o
  * @returns Promise resolving to array of duplicate groups
  * @throws Error if directory not found
  */
-export function scanDirectoryForDuplicatesEnhanced(directoryPath: string, options?: EnhancedScanOptions): Promise<DuplicateGroup[]>;
\ No newline at end of file
+export function scanDirectoryForDuplicatesEnhanced(directoryPath: string, options?: EnhancedScanOptions): Promise<ScanResult>;
\ No newline at end of file
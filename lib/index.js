@@ -95,6 +95,58 @@ async function generateFingerprintLimited(filePath, maxDuration) {
   });
 }
 
+/**
+ * Split long recordings into overlapping segments that are fingerprinted on separate
+ * threads and stitched at the overlap; applies to generateFingerprint and addFileToIndex
+ * @param {Object} options - enabled, minFileSeconds, segmentSeconds, overlapSeconds, maxThreads
+ * @returns {Promise<boolean>} Success status
+ */
+async function configureSegmentedFingerprinting(options = {}) {
+  return new Promise((resolve, reject) => {
+    try {
+      const result = addon.configureSegmentedFingerprinting(options);
+      resolve(result);
+    } catch (error) {
+      reject(error);
+    }
+  });
+}
+
+/**
+ * Fingerprint short spans around fixed positions (head, middle and tail by default)
+ * for first-pass triage; only those spans are decoded
+ * @param {string} filePath - Path to audio file
+ * @param {Object} options - positions (fractions of the duration), spanSeconds
+ * @returns {Promise<Object>} Sampled fingerprint with per-span offsets and start times
+ */
+async function generateSampledFingerprint(filePath, options = {}) {
+  return new Promise((resolve, reject) => {
+    try {
+      const result = addon.generateSampledFingerprint(filePath, options);
+      resolve(result);
+    } catch (error) {
+      reject(error);
+    }
+  });
+}
+
+/**
+ * Compare two sampled fingerprints span by span
+ * @param {Object} fingerprint1 - First sampled fingerprint
+ * @param {Object} fingerprint2 - Second sampled fingerprint
+ * @returns {Promise<Object>} Comparison result with per-span matches
+ */
+async function compareSampledFingerprints(fingerprint1, fingerprint2) {
+  return new Promise((resolve, reject) => {
+    try {
+      const result = addon.compareSampledFingerprints(fingerprint1, fingerprint2);
+      resolve(result);
+    } catch (error) {
+      reject(error);
+    }
+  });
+}
+
 /**
  * Generate audio fingerprint with preprocessing
  * @param {string} filePath - Path to audio file
@@ -163,6 +215,77 @@ async function compareFingerprints(fingerprint1, fingerprint2) {
   });
 }
 
+/**
+ * Compare two fingerprints near a known alignment instead of searching every offset
+ * @param {Object} fingerprint1 - First fingerprint
+ * @param {Object} fingerprint2 - Second fingerprint
+ * @param {number} offsetHint - Expected offset of fingerprint2 relative to fingerprint1, in fingerprint items
+ * @param {Object} options - compressed: compare block-compressed copies, decoding blocks only as needed (default: false)
+ * @returns {Promise<Object>} Comparison result (with blocksDecoded when compressed)
+ */
+async function compareFingerprintsAtOffset(fingerprint1, fingerprint2, offsetHint, options = {}) {
+  return new Promise((resolve, reject) => {
+    try {
+      const result = addon.compareFingerprintsAtOffset(fingerprint1, fingerprint2, offsetHint, options);
+      resolve(result);
+    } catch (error) {
+      reject(error);
+    }
+  });
+}
+
+/**
+ * Benchmark the fingerprint codecs on one fingerprint
+ * @param {Object} fingerprint - Fingerprint to encode
+ * @param {number} iterations - Decode repetitions for the throughput measurement (default: 100)
+ * @returns {Promise<Array>} Per-codec compressed size, ratio and decode throughput
+ */
+async function benchmarkFingerprintCodecs(fingerprint, iterations = 100) {
+  return new Promise((resolve, reject) => {
+    try {
+      const result = addon.benchmarkFingerprintCodecs(fingerprint, iterations);
+      resolve(result);
+    } catch (error) {
+      reject(error);
+    }
+  });
+}
+
+/**
+ * Benchmark PCM decoding through the native WAV mapping against libsndfile
+ * @param {Array<string>} filePaths - Files to decode (non-WAV files fall back to libsndfile in both runs)
+ * @param {boolean} coldCache - Drop each file from the page cache before decoding it (default: false)
+ * @returns {Promise<Array>} Per-reader files, decoded bytes, seconds and MB/s
+ */
+async function benchmarkPcmReaders(filePaths, coldCache = false) {
+  return new Promise((resolve, reject) => {
+    try {
+      const result = addon.benchmarkPcmReaders(filePaths, coldCache);
+      resolve(result);
+    } catch (error) {
+      reject(error);
+    }
+  });
+}
+
+/**
+ * Decode a file to 16-bit mono PCM the way fingerprinting does
+ * @param {string} filePath - Path to audio file
+ * @param {Object} options - sampleRate (default: 11025), maxDuration in seconds (0: whole file),
+ *   chunkBytes per read, integerPath and mappedReader (both default: true)
+ * @returns {Promise<Object>} Int16Array samples plus the source rate, channel count and decode path taken
+ */
+async function decodePcm(filePath, options = {}) {
+  return new Promise((resolve, reject) => {
+    try {
+      const result = addon.decodePcm(filePath, options);
+      resolve(result);
+    } catch (error) {
+      reject(error);
+    }
+  });
+}
+
 /**
  * Compare two fingerprints using sliding window approach for better silence padding handling
  * @param {Object} fingerprint1 - First fingerprint
@@ -214,6 +337,119 @@ async function addFileToIndex(filePath) {
   });
 }
 
+/**
+ * Add a file that is byte-identical to an indexed file, without decoding it
+ * @param {string} filePath - Path to the copy
+ * @param {number} sourceFileId - File ID of the indexed original
+ * @returns {Promise<number>} File ID in the index
+ */
+async function addIdenticalFileToIndex(filePath, sourceFileId) {
+  return new Promise((resolve, reject) => {
+    try {
+      const result = addon.addIdenticalFileToIndex(filePath, sourceFileId);
+      resolve(result);
+    } catch (error) {
+      reject(error);
+    }
+  });
+}
+
+/**
+ * Add file to the index and match it against the files already indexed
+ * @param {string} filePath - Path to audio file
+ * @returns {Promise<Object>} Insert result with fileId, groupId, isDuplicate and verified matches
+ */
+async function addFileAndMatch(filePath) {
+  return new Promise((resolve, reject) => {
+    try {
+      if (!fs.existsSync(filePath)) {
+        throw new Error(`File not found: ${filePath}`);
+      }
+      const result = addon.addFileAndMatch(filePath);
+      resolve(result);
+    } catch (error) {
+      reject(error);
+    }
+  });
+}
+
+/**
+ * Get duplicate groups maintained incrementally by addFileAndMatch
+ * @returns {Promise<Array>} Array of duplicate groups
+ */
+async function getOnlineDuplicateGroups() {
+  return new Promise((resolve, reject) => {
+    try {
+      const result = addon.getOnlineDuplicateGroups();
+      resolve(result);
+    } catch (error) {
+      reject(error);
+    }
+  });
+}
+
+/**
+ * Find the k best matches in the index for a fingerprint or audio file
+ * @param {Object|string} query - Fingerprint object or path to audio file
+ * @param {number} k - Maximum number of matches to return (default: 10)
+ * @param {number} minSimilarity - Minimum similarity score to report (default: 0.0)
+ * @param {number} voteCutoff - 0 verifies every candidate (exact); a fraction such as 0.5 stops once candidates
+ *   have fewer than that share of the k-th result's hash votes, which is faster but may miss matches (default: 0)
+ * @returns {Promise<Array>} Matches with fileId, filePath, similarity, bitErrorRate and offset, best first
+ */
+async function queryTopK(query, k = 10, minSimilarity = 0.0, voteCutoff = 0) {
+  return new Promise((resolve, reject) => {
+    try {
+      if (typeof query === 'string' && !fs.existsSync(query)) {
+        throw new Error(`File not found: ${query}`);
+      }
+      if (k < 1) {
+        throw new Error('k must be at least 1');
+      }
+      const result = addon.queryTopK(query, k, minSimilarity, voteCutoff);
+      resolve(result);
+    } catch (error) {
+      reject(error);
+    }
+  });
+}
+
+/**
+ * Read an indexed file's fingerprint back from the index
+ * @param {number} fileId - Id returned when the file was indexed
+ * @returns {Promise<Object|null>} Fingerprint object with the storage tier it was read from
+ *   ('hot', 'warm' or 'cold'), or null for an unknown id
+ */
+async function getIndexedFingerprint(fileId) {
+  return new Promise((resolve, reject) => {
+    try {
+      const result = addon.getIndexedFingerprint(fileId);
+      resolve(result);
+    } catch (error) {
+      reject(error);
+    }
+  });
+}
+
+/**
+ * Candidate file ids the index votes for, per fingerprint, before any comparison
+ * @param {Array<Object>} fingerprints - Fingerprint objects to look up
+ * @param {Object} options - Lookup options
+ * @param {boolean} options.batched - One posting-major pass over all fingerprints (default: true)
+ *   instead of one lookup per fingerprint
+ * @returns {Promise<Array<Array<number>>>} Candidate file ids for each fingerprint, most votes first
+ */
+async function findCandidates(fingerprints, options = {}) {
+  return new Promise((resolve, reject) => {
+    try {
+      const result = addon.findCandidates(fingerprints, options);
+      resolve(result);
+    } catch (error) {
+      reject(error);
+    }
+  });
+}
+
 /**
  * Find all duplicate groups in the index
  * @returns {Promise<Array>} Array of duplicate groups
@@ -282,6 +518,90 @@ async function generateFingerprintsBatch(filePaths, maxDuration) {
   });
 }
 
+/**
+ * Fingerprint files through the staged pipeline (I/O, decode, DSP, fingerprint)
+ * and add them to the index
+ * @param {string[]} filePaths - Array of file paths
+ * @param {Object} options - ioThreads (default: 2), decodeThreads, dspThreads, fingerprintThreads
+ *   (default: split across the remaining cores), queueCapacity (default: 8), maxBufferedMB (default: 512),
+ *   maxDuration (default: whole file),
+ *   prefetchDepth (default: 0 = off), prefetchBackend ('auto', 'io_uring' or 'threads'; default: 'auto'),
+ *   diskOrder (read files in on-disk order; default: false)
+ * @returns {Promise<Object>} File id per path (null on failure), errors, and per-stage utilisation and queue depths
+ */
+async function addFilesToIndexPipeline(filePaths, options = {}) {
+  return new Promise((resolve, reject) => {
+    try {
+      if (!Array.isArray(filePaths)) {
+        throw new Error('First argument must be an array of file paths');
+      }
+      const result = addon.addFilesToIndexPipeline(filePaths, options);
+      resolve(result);
+    } catch (error) {
+      reject(error);
+    }
+  });
+}
+
+/**
+ * Find byte-identical files without decoding them (size, then sampled-block hash, then full hash)
+ * @param {string[]} filePaths - Array of file paths
+ * @param {Object} options - sampleBlockBytes (default: 65536), numThreads (default: auto)
+ * @returns {Promise<Object>} Groups of identical paths (representative first) and pre-pass statistics
+ */
+async function findIdenticalFiles(filePaths, options = {}) {
+  return new Promise((resolve, reject) => {
+    try {
+      if (!Array.isArray(filePaths)) {
+        throw new Error('First argument must be an array of file paths');
+      }
+      const result = addon.findIdenticalFiles(filePaths, options);
+      resolve(result);
+    } catch (error) {
+      reject(error);
+    }
+  });
+}
+
+/**
+ * Order files by their location on disk so a cold scan reads them in one sweep
+ * (physical offset of the first extent via FIEMAP, falling back to inode number)
+ * @param {string[]} filePaths - Array of file paths
+ * @param {Object} options - useExtents (default: true), numThreads (default: auto)
+ * @returns {Promise<Object>} The paths in on-disk order and how each file was located
+ */
+async function orderFilesByDiskLayout(filePaths, options = {}) {
+  return new Promise((resolve, reject) => {
+    try {
+      if (!Array.isArray(filePaths)) {
+        throw new Error('First argument must be an array of file paths');
+      }
+      const result = addon.orderFilesByDiskLayout(filePaths, options);
+      resolve(result);
+    } catch (error) {
+      reject(error);
+    }
+  });
+}
+
+/**
+ * Drop files from the OS page cache so the next read hits the device (for cold-cache benchmarks)
+ * @param {string[]} filePaths - Array of file paths
+ * @returns {Promise<number>} Number of files evicted (0 where the platform cannot evict)
+ */
+async function evictPageCache(filePaths) {
+  return new Promise((resolve, reject) => {
+    try {
+      if (!Array.isArray(filePaths)) {
+        throw new Error('First argument must be an array of file paths');
+      }
+      resolve(addon.evictPageCache(filePaths));
+    } catch (error) {
+      reject(error);
+    }
+  });
+}
+
 /**
  * Find all duplicate groups using parallel processing
  * @param {number} numThreads - Number of threads to use (0 = auto-detect)
@@ -298,6 +618,122 @@ async function findAllDuplicatesParallel(numThreads = 0) {
   });
 }
 
+/**
+ * Find all duplicate groups with the bulk sort-merge self-join (batch jobs)
+ * @param {Object} options - Options object
+ * @param {number} options.numThreads - Number of threads to use (0 = auto-detect)
+ * @param {string} options.spillDirectory - Directory for spilling tuple partitions and vote runs to disk (default: in memory)
+ * @param {number} options.spillBufferTuples - Tuples buffered per partition before spilling (default: 65536)
+ * @param {number} options.maxRunLength - Skip hashes shared by more than this many frames (default: 4096)
+ * @returns {Promise<Array>} Array of duplicate groups
+ */
+async function findAllDuplicatesBulk(options = {}) {
+  return new Promise((resolve, reject) => {
+    try {
+      if (options.spillDirectory && !fs.existsSync(options.spillDirectory)) {
+        throw new Error(`Spill directory not found: ${options.spillDirectory}`);
+      }
+      const result = addon.findAllDuplicatesBulk(options);
+      resolve(result);
+    } catch (error) {
+      reject(error);
+    }
+  });
+}
+
+/**
+ * Candidate pairs the bulk self-join emits for the indexed files, before verification
+ * @param {Object} options - Same options as findAllDuplicatesBulk
+ * @returns {Promise<Array>} Array of { fileA, fileB, votes, offsetHint } sorted by fileA, fileB
+ */
+async function findBulkCandidatePairs(options = {}) {
+  return new Promise((resolve, reject) => {
+    try {
+      if (options.spillDirectory && !fs.existsSync(options.spillDirectory)) {
+        throw new Error(`Spill directory not found: ${options.spillDirectory}`);
+      }
+      const result = addon.findBulkCandidatePairs(options);
+      resolve(result);
+    } catch (error) {
+      reject(error);
+    }
+  });
+}
+
+/**
+ * Two-tier duplicate scan: fingerprint the first seconds of every file, find
+ * candidates among those prefixes and fingerprint in full only the files that
+ * have one. Does not use the index
+ * @param {string[]} filePaths - Array of file paths
+ * @param {Object} options - prefixSeconds (default: 30), minVotes (default: 5), maxRunLength (default: 4096),
+ *   numThreads (default: auto), similarityThreshold, bitErrorThreshold, maxAlignmentOffset
+ * @returns {Promise<Object>} Duplicate groups (fileIds are input positions), errors, and decode seconds saved
+ */
+async function findDuplicatesTwoTier(filePaths, options = {}) {
+  return new Promise((resolve, reject) => {
+    try {
+      if (!Array.isArray(filePaths)) {
+        throw new Error('First argument must be an array of file paths');
+      }
+      const result = addon.findDuplicatesTwoTier(filePaths, options);
+      resolve(result);
+    } catch (error) {
+      reject(error);
+    }
+  });
+}
+
+/**
+ * Find every file pair the quick filter accepts (hash-set Jaccard overlap at or
+ * above 60% of the similarity threshold)
+ * @param {string} method - 'prefix' for the prefix-filtering join, 'indexed' for per-file index queries,
+ *   'all' to check every file pair
+ * @returns {Promise<Array>} Array of { fileA, fileB, overlap } sorted by fileA, fileB
+ */
+async function findQuickFilterPairs(method = 'prefix') {
+  return new Promise((resolve, reject) => {
+    try {
+      const result = addon.findQuickFilterPairs(method);
+      resolve(result);
+    } catch (error) {
+      reject(error);
+    }
+  });
+}
+
+/**
+ * Train a shared compression dictionary from indexed fingerprints and recompress
+ * the index with it; files added later are compressed against the same dictionary
+ * @param {number} maxSamples - Maximum number of fingerprints to sample (default: 1000)
+ * @returns {Promise<Object>} Dictionary size and per-duration compression ratios before and after
+ */
+async function trainCompressionDictionary(maxSamples = 1000) {
+  return new Promise((resolve, reject) => {
+    try {
+      const result = addon.trainCompressionDictionary(maxSamples);
+      resolve(result);
+    } catch (error) {
+      reject(error);
+    }
+  });
+}
+
+/**
+ * Start, reconfigure or stop background tiering of indexed fingerprints
+ * @param {Object} options - hotBudgetMB, hotMinAccesses, coldAfterEpochs, coldDirectory, maxColdMB, intervalMs, enabled
+ * @returns {Promise<boolean>} Success status
+ */
+async function configureTiering(options = {}) {
+  return new Promise((resolve, reject) => {
+    try {
+      const result = addon.configureTiering(options);
+      resolve(result);
+    } catch (error) {
+      reject(error);
+    }
+  });
+}
+
 /**
  * Set similarity threshold for duplicate detection
  * @param {number} threshold - Similarity threshold (0.0 to 1.0)
@@ -355,6 +791,41 @@ async function setBitErrorThreshold(threshold) {
   });
 }
 
+/**
+ * Restrict candidates to files of similar length (whole-file duplicate mode)
+ * @param {number} minRatio - Minimum shorter/longer frame-count ratio (0 disables the window, default)
+ * @returns {Promise<boolean>} Success status
+ */
+async function setDurationRatioWindow(minRatio) {
+  return new Promise((resolve, reject) => {
+    try {
+      if (minRatio < 0 || minRatio > 1) {
+        throw new Error('Ratio must be between 0.0 and 1.0');
+      }
+      const result = addon.setDurationRatioWindow(minRatio);
+      resolve(result);
+    } catch (error) {
+      reject(error);
+    }
+  });
+}
+
+/**
+ * Collapse bit-identical fingerprints to one representative before pairwise verification
+ * @param {boolean} enabled - true to collapse (default), false to verify every file directly
+ * @returns {Promise<boolean>} Success status
+ */
+async function setExactDuplicateCollapse(enabled) {
+  return new Promise((resolve, reject) => {
+    try {
+      const result = addon.setExactDuplicateCollapse(enabled);
+      resolve(result);
+    } catch (error) {
+      reject(error);
+    }
+  });
+}
+
 /**
  * Get memory pool statistics
  * @returns {Promise<Object>} Memory pool statistics
@@ -424,17 +895,80 @@ function createSilenceHandlingConfig(overrides = {}) {
   };
 }
 
+/**
+ * Decide which files a scan has to decode when the exact-file pre-pass is enabled
+ * @param {string[]} audioFiles - Files found by the scan
+ * @param {boolean} enabled - Run the pre-pass
+ * @returns {Promise<Object>} Files to fingerprint, copies per representative and pre-pass statistics (null when disabled)
+ */
+async function planExactFilePrepass(audioFiles, enabled) {
+  if (!enabled || audioFiles.length < 2) {
+    return { files: audioFiles, copies: new Map(), stats: null };
+  }
+
+  const { groups, stats } = await findIdenticalFiles(audioFiles);
+  const copies = new Map();
+  const skipped = new Set();
+  for (const group of groups) {
+    copies.set(group[0], group.slice(1));
+    group.slice(1).forEach(file => skipped.add(file));
+  }
+
+  return {
+    files: audioFiles.filter(file => !skipped.has(file)),
+    copies,
+    stats: { ...stats, skippedDecodes: 0 }
+  };
+}
+
+/**
+ * Index the byte-identical copies of a representative that was just fingerprinted
+ * @param {Object} prepass - Result of planExactFilePrepass
+ * @param {string} filePath - Representative that was added
+ * @param {number} fileId - Its file ID in the index
+ */
+function addIdenticalCopies(prepass, filePath, fileId) {
+  const copies = prepass.copies.get(filePath);
+  if (!copies) {
+    return;
+  }
+  // A copy that cannot be added must not count against its representative
+  for (const copy of copies) {
+    try {
+      addon.addIdenticalFileToIndex(copy, fileId);
+      prepass.stats.skippedDecodes++;
+    } catch (error) {
+      console.warn(`Warning: Could not process ${copy}: ${error.message}`);
+    }
+  }
+}
+
+/**
+ * Put the files a scan decodes into on-disk order when requested
+ * @param {string[]} files - Files to decode
+ * @param {boolean} enabled - Reorder them
+ * @returns {Promise<Object>} Files in decode order and ordering statistics (null when disabled)
+ */
+async function planDiskOrder(files, enabled) {
+  if (!enabled || files.length < 2) {
+    return { files, stats: null };
+  }
+  return orderFilesByDiskLayout(files);
+}
+
 /**
  * Scan directory for audio files and find duplicates
  * @param {string} directoryPath - Path to directory
  * @param {Object} options - Options object
  * @param {number} options.threshold - Similarity threshold (default: 0.85)
  * @param {string[]} options.extensions - File extensions to scan (default: ['.wav'])
+ * @param {boolean} options.exactFilePrepass - Fingerprint only one file per set of byte-identical files (default: false)
+ * @param {boolean} options.diskOrder - Decode files in on-disk order rather than walk order (default: false)
  * @param {function} options.onProgress - Progress callback
- * @returns {Promise<Array>} Array of duplicate groups
+ * @returns {Promise<Array>} Array of duplicate groups (with exactFilePrepass statistics when enabled)
  */
 async function scanDirectoryForDuplicates(directoryPath, options = {}) {
-  const { threshold = 0.85, extensions = ['.wav'], onProgress } = options;
+  const { threshold = 0.85, extensions = ['.wav'], exactFilePrepass = false, diskOrder = false, onProgress } = options;
 
   if (!fs.existsSync(directoryPath)) {
     throw new Error(`Directory not found: ${directoryPath}`);
@@ -463,24 +997,36 @@ async function scanDirectoryForDuplicates(directoryPath, options = {}) {
 
   scanDirectory(directoryPath);
 
+  const prepass = await planExactFilePrepass(audioFiles, exactFilePrepass);
+  const ordering = await planDiskOrder(prepass.files, diskOrder);
+  const filesToDecode = ordering.files;
+
   // Add files to index
-  for (let i = 0; i < audioFiles.length; i++) {
+  for (let i = 0; i < filesToDecode.length; i++) {
     try {
-      await addFileToIndex(audioFiles[i]);
+      const fileId = await addFileToIndex(filesToDecode[i]);
+      addIdenticalCopies(prepass, filesToDecode[i], fileId);
       if (onProgress) {
         onProgress({
           current: i + 1,
-          total: audioFiles.length,
-          file: audioFiles[i]
+          total: filesToDecode.length,
+          file: filesToDecode[i]
         });
       }
     } catch (error) {
-      console.warn(`Warning: Could not process ${audioFiles[i]}: ${error.message}`);
+      console.warn(`Warning: Could not process ${filesToDecode[i]}: ${error.message}`);
     }
   }
 
   // Find duplicates
-  return await findAllDuplicates();
+  const groups = await findAllDuplicates();
+  if (prepass.stats) {
+    groups.exactFilePrepass = prepass.stats;
+  }
+  if (ordering.stats) {
+    groups.diskOrder = ordering.stats;
+  }
+  return groups;
 }
 
 /**
@@ -488,11 +1034,13 @@ async function scanDirectoryForDuplicates(directoryPath, options = {}) {
  * @param {string[]} directoryPaths - Array of directory paths
  * @param {Object} options - Options object
  * @param {number} options.threshold - Similarity threshold (default: 0.85)
+ * @param {boolean} options.exactFilePrepass - Fingerprint only one file per set of byte-identical files (default: false)
+ * @param {boolean} options.diskOrder - Decode files in on-disk order rather than walk order (default: false)
  * @param {function} options.onProgress - Progress callback
- * @returns {Promise<Array>} Array of duplicate groups
+ * @returns {Promise<Array>} Array of duplicate groups (with exactFilePrepass statistics when enabled)
  */
 async function scanMultipleDirectoriesForDuplicates(directoryPaths, options = {}) {
-  const { threshold = 0.85, extensions = ['.wav'], onProgress } = options;
+  const { threshold = 0.85, extensions = ['.wav'], exactFilePrepass = false, diskOrder = false, onProgress } = options;
 
   // Validate all directories exist
   for (const directoryPath of directoryPaths) {
@@ -527,25 +1075,37 @@ async function scanMultipleDirectoriesForDuplicates(directoryPaths, options = {}
     scanDirectory(directoryPath);
   }
 
+  const prepass = await planExactFilePrepass(audioFiles, exactFilePrepass);
+  const ordering = await planDiskOrder(prepass.files, diskOrder);
+  const filesToDecode = ordering.files;
+
   // Add files to index
-  for (let i = 0; i < audioFiles.length; i++) {
+  for (let i = 0; i < filesToDecode.length; i++) {
     try {
-      await addFileToIndex(audioFiles[i]);
+      const fileId = await addFileToIndex(filesToDecode[i]);
+      addIdenticalCopies(prepass, filesToDecode[i], fileId);
       if (onProgress) {
         onProgress({
           current: i + 1,
-          total: audioFiles.length,
-          file: audioFiles[i],
-          currentDirectory: path.dirname(audioFiles[i])
+          total: filesToDecode.length,
+          file: filesToDecode[i],
+          currentDirectory: path.dirname(filesToDecode[i])
         });
       }
     } catch (error) {
-      console.warn(`Warning: Could not process ${audioFiles[i]}: ${error.message}`);
+      console.warn(`Warning: Could not process ${filesToDecode[i]}: ${error.message}`);
     }
   }
 
   // Find duplicates
-  return await findAllDuplicates();
+  const groups = await findAllDuplicates();
+  if (prepass.stats) {
+    groups.exactFilePrepass = prepass.stats;
+  }
+  if (ordering.stats) {
+    groups.diskOrder = ordering.stats;
+  }
+  return groups;
 }
 
 /**
@@ -556,8 +1116,10 @@ async function scanMultipleDirectoriesForDuplicates(directoryPaths, options = {}
  * @param {boolean} options.useSlidingWindow - Use sliding window comparison (default: true)
  * @param {boolean} options.enableSilenceTrimming - Enable silence trimming preprocessing (default: true)
  * @param {Object} options.preprocessConfig - Custom preprocessing configuration
+ * @param {boolean} options.exactFilePrepass - Fingerprint only one file per set of byte-identical files (default: false)
+ * @param {boolean} options.diskOrder - Decode files in on-disk order rather than walk order (default: false)
  * @param {function} options.onProgress - Progress callback
- * @returns {Promise<Array>} Array of duplicate groups
+ * @returns {Promise<Array>} Array of duplicate groups (with exactFilePrepass statistics when enabled)
  */
 async function scanDirectoryForDuplicatesEnhanced(directoryPath, options = {}) {
   const {
@@ -566,6 +1128,8 @@ async function scanDirectoryForDuplicatesEnhanced(directoryPath, options = {}) {
     useSlidingWindow = true,
     enableSilenceTrimming = true,
     preprocessConfig = {},
+    exactFilePrepass = false,
+    diskOrder = false,
     onProgress
   } = options;
 
@@ -605,35 +1169,48 @@ async function scanDirectoryForDuplicatesEnhanced(directoryPath, options = {}) {
 
   scanDirectory(directoryPath);
 
+  const prepass = await planExactFilePrepass(audioFiles, exactFilePrepass);
+  const ordering = await planDiskOrder(prepass.files, diskOrder);
+  const filesToDecode = ordering.files;
+
   // Add files to index with optional preprocessing
-  for (let i = 0; i < audioFiles.length; i++) {
+  for (let i = 0; i < filesToDecode.length; i++) {
     try {
+      let fileId;
       if (finalPreprocessConfig) {
         // Use preprocessing-enabled fingerprint generation
-        const fingerprint = await generateFingerprintWithPreprocessing(audioFiles[i], finalPreprocessConfig);
+        const fingerprint = await generateFingerprintWithPreprocessing(filesToDecode[i], finalPreprocessConfig);
         // Note: addFingerprintToIndex would need to be implemented in the native addon
-        await addFileToIndex(audioFiles[i]); // Fallback to regular for now
+        fileId = await addFileToIndex(filesToDecode[i]); // Fallback to regular for now
       } else {
-        await addFileToIndex(audioFiles[i]);
+        fileId = await addFileToIndex(filesToDecode[i]);
       }
+      addIdenticalCopies(prepass, filesToDecode[i], fileId);
 
       if (onProgress) {
         onProgress({
           current: i + 1,
-          total: audioFiles.length,
-          file: audioFiles[i],
+          total: filesToDecode.length,
+          file: filesToDecode[i],
           preprocessing: !!finalPreprocessConfig,
           slidingWindow: useSlidingWindow
         });
       }
     } catch (error) {
-      console.warn(`Warning: Could not process ${audioFiles[i]}: ${error.message}`);
+      console.warn(`Warning: Could not process ${filesToDecode[i]}: ${error.message}`);
     }
   }
 
   // Find duplicates using appropriate method
   // Note: findAllDuplicatesSlidingWindow would need to be implemented in the native addon
-  return await findAllDuplicates();
+  const groups = await findAllDuplicates();
+  if (prepass.stats) {
+    groups.exactFilePrepass = prepass.stats;
+  }
+  if (ordering.stats) {
+    groups.diskOrder = ordering.stats;
+  }
+  return groups;
 }
 
 /**
@@ -643,8 +1220,10 @@ async function scanDirectoryForDuplicatesEnhanced(directoryPath, options = {}) {
  * @param {number} options.threshold - Similarity threshold (default: 0.85)
  * @param {number} options.concurrency - Number of concurrent operations (default: CPU cores)
  * @param {number} options.batchSize - Files to process in each batch (default: 50)
+ * @param {boolean} options.exactFilePrepass - Fingerprint only one file per set of byte-identical files (default: false)
+ * @param {boolean} options.diskOrder - Decode files in on-disk order rather than walk order (default: false)
  * @param {function} options.onProgress - Progress callback
- * @returns {Promise<Array>} Array of duplicate groups
+ * @returns {Promise<Array>} Array of duplicate groups (with exactFilePrepass statistics when enabled)
  */
 async function scanDirectoryForDuplicatesParallel(directoryPath, options = {}) {
   const {
@@ -652,6 +1231,8 @@ async function scanDirectoryForDuplicatesParallel(directoryPath, options = {}) {
     extensions = ['.wav'],
     concurrency = require('os').cpus().length,
     batchSize = 50,
+    exactFilePrepass = false,
+    diskOrder = false,
     onProgress
   } = options;
 
@@ -731,23 +1312,28 @@ async function scanDirectoryForDuplicatesParallel(directoryPath, options = {}) {
     return [];
   }
 
+  const prepass = await planExactFilePrepass(audioFiles, exactFilePrepass);
+  const ordering = await planDiskOrder(prepass.files, diskOrder);
+  const filesToDecode = ordering.files;
+
   // Add files to index sequentially (OpenMP parallelizes the duplicate detection)
-  for (let i = 0; i < audioFiles.length; i++) {
+  for (let i = 0; i < filesToDecode.length; i++) {
     try {
-      await addFileToIndex(audioFiles[i]);
+      const fileId = await addFileToIndex(filesToDecode[i]);
+      addIdenticalCopies(prepass, filesToDecode[i], fileId);
 
       if (onProgress) {
         onProgress({
           phase: 'processing',
           current: i + 1,
-          total: audioFiles.length,
-          file: audioFiles[i],
+          total: filesToDecode.length,
+          file: filesToDecode[i],
           parallel: true,
           concurrency: concurrency || require('os').cpus().length
         });
       }
     } catch (error) {
-      console.warn(`Warning: Could not process ${audioFiles[i]}: ${error.message}`);
+      console.warn(`Warning: Could not process ${filesToDecode[i]}: ${error.message}`);
     }
   }
 
@@ -759,7 +1345,14 @@ async function scanDirectoryForDuplicatesParallel(directoryPath, options = {}) {
     });
   }
 
-  return await findAllDuplicatesParallel(concurrency);
+  const groups = await findAllDuplicatesParallel(concurrency);
+  if (prepass.stats) {
+    groups.exactFilePrepass = prepass.stats;
+  }
+  if (ordering.stats) {
+    groups.diskOrder = ordering.stats;
+  }
+  return groups;
 }
 
 // Export all functions
@@ -767,24 +1360,49 @@ module.exports = {
   // Core fingerprinting functions
   generateFingerprint,
   generateFingerprintLimited,
+  configureSegmentedFingerprinting,
+  generateSampledFingerprint,
+  compareSampledFingerprints,
   generateFingerprintWithPreprocessing,
   generateFingerprintsBatch,
+  findIdenticalFiles,
+  orderFilesByDiskLayout,
+  evictPageCache,
   testPreprocessing,
   compareFingerprints,
+  compareFingerprintsAtOffset,
   compareFingerprintsSlidingWindow,
+  benchmarkFingerprintCodecs,
+  benchmarkPcmReaders,
+  decodePcm,
 
   // Index management functions
   initializeIndex,
   addFileToIndex,
+  addIdenticalFileToIndex,
+  addFilesToIndexPipeline,
+  addFileAndMatch,
+  getOnlineDuplicateGroups,
+  queryTopK,
+  getIndexedFingerprint,
+  findCandidates,
   findAllDuplicates,
   findAllDuplicatesParallel,
+  findAllDuplicatesBulk,
+  findBulkCandidatePairs,
+  findDuplicatesTwoTier,
+  findQuickFilterPairs,
   getIndexStats,
+  trainCompressionDictionary,
+  configureTiering,
   clearIndex,
 
   // Configuration functions
   setSimilarityThreshold,
   setMaxAlignmentOffset,
   setBitErrorThreshold,
+  setDurationRatioWindow,
+  setExactDuplicateCollapse,
   createSilenceHandlingConfig,
 
   // Memory monitoring functions
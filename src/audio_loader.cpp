@@ -1,5 +1,6 @@
 #include "audio_loader.h"
 #include "audio_preprocessor.h"
+#include "streaming_resampler.h"
 #include <algorithm>
 #include <cmath>
 #include <iostream>
@@ -80,7 +81,7 @@ std::unique_ptr<AudioData> AudioLoader::resample(const AudioData& input, int tar
     }
 
     auto resampled = std::make_unique<AudioData>();
-    resampled->samples = linear_resample(input.samples, input.sample_rate, target_sample_rate);
+    resampled->samples = resample_samples(input.samples, input.sample_rate, target_sample_rate);
     resampled->sample_rate = target_sample_rate;
     resampled->channels = input.channels;
     resampled->frames = resampled->samples.size();
@@ -138,31 +139,12 @@ void AudioLoader::convert_to_mono(std::vector<float>& samples, int channels) {
     samples = std::move(mono_samples);
 }
 
-std::vector<float> AudioLoader::linear_resample(const std::vector<float>& input, int input_rate, int output_rate) {
+std::vector<float> AudioLoader::resample_samples(const std::vector<float>& input, int input_rate, int output_rate) {
     if (input_rate == output_rate) {
         return input;
     }
 
-    double ratio = static_cast<double>(output_rate) / input_rate;
-    size_t output_size = static_cast<size_t>(input.size() * ratio);
-    std::vector<float> output(output_size);
-
-    for (size_t i = 0; i < output_size; ++i) {
-        double input_index = i / ratio;
-        size_t index = static_cast<size_t>(input_index);
-        double frac = input_index - index;
-
-        if (index + 1 < input.size()) {
-            // Linear interpolation
-            output[i] = input[index] * (1.0 - frac) + input[index + 1] * frac;
-        } else if (index < input.size()) {
-            output[i] = input[index];
-        } else {
-            output[i] = 0.0f;
-        }
-    }
-
-    return output;
+    return StreamingResampler::resample(input, input_rate, output_rate);
 }
 
 }
\ No newline at end of file
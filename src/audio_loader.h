@@ -44,8 +44,8 @@ private:
     // Convert multi-channel audio to mono
     void convert_to_mono(std::vector<float>& samples, int channels);
 
-    // Simple linear resampling (for basic sample rate conversion)
-    std::vector<float> linear_resample(const std::vector<float>& input, int input_rate, int output_rate);
+    // Anti-aliased polyphase resampling (StreamingResampler over the whole buffer)
+    std::vector<float> resample_samples(const std::vector<float>& input, int input_rate, int output_rate);
 };
 
 }
\ No newline at end of file
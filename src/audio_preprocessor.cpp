@@ -1,4 +1,5 @@
 #include "audio_preprocessor.h"
+#include "streaming_resampler.h"
 #include <algorithm>
 #include <cmath>
 #include <iostream>
@@ -273,26 +274,7 @@ std::vector<float> AudioPreprocessor::resample_sinc(const std::vector<float>& in
         return input;
     }
 
-    // Simple linear interpolation for now - can be replaced with libsamplerate later
-    double ratio = static_cast<double>(output_rate) / input_rate;
-    size_t output_size = static_cast<size_t>(input.size() * ratio);
-
-    std::vector<float> output(output_size);
-
-    for (size_t i = 0; i < output_size; ++i) {
-        double src_index = i / ratio;
-        size_t src_index_floor = static_cast<size_t>(src_index);
-
-        if (src_index_floor >= input.size() - 1) {
-            output[i] = input.back();
-        } else {
-            double fraction = src_index - src_index_floor;
-            output[i] = input[src_index_floor] * (1.0 - fraction) +
-                       input[src_index_floor + 1] * fraction;
-        }
-    }
-
-    return output;
+    return StreamingResampler::resample(input, input_rate, output_rate);
 }
 
 float AudioPreprocessor::calculate_energy(const std::vector<float>& samples,
@@ -67,7 +67,7 @@ public:
 private:
     PreprocessConfig config_;
 
-    // Internal resampling using higher quality algorithm
+    // Windowed-sinc polyphase resampling (see StreamingResampler)
     std::vector<float> resample_sinc(const std::vector<float>& input,
                                    int input_rate, int output_rate);
 
@@ -0,0 +1,148 @@
+#pragma once
+
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <thread>
+#include <utility>
+#include <cstddef>
+#include <cstdint>
+
+namespace AudioDuplicates {
+
+/**
+ * Bounded multi-producer multi-consumer queue (Vyukov's sequence-numbered ring)
+ * try_push / try_pop are lock-free; push / pop wait with spin-then-sleep backoff.
+ * close() ends the stream: pop returns false once the queue is closed and drained
+ */
+template <typename T>
+class BoundedQueue {
+public:
+    // Capacity is rounded up to a power of two
+    explicit BoundedQueue(size_t capacity)
+        : capacity_(round_up(capacity)), mask_(capacity_ - 1), cells_(new Cell[capacity_]),
+          enqueue_pos_(0), dequeue_pos_(0), closed_(false) {
+        for (size_t i = 0; i < capacity_; ++i) {
+            cells_[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    BoundedQueue(const BoundedQueue&) = delete;
+    BoundedQueue& operator=(const BoundedQueue&) = delete;
+
+    bool try_push(T& value) {
+        Cell* cell;
+        size_t pos = enqueue_pos_.load(std::memory_order_relaxed);
+        for (;;) {
+            cell = &cells_[pos & mask_];
+            const size_t seq = cell->sequence.load(std::memory_order_acquire);
+            const intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos);
+            if (diff == 0) {
+                if (enqueue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false; // Full
+            } else {
+                pos = enqueue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+        cell->value = std::move(value);
+        cell->sequence.store(pos + 1, std::memory_order_release);
+        return true;
+    }
+
+    bool try_pop(T& out) {
+        Cell* cell;
+        size_t pos = dequeue_pos_.load(std::memory_order_relaxed);
+        for (;;) {
+            cell = &cells_[pos & mask_];
+            const size_t seq = cell->sequence.load(std::memory_order_acquire);
+            const intptr_t diff = static_cast<intptr_t>(seq) - static_cast<intptr_t>(pos + 1);
+            if (diff == 0) {
+                if (dequeue_pos_.compare_exchange_weak(pos, pos + 1, std::memory_order_relaxed)) {
+                    break;
+                }
+            } else if (diff < 0) {
+                return false; // Empty
+            } else {
+                pos = dequeue_pos_.load(std::memory_order_relaxed);
+            }
+        }
+        out = std::move(cell->value);
+        cell->sequence.store(pos + mask_ + 1, std::memory_order_release);
+        return true;
+    }
+
+    // Wait for space; value is moved from only on success (always, unless closed)
+    bool push(T& value) {
+        for (size_t attempt = 0; !try_push(value); ++attempt) {
+            if (closed_.load(std::memory_order_acquire)) {
+                return false;
+            }
+            backoff(attempt);
+        }
+        return true;
+    }
+
+    // Wait for an item; false once the queue is closed and empty
+    bool pop(T& out) {
+        for (size_t attempt = 0; !try_pop(out); ++attempt) {
+            if (closed_.load(std::memory_order_acquire)) {
+                // Nothing is pushed after close, so one more miss means drained
+                return try_pop(out);
+            }
+            backoff(attempt);
+        }
+        return true;
+    }
+
+    void close() { closed_.store(true, std::memory_order_release); }
+    bool closed() const { return closed_.load(std::memory_order_acquire); }
+
+    // Items currently queued; approximate while producers and consumers are active
+    size_t depth() const {
+        const size_t head = dequeue_pos_.load(std::memory_order_relaxed);
+        const size_t tail = enqueue_pos_.load(std::memory_order_relaxed);
+        return tail > head ? tail - head : 0;
+    }
+
+    size_t capacity() const { return capacity_; }
+
+private:
+    struct Cell {
+        std::atomic<size_t> sequence;
+        T value;
+    };
+
+    static constexpr size_t CACHE_LINE = 64;
+
+    const size_t capacity_;
+    const size_t mask_;
+    std::unique_ptr<Cell[]> cells_;
+    alignas(CACHE_LINE) std::atomic<size_t> enqueue_pos_;
+    alignas(CACHE_LINE) std::atomic<size_t> dequeue_pos_;
+    alignas(CACHE_LINE) std::atomic<bool> closed_;
+
+    static size_t round_up(size_t capacity) {
+        size_t rounded = 2;
+        while (rounded < capacity) {
+            rounded <<= 1;
+        }
+        return rounded;
+    }
+
+    // Spin briefly, then yield, then sleep so idle stages leave their cores to busy ones
+    static void backoff(size_t attempt) {
+        if (attempt < 64) {
+            return;
+        }
+        if (attempt < 128) {
+            std::this_thread::yield();
+            return;
+        }
+        std::this_thread::sleep_for(std::chrono::microseconds(attempt < 1024 ? 50 : 500));
+    }
+};
+
+} // namespace AudioDuplicates
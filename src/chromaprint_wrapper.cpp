@@ -19,8 +19,7 @@ ChromaprintWrapper::~ChromaprintWrapper() {
 
 std::unique_ptr<Fingerprint> ChromaprintWrapper::generate_fingerprint(const std::string& file_path) {
     try {
-        auto audio_data = audio_loader_.load(file_path);
-        return generate_fingerprint(*audio_data, file_path);
+        return generate_fingerprint_pcm(file_path, 0);
     } catch (const std::exception& e) {
         throw std::runtime_error("Failed to generate fingerprint for " + file_path + ": " + e.what());
     }
@@ -61,60 +60,34 @@ std::unique_ptr<Fingerprint> ChromaprintWrapper::generate_fingerprint(const Audi
                        return static_cast<int16_t>(clamped * 32767.0f);
                    });
 
-    // Start Chromaprint processing
-    if (!chromaprint_start(context_, CHROMAPRINT_SAMPLE_RATE, 1)) {
-        throw std::runtime_error("Failed to start Chromaprint processing");
-    }
+    return fingerprint_samples(int_samples.data(), int_samples.size(), data_to_use->duration, file_path);
+}
 
-    // Feed audio data to Chromaprint
-    if (!chromaprint_feed(context_, int_samples.data(), int_samples.size())) {
-        throw std::runtime_error("Failed to feed audio data to Chromaprint");
+std::unique_ptr<Fingerprint> ChromaprintWrapper::generate_fingerprint_limited(const std::string& file_path, int max_duration) {
+    try {
+        return generate_fingerprint_pcm(file_path, max_duration);
+    } catch (const std::exception& e) {
+        throw std::runtime_error("Failed to generate limited fingerprint for " + file_path + ": " + e.what());
     }
+}
 
-    // Finish processing and get fingerprint
-    if (!chromaprint_finish(context_)) {
-        throw std::runtime_error("Failed to finish Chromaprint processing");
+std::unique_ptr<Fingerprint> ChromaprintWrapper::generate_fingerprint_pcm(const std::string& file_path, int max_duration) {
+    std::vector<int16_t> samples = pcm_decoder_.decode_all(file_path, CHROMAPRINT_SAMPLE_RATE, max_duration);
+    if (samples.empty()) {
+        throw std::runtime_error("Empty audio data");
     }
 
-    // Get raw fingerprint data
-    uint32_t* fp_data = nullptr;
-    int fp_size = 0;
+    const double duration = static_cast<double>(samples.size()) / CHROMAPRINT_SAMPLE_RATE;
 
-    if (!chromaprint_get_raw_fingerprint(context_, &fp_data, &fp_size)) {
-        throw std::runtime_error("Failed to get raw fingerprint from Chromaprint");
+    // Double short audio files to meet minimum duration requirement
+    const double MIN_DURATION_THRESHOLD = 3.0; // seconds
+    if (duration < MIN_DURATION_THRESHOLD) {
+        const size_t count = samples.size();
+        samples.resize(count * 2);
+        std::copy(samples.begin(), samples.begin() + count, samples.begin() + count);
     }
 
-    // Create fingerprint object
-    auto fingerprint = std::make_unique<Fingerprint>();
-    fingerprint->data.assign(fp_data, fp_data + fp_size);
-    fingerprint->sample_rate = CHROMAPRINT_SAMPLE_RATE;
-    fingerprint->duration = data_to_use->duration;
-    fingerprint->file_path = file_path;
-
-    // Free Chromaprint-allocated memory
-    chromaprint_dealloc(fp_data);
-
-    return fingerprint;
-}
-
-std::unique_ptr<Fingerprint> ChromaprintWrapper::generate_fingerprint_limited(const std::string& file_path, int max_duration) {
-    try {
-        auto audio_data = audio_loader_.load(file_path);
-
-        // Limit audio duration if necessary
-        if (audio_data->duration > max_duration) {
-            size_t max_samples = max_duration * audio_data->sample_rate;
-            if (audio_data->samples.size() > max_samples) {
-                audio_data->samples.resize(max_samples);
-                audio_data->frames = max_samples;
-                audio_data->duration = max_duration;
-            }
-        }
-
-        return generate_fingerprint(*audio_data, file_path);
-    } catch (const std::exception& e) {
-        throw std::runtime_error("Failed to generate limited fingerprint for " + file_path + ": " + e.what());
-    }
+    return fingerprint_samples(samples.data(), samples.size(), duration, file_path);
 }
 
 std::unique_ptr<Fingerprint> ChromaprintWrapper::generate_fingerprint_with_preprocessing(
@@ -184,39 +157,19 @@ std::unique_ptr<Fingerprint> ChromaprintWrapper::generate_fingerprint_with_smart
                        return static_cast<int16_t>(clamped * 32767.0f);
                    });
 
-    // Start Chromaprint processing
-    if (!chromaprint_start(context_, CHROMAPRINT_SAMPLE_RATE, 1)) {
-        throw std::runtime_error("Failed to start Chromaprint processing");
-    }
-
-    // Feed audio data to Chromaprint
-    if (!chromaprint_feed(context_, int_samples.data(), int_samples.size())) {
-        throw std::runtime_error("Failed to feed audio data to Chromaprint");
-    }
-
-    // Finish processing and get fingerprint
-    if (!chromaprint_finish(context_)) {
-        throw std::runtime_error("Failed to finish Chromaprint processing");
-    }
-
-    // Get raw fingerprint data
-    uint32_t* fp_data = nullptr;
-    int fp_size = 0;
-
-    if (!chromaprint_get_raw_fingerprint(context_, &fp_data, &fp_size)) {
-        throw std::runtime_error("Failed to get raw fingerprint from Chromaprint");
-    }
+    return fingerprint_samples(int_samples.data(), int_samples.size(), data_to_use->duration, file_path);
+}
 
-    // Create fingerprint object
+std::unique_ptr<Fingerprint> ChromaprintWrapper::fingerprint_samples(const int16_t* samples, size_t count,
+                                                                  double duration, const std::string& file_path) {
     auto fingerprint = std::make_unique<Fingerprint>();
-    fingerprint->data.assign(fp_data, fp_data + fp_size);
+    run_chromaprint(context_, CHROMAPRINT_SAMPLE_RATE, fingerprint->data, [&](const auto& feed) {
+        feed(samples, count);
+    });
     fingerprint->sample_rate = CHROMAPRINT_SAMPLE_RATE;
-    fingerprint->duration = data_to_use->duration;
+    fingerprint->duration = duration;
     fingerprint->file_path = file_path;
 
-    // Free Chromaprint-allocated memory
-    chromaprint_dealloc(fp_data);
-
     return fingerprint;
 }
 
@@ -3,8 +3,12 @@
 #include <vector>
 #include <string>
 #include <memory>
+#include <cstdint>
+#include <cstddef>
+#include <stdexcept>
 #include <chromaprint.h>
 #include "audio_loader.h"
+#include "pcm_decoder.h"
 
 namespace AudioDuplicates {
 
@@ -18,6 +22,81 @@ struct Fingerprint {
     std::string file_path;
 };
 
+// Non-owning view of fingerprint frames and their metadata; cheap to pass by value
+struct FingerprintView {
+    const uint32_t* data;
+    size_t size;
+    int sample_rate;
+    double duration;
+
+    FingerprintView() : data(nullptr), size(0), sample_rate(0), duration(0.0) {}
+    FingerprintView(const uint32_t* d, size_t n, int rate, double dur)
+        : data(d), size(n), sample_rate(rate), duration(dur) {}
+    FingerprintView(const Fingerprint& fp)
+        : data(fp.data.data()), size(fp.data.size()), sample_rate(fp.sample_rate), duration(fp.duration) {}
+};
+
+// Coarse fingerprint of a few short spans of a file, stored back to back.
+// Files shorter than the spans together are kept as one span of the whole file
+struct SampledFingerprint {
+    std::vector<uint32_t> data;
+    std::vector<uint32_t> span_offsets;  // Start of each span in data, plus data.size()
+    std::vector<double> span_starts;     // Start of each span in the file, seconds
+    double items_per_second;             // Fingerprint items per second of audio
+    int sample_rate;
+    double duration;                     // Whole file, seconds
+    double decoded_seconds;              // Audio actually decoded for the spans
+    std::string file_path;
+
+    size_t span_count() const { return span_starts.size(); }
+    FingerprintView span(size_t i) const {
+        return FingerprintView(data.data() + span_offsets[i], span_offsets[i + 1] - span_offsets[i],
+                               sample_rate, static_cast<double>(span_offsets[i + 1] - span_offsets[i]) / items_per_second);
+    }
+};
+
+// Raw frames of the start of a file, kept so the full fingerprint can continue
+// from there without decoding the whole prefix again
+struct PrefixFingerprint {
+    Fingerprint fingerprint;   // Prefix frames; duration is the length of the prefix
+    int64_t decoded_frames;    // Source frames behind the prefix
+    int64_t total_frames;      // Whole file, source frames
+    int source_rate;
+    bool complete;             // The prefix reached the end of the file
+};
+
+// One start/feed/finish run of a Chromaprint context, shared by every path that
+// fingerprints audio: produce(feed) passes each block of mono samples at
+// sample_rate to feed(samples, count), and the raw frames are stored in raw
+template <typename Produce>
+void run_chromaprint(ChromaprintContext* ctx, int sample_rate, std::vector<uint32_t>& raw, Produce&& produce) {
+    if (!ctx) {
+        throw std::runtime_error("Failed to create Chromaprint context");
+    }
+    if (!chromaprint_start(ctx, sample_rate, 1)) {
+        throw std::runtime_error("Failed to start Chromaprint");
+    }
+
+    auto feed = [ctx](const int16_t* samples, size_t count) {
+        if (count > 0 && !chromaprint_feed(ctx, samples, static_cast<int>(count))) {
+            throw std::runtime_error("Failed to feed audio data to Chromaprint");
+        }
+    };
+    produce(feed);
+
+    if (!chromaprint_finish(ctx)) {
+        throw std::runtime_error("Failed to finish Chromaprint processing");
+    }
+
+    uint32_t* raw_fp_data = nullptr;
+    int fp_size = 0;
+    if (!chromaprint_get_raw_fingerprint(ctx, &raw_fp_data, &fp_size)) {
+        throw std::runtime_error("Failed to get fingerprint");
+    }
+    std::unique_ptr<uint32_t, void (*)(void*)> frames(raw_fp_data, chromaprint_dealloc);
+    raw.assign(frames.get(), frames.get() + fp_size);
+}
+
 class ChromaprintWrapper {
 public:
     ChromaprintWrapper();
@@ -51,6 +130,7 @@ public:
 private:
     ChromaprintContext* context_;
     AudioLoader audio_loader_;
+    PcmDecoder pcm_decoder_;
     int algorithm_;
 
     static const int CHROMAPRINT_SAMPLE_RATE = 11025;
@@ -61,6 +141,14 @@ private:
 
     // Free Chromaprint context
     void cleanup_context();
+
+    // Paths without float preprocessing: decode straight to int16 at the fingerprint
+    // rate (max_duration <= 0 decodes everything), doubling short signals
+    std::unique_ptr<Fingerprint> generate_fingerprint_pcm(const std::string& file_path, int max_duration);
+
+    // Run Chromaprint over 16-bit mono samples at CHROMAPRINT_SAMPLE_RATE
+    std::unique_ptr<Fingerprint> fingerprint_samples(const int16_t* samples, size_t count,
+                                                     double duration, const std::string& file_path);
 };
 
 }
\ No newline at end of file
@@ -1,53 +1,251 @@
 #include "compressed_fingerprint.h"
+#include <algorithm>
 #include <stdexcept>
 #include <cstring>
+#include <unordered_map>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
 
 namespace AudioDuplicates {
 
+namespace {
+
+// Transpose an 8x8 bit matrix held row-per-byte (bit c of byte r moves to bit r of byte c)
+inline uint64_t transpose_8x8(uint64_t x) {
+    uint64_t t;
+    t = (x ^ (x >> 7)) & 0x00AA00AA00AA00AAULL;
+    x = x ^ t ^ (t << 7);
+    t = (x ^ (x >> 14)) & 0x0000CCCC0000CCCCULL;
+    x = x ^ t ^ (t << 14);
+    t = (x ^ (x >> 28)) & 0x00000000F0F0F0F0ULL;
+    x = x ^ t ^ (t << 28);
+    return x;
+}
+
+// Fixed-size dictionary training segment (FingerprintDictionary::SEGMENT_SIZE bytes)
+struct Segment {
+    uint64_t low;
+    uint64_t high;
+
+    bool operator==(const Segment& other) const { return low == other.low && high == other.high; }
+};
+
+struct SegmentHash {
+    size_t operator()(const Segment& segment) const {
+        return static_cast<size_t>((segment.low * 0x9E3779B97F4A7C15ULL) ^ (segment.high + (segment.low >> 29)));
+    }
+};
+
+static_assert(sizeof(Segment) == FingerprintDictionary::SEGMENT_SIZE, "Segment must cover one dictionary segment");
+
+} // namespace
+
+FingerprintDictionary::FingerprintDictionary(std::vector<uint8_t>&& data)
+    : data_(std::move(data)), stream_(std::make_unique<LZ4_stream_t>()) {
+    LZ4_initStream(stream_.get(), sizeof(LZ4_stream_t));
+    LZ4_loadDict(stream_.get(), reinterpret_cast<const char*>(data_.data()), static_cast<int>(data_.size()));
+}
+
+std::shared_ptr<const FingerprintDictionary> FingerprintDictionary::train(const std::vector<const Fingerprint*>& samples,
+                                                                          FingerprintCodec codec,
+                                                                          size_t max_size) {
+    max_size = std::min(max_size, MAX_DICTIONARY_SIZE);
+
+    // Count half-overlapping segments of exactly what LZ4 will see for each block
+    std::unordered_map<Segment, uint32_t, SegmentHash> counts;
+    uint8_t source[CompressedFingerprint::BLOCK_FRAMES * sizeof(uint32_t)];
+
+    for (const Fingerprint* sample : samples) {
+        if (!sample) {
+            continue;
+        }
+
+        const size_t frame_count = sample->data.size();
+        for (size_t first = 0; first < frame_count; first += CompressedFingerprint::BLOCK_FRAMES) {
+            const size_t frames = std::min(CompressedFingerprint::BLOCK_FRAMES, frame_count - first);
+            const size_t source_size = CompressedFingerprint::encode_block_source(sample->data.data() + first, frames, codec, source);
+
+            for (size_t pos = 0; pos + SEGMENT_SIZE <= source_size; pos += SEGMENT_SIZE / 2) {
+                Segment segment;
+                std::memcpy(&segment, source + pos, SEGMENT_SIZE);
+                counts[segment]++;
+            }
+        }
+    }
+
+    // Keep segments that repeat, most frequent first
+    std::vector<std::pair<Segment, uint32_t>> frequent;
+    for (const auto& entry : counts) {
+        if (entry.second >= 2) {
+            frequent.push_back(entry);
+        }
+    }
+
+    if (frequent.empty()) {
+        return nullptr;
+    }
+
+    std::sort(frequent.begin(), frequent.end(),
+              [](const std::pair<Segment, uint32_t>& a, const std::pair<Segment, uint32_t>& b) {
+                  if (a.second != b.second) return a.second > b.second;
+                  return a.first.low != b.first.low ? a.first.low < b.first.low : a.first.high < b.first.high;
+              });
+    frequent.resize(std::min(frequent.size(), max_size / SEGMENT_SIZE));
+
+    // Most frequent segments go last, nearest to the data being compressed
+    std::vector<uint8_t> data(frequent.size() * SEGMENT_SIZE);
+    for (size_t i = 0; i < frequent.size(); ++i) {
+        std::memcpy(data.data() + (frequent.size() - 1 - i) * SEGMENT_SIZE, &frequent[i].first, SEGMENT_SIZE);
+    }
+
+    return std::shared_ptr<const FingerprintDictionary>(new FingerprintDictionary(std::move(data)));
+}
+
 CompressedFingerprint::CompressedFingerprint()
-    : original_size_(0), sample_rate_(0), duration_(0.0) {
+    : data_(nullptr), data_size_(0), original_size_(0), sample_rate_(0), duration_(0.0), dictionary_(nullptr) {
 }
 
 CompressedFingerprint::~CompressedFingerprint() {
     // Vector automatically cleans up
 }
 
+CompressedFingerprint::CompressedFingerprint(CompressedFingerprint&& other) noexcept
+    : CompressedFingerprint() {
+    *this = std::move(other);
+}
+
+CompressedFingerprint& CompressedFingerprint::operator=(CompressedFingerprint&& other) noexcept {
+    if (this == &other) {
+        return *this;
+    }
+
+    // A moved vector keeps its heap buffer, so data_ stays valid for owned blobs
+    owned_data_ = std::move(other.owned_data_);
+    data_ = other.data_;
+    data_size_ = other.data_size_;
+    original_size_ = other.original_size_;
+    sample_rate_ = other.sample_rate_;
+    duration_ = other.duration_;
+    file_path_ = std::move(other.file_path_);
+    dictionary_owner_ = std::move(other.dictionary_owner_);
+    dictionary_ = other.dictionary_;
+
+    other.owned_data_.clear();
+    other.data_ = nullptr;
+    other.data_size_ = 0;
+    other.original_size_ = 0;
+    other.sample_rate_ = 0;
+    other.duration_ = 0.0;
+    other.file_path_.clear();
+    other.dictionary_owner_.reset();
+    other.dictionary_ = nullptr;
+    return *this;
+}
+
 CompressedFingerprint::CompressedFingerprint(std::vector<uint8_t>&& data, size_t original_size,
-                                           int sample_rate, double duration, const std::string& file_path)
-    : compressed_data_(std::move(data)), original_size_(original_size),
-      sample_rate_(sample_rate), duration_(duration), file_path_(file_path) {
+                                           int sample_rate, double duration, const std::string& file_path,
+                                           std::shared_ptr<const FingerprintDictionary> dictionary)
+    : owned_data_(std::move(data)), data_(owned_data_.data()), data_size_(owned_data_.size()),
+      original_size_(original_size), sample_rate_(sample_rate), duration_(duration), file_path_(file_path),
+      dictionary_owner_(std::move(dictionary)), dictionary_(dictionary_owner_.get()) {
+}
+
+CompressedFingerprint CompressedFingerprint::view(const uint8_t* data, size_t size, size_t original_size,
+                                                  int sample_rate, double duration,
+                                                  const FingerprintDictionary* dictionary) {
+    CompressedFingerprint fingerprint;
+    fingerprint.data_ = data;
+    fingerprint.data_size_ = size;
+    fingerprint.original_size_ = original_size;
+    fingerprint.sample_rate_ = sample_rate;
+    fingerprint.duration_ = duration;
+
+    if (size > 0 && (data[0] & DICTIONARY_FLAG)) {
+        if (!dictionary) {
+            throw std::invalid_argument("Fingerprint blob requires a compression dictionary");
+        }
+        fingerprint.dictionary_ = dictionary;
+    }
+
+    return fingerprint;
 }
 
-std::unique_ptr<CompressedFingerprint> CompressedFingerprint::compress(const Fingerprint& fingerprint) {
+std::unique_ptr<CompressedFingerprint> CompressedFingerprint::compress(const Fingerprint& fingerprint,
+                                                                       FingerprintCodec codec,
+                                                                       std::shared_ptr<const FingerprintDictionary> dictionary) {
     if (fingerprint.data.empty()) {
         throw std::invalid_argument("Cannot compress empty fingerprint");
     }
 
+    if (codec != FingerprintCodec::LZ4 && codec != FingerprintCodec::XorDelta) {
+        throw std::invalid_argument("Unknown fingerprint codec");
+    }
+
     // Calculate sizes
-    const size_t original_size = fingerprint.data.size() * sizeof(uint32_t);
-    const int max_compressed_size = LZ4_compressBound(static_cast<int>(original_size));
+    const size_t frame_count = fingerprint.data.size();
+    const size_t original_size = frame_count * sizeof(uint32_t);
+    const size_t block_count = (frame_count + BLOCK_FRAMES - 1) / BLOCK_FRAMES;
+    const size_t header_size = 1 + block_count * sizeof(uint32_t);
+
+    const int max_block_size = LZ4_compressBound(static_cast<int>(BLOCK_FRAMES * sizeof(uint32_t)));
 
-    if (max_compressed_size <= 0) {
+    if (max_block_size <= 0) {
         throw std::runtime_error("Failed to calculate compression bound");
     }
 
-    // Prepare compression buffer
-    std::vector<uint8_t> compressed_buffer(max_compressed_size);
+    // Prepare compression buffer (header followed by the worst case for every block)
+    std::vector<uint8_t> compressed_buffer(header_size + block_count * max_block_size);
+    compressed_buffer[0] = static_cast<uint8_t>(codec) | (dictionary ? DICTIONARY_FLAG : 0);
 
-    // Compress fingerprint data using LZ4
-    const int compressed_size = LZ4_compress_default(
-        reinterpret_cast<const char*>(fingerprint.data.data()),
-        reinterpret_cast<char*>(compressed_buffer.data()),
-        static_cast<int>(original_size),
-        max_compressed_size
-    );
+    // Each block starts from a copy of the dictionary state, never from the previous block
+    std::unique_ptr<LZ4_stream_t> stream;
+    if (dictionary) {
+        stream = std::make_unique<LZ4_stream_t>();
+    }
+
+    uint8_t planes[BLOCK_FRAMES * sizeof(uint32_t)];
+    size_t payload_size = 0;
+
+    for (size_t block = 0; block < block_count; ++block) {
+        const size_t first = block * BLOCK_FRAMES;
+        const size_t frames = std::min(BLOCK_FRAMES, frame_count - first);
+
+        // Select the LZ4 input for the codec
+        const char* source = reinterpret_cast<const char*>(fingerprint.data.data() + first);
+        size_t source_size = frames * sizeof(uint32_t);
+
+        if (codec != FingerprintCodec::LZ4) {
+            source_size = encode_block_source(fingerprint.data.data() + first, frames, codec, planes);
+            source = reinterpret_cast<const char*>(planes);
+        }
 
-    if (compressed_size <= 0) {
-        throw std::runtime_error("LZ4 compression failed");
+        // Compress each block independently using LZ4
+        char* destination = reinterpret_cast<char*>(compressed_buffer.data() + header_size + payload_size);
+        int compressed_size = 0;
+        if (dictionary) {
+            std::memcpy(stream.get(), &dictionary->stream(), sizeof(LZ4_stream_t));
+            compressed_size = LZ4_compress_fast_continue(stream.get(), source, destination,
+                                                         static_cast<int>(source_size), max_block_size, 1);
+        } else {
+            compressed_size = LZ4_compress_default(source, destination,
+                                                   static_cast<int>(source_size), max_block_size);
+        }
+
+        if (compressed_size <= 0) {
+            throw std::runtime_error("LZ4 compression failed");
+        }
+
+        payload_size += compressed_size;
+
+        const uint32_t block_end = static_cast<uint32_t>(payload_size);
+        std::memcpy(compressed_buffer.data() + 1 + block * sizeof(uint32_t), &block_end, sizeof(uint32_t));
     }
 
     // Resize buffer to actual compressed size
-    compressed_buffer.resize(compressed_size);
+    compressed_buffer.resize(header_size + payload_size);
+    compressed_buffer.shrink_to_fit();
 
     // Create compressed fingerprint
     return std::unique_ptr<CompressedFingerprint>(
@@ -56,35 +254,30 @@ std::unique_ptr<CompressedFingerprint> CompressedFingerprint::compress(const Fin
             original_size,
             fingerprint.sample_rate,
             fingerprint.duration,
-            fingerprint.file_path
+            fingerprint.file_path,
+            std::move(dictionary)
         )
     );
 }
 
+size_t CompressedFingerprint::encode_block_source(const uint32_t* frames, size_t count, FingerprintCodec codec, uint8_t* out) {
+    if (codec == FingerprintCodec::XorDelta) {
+        xor_delta_shuffle(frames, count, out);
+        return ((count + 7) / 8) * 32;
+    }
+
+    std::memcpy(out, frames, count * sizeof(uint32_t));
+    return count * sizeof(uint32_t);
+}
+
 std::unique_ptr<Fingerprint> CompressedFingerprint::decompress() const {
     if (!isValid()) {
         throw std::invalid_argument("Cannot decompress invalid fingerprint");
     }
 
     // Create decompression buffer
-    const size_t data_count = original_size_ / sizeof(uint32_t);
-    std::vector<uint32_t> decompressed_data(data_count);
-
-    // Decompress using LZ4
-    const int decompressed_size = LZ4_decompress_safe(
-        reinterpret_cast<const char*>(compressed_data_.data()),
-        reinterpret_cast<char*>(decompressed_data.data()),
-        static_cast<int>(compressed_data_.size()),
-        static_cast<int>(original_size_)
-    );
-
-    if (decompressed_size < 0) {
-        throw std::runtime_error("LZ4 decompression failed");
-    }
-
-    if (static_cast<size_t>(decompressed_size) != original_size_) {
-        throw std::runtime_error("Decompressed size mismatch");
-    }
+    std::vector<uint32_t> decompressed_data(getFrameCount());
+    decompress_into(decompressed_data.data(), decompressed_data.size());
 
     // Create fingerprint
     auto fingerprint = std::make_unique<Fingerprint>();
@@ -96,4 +289,248 @@ std::unique_ptr<Fingerprint> CompressedFingerprint::decompress() const {
     return fingerprint;
 }
 
+size_t CompressedFingerprint::decompress_into(uint32_t* out, size_t capacity) const {
+    if (!isValid()) {
+        throw std::invalid_argument("Cannot decompress invalid fingerprint");
+    }
+
+    const size_t frame_count = getFrameCount();
+    if (capacity < frame_count) {
+        throw std::length_error("Decompression buffer too small");
+    }
+
+    for (size_t block = 0; block < getBlockCount(); ++block) {
+        decompress_block(block, out + block * BLOCK_FRAMES);
+    }
+
+    return frame_count;
+}
+
+FingerprintView CompressedFingerprint::decompress_view(std::vector<uint32_t>& buffer) const {
+    if (buffer.size() < getFrameCount()) {
+        buffer.resize(getFrameCount());
+    }
+
+    const size_t frame_count = decompress_into(buffer.data(), buffer.size());
+    return FingerprintView(buffer.data(), frame_count, sample_rate_, duration_);
+}
+
+size_t CompressedFingerprint::decompress_range(size_t start, size_t count, std::vector<uint32_t>& out) const {
+    if (!isValid()) {
+        throw std::invalid_argument("Cannot decompress invalid fingerprint");
+    }
+
+    const size_t frame_count = getFrameCount();
+    start = std::min(start, frame_count);
+    count = std::min(count, frame_count - start);
+    out.resize(count);
+
+    if (count == 0) {
+        return 0;
+    }
+
+    uint32_t scratch[BLOCK_FRAMES];
+    const size_t end = start + count;
+
+    for (size_t block = start / BLOCK_FRAMES; block * BLOCK_FRAMES < end; ++block) {
+        const size_t block_first = block * BLOCK_FRAMES;
+        const size_t block_last = std::min(block_first + BLOCK_FRAMES, frame_count);
+        const size_t copy_first = std::max(start, block_first);
+        const size_t copy_last = std::min(end, block_last);
+
+        // Whole blocks decode straight into the output
+        if (copy_first == block_first && copy_last == block_last) {
+            decompress_block(block, out.data() + (block_first - start));
+        } else {
+            decompress_block(block, scratch);
+            std::copy(scratch + (copy_first - block_first), scratch + (copy_last - block_first),
+                      out.begin() + (copy_first - start));
+        }
+    }
+
+    return count;
+}
+
+void CompressedFingerprint::decompress_block(size_t block, uint32_t* out) const {
+    const size_t block_count = getBlockCount();
+    if (block >= block_count) {
+        throw std::out_of_range("Fingerprint block index out of range");
+    }
+    const size_t header_size = 1 + block_count * sizeof(uint32_t);
+    const size_t frames = std::min(BLOCK_FRAMES, getFrameCount() - block * BLOCK_FRAMES);
+
+    // The frame count comes from metadata, so a truncated blob can be shorter than its directory
+    if (data_size_ < header_size) {
+        throw std::runtime_error("Truncated fingerprint block directory");
+    }
+
+    uint32_t block_begin = 0;
+    uint32_t block_end = 0;
+    if (block > 0) {
+        std::memcpy(&block_begin, data_ + 1 + (block - 1) * sizeof(uint32_t), sizeof(uint32_t));
+    }
+    std::memcpy(&block_end, data_ + 1 + block * sizeof(uint32_t), sizeof(uint32_t));
+
+    if (block_end < block_begin || header_size + block_end > data_size_) {
+        throw std::runtime_error("Corrupt fingerprint block directory");
+    }
+
+    const char* payload = reinterpret_cast<const char*>(data_ + header_size + block_begin);
+    const int payload_size = static_cast<int>(block_end - block_begin);
+
+    const FingerprintCodec codec = getCodec();
+    if (codec == FingerprintCodec::LZ4) {
+        const size_t expected_size = frames * sizeof(uint32_t);
+
+        // Decompress using LZ4
+        const int decompressed_size = decompress_payload(
+            payload, payload_size, reinterpret_cast<char*>(out), static_cast<int>(expected_size));
+
+        if (decompressed_size < 0) {
+            throw std::runtime_error("LZ4 decompression failed");
+        }
+
+        if (static_cast<size_t>(decompressed_size) != expected_size) {
+            throw std::runtime_error("Decompressed size mismatch");
+        }
+    } else if (codec == FingerprintCodec::XorDelta) {
+        const size_t expected_size = ((frames + 7) / 8) * 32;
+        uint8_t planes[BLOCK_FRAMES * sizeof(uint32_t)];
+
+        const int decompressed_size = decompress_payload(
+            payload, payload_size, reinterpret_cast<char*>(planes), static_cast<int>(expected_size));
+
+        if (decompressed_size < 0) {
+            throw std::runtime_error("LZ4 decompression failed");
+        }
+
+        if (static_cast<size_t>(decompressed_size) != expected_size) {
+            throw std::runtime_error("Decompressed size mismatch");
+        }
+
+        xor_delta_unshuffle(planes, frames, out);
+    } else {
+        throw std::runtime_error("Unknown fingerprint codec");
+    }
+}
+
+int CompressedFingerprint::decompress_payload(const char* payload, int payload_size, char* out, int capacity) const {
+    if (dictionary_) {
+        return LZ4_decompress_safe_usingDict(payload, out, payload_size, capacity,
+                                             reinterpret_cast<const char*>(dictionary_->data()),
+                                             static_cast<int>(dictionary_->size()));
+    }
+    return LZ4_decompress_safe(payload, out, payload_size, capacity);
+}
+
+void CompressedFingerprint::xor_delta_shuffle(const uint32_t* frames, size_t count, uint8_t* planes) {
+    // Plane p holds bit p of every delta, one byte per group of 8 frames
+    const size_t groups = (count + 7) / 8;
+    std::fill(planes, planes + groups * 32, 0);
+
+    uint32_t previous = 0;
+    for (size_t g = 0; g < groups; ++g) {
+        uint32_t deltas[8] = {0};
+        for (size_t r = 0; r < 8 && g * 8 + r < count; ++r) {
+            const uint32_t frame = frames[g * 8 + r];
+            deltas[r] = frame ^ previous;
+            previous = frame;
+        }
+
+        // Byte lane k of the 8 deltas forms an 8x8 bit matrix; its transpose is planes 8k..8k+7
+        for (unsigned k = 0; k < 4; ++k) {
+            uint64_t rows = 0;
+            for (unsigned r = 0; r < 8; ++r) {
+                rows |= static_cast<uint64_t>((deltas[r] >> (8 * k)) & 0xFF) << (8 * r);
+            }
+
+            const uint64_t columns = transpose_8x8(rows);
+            for (unsigned c = 0; c < 8; ++c) {
+                planes[(8 * k + c) * groups + g] = static_cast<uint8_t>(columns >> (8 * c));
+            }
+        }
+    }
+}
+
+void CompressedFingerprint::xor_delta_unshuffle(const uint8_t* planes, size_t count, uint32_t* frames) {
+    const size_t groups = (count + 7) / 8;
+    size_t g = 0;
+
+#if defined(__SSE2__)
+    // 16 groups per step: byte-transpose 8 plane rows so each 64-bit lane holds one
+    // group's plane bytes, then movemask pulls out bit r of all 8 planes at once.
+    // Frames are written byte lane by byte lane (x86 is little-endian)
+    uint8_t* frame_bytes = reinterpret_cast<uint8_t*>(frames);
+    for (; g + 16 <= count / 8; g += 16) {
+        for (unsigned k = 0; k < 4; ++k) {
+            const uint8_t* lane = planes + (8 * k) * groups + g;
+            __m128i x[8];
+            for (unsigned c = 0; c < 8; ++c) {
+                x[c] = _mm_loadu_si128(reinterpret_cast<const __m128i*>(lane + c * groups));
+            }
+
+            __m128i a[8];
+            for (unsigned c = 0; c < 4; ++c) {
+                a[2 * c] = _mm_unpacklo_epi8(x[2 * c], x[2 * c + 1]);
+                a[2 * c + 1] = _mm_unpackhi_epi8(x[2 * c], x[2 * c + 1]);
+            }
+            __m128i b[8];
+            for (unsigned h = 0; h < 2; ++h) {
+                b[4 * h] = _mm_unpacklo_epi16(a[h], a[2 + h]);
+                b[4 * h + 1] = _mm_unpackhi_epi16(a[h], a[2 + h]);
+                b[4 * h + 2] = _mm_unpacklo_epi16(a[4 + h], a[6 + h]);
+                b[4 * h + 3] = _mm_unpackhi_epi16(a[4 + h], a[6 + h]);
+            }
+
+            // columns[q] holds groups 2q and 2q+1, 8 plane bytes each
+            __m128i columns[8];
+            for (unsigned h = 0; h < 2; ++h) {
+                for (unsigned q = 0; q < 2; ++q) {
+                    columns[4 * h + 2 * q] = _mm_unpacklo_epi32(b[4 * h + q], b[4 * h + 2 + q]);
+                    columns[4 * h + 2 * q + 1] = _mm_unpackhi_epi32(b[4 * h + q], b[4 * h + 2 + q]);
+                }
+            }
+
+            for (unsigned q = 0; q < 8; ++q) {
+                uint8_t* first = frame_bytes + ((g + 2 * q) * 8) * 4 + k;
+                for (unsigned r = 0; r < 8; ++r) {
+                    const int mask = _mm_movemask_epi8(_mm_slli_epi64(columns[q], 7 - r));
+                    first[r * 4] = static_cast<uint8_t>(mask);
+                    first[(8 + r) * 4] = static_cast<uint8_t>(mask >> 8);
+                }
+            }
+        }
+    }
+#endif
+
+    // Portable path: 8 plane bytes -> one 64-bit transpose -> byte k of 8 deltas
+    for (; g < groups; ++g) {
+        uint32_t deltas[8] = {0};
+
+        for (unsigned k = 0; k < 4; ++k) {
+            const uint8_t* lane = planes + (8 * k) * groups + g;
+            uint64_t columns = 0;
+            for (unsigned c = 0; c < 8; ++c) {
+                columns |= static_cast<uint64_t>(lane[c * groups]) << (8 * c);
+            }
+
+            // The 8x8 transpose is its own inverse
+            const uint64_t rows = transpose_8x8(columns);
+            for (unsigned r = 0; r < 8; ++r) {
+                deltas[r] |= static_cast<uint32_t>((rows >> (8 * r)) & 0xFF) << (8 * k);
+            }
+        }
+
+        const size_t frames_in_group = std::min<size_t>(8, count - g * 8);
+        std::copy(deltas, deltas + frames_in_group, frames + g * 8);
+    }
+
+    // Undo the XOR delta with a running prefix
+    uint32_t previous = 0;
+    for (size_t i = 0; i < count; ++i) {
+        previous ^= frames[i];
+        frames[i] = previous;
+    }
+}
+
 } // namespace AudioDuplicates
\ No newline at end of file
@@ -4,11 +4,47 @@
 #include <string>
 #include <memory>
 #include <cstdint>
+#include <cstddef>
 #include <lz4.h>
 #include "chromaprint_wrapper.h"
 
 namespace AudioDuplicates {
 
+// Codec id, stored as the first byte of every compressed blob
+enum class FingerprintCodec : uint8_t {
+    LZ4 = 0,      // Raw frames compressed with LZ4
+    XorDelta = 1  // Frames XORed with their predecessor, bit-plane shuffled, then LZ4
+};
+
+/**
+ * Shared LZ4 dictionary trained from a sample of the fingerprint corpus
+ * Short fingerprints give LZ4 little history; compressing every block against
+ * the corpus' most frequent codec segments recovers most of that ratio
+ */
+class FingerprintDictionary {
+public:
+    // Build a dictionary from the most frequent segments of the samples' codec
+    // output; returns nullptr when no segment repeats
+    static std::shared_ptr<const FingerprintDictionary> train(const std::vector<const Fingerprint*>& samples,
+                                                              FingerprintCodec codec,
+                                                              size_t max_size = MAX_DICTIONARY_SIZE);
+
+    const uint8_t* data() const { return data_.data(); }
+    size_t size() const { return data_.size(); }
+
+    // Compression state with the dictionary preloaded; copied per block so blocks stay independent
+    const LZ4_stream_t& stream() const { return *stream_; }
+
+    static constexpr size_t MAX_DICTIONARY_SIZE = 64 * 1024; // LZ4 only references the last 64KB
+    static constexpr size_t SEGMENT_SIZE = 16;
+
+private:
+    explicit FingerprintDictionary(std::vector<uint8_t>&& data);
+
+    std::vector<uint8_t> data_;
+    std::unique_ptr<LZ4_stream_t> stream_;
+};
+
 /**
  * Compressed fingerprint with LZ4 compression for memory optimization
  * Reduces fingerprint memory usage by 60-70% while maintaining fast decompression
@@ -18,25 +54,77 @@ public:
     CompressedFingerprint();
     ~CompressedFingerprint();
 
+    // Move-only: a copy would alias the owned buffer through data_. The moved-from
+    // object is left empty (isValid() false) rather than pointing at the new owner's bytes
+    CompressedFingerprint(CompressedFingerprint&& other) noexcept;
+    CompressedFingerprint& operator=(CompressedFingerprint&& other) noexcept;
+    CompressedFingerprint(const CompressedFingerprint&) = delete;
+    CompressedFingerprint& operator=(const CompressedFingerprint&) = delete;
+
     // Create compressed fingerprint from regular fingerprint
-    static std::unique_ptr<CompressedFingerprint> compress(const Fingerprint& fingerprint);
+    static std::unique_ptr<CompressedFingerprint> compress(const Fingerprint& fingerprint,
+                                                           FingerprintCodec codec = FingerprintCodec::XorDelta,
+                                                           std::shared_ptr<const FingerprintDictionary> dictionary = nullptr);
+
+    // Non-owning fingerprint over a blob held elsewhere (e.g. a FingerprintStore slab);
+    // the bytes and the dictionary must outlive the view. The dictionary is only
+    // consulted when the blob's codec byte says it was compressed against one
+    static CompressedFingerprint view(const uint8_t* data, size_t size, size_t original_size,
+                                      int sample_rate, double duration,
+                                      const FingerprintDictionary* dictionary = nullptr);
+
+    // Codec transform of one block, i.e. the bytes handed to LZ4; returns the byte count
+    static size_t encode_block_source(const uint32_t* frames, size_t count, FingerprintCodec codec, uint8_t* out);
 
     // Decompress back to regular fingerprint
     std::unique_ptr<Fingerprint> decompress() const;
 
+    // Decode every frame into out without allocating; capacity must be at least
+    // getFrameCount(). Returns the number of frames written
+    size_t decompress_into(uint32_t* out, size_t capacity) const;
+
+    // Decode into a reusable buffer (grown when too small, never shrunk) and view it
+    FingerprintView decompress_view(std::vector<uint32_t>& buffer) const;
+
+    // Decode frames [start, start + count) into out, touching only the blocks that
+    // overlap the range; returns the number of frames decoded (clamped to the end)
+    size_t decompress_range(size_t start, size_t count, std::vector<uint32_t>& out) const;
+
+    // Decode one block into out (BLOCK_FRAMES frames, fewer for the last block)
+    void decompress_block(size_t block, uint32_t* out) const;
+
+    // Frames per independently decodable block
+    static constexpr size_t BLOCK_FRAMES = 256;
+
+    size_t getFrameCount() const { return original_size_ / sizeof(uint32_t); }
+    size_t getBlockCount() const { return (getFrameCount() + BLOCK_FRAMES - 1) / BLOCK_FRAMES; }
+
     // Get compressed size in bytes
-    size_t getCompressedSize() const { return compressed_data_.size(); }
+    size_t getCompressedSize() const { return data_size_; }
+
+    // Raw blob bytes (codec byte, block directory, payload)
+    const uint8_t* getData() const { return data_; }
 
     // Get original size in bytes
     size_t getOriginalSize() const { return original_size_; }
 
     // Get compression ratio (0.0-1.0, lower is better compression)
     double getCompressionRatio() const {
-        return static_cast<double>(compressed_data_.size()) / original_size_;
+        return static_cast<double>(data_size_) / original_size_;
     }
 
     // Check if compression was successful
-    bool isValid() const { return !compressed_data_.empty() && original_size_ > 0; }
+    bool isValid() const { return data_size_ > 0 && original_size_ > 0; }
+
+    // Codec the blob was written with
+    FingerprintCodec getCodec() const {
+        return data_size_ == 0 ? FingerprintCodec::LZ4
+                               : static_cast<FingerprintCodec>(data_[0] & ~DICTIONARY_FLAG);
+    }
+
+    // Whether blocks were compressed against a shared dictionary
+    bool usesDictionary() const { return dictionary_ != nullptr; }
+    const FingerprintDictionary* getDictionary() const { return dictionary_; }
 
     // Get metadata
     int getSampleRate() const { return sample_rate_; }
@@ -44,15 +132,34 @@ public:
     const std::string& getFilePath() const { return file_path_; }
 
 private:
-    std::vector<uint8_t> compressed_data_;
+    // Blob layout: codec id (1 byte), block directory (uint32 end offset of each
+    // block's payload), then the independently LZ4-compressed blocks. data_ points
+    // into owned_data_, or into external storage for views
+    std::vector<uint8_t> owned_data_;
+    const uint8_t* data_;
+    size_t data_size_;
     size_t original_size_;
     int sample_rate_;
     double duration_;
     std::string file_path_;
+    std::shared_ptr<const FingerprintDictionary> dictionary_owner_; // Empty for views
+    const FingerprintDictionary* dictionary_;
+
+    // Set in the codec byte when blocks reference the shared dictionary
+    static constexpr uint8_t DICTIONARY_FLAG = 0x80;
 
     // Private constructor for internal use
     CompressedFingerprint(std::vector<uint8_t>&& data, size_t original_size,
-                         int sample_rate, double duration, const std::string& file_path);
+                         int sample_rate, double duration, const std::string& file_path,
+                         std::shared_ptr<const FingerprintDictionary> dictionary = nullptr);
+
+    // XOR-delta transform: consecutive frames differ in few bits, so the deltas
+    // are regrouped into bit-planes (8 frames per byte) that LZ4 sees as zero runs
+    static void xor_delta_shuffle(const uint32_t* frames, size_t count, uint8_t* planes);
+    static void xor_delta_unshuffle(const uint8_t* planes, size_t count, uint32_t* frames);
+
+    // LZ4 decode of one block payload, against the dictionary when one was used
+    int decompress_payload(const char* payload, int payload_size, char* out, int capacity) const;
 };
 
 } // namespace AudioDuplicates
\ No newline at end of file
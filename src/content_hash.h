@@ -0,0 +1,105 @@
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+
+namespace AudioDuplicates {
+
+/**
+ * 64-bit content hash (XXH64 algorithm) for detecting bit-identical data
+ * Header-only so fingerprints and raw file blocks can be hashed without an
+ * extra library dependency
+ */
+class ContentHash {
+public:
+    static uint64_t hash(const void* data, size_t size, uint64_t seed = 0) {
+        const uint8_t* p = static_cast<const uint8_t*>(data);
+        const uint8_t* const end = p + size;
+        uint64_t h;
+
+        if (size >= 32) {
+            uint64_t v1 = seed + PRIME1 + PRIME2;
+            uint64_t v2 = seed + PRIME2;
+            uint64_t v3 = seed;
+            uint64_t v4 = seed - PRIME1;
+
+            const uint8_t* const limit = end - 32;
+            do {
+                v1 = round(v1, read64(p));
+                v2 = round(v2, read64(p + 8));
+                v3 = round(v3, read64(p + 16));
+                v4 = round(v4, read64(p + 24));
+                p += 32;
+            } while (p <= limit);
+
+            h = rotl(v1, 1) + rotl(v2, 7) + rotl(v3, 12) + rotl(v4, 18);
+            h = merge_round(h, v1);
+            h = merge_round(h, v2);
+            h = merge_round(h, v3);
+            h = merge_round(h, v4);
+        } else {
+            h = seed + PRIME5;
+        }
+
+        h += static_cast<uint64_t>(size);
+
+        while (p + 8 <= end) {
+            h ^= round(0, read64(p));
+            h = rotl(h, 27) * PRIME1 + PRIME4;
+            p += 8;
+        }
+        if (p + 4 <= end) {
+            h ^= static_cast<uint64_t>(read32(p)) * PRIME1;
+            h = rotl(h, 23) * PRIME2 + PRIME3;
+            p += 4;
+        }
+        while (p < end) {
+            h ^= (*p) * PRIME5;
+            h = rotl(h, 11) * PRIME1;
+            ++p;
+        }
+
+        h ^= h >> 33;
+        h *= PRIME2;
+        h ^= h >> 29;
+        h *= PRIME3;
+        h ^= h >> 32;
+        return h;
+    }
+
+private:
+    static constexpr uint64_t PRIME1 = 0x9E3779B185EBCA87ULL;
+    static constexpr uint64_t PRIME2 = 0xC2B2AE3D27D4EB4FULL;
+    static constexpr uint64_t PRIME3 = 0x165667B19E3779F9ULL;
+    static constexpr uint64_t PRIME4 = 0x85EBCA77C2B2AE63ULL;
+    static constexpr uint64_t PRIME5 = 0x27D4EB2F165667C5ULL;
+
+    static uint64_t rotl(uint64_t x, int r) { return (x << r) | (x >> (64 - r)); }
+
+    static uint64_t round(uint64_t acc, uint64_t input) {
+        acc += input * PRIME2;
+        acc = rotl(acc, 31);
+        return acc * PRIME1;
+    }
+
+    static uint64_t merge_round(uint64_t acc, uint64_t value) {
+        acc ^= round(0, value);
+        return acc * PRIME1 + PRIME4;
+    }
+
+    // Little-endian hosts only (x86-64 and arm64), like the rest of the blob formats
+    static uint64_t read64(const uint8_t* p) {
+        uint64_t value;
+        std::memcpy(&value, p, sizeof(value));
+        return value;
+    }
+
+    static uint32_t read32(const uint8_t* p) {
+        uint32_t value;
+        std::memcpy(&value, p, sizeof(value));
+        return value;
+    }
+};
+
+} // namespace AudioDuplicates
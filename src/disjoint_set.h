@@ -0,0 +1,78 @@
+#pragma once
+
+#include <vector>
+#include <numeric>
+#include <utility>
+#include <cstddef>
+
+namespace AudioDuplicates {
+
+/**
+ * Union-find over dense ids with path halving and union by size
+ * Used to maintain duplicate groups incrementally instead of re-clustering
+ */
+class DisjointSet {
+public:
+    DisjointSet() = default;
+    explicit DisjointSet(size_t count) { reset(count); }
+
+    // Reset to `count` singleton sets
+    void reset(size_t count) {
+        parent_.resize(count);
+        std::iota(parent_.begin(), parent_.end(), size_t{0});
+        size_.assign(count, 1);
+    }
+
+    // Append a new singleton set and return its id
+    size_t add() {
+        size_t id = parent_.size();
+        parent_.push_back(id);
+        size_.push_back(1);
+        return id;
+    }
+
+    size_t find(size_t id) {
+        while (parent_[id] != id) {
+            parent_[id] = parent_[parent_[id]];
+            id = parent_[id];
+        }
+        return id;
+    }
+
+    // Find without path compression, safe under shared (read-only) access
+    size_t find(size_t id) const {
+        while (parent_[id] != id) {
+            id = parent_[id];
+        }
+        return id;
+    }
+
+    // Merge the sets containing a and b, returning the surviving root
+    size_t unite(size_t a, size_t b) {
+        a = find(a);
+        b = find(b);
+        if (a == b) {
+            return a;
+        }
+        if (size_[a] < size_[b]) {
+            std::swap(a, b);
+        }
+        parent_[b] = a;
+        size_[a] += size_[b];
+        return a;
+    }
+
+    size_t set_size(size_t id) const { return size_[find(id)]; }
+    size_t size() const { return parent_.size(); }
+
+    void clear() {
+        parent_.clear();
+        size_.clear();
+    }
+
+private:
+    std::vector<size_t> parent_;
+    std::vector<size_t> size_;
+};
+
+} // namespace AudioDuplicates
@@ -0,0 +1,135 @@
+#include "disk_order.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <omp.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+#ifdef __linux__
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/ioctl.h>
+#include <linux/fs.h>
+#include <linux/fiemap.h>
+#endif
+
+namespace AudioDuplicates {
+
+DiskOrderPlanner::DiskOrderPlanner(const DiskOrderConfig& config)
+    : config_(config) {}
+
+DiskOrderResult DiskOrderPlanner::plan(const std::vector<std::string>& paths) const {
+    const auto start = std::chrono::steady_clock::now();
+
+    DiskOrderResult result;
+    result.stats = DiskOrderStats{};
+    result.stats.files = paths.size();
+
+    const int threads = config_.num_threads > 0 ? static_cast<int>(config_.num_threads) : omp_get_max_threads();
+
+    // Metadata lookups are independent; on a cold cache they are seeks themselves
+    std::vector<DiskKey> keys(paths.size());
+    #pragma omp parallel for num_threads(threads) schedule(dynamic, 64)
+    for (int64_t i = 0; i < static_cast<int64_t>(paths.size()); ++i) {
+        keys[i] = locate(paths[i]);
+    }
+
+    for (const DiskKey& key : keys) {
+        switch (key.source) {
+            case KeySource::Extent: result.stats.extent_files++; break;
+            case KeySource::Inode: result.stats.inode_files++; break;
+            case KeySource::Unknown: result.stats.unknown_files++; break;
+        }
+    }
+
+    // Stable, so ties and unknown files keep their walk order
+    result.order.resize(paths.size());
+    for (size_t i = 0; i < paths.size(); ++i) {
+        result.order[i] = i;
+    }
+    std::stable_sort(result.order.begin(), result.order.end(), [&keys](size_t a, size_t b) {
+        const DiskKey& ka = keys[a];
+        const DiskKey& kb = keys[b];
+        if ((ka.source == KeySource::Unknown) != (kb.source == KeySource::Unknown)) {
+            return kb.source == KeySource::Unknown;
+        }
+        if (ka.source == KeySource::Unknown) {
+            return false;
+        }
+        if (ka.device != kb.device) {
+            return ka.device < kb.device;
+        }
+        if (ka.source != kb.source) {
+            return ka.source < kb.source;
+        }
+        return ka.position < kb.position;
+    });
+
+    result.stats.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
+DiskOrderPlanner::DiskKey DiskOrderPlanner::locate(const std::string& path) const {
+    DiskKey key{0, KeySource::Unknown, 0};
+
+#ifdef __linux__
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return key;
+    }
+    struct stat st;
+    if (fstat(fd, &st) == 0) {
+        key.device = static_cast<uint64_t>(st.st_dev);
+        key.source = KeySource::Inode;
+        key.position = static_cast<uint64_t>(st.st_ino);
+        uint64_t physical = 0;
+        if (config_.use_extents && first_extent(fd, physical)) {
+            key.source = KeySource::Extent;
+            key.position = physical;
+        }
+    }
+    ::close(fd);
+#else
+    struct stat st;
+    if (stat(path.c_str(), &st) == 0) {
+        key.device = static_cast<uint64_t>(st.st_dev);
+        key.source = KeySource::Inode;
+        key.position = static_cast<uint64_t>(st.st_ino);
+    }
+#endif
+
+    return key;
+}
+
+bool DiskOrderPlanner::first_extent(int fd, uint64_t& physical) {
+#ifdef __linux__
+    // Room for the header and exactly one extent; only where the file starts matters
+    alignas(struct fiemap) uint8_t buffer[sizeof(struct fiemap) + sizeof(struct fiemap_extent)];
+    std::memset(buffer, 0, sizeof(buffer));
+    struct fiemap* map = reinterpret_cast<struct fiemap*>(buffer);
+    map->fm_start = 0;
+    map->fm_length = FIEMAP_MAX_OFFSET;
+    map->fm_extent_count = 1;
+
+    if (ioctl(fd, FS_IOC_FIEMAP, map) != 0 || map->fm_mapped_extents == 0) {
+        return false;
+    }
+
+    // Delayed-allocation, inline and encoded extents have no meaningful disk address
+    const uint32_t unusable = FIEMAP_EXTENT_UNKNOWN | FIEMAP_EXTENT_DELALLOC |
+                              FIEMAP_EXTENT_DATA_INLINE | FIEMAP_EXTENT_DATA_ENCRYPTED;
+    const struct fiemap_extent& extent = map->fm_extents[0];
+    if (extent.fe_flags & unusable) {
+        return false;
+    }
+    physical = extent.fe_physical;
+    return true;
+#else
+    (void)fd;
+    (void)physical;
+    return false;
+#endif
+}
+
+} // namespace AudioDuplicates
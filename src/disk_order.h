@@ -0,0 +1,59 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstddef>
+
+namespace AudioDuplicates {
+
+struct DiskOrderConfig {
+    bool use_extents = true;   // Query FIEMAP; false orders by inode number only
+    size_t num_threads = 0;    // 0 = OpenMP default
+};
+
+struct DiskOrderStats {
+    size_t files;
+    size_t extent_files;   // Ordered by the physical offset of their first extent
+    size_t inode_files;    // No usable extent (unsupported filesystem, inline or empty file)
+    size_t unknown_files;  // Could not be stat'ed; kept at the end in input order
+    double seconds;
+};
+
+struct DiskOrderResult {
+    // Indices into the input paths in the order they should be read
+    std::vector<size_t> order;
+    DiskOrderStats stats;
+};
+
+/**
+ * Orders a file list by where the files live on disk so a cold scan reads a
+ * spinning disk in one sweep instead of seeking back and forth
+ * Files are grouped by device, then sorted by the physical offset of their
+ * first extent (FIEMAP, Linux only), or by inode number where the filesystem
+ * cannot report extents; inode numbers roughly follow allocation order
+ */
+class DiskOrderPlanner {
+public:
+    explicit DiskOrderPlanner(const DiskOrderConfig& config = DiskOrderConfig{});
+
+    DiskOrderResult plan(const std::vector<std::string>& paths) const;
+
+private:
+    DiskOrderConfig config_;
+
+    enum class KeySource : uint8_t { Extent = 0, Inode = 1, Unknown = 2 };
+
+    struct DiskKey {
+        uint64_t device;
+        KeySource source;
+        uint64_t position;   // Physical byte offset or inode number
+    };
+
+    DiskKey locate(const std::string& path) const;
+
+    // Physical offset of the file's first extent; false when FIEMAP cannot say
+    static bool first_extent(int fd, uint64_t& physical);
+};
+
+} // namespace AudioDuplicates
@@ -0,0 +1,415 @@
+#include "file_prefetcher.h"
+#include <algorithm>
+#include <cerrno>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <memory>
+#include <new>
+
+#if defined(__linux__) && defined(AUDIO_DUPLICATES_HAVE_LIBURING) && __has_include(<liburing.h>)
+#define AUDIO_DUPLICATES_IO_URING 1
+#include <liburing.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#endif
+
+namespace AudioDuplicates {
+
+#ifdef AUDIO_DUPLICATES_IO_URING
+namespace {
+
+// Kernels before 5.6 set up rings but have no IORING_OP_READ, failing every read
+// with EINVAL; they also lack the probe, which rules them out as well
+bool ring_supports_read(io_uring& ring) {
+    io_uring_probe* probe = io_uring_get_probe_ring(&ring);
+    if (!probe) {
+        return false;
+    }
+    const bool supported = io_uring_opcode_supported(probe, IORING_OP_READ);
+    io_uring_free_probe(probe);
+    return supported;
+}
+
+} // namespace
+#endif
+
+FilePrefetcher::FilePrefetcher(const std::vector<std::string>& paths, const PrefetchConfig& config)
+    : paths_(paths), config_(config), backend_(PrefetchBackend::Threads),
+      in_flight_(0), handed_out_(0), next_path_(0), stopping_(false) {
+    config_.depth = std::max<size_t>(1, config_.depth);
+    config_.threads = std::max<size_t>(1, config_.threads);
+    config_.read_bytes = std::max<size_t>(4096, config_.read_bytes);
+    config_.ring_entries = std::max(4u, config_.ring_entries);
+    stats_ = PrefetchStats{};
+
+#ifdef AUDIO_DUPLICATES_IO_URING
+    if (config_.backend != PrefetchBackend::Threads) {
+        // Set the ring up here so a kernel without io_uring, one too old for its
+        // reads, or a seccomp filter blocking it falls back to threads before any
+        // file is claimed
+        auto ring = std::make_shared<io_uring>();
+        if (io_uring_queue_init(config_.ring_entries, ring.get(), 0) == 0) {
+            if (!ring_supports_read(*ring)) {
+                io_uring_queue_exit(ring.get());
+            } else {
+                backend_ = PrefetchBackend::IoUring;
+                threads_.emplace_back([this, ring] {
+                    run_io_uring(*ring);
+                    io_uring_queue_exit(ring.get());
+                });
+            }
+        }
+    }
+#endif
+
+    if (backend_ == PrefetchBackend::Threads) {
+        for (size_t t = 0; t < std::min(config_.threads, std::max<size_t>(1, paths_.size())); ++t) {
+            threads_.emplace_back([this] { run_threads(); });
+        }
+    }
+    stats_.backend = backend_;
+}
+
+FilePrefetcher::~FilePrefetcher() {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stopping_ = true;
+    }
+    space_cv_.notify_all();
+    ready_cv_.notify_all();
+    for (auto& thread : threads_) {
+        thread.join();
+    }
+}
+
+bool FilePrefetcher::io_uring_available() {
+#ifdef AUDIO_DUPLICATES_IO_URING
+    return true;
+#else
+    return false;
+#endif
+}
+
+bool FilePrefetcher::next(PrefetchedFile& out) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    if (ready_.empty() && handed_out_ < paths_.size()) {
+        const auto start = std::chrono::steady_clock::now();
+        stats_.consumer_waits++;
+        ready_cv_.wait(lock, [this] { return !ready_.empty() || handed_out_ >= paths_.size() || stopping_; });
+        stats_.consumer_wait_seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    }
+    if (ready_.empty()) {
+        return false;
+    }
+
+    out = std::move(ready_.front());
+    ready_.pop_front();
+    handed_out_++;
+    in_flight_--;
+    const bool all_handed_out = handed_out_ >= paths_.size();
+    lock.unlock();
+
+    space_cv_.notify_one();
+    if (all_handed_out) {
+        ready_cv_.notify_all();
+    }
+    return true;
+}
+
+PrefetchStats FilePrefetcher::stats() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stats_;
+}
+
+bool FilePrefetcher::claim(size_t& index, bool wait) {
+    std::unique_lock<std::mutex> lock(mutex_);
+    auto can_start = [this] { return stopping_ || next_path_ >= paths_.size() || in_flight_ < config_.depth; };
+    if (wait) {
+        space_cv_.wait(lock, can_start);
+    } else if (!can_start()) {
+        return false;
+    }
+    if (stopping_ || next_path_ >= paths_.size()) {
+        return false;
+    }
+
+    index = next_path_++;
+    in_flight_++;
+    return true;
+}
+
+bool FilePrefetcher::finished() const {
+    std::lock_guard<std::mutex> lock(mutex_);
+    return stopping_ || next_path_ >= paths_.size();
+}
+
+void FilePrefetcher::complete(PrefetchedFile&& file, size_t read_requests) {
+    {
+        std::lock_guard<std::mutex> lock(mutex_);
+        stats_.files++;
+        stats_.bytes += file.bytes.size();
+        stats_.read_requests += read_requests;
+        ready_.push_back(std::move(file));
+    }
+    ready_cv_.notify_one();
+}
+
+void FilePrefetcher::run_threads() {
+    size_t index;
+    while (claim(index, true)) {
+        size_t read_requests = 0;
+        PrefetchedFile file = read_file(index, read_requests);
+        complete(std::move(file), read_requests);
+    }
+}
+
+PrefetchedFile FilePrefetcher::read_file(size_t index, size_t& read_requests) const {
+    PrefetchedFile file{index, {}, 0};
+
+    std::FILE* handle = std::fopen(paths_[index].c_str(), "rb");
+    if (!handle) {
+        file.error = errno ? errno : ENOENT;
+        return file;
+    }
+
+    std::fseek(handle, 0, SEEK_END);
+    const long size = std::ftell(handle);
+    std::fseek(handle, 0, SEEK_SET);
+    if (size < 0) {
+        file.error = errno ? errno : EIO;
+        std::fclose(handle);
+        return file;
+    }
+
+    // A file too large to hold is reported like a failed read
+    try {
+        file.bytes.resize(static_cast<size_t>(size));
+    } catch (const std::bad_alloc&) {
+        file.error = ENOMEM;
+        std::fclose(handle);
+        return file;
+    }
+    for (size_t offset = 0; offset < file.bytes.size();) {
+        const size_t length = std::min(config_.read_bytes, file.bytes.size() - offset);
+        const size_t read = std::fread(file.bytes.data() + offset, 1, length, handle);
+        read_requests++;
+        if (read == 0) {
+            file.error = std::ferror(handle) && errno ? errno : EIO;
+            file.bytes.clear();
+            break;
+        }
+        offset += read;
+    }
+
+    std::fclose(handle);
+    return file;
+}
+
+#ifdef AUDIO_DUPLICATES_IO_URING
+
+namespace {
+
+struct RingFile {
+    size_t index;
+    int fd;
+    std::vector<uint8_t> bytes;
+    size_t queued;      // Bytes covered by reads submitted so far
+    size_t pending;     // Reads submitted or waiting to be resubmitted
+    size_t requests;
+    int error;
+};
+
+struct RingRead {
+    RingFile* file;
+    size_t offset;
+    size_t length;
+};
+
+} // namespace
+
+void FilePrefetcher::run_io_uring(io_uring& ring) {
+    std::vector<std::unique_ptr<RingFile>> active;
+    std::deque<RingRead> retries;  // Remainders of short reads
+    size_t in_kernel = 0;
+
+    auto finish = [&](RingFile* file) {
+        if (file->fd >= 0) {
+            ::close(file->fd);
+        }
+        PrefetchedFile done{file->index, {}, file->error};
+        if (file->error == 0) {
+            done.bytes = std::move(file->bytes);
+        }
+        complete(std::move(done), file->requests);
+        active.erase(std::find_if(active.begin(), active.end(),
+                                  [file](const std::unique_ptr<RingFile>& f) { return f.get() == file; }));
+    };
+
+    auto queue_read = [&](const RingRead& read) {
+        io_uring_sqe* sqe = io_uring_get_sqe(&ring);
+        if (!sqe) {
+            return false;
+        }
+        io_uring_prep_read(sqe, read.file->fd, read.file->bytes.data() + read.offset,
+                           static_cast<unsigned>(read.length), read.offset);
+        io_uring_sqe_set_data(sqe, new RingRead(read));
+        read.file->requests++;
+        in_kernel++;
+        return true;
+    };
+
+    // The ring stopped delivering completions: fail the files being read and the
+    // ones not started yet so consumers are not left waiting. Reads may still be
+    // in the kernel, so their buffers (and RingRead records) are left allocated
+    auto fail_all = [&](int error) {
+        for (auto& file : active) {
+            if (file->fd >= 0) {
+                ::close(file->fd);
+            }
+            complete(PrefetchedFile{file->index, {}, error}, file->requests);
+            file.release();
+        }
+        active.clear();
+
+        size_t index;
+        while (claim(index, true)) {
+            complete(PrefetchedFile{index, {}, error}, 0);
+        }
+    };
+
+    for (;;) {
+        // Open new files while slots are free; only block for a slot when nothing is outstanding
+        size_t index;
+        while (claim(index, active.empty() && in_kernel == 0)) {
+            std::unique_ptr<RingFile> file(new RingFile{index, -1, {}, 0, 0, 0, 0});
+            file->fd = ::open(paths_[index].c_str(), O_RDONLY);
+            struct stat st;
+            if (file->fd < 0 || fstat(file->fd, &st) != 0) {
+                file->error = errno ? errno : EIO;
+            } else {
+                try {
+                    file->bytes.resize(static_cast<size_t>(st.st_size));
+                } catch (const std::bad_alloc&) {
+                    file->error = ENOMEM;
+                }
+            }
+            active.push_back(std::move(file));
+            if (active.back()->error != 0 || active.back()->bytes.empty()) {
+                finish(active.back().get());
+            }
+        }
+        if (active.empty() && in_kernel == 0 && finished()) {
+            break;
+        }
+
+        // Keep every in-flight file's remaining reads queued, short-read remainders first
+        bool ring_full = false;
+        while (!retries.empty() && !ring_full) {
+            ring_full = !queue_read(retries.front());
+            if (!ring_full) {
+                retries.pop_front();
+            }
+        }
+        for (size_t f = 0; f < active.size() && !ring_full; ++f) {
+            RingFile* file = active[f].get();
+            while (file->error == 0 && file->queued < file->bytes.size()) {
+                const size_t length = std::min(config_.read_bytes, file->bytes.size() - file->queued);
+                if (!queue_read(RingRead{file, file->queued, length})) {
+                    ring_full = true;
+                    break;
+                }
+                file->queued += length;
+                file->pending++;
+            }
+        }
+
+        if (in_kernel == 0) {
+            continue;
+        }
+        io_uring_submit(&ring);
+
+        // Wait for one completion, then reap whatever else is ready
+        io_uring_cqe* cqe = nullptr;
+        int wait = io_uring_wait_cqe(&ring, &cqe);
+        while (wait == -EINTR) {
+            wait = io_uring_wait_cqe(&ring, &cqe);
+        }
+        if (wait < 0) {
+            fail_all(-wait);
+            return;
+        }
+        while (wait == 0 && cqe) {
+            std::unique_ptr<RingRead> read(static_cast<RingRead*>(io_uring_cqe_get_data(cqe)));
+            const int result = cqe->res;
+            io_uring_cqe_seen(&ring, cqe);
+            in_kernel--;
+
+            RingFile* file = read->file;
+            if (result < 0) {
+                file->error = -result;
+            } else if (result == 0) {
+                file->error = EIO; // File shrank under us
+            } else if (static_cast<size_t>(result) < read->length && file->error == 0) {
+                retries.push_back(RingRead{file, read->offset + result, read->length - result});
+                cqe = nullptr;
+                wait = io_uring_peek_cqe(&ring, &cqe);
+                continue;
+            }
+
+            // A failed file still waits for its other reads, which target its buffer
+            if (--file->pending == 0 && (file->error != 0 || file->queued >= file->bytes.size())) {
+                finish(file);
+            }
+
+            cqe = nullptr;
+            wait = io_uring_peek_cqe(&ring, &cqe);
+        }
+    }
+}
+
+#endif
+
+MemoryAudioFile::MemoryAudioFile(const uint8_t* data, size_t size)
+    : data_(data), size_(static_cast<sf_count_t>(size)), position_(0) {}
+
+SNDFILE* MemoryAudioFile::open(SF_INFO* info) {
+    static SF_VIRTUAL_IO io = {get_filelen, seek, read, write, tell};
+    position_ = 0;
+    return sf_open_virtual(&io, SFM_READ, info, this);
+}
+
+sf_count_t MemoryAudioFile::get_filelen(void* user) {
+    return static_cast<MemoryAudioFile*>(user)->size_;
+}
+
+sf_count_t MemoryAudioFile::seek(sf_count_t offset, int whence, void* user) {
+    MemoryAudioFile* file = static_cast<MemoryAudioFile*>(user);
+    sf_count_t target = offset;
+    if (whence == SEEK_CUR) {
+        target += file->position_;
+    } else if (whence == SEEK_END) {
+        target += file->size_;
+    }
+    file->position_ = std::max<sf_count_t>(0, std::min(target, file->size_));
+    return file->position_;
+}
+
+sf_count_t MemoryAudioFile::read(void* ptr, sf_count_t count, void* user) {
+    MemoryAudioFile* file = static_cast<MemoryAudioFile*>(user);
+    const sf_count_t available = std::max<sf_count_t>(0, std::min(count, file->size_ - file->position_));
+    std::memcpy(ptr, file->data_ + file->position_, static_cast<size_t>(available));
+    file->position_ += available;
+    return available;
+}
+
+sf_count_t MemoryAudioFile::write(const void*, sf_count_t, void*) {
+    return 0;
+}
+
+sf_count_t MemoryAudioFile::tell(void* user) {
+    return static_cast<MemoryAudioFile*>(user)->position_;
+}
+
+} // namespace AudioDuplicates
@@ -0,0 +1,122 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <deque>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <cstdint>
+#include <cstddef>
+#include <sndfile.h>
+
+struct io_uring;
+
+namespace AudioDuplicates {
+
+enum class PrefetchBackend : uint8_t {
+    Auto = 0,    // io_uring when compiled in and the kernel allows it, threads otherwise
+    IoUring = 1,
+    Threads = 2
+};
+
+struct PrefetchConfig {
+    size_t depth = 8;                         // Files read (or being read) but not yet taken by next()
+    PrefetchBackend backend = PrefetchBackend::Auto;
+    size_t threads = 4;                       // Reader threads for the thread-pool backend
+    size_t read_bytes = 1 << 20;              // Bytes per read request
+    unsigned ring_entries = 64;               // io_uring submission queue size
+};
+
+struct PrefetchedFile {
+    size_t index;               // Position in the prefetcher's path list
+    std::vector<uint8_t> bytes; // Whole file
+    int error;                  // errno of the failed open or read, 0 on success
+};
+
+struct PrefetchStats {
+    PrefetchBackend backend;    // Backend actually used
+    size_t files;
+    size_t bytes;
+    size_t read_requests;
+    size_t consumer_waits;      // next() calls that found nothing ready
+    double consumer_wait_seconds;
+};
+
+/**
+ * Reads whole files ahead of their consumer, keeping up to `depth` files in flight
+ * With io_uring one thread keeps every in-flight file's reads queued in the
+ * kernel at once; the fallback spreads blocking preads over a thread pool.
+ * Files are handed out in completion order
+ */
+class FilePrefetcher {
+public:
+    FilePrefetcher(const std::vector<std::string>& paths, const PrefetchConfig& config = PrefetchConfig{});
+    ~FilePrefetcher();
+
+    FilePrefetcher(const FilePrefetcher&) = delete;
+    FilePrefetcher& operator=(const FilePrefetcher&) = delete;
+
+    // Block until a file is ready; false once every file has been handed out.
+    // Safe to call from several threads
+    bool next(PrefetchedFile& out);
+
+    PrefetchStats stats() const;
+
+    // Whether this build includes the io_uring backend
+    static bool io_uring_available();
+
+private:
+    std::vector<std::string> paths_;
+    PrefetchConfig config_;
+    PrefetchBackend backend_;
+
+    mutable std::mutex mutex_;
+    std::condition_variable ready_cv_;  // Consumers: a file completed or the readers finished
+    std::condition_variable space_cv_;  // Readers: a consumer freed a slot or the prefetcher is stopping
+    std::deque<PrefetchedFile> ready_;
+    size_t in_flight_;                  // Started and not yet handed out
+    size_t handed_out_;
+    size_t next_path_;
+    bool stopping_;
+    PrefetchStats stats_;
+
+    std::vector<std::thread> threads_;
+
+    // Claim the next path if fewer than depth files are in flight (waiting for a
+    // slot when asked to); false when no slot is free, every path is claimed or stopping
+    bool claim(size_t& index, bool wait);
+    bool finished() const;
+    void complete(PrefetchedFile&& file, size_t read_requests);
+
+    void run_threads();
+    void run_io_uring(io_uring& ring);
+
+    // Blocking whole-file read used by the thread backend
+    PrefetchedFile read_file(size_t index, size_t& read_requests) const;
+};
+
+/**
+ * In-memory audio file opened through libsndfile's SF_VIRTUAL_IO
+ * The bytes must outlive the SNDFILE handle
+ */
+class MemoryAudioFile {
+public:
+    MemoryAudioFile(const uint8_t* data, size_t size);
+
+    // sf_open_virtual over the bytes; nullptr on failure like sf_open
+    SNDFILE* open(SF_INFO* info);
+
+private:
+    const uint8_t* data_;
+    sf_count_t size_;
+    sf_count_t position_;
+
+    static sf_count_t get_filelen(void* user);
+    static sf_count_t seek(sf_count_t offset, int whence, void* user);
+    static sf_count_t read(void* ptr, sf_count_t count, void* user);
+    static sf_count_t write(const void* ptr, sf_count_t count, void* user);
+    static sf_count_t tell(void* user);
+};
+
+} // namespace AudioDuplicates
@@ -1,7 +1,6 @@
 #include "fingerprint_comparator.h"
 #include <algorithm>
 #include <cmath>
-#include <unordered_set>
 
 #if defined(__GNUC__) || defined(__clang__)
     #define POPCOUNT __builtin_popcountll
@@ -23,6 +22,74 @@
 
 namespace AudioDuplicates {
 
+namespace {
+
+// Per-offset overlap [start, end) in fp1 and running error count for compare_compressed
+struct OffsetScan {
+    int offset;
+    int start;
+    int end;
+    size_t error_bits;
+    bool alive;
+};
+
+// Per-thread working storage; vectors only grow, so a warmed-up thread compares
+// without touching the heap
+struct ComparatorScratch {
+    std::vector<uint64_t> hash_bits1; // 16-bit hash membership bitmaps for the quick filter
+    std::vector<uint64_t> hash_bits2;
+    std::vector<int> histogram;
+    std::vector<double> filtered;
+    std::vector<int> peaks;
+    std::vector<uint32_t> frames1;    // Block decode buffers for compare_compressed
+    std::vector<uint32_t> frames2;
+    std::vector<OffsetScan> scans;
+
+    ComparatorScratch() : hash_bits1(65536 / 64, 0), hash_bits2(65536 / 64, 0) {}
+};
+
+ComparatorScratch& comparator_scratch() {
+    thread_local ComparatorScratch scratch;
+    return scratch;
+}
+
+// Compressed fingerprint decoded block by block on demand into a reused buffer
+class LazyFingerprint {
+public:
+    LazyFingerprint(const CompressedFingerprint& compressed, std::vector<uint32_t>& buffer)
+        : compressed_(compressed), buffer_(buffer), decoded_blocks_(0) {
+        if (buffer_.size() < compressed.getFrameCount()) {
+            buffer_.resize(compressed.getFrameCount());
+        }
+    }
+
+    // Decode every block needed for frames [0, end)
+    const uint32_t* frames_until(size_t end) {
+        const size_t needed = std::min(compressed_.getBlockCount(),
+                                       (end + CompressedFingerprint::BLOCK_FRAMES - 1) / CompressedFingerprint::BLOCK_FRAMES);
+        for (; decoded_blocks_ < needed; ++decoded_blocks_) {
+            compressed_.decompress_block(decoded_blocks_,
+                                         buffer_.data() + decoded_blocks_ * CompressedFingerprint::BLOCK_FRAMES);
+        }
+        return buffer_.data();
+    }
+
+    FingerprintView full() {
+        frames_until(compressed_.getFrameCount());
+        return FingerprintView(buffer_.data(), compressed_.getFrameCount(),
+                               compressed_.getSampleRate(), compressed_.getDuration());
+    }
+
+    size_t decoded_blocks() const { return decoded_blocks_; }
+
+private:
+    const CompressedFingerprint& compressed_;
+    std::vector<uint32_t>& buffer_;
+    size_t decoded_blocks_;
+};
+
+} // namespace
+
 FingerprintComparator::FingerprintComparator()
     : similarity_threshold_(DEFAULT_SIMILARITY_THRESHOLD)
     , bit_error_threshold_(DEFAULT_BIT_ERROR_THRESHOLD)
@@ -34,7 +101,7 @@ FingerprintComparator::FingerprintComparator()
 FingerprintComparator::~FingerprintComparator() {
 }
 
-MatchResult FingerprintComparator::compare(const Fingerprint& fp1, const Fingerprint& fp2) const {
+MatchResult FingerprintComparator::compare(FingerprintView fp1, FingerprintView fp2) const {
     MatchResult result;
     result.similarity_score = 0.0;
     result.best_offset = 0;
@@ -44,7 +111,7 @@ MatchResult FingerprintComparator::compare(const Fingerprint& fp1, const Fingerp
     result.coverage_ratio = 0.0;
 
     // Check minimum overlap requirement
-    if (fp1.data.size() < minimum_overlap_ || fp2.data.size() < minimum_overlap_) {
+    if (fp1.size < minimum_overlap_ || fp2.size < minimum_overlap_) {
         return result;
     }
 
@@ -54,16 +121,16 @@ MatchResult FingerprintComparator::compare(const Fingerprint& fp1, const Fingerp
     }
 
     // Find best alignment offset
-    int best_offset = find_best_alignment(fp1.data, fp2.data);
+    int best_offset = find_best_alignment(fp1, fp2);
     result.best_offset = best_offset;
 
     // Calculate similarity at best offset
-    result.similarity_score = calculate_similarity_at_offset(fp1.data, fp2.data, best_offset);
-    result.bit_error_rate = calculate_bit_error_rate(fp1.data, fp2.data, best_offset);
+    result.similarity_score = calculate_similarity_at_offset(fp1, fp2, best_offset);
+    result.bit_error_rate = calculate_bit_error_rate(fp1, fp2, best_offset);
 
     // Calculate matched segments
     size_t overlap_start = std::max(0, -best_offset);
-    size_t overlap_end = std::min(static_cast<int>(fp1.data.size()), static_cast<int>(fp2.data.size()) - best_offset);
+    size_t overlap_end = std::min(static_cast<int>(fp1.size), static_cast<int>(fp2.size) - best_offset);
     result.matched_segments = overlap_end > overlap_start ? overlap_end - overlap_start : 0;
 
     // Determine if it's a duplicate based on thresholds
@@ -74,7 +141,7 @@ MatchResult FingerprintComparator::compare(const Fingerprint& fp1, const Fingerp
     return result;
 }
 
-MatchResult FingerprintComparator::compare_sliding_window(const Fingerprint& fp1, const Fingerprint& fp2) const {
+MatchResult FingerprintComparator::compare_with_offset_hint(FingerprintView fp1, FingerprintView fp2, int offset_hint) const {
     MatchResult result;
     result.similarity_score = 0.0;
     result.best_offset = 0;
@@ -84,7 +151,256 @@ MatchResult FingerprintComparator::compare_sliding_window(const Fingerprint& fp1
     result.coverage_ratio = 0.0;
 
     // Check minimum overlap requirement
-    if (fp1.data.size() < minimum_overlap_ || fp2.data.size() < minimum_overlap_) {
+    if (fp1.size < minimum_overlap_ || fp2.size < minimum_overlap_) {
+        return result;
+    }
+
+    // Quick filter check
+    if (!quick_filter(fp1, fp2)) {
+        return result;
+    }
+
+    // Refine within one coarse alignment step of the hint
+    int best_offset = std::max(-max_alignment_offset_, std::min(max_alignment_offset_, offset_hint));
+    double best_similarity = calculate_similarity_at_offset(fp1, fp2, best_offset);
+    const int hint_center = best_offset;
+
+    for (int fine_offset = hint_center - alignment_step_; fine_offset <= hint_center + alignment_step_; ++fine_offset) {
+        if (std::abs(fine_offset) <= max_alignment_offset_ && fine_offset != hint_center) {
+            double similarity = calculate_similarity_at_offset(fp1, fp2, fine_offset);
+            if (similarity > best_similarity) {
+                best_similarity = similarity;
+                best_offset = fine_offset;
+            }
+        }
+    }
+
+    result.best_offset = best_offset;
+    result.similarity_score = best_similarity;
+    result.bit_error_rate = calculate_bit_error_rate(fp1, fp2, best_offset);
+
+    // Calculate matched segments
+    size_t overlap_start = std::max(0, -best_offset);
+    size_t overlap_end = std::min(static_cast<int>(fp1.size), static_cast<int>(fp2.size) - best_offset);
+    result.matched_segments = overlap_end > overlap_start ? overlap_end - overlap_start : 0;
+
+    // Determine if it's a duplicate based on thresholds
+    result.is_duplicate = (result.similarity_score >= similarity_threshold_) &&
+                         (result.bit_error_rate <= bit_error_threshold_) &&
+                         (result.matched_segments >= minimum_overlap_);
+
+    return result;
+}
+
+MatchResult FingerprintComparator::compare_compressed(const CompressedFingerprint& fp1, const CompressedFingerprint& fp2,
+                                                      int offset_hint, size_t* blocks_decoded) const {
+    MatchResult result;
+    result.similarity_score = 0.0;
+    result.best_offset = 0;
+    result.matched_segments = 0;
+    result.bit_error_rate = 1.0;
+    result.is_duplicate = false;
+    result.coverage_ratio = 0.0;
+
+    if (blocks_decoded) {
+        *blocks_decoded = 0;
+    }
+
+    const int size1 = static_cast<int>(fp1.getFrameCount());
+    const int size2 = static_cast<int>(fp2.getFrameCount());
+
+    // Check minimum overlap requirement
+    if (static_cast<size_t>(size1) < minimum_overlap_ || static_cast<size_t>(size2) < minimum_overlap_) {
+        return result;
+    }
+
+    ComparatorScratch& scratch = comparator_scratch();
+
+    // Same offsets, in the same order, as compare_with_offset_hint
+    const int hint_center = std::max(-max_alignment_offset_, std::min(max_alignment_offset_, offset_hint));
+    auto& scans = scratch.scans;
+    scans.clear();
+    int scan_begin = size1;
+    int scan_end = 0;
+    auto add_scan = [&](int offset) {
+        OffsetScan scan{offset, std::max(0, -offset), std::min(size1, size2 - offset), 0, true};
+        if (scan.end > scan.start) {
+            scan_begin = std::min(scan_begin, scan.start);
+            scan_end = std::max(scan_end, scan.end);
+        }
+        scans.push_back(scan);
+    };
+
+    add_scan(hint_center);
+    for (int fine_offset = hint_center - alignment_step_; fine_offset <= hint_center + alignment_step_; ++fine_offset) {
+        if (std::abs(fine_offset) <= max_alignment_offset_ && fine_offset != hint_center) {
+            add_scan(fine_offset);
+        }
+    }
+
+    // No offset near the hint overlaps enough frames to be a duplicate: decode nothing
+    const bool long_enough = std::any_of(scans.begin(), scans.end(), [this](const OffsetScan& scan) {
+        return scan.end - scan.start >= static_cast<int>(minimum_overlap_);
+    });
+    if (!long_enough) {
+        return result;
+    }
+
+    LazyFingerprint lazy1(fp1, scratch.frames1);
+    LazyFingerprint lazy2(fp2, scratch.frames2);
+    auto report_blocks = [&]() {
+        if (blocks_decoded) {
+            *blocks_decoded = lazy1.decoded_blocks() + lazy2.decoded_blocks();
+        }
+    };
+
+    // Error counts only grow, so an offset whose partial counts already fail the
+    // thresholds over its full overlap can never become a duplicate
+    const int segment = static_cast<int>(CompressedFingerprint::BLOCK_FRAMES);
+    size_t alive = scans.size();
+
+    for (int segment_begin = scan_begin; segment_begin < scan_end && alive > 0; segment_begin += segment) {
+        const int segment_end = std::min(segment_begin + segment, scan_end);
+        const uint32_t* frames1 = lazy1.frames_until(segment_end);
+        const uint32_t* frames2 = lazy2.frames_until(std::min(size2, segment_end + hint_center + alignment_step_));
+
+        for (auto& scan : scans) {
+            if (!scan.alive) {
+                continue;
+            }
+
+            const int begin = std::max(segment_begin, scan.start);
+            const int end = std::min(segment_end, scan.end);
+            for (int i = begin; i < end; ++i) {
+                scan.error_bits += POPCOUNT(frames1[i] ^ frames2[i + scan.offset]);
+            }
+
+            const size_t total = 32 * static_cast<size_t>(std::max(0, scan.end - scan.start));
+            if (total == 0 ||
+                static_cast<double>(scan.error_bits) / total > bit_error_threshold_ ||
+                static_cast<double>(total - scan.error_bits) / total < similarity_threshold_) {
+                scan.alive = false;
+                alive--;
+            }
+        }
+    }
+
+    if (alive == 0) {
+        report_blocks();
+        return result;
+    }
+
+    // compare_with_offset_hint rejects on the quick filter before reporting any
+    // alignment; it is only run here once a duplicate is still possible, as it
+    // needs every block of both fingerprints
+    if (!quick_filter(lazy1.full(), lazy2.full())) {
+        report_blocks();
+        return result;
+    }
+
+    // Pick the most similar surviving offset (ties keep the earlier offset)
+    const OffsetScan* best = nullptr;
+    double best_similarity = 0.0;
+    for (const auto& scan : scans) {
+        if (!scan.alive) {
+            continue;
+        }
+        const size_t total = 32 * static_cast<size_t>(scan.end - scan.start);
+        const double similarity = static_cast<double>(total - scan.error_bits) / total;
+        if (!best || similarity > best_similarity) {
+            best = &scan;
+            best_similarity = similarity;
+        }
+    }
+
+    const size_t best_total = 32 * static_cast<size_t>(best->end - best->start);
+    result.best_offset = best->offset;
+    result.similarity_score = best_similarity;
+    result.bit_error_rate = static_cast<double>(best->error_bits) / best_total;
+    result.matched_segments = static_cast<size_t>(best->end - best->start);
+
+    // Determine if it's a duplicate based on thresholds
+    result.is_duplicate = (result.similarity_score >= similarity_threshold_) &&
+                         (result.bit_error_rate <= bit_error_threshold_) &&
+                         (result.matched_segments >= minimum_overlap_);
+
+    report_blocks();
+    return result;
+}
+
+MatchResult FingerprintComparator::compare_sampled(const SampledFingerprint& fp1, const SampledFingerprint& fp2) const {
+    MatchResult result;
+    result.similarity_score = 0.0;
+    result.best_offset = 0;
+    result.matched_segments = 0;
+    result.bit_error_rate = 1.0;
+    result.is_duplicate = false;
+    result.coverage_ratio = 0.0;
+
+    const size_t spans1 = fp1.span_count();
+    const size_t spans2 = fp2.span_count();
+    if (spans1 == 0 || spans2 == 0) {
+        return result;
+    }
+
+    // Iterate the file with fewer spans; swap the offset sign back when fp2 leads
+    const bool swapped = spans2 < spans1;
+    const SampledFingerprint& outer = swapped ? fp2 : fp1;
+    const SampledFingerprint& inner = swapped ? fp1 : fp2;
+    const bool paired = spans1 == spans2;
+
+    double similarity_sum = 0.0;
+    double bit_error_sum = 0.0;
+    bool have_offset = false;
+    for (size_t i = 0; i < outer.span_count(); ++i) {
+        MatchResult best;
+        best.similarity_score = -1.0;
+        int best_global_offset = 0;
+        const size_t first = paired ? i : 0;
+        const size_t last = paired ? i + 1 : inner.span_count();
+        for (size_t j = first; j < last; ++j) {
+            MatchResult span_result = compare(outer.span(i), inner.span(j));
+            if (span_result.similarity_score > best.similarity_score) {
+                best = span_result;
+                // Item p of outer span i lines up with item p + offset of inner span j
+                best_global_offset = span_result.best_offset + static_cast<int>(std::lround(
+                    (inner.span_starts[j] - outer.span_starts[i]) * outer.items_per_second));
+            }
+        }
+
+        const int offset = swapped ? -best_global_offset : best_global_offset;
+        result.segment_matches.emplace_back(offset, best.similarity_score);
+        similarity_sum += best.similarity_score;
+        bit_error_sum += best.bit_error_rate;
+        if (best.is_duplicate) {
+            if (!have_offset) {
+                result.best_offset = offset;
+                have_offset = true;
+            }
+            result.matched_segments++;
+        }
+    }
+
+    const size_t pairs = outer.span_count();
+    result.similarity_score = similarity_sum / pairs;
+    result.bit_error_rate = bit_error_sum / pairs;
+    result.coverage_ratio = static_cast<double>(result.matched_segments) / pairs;
+    result.is_duplicate = result.matched_segments * 2 >= pairs && result.matched_segments > 0;
+
+    return result;
+}
+
+MatchResult FingerprintComparator::compare_sliding_window(FingerprintView fp1, FingerprintView fp2) const {
+    MatchResult result;
+    result.similarity_score = 0.0;
+    result.best_offset = 0;
+    result.matched_segments = 0;
+    result.bit_error_rate = 1.0;
+    result.is_duplicate = false;
+    result.coverage_ratio = 0.0;
+
+    // Check minimum overlap requirement
+    if (fp1.size < minimum_overlap_ || fp2.size < minimum_overlap_) {
         return result;
     }
 
@@ -95,7 +411,7 @@ MatchResult FingerprintComparator::compare_sliding_window(const Fingerprint& fp1
 
     // Find matching segments using sliding window approach
     int window_size = 60; // ~5 seconds window at default rate
-    result.segment_matches = find_segment_matches(fp1.data, fp2.data, window_size);
+    result.segment_matches = find_segment_matches(fp1, fp2, window_size);
 
     if (result.segment_matches.empty()) {
         return result;
@@ -119,11 +435,11 @@ MatchResult FingerprintComparator::compare_sliding_window(const Fingerprint& fp1
     }
 
     // Calculate coverage ratio
-    size_t max_length = std::max(fp1.data.size(), fp2.data.size());
+    size_t max_length = std::max(fp1.size, fp2.size);
     result.coverage_ratio = calculate_coverage_ratio(result.segment_matches, max_length);
 
     // Calculate bit error rate at best offset
-    result.bit_error_rate = calculate_bit_error_rate(fp1.data, fp2.data, result.best_offset);
+    result.bit_error_rate = calculate_bit_error_rate(fp1, fp2, result.best_offset);
 
     // Count matched segments
     result.matched_segments = result.segment_matches.size();
@@ -137,16 +453,14 @@ MatchResult FingerprintComparator::compare_sliding_window(const Fingerprint& fp1
     return result;
 }
 
-bool FingerprintComparator::quick_filter(const Fingerprint& fp1, const Fingerprint& fp2) const {
-    // Extract 16-bit hash subsets for quick comparison
-    auto hashes1 = extract_hash_subset(fp1.data);
-    auto hashes2 = extract_hash_subset(fp2.data);
-
-    // Calculate hash overlap
-    double overlap = calculate_hash_overlap(hashes1, hashes2);
-
+bool FingerprintComparator::quick_filter(FingerprintView fp1, FingerprintView fp2) const {
     // Quick filter threshold (more permissive than final threshold)
-    return overlap >= (similarity_threshold_ * 0.6);
+    return quick_filter_overlap(fp1, fp2) >= get_quick_filter_threshold();
+}
+
+double FingerprintComparator::quick_filter_overlap(FingerprintView fp1, FingerprintView fp2) const {
+    // Compare the 16-bit hash sets of both fingerprints
+    return calculate_hash_overlap(fp1, fp2);
 }
 
 void FingerprintComparator::set_similarity_threshold(double threshold) {
@@ -169,19 +483,19 @@ void FingerprintComparator::set_alignment_step(int step) {
     alignment_step_ = std::max(1, step);
 }
 
-double FingerprintComparator::calculate_similarity_at_offset(const std::vector<uint32_t>& fp1,
-                                                           const std::vector<uint32_t>& fp2,
+double FingerprintComparator::calculate_similarity_at_offset(FingerprintView fp1,
+                                                           FingerprintView fp2,
                                                            int offset) const {
     size_t total_comparisons = 0;
     size_t matching_bits = 0;
 
     int start1 = std::max(0, -offset);
     int start2 = std::max(0, offset);
-    int end1 = std::min(static_cast<int>(fp1.size()), static_cast<int>(fp2.size()) - offset);
-    int end2 = std::min(static_cast<int>(fp2.size()), static_cast<int>(fp1.size()) + offset);
+    int end1 = std::min(static_cast<int>(fp1.size), static_cast<int>(fp2.size) - offset);
+    int end2 = std::min(static_cast<int>(fp2.size), static_cast<int>(fp1.size) + offset);
 
     for (int i = start1, j = start2; i < end1 && j < end2; ++i, ++j) {
-        matching_bits += count_matching_bits(fp1[i], fp2[j]);
+        matching_bits += count_matching_bits(fp1.data[i], fp2.data[j]);
         total_comparisons += 32; // 32 bits per uint32_t
     }
 
@@ -193,27 +507,27 @@ int FingerprintComparator::count_matching_bits(uint32_t a, uint32_t b) const {
     return 32 - POPCOUNT(a ^ b);
 }
 
-double FingerprintComparator::calculate_bit_error_rate(const std::vector<uint32_t>& fp1,
-                                                      const std::vector<uint32_t>& fp2,
+double FingerprintComparator::calculate_bit_error_rate(FingerprintView fp1,
+                                                      FingerprintView fp2,
                                                       int offset) const {
     size_t total_comparisons = 0;
     size_t error_bits = 0;
 
     int start1 = std::max(0, -offset);
     int start2 = std::max(0, offset);
-    int end1 = std::min(static_cast<int>(fp1.size()), static_cast<int>(fp2.size()) - offset);
-    int end2 = std::min(static_cast<int>(fp2.size()), static_cast<int>(fp1.size()) + offset);
+    int end1 = std::min(static_cast<int>(fp1.size), static_cast<int>(fp2.size) - offset);
+    int end2 = std::min(static_cast<int>(fp2.size), static_cast<int>(fp1.size) + offset);
 
     for (int i = start1, j = start2; i < end1 && j < end2; ++i, ++j) {
-        error_bits += POPCOUNT(fp1[i] ^ fp2[j]);
+        error_bits += POPCOUNT(fp1.data[i] ^ fp2.data[j]);
         total_comparisons += 32;
     }
 
     return total_comparisons > 0 ? static_cast<double>(error_bits) / total_comparisons : 1.0;
 }
 
-int FingerprintComparator::find_best_alignment(const std::vector<uint32_t>& fp1,
-                                              const std::vector<uint32_t>& fp2) const {
+int FingerprintComparator::find_best_alignment(FingerprintView fp1,
+                                              FingerprintView fp2) const {
     // Try histogram-based approach first for better handling of silence padding
     int histogram_offset = find_best_alignment_histogram(fp1, fp2);
 
@@ -241,55 +555,74 @@ int FingerprintComparator::find_best_alignment(const std::vector<uint32_t>& fp1,
     return best_offset;
 }
 
-std::vector<uint16_t> FingerprintComparator::extract_hash_subset(const std::vector<uint32_t>& fingerprint) const {
-    std::vector<uint16_t> hashes;
-    hashes.reserve(fingerprint.size());
-
-    for (uint32_t value : fingerprint) {
-        // Extract 16-bit hash from the 32-bit fingerprint value
-        hashes.push_back(static_cast<uint16_t>(value & 0xFFFF));
-    }
-
-    return hashes;
-}
-
-double FingerprintComparator::calculate_hash_overlap(const std::vector<uint16_t>& hashes1,
-                                                    const std::vector<uint16_t>& hashes2) const {
-    if (hashes1.empty() || hashes2.empty()) {
+double FingerprintComparator::calculate_hash_overlap(FingerprintView fp1,
+                                                    FingerprintView fp2) const {
+    if (fp1.size == 0 || fp2.size == 0) {
         return 0.0;
     }
 
-    // Create sets for efficient intersection calculation
-    std::unordered_set<uint16_t> set1(hashes1.begin(), hashes1.end());
-    std::unordered_set<uint16_t> set2(hashes2.begin(), hashes2.end());
+    // Mark the 16-bit hashes (lower bits of each frame) of both fingerprints in
+    // per-thread bitmaps, counting set sizes and the intersection as bits flip on
+    auto& scratch = comparator_scratch();
+    uint64_t* bits1 = scratch.hash_bits1.data();
+    uint64_t* bits2 = scratch.hash_bits2.data();
+
+    size_t size1 = 0;
+    for (size_t i = 0; i < fp1.size; ++i) {
+        const uint16_t hash = static_cast<uint16_t>(fp1.data[i] & 0xFFFF);
+        const uint64_t mask = 1ULL << (hash & 63);
+        if (!(bits1[hash >> 6] & mask)) {
+            bits1[hash >> 6] |= mask;
+            size1++;
+        }
+    }
 
-    // Count intersection
+    size_t size2 = 0;
     size_t intersection = 0;
-    for (uint16_t hash : set1) {
-        if (set2.count(hash)) {
-            intersection++;
+    for (size_t i = 0; i < fp2.size; ++i) {
+        const uint16_t hash = static_cast<uint16_t>(fp2.data[i] & 0xFFFF);
+        const uint64_t mask = 1ULL << (hash & 63);
+        if (!(bits2[hash >> 6] & mask)) {
+            bits2[hash >> 6] |= mask;
+            size2++;
+            if (bits1[hash >> 6] & mask) {
+                intersection++;
+            }
         }
     }
 
+    // Clear only the words that were touched
+    for (size_t i = 0; i < fp1.size; ++i) {
+        bits1[(fp1.data[i] & 0xFFFF) >> 6] = 0;
+    }
+    for (size_t i = 0; i < fp2.size; ++i) {
+        bits2[(fp2.data[i] & 0xFFFF) >> 6] = 0;
+    }
+
     // Calculate Jaccard similarity (intersection / union)
-    size_t union_size = set1.size() + set2.size() - intersection;
+    size_t union_size = size1 + size2 - intersection;
     return union_size > 0 ? static_cast<double>(intersection) / union_size : 0.0;
 }
 
-int FingerprintComparator::find_best_alignment_histogram(const std::vector<uint32_t>& fp1,
-                                                        const std::vector<uint32_t>& fp2) const {
+int FingerprintComparator::find_best_alignment_histogram(FingerprintView fp1,
+                                                        FingerprintView fp2) const {
+    auto& scratch = comparator_scratch();
+
     // Build histogram of offset differences
-    auto histogram = build_offset_histogram(fp1, fp2);
+    auto& histogram = scratch.histogram;
+    build_offset_histogram(fp1, fp2, histogram);
 
     if (histogram.empty()) {
         return 0;
     }
 
     // Apply Gaussian filtering to smooth the histogram
-    auto filtered = apply_gaussian_filter(histogram, 2.0);
+    auto& filtered = scratch.filtered;
+    apply_gaussian_filter(histogram, 2.0, filtered);
 
     // Find peaks in the filtered histogram
-    auto peaks = find_histogram_peaks(filtered);
+    auto& peaks = scratch.peaks;
+    find_histogram_peaks(filtered, peaks);
 
     if (peaks.empty()) {
         return 0;
@@ -301,8 +634,8 @@ int FingerprintComparator::find_best_alignment_histogram(const std::vector<uint3
     return best_peak_index - histogram_center;
 }
 
-int FingerprintComparator::find_best_alignment_correlation(const std::vector<uint32_t>& fp1,
-                                                          const std::vector<uint32_t>& fp2) const {
+int FingerprintComparator::find_best_alignment_correlation(FingerprintView fp1,
+                                                          FingerprintView fp2) const {
     double best_similarity = 0.0;
     int best_offset = 0;
 
@@ -318,23 +651,20 @@ int FingerprintComparator::find_best_alignment_correlation(const std::vector<uin
     return best_offset;
 }
 
-std::vector<int> FingerprintComparator::build_offset_histogram(const std::vector<uint32_t>& fp1,
-                                                              const std::vector<uint32_t>& fp2) const {
+void FingerprintComparator::build_offset_histogram(FingerprintView fp1,
+                                                   FingerprintView fp2,
+                                                   std::vector<int>& histogram) const {
     // Create histogram covering -max_alignment_offset_ to +max_alignment_offset_
     int histogram_size = 2 * max_alignment_offset_ + 1;
-    std::vector<int> histogram(histogram_size, 0);
+    histogram.assign(histogram_size, 0);
     int histogram_center = max_alignment_offset_;
 
-    // Extract 16-bit hashes from both fingerprints
-    auto hashes1 = extract_hash_subset(fp1);
-    auto hashes2 = extract_hash_subset(fp2);
-
-    // For each hash in fp1, find matches in fp2 and record offset differences
-    for (size_t i = 0; i < hashes1.size(); ++i) {
-        uint16_t hash1 = hashes1[i];
+    // For each 16-bit hash in fp1, find matches in fp2 and record offset differences
+    for (size_t i = 0; i < fp1.size; ++i) {
+        uint16_t hash1 = static_cast<uint16_t>(fp1.data[i] & 0xFFFF);
 
-        for (size_t j = 0; j < hashes2.size(); ++j) {
-            uint16_t hash2 = hashes2[j];
+        for (size_t j = 0; j < fp2.size; ++j) {
+            uint16_t hash2 = static_cast<uint16_t>(fp2.data[j] & 0xFFFF);
 
             // Check for exact hash match (can be made more flexible)
             if (hash1 == hash2) {
@@ -350,13 +680,11 @@ std::vector<int> FingerprintComparator::build_offset_histogram(const std::vector
             }
         }
     }
-
-    return histogram;
 }
 
-std::vector<double> FingerprintComparator::apply_gaussian_filter(const std::vector<int>& histogram,
-                                                                double sigma) const {
-    std::vector<double> filtered(histogram.size(), 0.0);
+void FingerprintComparator::apply_gaussian_filter(const std::vector<int>& histogram, double sigma,
+                                                  std::vector<double>& filtered) const {
+    filtered.assign(histogram.size(), 0.0);
 
     // Calculate kernel size (3 sigma on each side)
     int kernel_size = static_cast<int>(3 * sigma);
@@ -376,15 +704,14 @@ std::vector<double> FingerprintComparator::apply_gaussian_filter(const std::vect
 
         filtered[i] = weight_sum > 0 ? sum / weight_sum : 0.0;
     }
-
-    return filtered;
 }
 
-std::vector<int> FingerprintComparator::find_histogram_peaks(const std::vector<double>& filtered_histogram) const {
-    std::vector<int> peaks;
+void FingerprintComparator::find_histogram_peaks(const std::vector<double>& filtered_histogram,
+                                                 std::vector<int>& peaks) const {
+    peaks.clear();
 
     if (filtered_histogram.size() < 3) {
-        return peaks;
+        return;
     }
 
     // Find local maxima
@@ -401,30 +728,28 @@ std::vector<int> FingerprintComparator::find_histogram_peaks(const std::vector<d
               [&filtered_histogram](int a, int b) {
                   return filtered_histogram[a] > filtered_histogram[b];
               });
-
-    return peaks;
 }
 
-std::vector<std::pair<int, double>> FingerprintComparator::find_segment_matches(const std::vector<uint32_t>& fp1,
-                                                                               const std::vector<uint32_t>& fp2,
+std::vector<std::pair<int, double>> FingerprintComparator::find_segment_matches(FingerprintView fp1,
+                                                                               FingerprintView fp2,
                                                                                int window_size) const {
     std::vector<std::pair<int, double>> segment_matches;
 
-    if (static_cast<int>(fp1.size()) < window_size || static_cast<int>(fp2.size()) < window_size) {
+    if (static_cast<int>(fp1.size) < window_size || static_cast<int>(fp2.size) < window_size) {
         return segment_matches;
     }
 
     // Slide window across fp1
-    for (int i = 0; i <= static_cast<int>(fp1.size()) - window_size; i += window_size / 2) {
+    for (int i = 0; i <= static_cast<int>(fp1.size) - window_size; i += window_size / 2) {
         double best_similarity = 0.0;
         int best_offset = 0;
 
-        // Extract window from fp1
-        std::vector<uint32_t> window1(fp1.begin() + i, fp1.begin() + i + window_size);
+        // Window of fp1 (a view, no copy)
+        FingerprintView window1(fp1.data + i, window_size, fp1.sample_rate, fp1.duration);
 
         // Try different positions in fp2 for this window
-        for (int j = 0; j <= static_cast<int>(fp2.size()) - window_size; j += 6) { // 6 = alignment_step
-            std::vector<uint32_t> window2(fp2.begin() + j, fp2.begin() + j + window_size);
+        for (int j = 0; j <= static_cast<int>(fp2.size) - window_size; j += 6) { // 6 = alignment_step
+            FingerprintView window2(fp2.data + j, window_size, fp2.sample_rate, fp2.duration);
 
             // Calculate similarity between windows
             double similarity = calculate_similarity_at_offset(window1, window2, 0);
@@ -3,6 +3,7 @@
 #include <vector>
 #include <cstdint>
 #include "chromaprint_wrapper.h"
+#include "compressed_fingerprint.h"
 
 namespace AudioDuplicates {
 
@@ -18,19 +19,45 @@ struct MatchResult {
     double coverage_ratio; // Percentage of audio covered by matching segments
 };
 
+/**
+ * Fingerprint similarity scoring
+ * Works on FingerprintView so callers can compare decoded scratch buffers; working
+ * storage is thread-local and reused, so comparisons do not allocate once warmed up
+ */
 class FingerprintComparator {
 public:
     FingerprintComparator();
     ~FingerprintComparator();
 
     // Compare two fingerprints and return similarity score
-    MatchResult compare(const Fingerprint& fp1, const Fingerprint& fp2) const;
+    MatchResult compare(FingerprintView fp1, FingerprintView fp2) const;
+
+    // Compare using a known alignment (e.g. from the bulk self-join) instead of a
+    // full offset search; only the neighbourhood of the hint is refined
+    MatchResult compare_with_offset_hint(FingerprintView fp1, FingerprintView fp2, int offset_hint) const;
+
+    // compare_with_offset_hint on block-compressed fingerprints: blocks are decoded
+    // only as the Hamming scan reaches them and the scan stops once no offset near
+    // the hint can meet the thresholds. is_duplicate matches compare_with_offset_hint,
+    // and so do the other fields unless every offset was abandoned (then they are
+    // left at their defaults); blocks_decoded (optional) receives the blocks decoded
+    MatchResult compare_compressed(const CompressedFingerprint& fp1, const CompressedFingerprint& fp2,
+                                   int offset_hint, size_t* blocks_decoded = nullptr) const;
+
+    // Coarse comparison of sampled fingerprints: spans are paired by index when both
+    // files were sampled alike, otherwise each span of the file with fewer is matched
+    // against every span of the other. best_offset is in full-fingerprint items,
+    // matched_segments counts duplicate span pairs and is_duplicate needs at least half
+    MatchResult compare_sampled(const SampledFingerprint& fp1, const SampledFingerprint& fp2) const;
 
     // Sliding window comparison for robust silence padding handling
-    MatchResult compare_sliding_window(const Fingerprint& fp1, const Fingerprint& fp2) const;
+    MatchResult compare_sliding_window(FingerprintView fp1, FingerprintView fp2) const;
 
     // Fast pre-filter comparison using subset of fingerprint data
-    bool quick_filter(const Fingerprint& fp1, const Fingerprint& fp2) const;
+    bool quick_filter(FingerprintView fp1, FingerprintView fp2) const;
+
+    // Jaccard overlap of the 16-bit hash sets that quick_filter thresholds
+    double quick_filter_overlap(FingerprintView fp1, FingerprintView fp2) const;
 
     // Configure similarity thresholds
     void set_similarity_threshold(double threshold);
@@ -45,6 +72,8 @@ public:
     double get_similarity_threshold() const { return similarity_threshold_; }
     double get_bit_error_threshold() const { return bit_error_threshold_; }
     size_t get_minimum_overlap() const { return minimum_overlap_; }
+    int get_max_alignment_offset() const { return max_alignment_offset_; }
+    double get_quick_filter_threshold() const { return similarity_threshold_ * QUICK_FILTER_RATIO; }
 
 private:
     double similarity_threshold_;
@@ -59,43 +88,46 @@ private:
     static constexpr size_t DEFAULT_MINIMUM_OVERLAP = 10;
     static constexpr int DEFAULT_MAX_ALIGNMENT_OFFSET = 360; // ~30 seconds at default sample rate
     static constexpr int DEFAULT_ALIGNMENT_STEP = 6; // ~0.5 second steps
+    static constexpr double QUICK_FILTER_RATIO = 0.6; // Quick filter is more permissive than the final threshold
 
     // Core comparison functions
-    double calculate_similarity_at_offset(const std::vector<uint32_t>& fp1,
-                                         const std::vector<uint32_t>& fp2,
+    double calculate_similarity_at_offset(FingerprintView fp1,
+                                         FingerprintView fp2,
                                          int offset) const;
 
     int count_matching_bits(uint32_t a, uint32_t b) const;
-    double calculate_bit_error_rate(const std::vector<uint32_t>& fp1,
-                                   const std::vector<uint32_t>& fp2,
+    double calculate_bit_error_rate(FingerprintView fp1,
+                                   FingerprintView fp2,
                                    int offset) const;
 
     // Alignment optimization
-    int find_best_alignment(const std::vector<uint32_t>& fp1,
-                           const std::vector<uint32_t>& fp2) const;
+    int find_best_alignment(FingerprintView fp1,
+                           FingerprintView fp2) const;
 
     // Histogram-based offset detection for better silence padding handling
-    int find_best_alignment_histogram(const std::vector<uint32_t>& fp1,
-                                     const std::vector<uint32_t>& fp2) const;
+    int find_best_alignment_histogram(FingerprintView fp1,
+                                     FingerprintView fp2) const;
 
     // Cross-correlation alignment for precise offset detection
-    int find_best_alignment_correlation(const std::vector<uint32_t>& fp1,
-                                       const std::vector<uint32_t>& fp2) const;
-
-    // Quick filter helpers
-    std::vector<uint16_t> extract_hash_subset(const std::vector<uint32_t>& fingerprint) const;
-    double calculate_hash_overlap(const std::vector<uint16_t>& hashes1,
-                                 const std::vector<uint16_t>& hashes2) const;
-
-    // Histogram-based alignment helpers
-    std::vector<int> build_offset_histogram(const std::vector<uint32_t>& fp1,
-                                           const std::vector<uint32_t>& fp2) const;
-    std::vector<double> apply_gaussian_filter(const std::vector<int>& histogram, double sigma) const;
-    std::vector<int> find_histogram_peaks(const std::vector<double>& filtered_histogram) const;
+    int find_best_alignment_correlation(FingerprintView fp1,
+                                       FingerprintView fp2) const;
+
+    // Quick filter helper: Jaccard overlap of the 16-bit hash sets
+    double calculate_hash_overlap(FingerprintView fp1,
+                                 FingerprintView fp2) const;
+
+    // Histogram-based alignment helpers (results go into caller-provided buffers)
+    void build_offset_histogram(FingerprintView fp1,
+                               FingerprintView fp2,
+                               std::vector<int>& histogram) const;
+    void apply_gaussian_filter(const std::vector<int>& histogram, double sigma,
+                               std::vector<double>& filtered) const;
+    void find_histogram_peaks(const std::vector<double>& filtered_histogram,
+                              std::vector<int>& peaks) const;
 
     // Sliding window helpers
-    std::vector<std::pair<int, double>> find_segment_matches(const std::vector<uint32_t>& fp1,
-                                                            const std::vector<uint32_t>& fp2,
+    std::vector<std::pair<int, double>> find_segment_matches(FingerprintView fp1,
+                                                            FingerprintView fp2,
                                                             int window_size) const;
     double calculate_coverage_ratio(const std::vector<std::pair<int, double>>& segment_matches,
                                    size_t total_length) const;
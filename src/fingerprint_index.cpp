@@ -1,16 +1,81 @@
 #include "fingerprint_index.h"
+#include "content_hash.h"
 #include <algorithm>
+#include <cmath>
+#include <cstring>
 #include <unordered_map>
 #include <shared_mutex>
 
 namespace AudioDuplicates {
 
+namespace {
+
+// Per-thread decode buffers: the query side of a loop decodes into one and each
+// candidate into the other, so per-pair work reuses storage instead of allocating
+std::vector<uint32_t>& query_scratch() {
+    thread_local std::vector<uint32_t> buffer;
+    return buffer;
+}
+
+std::vector<uint32_t>& candidate_scratch() {
+    thread_local std::vector<uint32_t> buffer;
+    return buffer;
+}
+
+// Per-thread vote counts of candidates excluded by the duration window, reset by
+// bumping the epoch so a query costs nothing beyond the postings it skips
+struct PrunedVotes {
+    std::vector<uint32_t> epochs;
+    std::vector<uint32_t> counts;
+    uint32_t epoch = 0;
+
+    void begin(size_t files) {
+        if (epochs.size() < files) {
+            epochs.resize(files, 0);
+            counts.resize(files, 0);
+        }
+        if (++epoch == 0) {
+            std::fill(epochs.begin(), epochs.end(), 0);
+            epoch = 1;
+        }
+    }
+
+    // Count one skipped vote; returns the file's pruned votes so far
+    uint32_t add(size_t file_id, uint32_t votes) {
+        if (epochs[file_id] != epoch) {
+            epochs[file_id] = epoch;
+            counts[file_id] = 0;
+        }
+        return counts[file_id] += votes;
+    }
+};
+
+PrunedVotes& pruned_votes() {
+    thread_local PrunedVotes pruned;
+    return pruned;
+}
+
+} // namespace
+
 FingerprintIndex::FingerprintIndex()
     : comparator_(std::make_unique<FingerprintComparator>())
-    , hash_threshold_(DEFAULT_HASH_THRESHOLD) {
+    , hash_threshold_(DEFAULT_HASH_THRESHOLD)
+    , exact_collapse_(true)
+    , duration_min_ratio_(0.0)
+    , duration_queries_(0)
+    , duration_votes_pruned_(0)
+    , duration_comparisons_pruned_(0)
+    , last_bulk_stats_{}
+    , last_bulk_verify_stats_{}
+    , last_exact_stats_{}
+    , last_prefix_join_stats_{}
+    , tier_stop_(false)
+    , tier_interval_(DEFAULT_TIER_INTERVAL)
+    , tier_errors_(0) {
 }
 
 FingerprintIndex::~FingerprintIndex() {
+    stop_tiering();
 }
 
 size_t FingerprintIndex::add_file(const std::string& file_path, std::unique_ptr<CompressedFingerprint> compressed_fingerprint) {
@@ -21,16 +86,68 @@ size_t FingerprintIndex::add_file(const std::string& file_path, std::unique_ptr<
     std::unique_lock<std::mutex> files_lock(files_mutex_);
     std::unique_lock<std::shared_mutex> index_lock(index_mutex_);
 
-    // Create file entry with compressed fingerprint
-    auto file_entry = std::make_unique<FileEntry>(file_path, std::move(compressed_fingerprint));
-    size_t file_id = files_.size();
-
     // Decompress temporarily for hash index building
-    auto temp_fingerprint = file_entry->compressed_fingerprint->decompress();
-    build_hash_index(file_id, *temp_fingerprint);
+    auto temp_fingerprint = compressed_fingerprint->decompress();
+    return register_file(file_path, *compressed_fingerprint, *temp_fingerprint);
+}
+
+InsertMatchResult FingerprintIndex::add_and_match(const std::string& file_path, std::unique_ptr<CompressedFingerprint> compressed_fingerprint) {
+    if (!compressed_fingerprint || !compressed_fingerprint->isValid()) {
+        throw std::invalid_argument("Invalid compressed fingerprint provided");
+    }
+
+    // Query, verification and insertion happen under one exclusive lock so two
+    // concurrent uploads of the same track cannot miss each other
+    std::unique_lock<std::mutex> files_lock(files_mutex_);
+    std::unique_lock<std::shared_mutex> index_lock(index_mutex_);
+
+    auto query_fingerprint = compressed_fingerprint->decompress();
 
-    // Store file entry
-    files_.push_back(std::move(file_entry));
+    InsertMatchResult result;
+
+    // Verify candidates against the existing files before the new file is indexed
+    auto candidates = find_candidates_unlocked(*query_fingerprint);
+    for (size_t candidate_id : candidates) {
+        if (candidate_id >= store_.size()) {
+            continue;
+        }
+
+        auto candidate_fingerprint = store_.frames(candidate_id, candidate_scratch());
+        auto match_result = comparator_->compare(*query_fingerprint, candidate_fingerprint);
+
+        if (match_result.is_duplicate) {
+            result.matches.emplace_back(candidate_id, std::move(match_result));
+        }
+    }
+
+    result.file_id = register_file(file_path, *compressed_fingerprint, *query_fingerprint);
+
+    // Merge the new file into the groups of every verified match
+    for (const auto& match : result.matches) {
+        record_online_match(result.file_id, match.first, match.second.similarity_score);
+    }
+
+    result.group_id = online_groups_.find(result.file_id);
+    return result;
+}
+
+size_t FingerprintIndex::add_identical_file(const std::string& file_path, size_t source_file_id) {
+    std::unique_lock<std::mutex> files_lock(files_mutex_);
+    std::unique_lock<std::shared_mutex> index_lock(index_mutex_);
+
+    if (source_file_id >= store_.size()) {
+        throw std::out_of_range("Source file id out of range");
+    }
+
+    const size_t file_id = store_.append_alias(file_path, source_file_id);
+    build_hash_index(file_id, store_.frames(source_file_id, query_scratch()));
+
+    online_groups_.add();
+    group_similarity_sum_.push_back(0.0);
+    group_match_count_.push_back(0);
+
+    // Identical bytes decode to identical frames, so the match needs no verification
+    record_online_match(file_id, source_file_id, 1.0);
 
     return file_id;
 }
@@ -47,17 +164,10 @@ std::vector<size_t> FingerprintIndex::add_files_batch(std::vector<std::pair<std:
             throw std::invalid_argument("Invalid compressed fingerprint provided");
         }
 
-        // Create file entry
-        auto file_entry = std::make_unique<FileEntry>(file_data.first, std::move(file_data.second));
-        size_t file_id = files_.size();
-
         // Decompress temporarily for hash index building
-        auto temp_fingerprint = file_entry->compressed_fingerprint->decompress();
-        build_hash_index(file_id, *temp_fingerprint);
-
-        // Store file entry
-        files_.push_back(std::move(file_entry));
-        file_ids.push_back(file_id);
+        auto temp_fingerprint = file_data.second->decompress();
+        file_ids.push_back(register_file(file_data.first, *file_data.second, *temp_fingerprint));
+        file_data.second.reset();
     }
 
     return file_ids;
@@ -67,79 +177,705 @@ std::vector<size_t> FingerprintIndex::find_candidates(size_t file_id) const {
     std::shared_lock<std::shared_mutex> index_lock(index_mutex_);
     std::unique_lock<std::mutex> files_lock(files_mutex_);
 
-    if (file_id >= files_.size()) {
-        return {};
-    }
-
-    const auto& file_entry = files_[file_id];
-    if (!file_entry || !file_entry->compressed_fingerprint) {
+    if (file_id >= store_.size()) {
         return {};
     }
 
     // Decompress temporarily for candidate finding
-    auto temp_fingerprint = file_entry->compressed_fingerprint->decompress();
-    return find_candidates(*temp_fingerprint);
+    return find_candidates_unlocked(store_.frames(file_id, query_scratch()));
 }
 
 std::vector<size_t> FingerprintIndex::find_candidates(const Fingerprint& fingerprint) const {
     std::shared_lock<std::shared_mutex> index_lock(index_mutex_);
+    return find_candidates_unlocked(fingerprint);
+}
 
+std::vector<size_t> FingerprintIndex::find_candidates_unlocked(FingerprintView fingerprint) const {
+    auto votes = collect_candidate_votes(fingerprint);
+
+    std::vector<size_t> candidates;
+    candidates.reserve(votes.size());
+    for (const auto& vote : votes) {
+        candidates.push_back(vote.first);
+    }
+
+    return candidates;
+}
+
+std::vector<std::pair<size_t, size_t>> FingerprintIndex::collect_candidate_votes(FingerprintView fingerprint) const {
     std::unordered_map<size_t, size_t> candidate_counts;
 
     // Extract hashes from query fingerprint
     auto query_hashes = extract_hashes(fingerprint);
 
-    // Find matching files for each hash
-    for (uint16_t hash : query_hashes) {
-        auto it = hash_index_.find(hash);
-        if (it != hash_index_.end()) {
+    if (duration_min_ratio_ > 0.0) {
+        // Files outside the duration window never enter the vote map
+        const FrameWindow window = duration_window(fingerprint.size);
+        auto& pruned = pruned_votes();
+        pruned.begin(store_.size());
+
+        size_t votes_pruned = 0;
+        size_t comparisons_pruned = 0;
+        for (uint16_t hash : query_hashes) {
+            auto it = hash_index_.find(hash);
+            if (it == hash_index_.end()) {
+                continue;
+            }
             for (const auto& entry : it->second) {
-                candidate_counts[entry.file_id]++;
+                if (window.contains(static_cast<uint32_t>(store_.frame_count(entry.file_id)))) {
+                    candidate_counts[entry.file_id]++;
+                } else {
+                    votes_pruned++;
+                    if (pruned.add(entry.file_id, 1) == hash_threshold_) {
+                        comparisons_pruned++;
+                    }
+                }
+            }
+        }
+
+        duration_queries_.fetch_add(1, std::memory_order_relaxed);
+        duration_votes_pruned_.fetch_add(votes_pruned, std::memory_order_relaxed);
+        duration_comparisons_pruned_.fetch_add(comparisons_pruned, std::memory_order_relaxed);
+    } else {
+        // Find matching files for each hash
+        for (uint16_t hash : query_hashes) {
+            auto it = hash_index_.find(hash);
+            if (it != hash_index_.end()) {
+                for (const auto& entry : it->second) {
+                    candidate_counts[entry.file_id]++;
+                }
             }
         }
     }
 
     // Filter candidates based on minimum hash threshold
-    std::vector<size_t> candidates;
+    std::vector<std::pair<size_t, size_t>> votes;
     for (const auto& pair : candidate_counts) {
         if (pair.second >= hash_threshold_) {
-            candidates.push_back(pair.first);
+            votes.push_back(pair);
         }
     }
 
     // Sort by match count (highest first)
-    std::sort(candidates.begin(), candidates.end(),
-              [&candidate_counts](size_t a, size_t b) {
-                  return candidate_counts[a] > candidate_counts[b];
+    std::sort(votes.begin(), votes.end(),
+              [](const std::pair<size_t, size_t>& a, const std::pair<size_t, size_t>& b) {
+                  return a.second > b.second;
               });
 
-    return candidates;
+    return votes;
+}
+
+std::vector<std::vector<size_t>> FingerprintIndex::find_candidates_batch(const std::vector<const Fingerprint*>& queries) const {
+    std::shared_lock<std::shared_mutex> index_lock(index_mutex_);
+    return find_candidates_batch_unlocked(queries);
+}
+
+std::vector<std::vector<size_t>> FingerprintIndex::find_candidates_batch_unlocked(const std::vector<const Fingerprint*>& queries) const {
+    struct QueryHash {
+        uint16_t hash;
+        uint32_t query;
+        uint32_t multiplicity;
+    };
+
+    // Gather (hash, query) pairs for the whole block and group them by hash so
+    // every posting list is visited once, with multiplicities for repeated hashes
+    std::vector<QueryHash> query_hashes;
+    size_t total_hashes = 0;
+    for (const Fingerprint* query : queries) {
+        total_hashes += query ? query->data.size() : 0;
+    }
+    query_hashes.reserve(total_hashes);
+
+    for (size_t q = 0; q < queries.size(); ++q) {
+        if (!queries[q]) {
+            continue;
+        }
+        for (uint16_t hash : extract_hashes(*queries[q])) {
+            query_hashes.push_back({hash, static_cast<uint32_t>(q), 1});
+        }
+    }
+
+    std::sort(query_hashes.begin(), query_hashes.end(),
+              [](const QueryHash& a, const QueryHash& b) {
+                  return a.hash != b.hash ? a.hash < b.hash : a.query < b.query;
+              });
+
+    size_t unique_count = 0;
+    for (size_t i = 0; i < query_hashes.size(); ++i) {
+        if (unique_count > 0 &&
+            query_hashes[unique_count - 1].hash == query_hashes[i].hash &&
+            query_hashes[unique_count - 1].query == query_hashes[i].query) {
+            query_hashes[unique_count - 1].multiplicity++;
+        } else {
+            query_hashes[unique_count++] = query_hashes[i];
+        }
+    }
+    query_hashes.resize(unique_count);
+
+    // Duration window per query (all-accepting when the window is disabled)
+    const bool duration_filter = duration_min_ratio_ > 0.0;
+    std::vector<FrameWindow> windows(queries.size(), FrameWindow{0, UINT32_MAX});
+    if (duration_filter) {
+        for (size_t q = 0; q < queries.size(); ++q) {
+            if (queries[q]) {
+                windows[q] = duration_window(queries[q]->data.size());
+            }
+        }
+    }
+
+    // Posting-major traversal: stream each posting list once and count votes per
+    // query by file like collect_candidate_votes, so memory follows the files
+    // voted for rather than the postings walked; votes for files outside a
+    // query's duration window are only counted for the pruning statistics, the
+    // way PrunedVotes counts them on the single-query path
+    std::vector<std::unordered_map<uint32_t, uint32_t>> votes(queries.size());
+    std::vector<std::unordered_map<uint32_t, uint32_t>> pruned(duration_filter ? queries.size() : 0);
+    size_t votes_pruned = 0;
+    size_t comparisons_pruned = 0;
+
+    size_t run_start = 0;
+    while (run_start < query_hashes.size()) {
+        size_t run_end = run_start;
+        while (run_end < query_hashes.size() && query_hashes[run_end].hash == query_hashes[run_start].hash) {
+            ++run_end;
+        }
+
+        auto it = hash_index_.find(query_hashes[run_start].hash);
+        if (it != hash_index_.end()) {
+            for (const auto& entry : it->second) {
+                const uint32_t frames = duration_filter ? static_cast<uint32_t>(store_.frame_count(entry.file_id)) : 0;
+                for (size_t r = run_start; r < run_end; ++r) {
+                    const uint32_t q = query_hashes[r].query;
+                    if (!duration_filter || windows[q].contains(frames)) {
+                        votes[q][static_cast<uint32_t>(entry.file_id)] += query_hashes[r].multiplicity;
+                    } else {
+                        // Count the comparison once, when the file's pruned votes reach the threshold
+                        uint32_t& count = pruned[q][static_cast<uint32_t>(entry.file_id)];
+                        if (count < hash_threshold_ && count + query_hashes[r].multiplicity >= hash_threshold_) {
+                            comparisons_pruned++;
+                        }
+                        count += query_hashes[r].multiplicity;
+                        votes_pruned += query_hashes[r].multiplicity;
+                    }
+                }
+            }
+        }
+
+        run_start = run_end;
+    }
+
+    if (duration_filter) {
+        duration_queries_.fetch_add(queries.size(), std::memory_order_relaxed);
+        duration_votes_pruned_.fetch_add(votes_pruned, std::memory_order_relaxed);
+        duration_comparisons_pruned_.fetch_add(comparisons_pruned, std::memory_order_relaxed);
+    }
+
+    // Apply the hash threshold and order each query's candidates by count
+    std::vector<std::vector<size_t>> results(queries.size());
+    for (size_t q = 0; q < queries.size(); ++q) {
+        std::vector<std::pair<size_t, size_t>> counts;
+        for (const auto& vote : votes[q]) {
+            if (vote.second >= hash_threshold_) {
+                counts.emplace_back(vote.first, vote.second);
+            }
+        }
+
+        // Release the counters before the next query to keep the peak small
+        std::unordered_map<uint32_t, uint32_t>().swap(votes[q]);
+
+        std::sort(counts.begin(), counts.end(),
+                  [](const std::pair<size_t, size_t>& a, const std::pair<size_t, size_t>& b) {
+                      return a.second != b.second ? a.second > b.second : a.first < b.first;
+                  });
+
+        results[q].reserve(counts.size());
+        for (const auto& count : counts) {
+            results[q].push_back(count.first);
+        }
+    }
+
+    return results;
+}
+
+std::vector<TopKMatch> FingerprintIndex::query_top_k(const Fingerprint& fingerprint, size_t k, double min_similarity,
+                                                     double vote_cutoff) const {
+    std::vector<TopKMatch> results;
+    if (k == 0 || fingerprint.data.empty()) {
+        return results;
+    }
+
+    // Writers hold index_mutex_ exclusively, so the shared lock alone keeps store_
+    // stable and concurrent lookups do not serialize on files_mutex_
+    std::shared_lock<std::shared_mutex> index_lock(index_mutex_);
+
+    auto votes = collect_candidate_votes(fingerprint);
+
+    // Vote count of each kept result, parallel to results
+    std::vector<size_t> result_votes;
+
+    for (const auto& vote : votes) {
+        size_t candidate_id = vote.first;
+
+        // Candidates arrive in descending vote order; the approximate mode stops
+        // once they fall well below the weakest result they would have to displace
+        if (vote_cutoff > 0.0 && results.size() >= k) {
+            size_t weakest_votes = result_votes.back();
+            if (static_cast<double>(vote.second) < weakest_votes * vote_cutoff) {
+                break;
+            }
+        }
+
+        if (candidate_id >= store_.size()) {
+            continue;
+        }
+
+        auto candidate_fingerprint = store_.frames(candidate_id, candidate_scratch());
+        auto match_result = comparator_->compare(fingerprint, candidate_fingerprint);
+
+        // Anything not beating the current k-th score cannot enter the result set
+        double floor = min_similarity;
+        if (results.size() >= k) {
+            floor = std::max(floor, results.back().similarity);
+        }
+        if (match_result.similarity_score <= 0.0 || match_result.similarity_score < floor) {
+            continue;
+        }
+
+        // Insert keeping results sorted by similarity (highest first)
+        auto pos = std::upper_bound(results.begin(), results.end(), match_result.similarity_score,
+                                    [](double similarity, const TopKMatch& match) {
+                                        return similarity > match.similarity;
+                                    });
+        size_t index = static_cast<size_t>(pos - results.begin());
+        results.emplace(pos, candidate_id, match_result.similarity_score,
+                        match_result.bit_error_rate, match_result.best_offset);
+        result_votes.insert(result_votes.begin() + index, vote.second);
+
+        if (results.size() > k) {
+            results.pop_back();
+            result_votes.pop_back();
+        }
+    }
+
+    return results;
 }
 
 std::vector<DuplicateGroup> FingerprintIndex::find_all_duplicates() {
+    std::shared_lock<std::shared_mutex> tier_lock(tier_mutex_);
+
     std::vector<std::unordered_set<size_t>> raw_groups;
-    std::vector<bool> processed(files_.size(), false);
+    std::vector<bool> processed(store_.size(), false);
+
+    // Identical copies take part only through their representative
+    auto exact = collect_exact_duplicates();
+    for (size_t file_id = 0; file_id < store_.size(); ++file_id) {
+        processed[file_id] = exact.representative[file_id] != file_id;
+    }
 
     // Find duplicates for each file
-    for (size_t file_id = 0; file_id < files_.size(); ++file_id) {
-        if (!processed[file_id] && files_[file_id]) {
+    for (size_t file_id = 0; file_id < store_.size(); ++file_id) {
+        if (!processed[file_id]) {
             find_duplicates_for_file(file_id, raw_groups, processed);
         }
     }
 
     // Merge overlapping groups and convert to final format
-    return merge_duplicate_groups(raw_groups);
+    return merge_duplicate_groups(expand_exact_duplicates(raw_groups, exact), exact);
+}
+
+std::vector<CandidatePair> FingerprintIndex::run_self_join(const SelfJoinConfig& config, const ExactDuplicateSets& exact) {
+    SelfJoinConfig join_config = config;
+    join_config.min_votes = hash_threshold_;
+    join_config.max_offset = comparator_->get_max_alignment_offset();
+
+    // Emit (hash, file_id, position) tuples for every fingerprint; identical
+    // copies are joined through their representative
+    SelfJoinEngine engine(join_config);
+    for (size_t file_id = 0; file_id < store_.size(); ++file_id) {
+        if (exact.representative[file_id] != file_id) {
+            continue;
+        }
+        auto fingerprint = store_.frames(file_id, query_scratch());
+        engine.add(static_cast<uint32_t>(file_id), fingerprint.data, fingerprint.size);
+    }
+
+    auto pairs = engine.run();
+    {
+        std::lock_guard<std::mutex> lock(stats_mutex_);
+        last_bulk_stats_ = engine.getStats();
+    }
+    return pairs;
+}
+
+std::vector<CandidatePair> FingerprintIndex::find_bulk_candidate_pairs(const SelfJoinConfig& config) {
+    std::shared_lock<std::shared_mutex> index_lock(index_mutex_);
+
+    if (store_.empty()) {
+        return {};
+    }
+
+    return run_self_join(config, collect_exact_duplicates());
+}
+
+std::vector<DuplicateGroup> FingerprintIndex::find_all_duplicates_bulk(const SelfJoinConfig& config) {
+    std::shared_lock<std::shared_mutex> index_lock(index_mutex_);
+
+    if (store_.empty()) {
+        return {};
+    }
+
+    auto exact = collect_exact_duplicates();
+    auto pairs = run_self_join(config, exact);
+
+    // The self-join votes without looking at durations, so the window is applied
+    // to its pairs before any blocks are decoded
+    if (duration_min_ratio_ > 0.0) {
+        const size_t before = pairs.size();
+        pairs.erase(std::remove_if(pairs.begin(), pairs.end(),
+                                   [this](const CandidatePair& pair) {
+                                       return !duration_window(store_.frame_count(pair.file_a))
+                                                   .contains(static_cast<uint32_t>(store_.frame_count(pair.file_b)));
+                                   }),
+                    pairs.end());
+        duration_queries_.fetch_add(1, std::memory_order_relaxed);
+        duration_comparisons_pruned_.fetch_add(before - pairs.size(), std::memory_order_relaxed);
+    }
+
+    // Verify candidate pairs around their alignment hints, streaming the compressed
+    // blocks so rejected pairs stop decoding as soon as they fail the thresholds
+    std::vector<double> verified_similarity(pairs.size(), -1.0);
+    size_t blocks_decoded = 0;
+    size_t blocks_total = 0;
+
+    #pragma omp parallel for schedule(dynamic) reduction(+:blocks_decoded, blocks_total)
+    for (size_t i = 0; i < pairs.size(); ++i) {
+        const auto& pair = pairs[i];
+        const auto cfp_a = store_.fingerprint(pair.file_a);
+        const auto cfp_b = store_.fingerprint(pair.file_b);
+        store_.record_access(pair.file_a);
+        store_.record_access(pair.file_b);
+
+        size_t pair_blocks = 0;
+        auto match_result = comparator_->compare_compressed(cfp_a, cfp_b, pair.offset_hint, &pair_blocks);
+        if (match_result.is_duplicate) {
+            verified_similarity[i] = match_result.similarity_score;
+        }
+
+        blocks_decoded += pair_blocks;
+        blocks_total += cfp_a.getBlockCount() + cfp_b.getBlockCount();
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(stats_mutex_);
+        last_bulk_verify_stats_ = {pairs.size(), blocks_decoded, blocks_total};
+    }
+
+    // Cluster verified pairs; group similarity is the mean over verified edges
+    DisjointSet sets(store_.size());
+    for (size_t i = 0; i < pairs.size(); ++i) {
+        if (verified_similarity[i] >= 0.0) {
+            sets.unite(pairs[i].file_a, pairs[i].file_b);
+        }
+    }
+
+    // Each copy joins its representative with the set's self-similarity as its edge
+    std::vector<std::pair<size_t, double>> copy_edges;
+    for (const auto& entry : exact.copies) {
+        const auto cfp = store_.fingerprint(entry.first);
+        const double similarity = comparator_->compare_compressed(cfp, cfp, 0).similarity_score;
+        for (size_t copy_id : entry.second) {
+            sets.unite(entry.first, copy_id);
+            copy_edges.emplace_back(copy_id, similarity);
+        }
+    }
+
+    std::unordered_map<size_t, DuplicateGroup> groups_by_root;
+    std::unordered_map<size_t, size_t> edges_by_root;
+    for (size_t i = 0; i < pairs.size(); ++i) {
+        if (verified_similarity[i] >= 0.0) {
+            size_t root = sets.find(pairs[i].file_a);
+            groups_by_root[root].avg_similarity += verified_similarity[i];
+            edges_by_root[root]++;
+        }
+    }
+    for (const auto& edge : copy_edges) {
+        size_t root = sets.find(edge.first);
+        groups_by_root[root].avg_similarity += edge.second;
+        edges_by_root[root]++;
+    }
+
+    for (size_t file_id = 0; file_id < store_.size(); ++file_id) {
+        size_t root = sets.find(file_id);
+        auto it = groups_by_root.find(root);
+        if (it != groups_by_root.end()) {
+            it->second.file_ids.push_back(file_id);
+        }
+    }
+
+    std::vector<DuplicateGroup> groups;
+    groups.reserve(groups_by_root.size());
+    for (auto& entry : groups_by_root) {
+        entry.second.avg_similarity /= edges_by_root[entry.first];
+        groups.push_back(std::move(entry.second));
+    }
+
+    // Sort groups by average similarity (highest first)
+    std::sort(groups.begin(), groups.end(),
+              [](const DuplicateGroup& a, const DuplicateGroup& b) {
+                  return a.avg_similarity > b.avg_similarity;
+              });
+
+    return groups;
+}
+
+std::vector<SimilarPair> FingerprintIndex::find_quick_filter_pairs() {
+    std::shared_lock<std::shared_mutex> index_lock(index_mutex_);
+
+    // Ids are dense in store_, so join record ids map straight back to file ids
+    PrefixFilterJoin join(comparator_->get_quick_filter_threshold());
+    std::vector<uint16_t> hashes;
+    for (size_t file_id = 0; file_id < store_.size(); ++file_id) {
+        hashes = extract_hashes(store_.frames(file_id, query_scratch()));
+        join.add(hashes.data(), hashes.size());
+    }
+
+    auto pairs = join.run();
+    {
+        std::lock_guard<std::mutex> lock(stats_mutex_);
+        last_prefix_join_stats_ = join.getStats();
+    }
+    return pairs;
+}
+
+std::vector<SimilarPair> FingerprintIndex::find_quick_filter_pairs_indexed() {
+    std::shared_lock<std::shared_mutex> index_lock(index_mutex_);
+
+    const double threshold = comparator_->get_quick_filter_threshold();
+    std::vector<std::vector<SimilarPair>> pairs_by_file(store_.size());
+
+    #pragma omp parallel for schedule(dynamic)
+    for (size_t file_id = 0; file_id < store_.size(); ++file_id) {
+        auto fingerprint = store_.frames(file_id, query_scratch());
+
+        for (size_t candidate_id : find_candidates_unlocked(fingerprint)) {
+            if (candidate_id <= file_id) {
+                continue;
+            }
+
+            auto candidate_fp = store_.frames(candidate_id, candidate_scratch());
+            double overlap = comparator_->quick_filter_overlap(fingerprint, candidate_fp);
+            if (overlap >= threshold) {
+                pairs_by_file[file_id].push_back({static_cast<uint32_t>(file_id),
+                                                  static_cast<uint32_t>(candidate_id), overlap});
+            }
+        }
+    }
+
+    std::vector<SimilarPair> pairs;
+    for (auto& file_pairs : pairs_by_file) {
+        std::sort(file_pairs.begin(), file_pairs.end(),
+                  [](const SimilarPair& a, const SimilarPair& b) { return a.record_b < b.record_b; });
+        pairs.insert(pairs.end(), file_pairs.begin(), file_pairs.end());
+    }
+
+    return pairs;
+}
+
+std::vector<SimilarPair> FingerprintIndex::find_quick_filter_pairs_all() {
+    std::shared_lock<std::shared_mutex> index_lock(index_mutex_);
+
+    std::vector<std::unique_ptr<Fingerprint>> fingerprints;
+    fingerprints.reserve(store_.size());
+    for (size_t file_id = 0; file_id < store_.size(); ++file_id) {
+        fingerprints.push_back(store_.fingerprint(file_id).decompress());
+    }
+
+    const double threshold = comparator_->get_quick_filter_threshold();
+    std::vector<std::vector<SimilarPair>> pairs_by_file(fingerprints.size());
+
+    #pragma omp parallel for schedule(dynamic)
+    for (size_t file_a = 0; file_a < fingerprints.size(); ++file_a) {
+        for (size_t file_b = file_a + 1; file_b < fingerprints.size(); ++file_b) {
+            double overlap = comparator_->quick_filter_overlap(*fingerprints[file_a], *fingerprints[file_b]);
+            if (overlap >= threshold) {
+                pairs_by_file[file_a].push_back({static_cast<uint32_t>(file_a),
+                                                 static_cast<uint32_t>(file_b), overlap});
+            }
+        }
+    }
+
+    std::vector<SimilarPair> pairs;
+    for (auto& file_pairs : pairs_by_file) {
+        pairs.insert(pairs.end(), file_pairs.begin(), file_pairs.end());
+    }
+    return pairs;
+}
+
+DictionaryReport FingerprintIndex::train_dictionary(size_t max_samples) {
+    std::unique_lock<std::mutex> files_lock(files_mutex_);
+    std::unique_lock<std::shared_mutex> index_lock(index_mutex_);
+
+    DictionaryReport report;
+    if (store_.empty() || max_samples == 0) {
+        return report;
+    }
+
+    // Evenly spaced sample of the corpus
+    const size_t step = std::max<size_t>(1, store_.size() / max_samples);
+    std::vector<std::unique_ptr<Fingerprint>> samples;
+    std::vector<const Fingerprint*> sample_ptrs;
+    FingerprintCodec codec = FingerprintCodec::XorDelta;
+    for (size_t file_id = 0; file_id < store_.size() && samples.size() < max_samples; file_id += step) {
+        auto compressed = store_.fingerprint(file_id);
+        codec = compressed.getCodec();
+        samples.push_back(compressed.decompress());
+        sample_ptrs.push_back(samples.back().get());
+    }
+
+    auto dictionary = FingerprintDictionary::train(sample_ptrs, codec);
+    samples.clear();
+
+    report.samples = sample_ptrs.size();
+    if (!dictionary) {
+        return report;
+    }
+
+    // Recompress every file against the dictionary, then rebuild the slab in one pass
+    std::vector<size_t> bytes_before(store_.size(), 0);
+    std::vector<std::unique_ptr<CompressedFingerprint>> recompressed(store_.size());
+
+    #pragma omp parallel for schedule(dynamic)
+    for (size_t file_id = 0; file_id < store_.size(); ++file_id) {
+        auto compressed = store_.fingerprint(file_id);
+        bytes_before[file_id] = compressed.getCompressedSize();
+
+        auto fingerprint = compressed.decompress();
+        recompressed[file_id] = CompressedFingerprint::compress(*fingerprint, compressed.getCodec(), dictionary);
+    }
+
+    store_.replace_all(recompressed, dictionary);
+    recompressed.clear();
+    report.dictionary_size = dictionary->size();
+
+    // Report per duration range, where short clips gain the most
+    const double bucket_limits[] = {30.0, 120.0, 300.0, 600.0};
+    report.buckets = {CompressionBucket("<30s"), CompressionBucket("30s-2m"), CompressionBucket("2m-5m"),
+                      CompressionBucket("5m-10m"), CompressionBucket(">=10m")};
+
+    for (size_t file_id = 0; file_id < store_.size(); ++file_id) {
+        size_t bucket = 0;
+        while (bucket < 4 && store_.duration(file_id) >= bucket_limits[bucket]) {
+            ++bucket;
+        }
+
+        report.buckets[bucket].files++;
+        report.buckets[bucket].original_bytes += store_.original_size(file_id);
+        report.buckets[bucket].bytes_before += bytes_before[file_id];
+        report.buckets[bucket].bytes_after += store_.compressed_size(file_id);
+    }
+
+    return report;
+}
+
+size_t FingerprintIndex::get_dictionary_size() const {
+    std::shared_lock<std::shared_mutex> index_lock(index_mutex_);
+    return store_.dictionary() ? store_.dictionary()->size() : 0;
+}
+
+std::vector<DuplicateGroup> FingerprintIndex::get_online_groups() const {
+    std::shared_lock<std::shared_mutex> index_lock(index_mutex_);
+
+    std::unordered_map<size_t, DuplicateGroup> groups_by_root;
+    for (size_t file_id = 0; file_id < online_groups_.size(); ++file_id) {
+        size_t root = online_groups_.find(file_id);
+        if (online_groups_.set_size(root) > 1) {
+            groups_by_root[root].file_ids.push_back(file_id);
+        }
+    }
+
+    std::vector<DuplicateGroup> groups;
+    groups.reserve(groups_by_root.size());
+    for (auto& entry : groups_by_root) {
+        size_t root = entry.first;
+        DuplicateGroup& group = entry.second;
+        group.avg_similarity = group_match_count_[root] > 0
+            ? group_similarity_sum_[root] / group_match_count_[root]
+            : 0.0;
+        groups.push_back(std::move(group));
+    }
+
+    // Sort groups by average similarity (highest first)
+    std::sort(groups.begin(), groups.end(),
+              [](const DuplicateGroup& a, const DuplicateGroup& b) {
+                  return a.avg_similarity > b.avg_similarity;
+              });
+
+    return groups;
 }
 
-const FileEntry* FingerprintIndex::get_file(size_t file_id) const {
-    if (file_id >= files_.size()) {
+std::optional<FileEntry> FingerprintIndex::get_file(size_t file_id) const {
+    if (file_id >= store_.size()) {
+        return std::nullopt;
+    }
+    return FileEntry(&store_, file_id);
+}
+
+std::unique_ptr<Fingerprint> FingerprintIndex::get_fingerprint(size_t file_id, StorageTier* tier) const {
+    std::shared_lock<std::shared_mutex> index_lock(index_mutex_);
+    std::unique_lock<std::mutex> files_lock(files_mutex_);
+
+    if (file_id >= store_.size()) {
         return nullptr;
     }
-    return files_[file_id].get();
+
+    if (tier) {
+        *tier = store_.tier(file_id);
+    }
+
+    FingerprintView frames = store_.frames(file_id, query_scratch());
+    auto fingerprint = std::make_unique<Fingerprint>();
+    fingerprint->data.assign(frames.data, frames.data + frames.size);
+    fingerprint->sample_rate = store_.sample_rate(file_id);
+    fingerprint->duration = store_.duration(file_id);
+    fingerprint->file_path = store_.path(file_id);
+    return fingerprint;
 }
 
 size_t FingerprintIndex::get_file_count() const {
-    return files_.size();
+    return store_.size();
+}
+
+SelfJoinEngine::Stats FingerprintIndex::get_last_bulk_stats() const {
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    return last_bulk_stats_;
+}
+
+BulkVerifyStats FingerprintIndex::get_last_bulk_verify_stats() const {
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    return last_bulk_verify_stats_;
+}
+
+ExactDuplicateStats FingerprintIndex::get_last_exact_duplicate_stats() const {
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    return last_exact_stats_;
+}
+
+PrefixFilterJoin::Stats FingerprintIndex::get_last_prefix_join_stats() const {
+    std::lock_guard<std::mutex> lock(stats_mutex_);
+    return last_prefix_join_stats_;
+}
+
+FingerprintStoreStats FingerprintIndex::get_storage_stats() const {
+    FingerprintStoreStats stats;
+    {
+        std::shared_lock<std::shared_mutex> index_lock(index_mutex_);
+        stats = store_.getStats();
+    }
+
+    std::lock_guard<std::mutex> lock(tier_thread_mutex_);
+    stats.tier_errors = tier_errors_;
+    stats.last_tier_error = last_tier_error_;
+    return stats;
 }
 
 size_t FingerprintIndex::get_index_size() const {
@@ -150,6 +886,36 @@ double FingerprintIndex::get_load_factor() const {
     return hash_index_.load_factor();
 }
 
+void FingerprintIndex::set_exact_duplicate_collapse(bool enabled) {
+    std::unique_lock<std::shared_mutex> index_lock(index_mutex_);
+    exact_collapse_ = enabled;
+}
+
+void FingerprintIndex::set_duration_ratio_window(double min_ratio) {
+    std::unique_lock<std::shared_mutex> index_lock(index_mutex_);
+
+    duration_min_ratio_ = std::min(1.0, std::max(0.0, min_ratio));
+    duration_queries_ = 0;
+    duration_votes_pruned_ = 0;
+    duration_comparisons_pruned_ = 0;
+}
+
+DurationFilterStats FingerprintIndex::get_duration_filter_stats() const {
+    DurationFilterStats stats;
+    stats.min_ratio = duration_min_ratio_;
+    stats.queries = duration_queries_.load(std::memory_order_relaxed);
+    stats.votes_pruned = duration_votes_pruned_.load(std::memory_order_relaxed);
+    stats.comparisons_pruned = duration_comparisons_pruned_.load(std::memory_order_relaxed);
+    return stats;
+}
+
+FingerprintIndex::FrameWindow FingerprintIndex::duration_window(size_t query_frames) const {
+    const double frames = static_cast<double>(query_frames);
+    const double max_frames = std::min(frames / duration_min_ratio_, static_cast<double>(UINT32_MAX));
+    return FrameWindow{static_cast<uint32_t>(std::ceil(frames * duration_min_ratio_)),
+                       static_cast<uint32_t>(std::floor(max_frames))};
+}
+
 void FingerprintIndex::set_hash_threshold(size_t threshold) {
     hash_threshold_ = threshold;
 }
@@ -179,11 +945,127 @@ void FingerprintIndex::set_bit_error_threshold(double threshold) {
 }
 
 void FingerprintIndex::clear() {
+    std::unique_lock<std::shared_mutex> tier_lock(tier_mutex_);
+    std::unique_lock<std::mutex> files_lock(files_mutex_);
+    std::unique_lock<std::shared_mutex> index_lock(index_mutex_);
+
     hash_index_.clear();
-    files_.clear();
+    store_.clear();
+    online_groups_.clear();
+    group_similarity_sum_.clear();
+    group_match_count_.clear();
 }
 
-void FingerprintIndex::build_hash_index(size_t file_id, const Fingerprint& fingerprint) {
+void FingerprintIndex::configure_tiering(const TierConfig& config, std::chrono::milliseconds interval) {
+    stop_tiering();
+
+    {
+        std::lock_guard<std::mutex> lock(tier_thread_mutex_);
+        tier_config_ = config;
+        tier_interval_ = interval;
+        tier_stop_ = false;
+    }
+
+    tier_thread_ = std::thread([this]() {
+        std::unique_lock<std::mutex> lock(tier_thread_mutex_);
+        while (!tier_cv_.wait_for(lock, tier_interval_, [this]() { return tier_stop_; })) {
+            lock.unlock();
+            // A failed epoch (e.g. the cold file cannot be written) leaves the
+            // store as it was; count it and try again next interval
+            std::string error;
+            try {
+                rebalance_tiers();
+            } catch (const std::exception& e) {
+                error = e.what();
+            } catch (...) {
+                error = "unknown error";
+            }
+            lock.lock();
+            if (!error.empty()) {
+                tier_errors_++;
+                last_tier_error_ = std::move(error);
+            }
+        }
+    });
+}
+
+void FingerprintIndex::stop_tiering() {
+    {
+        std::lock_guard<std::mutex> lock(tier_thread_mutex_);
+        tier_stop_ = true;
+    }
+    tier_cv_.notify_all();
+
+    if (tier_thread_.joinable()) {
+        tier_thread_.join();
+    }
+}
+
+void FingerprintIndex::rebalance_tiers() {
+    TierConfig config;
+    {
+        std::lock_guard<std::mutex> lock(tier_thread_mutex_);
+        config = tier_config_;
+    }
+
+    std::lock_guard<std::mutex> plan_lock(tier_plan_mutex_);
+
+    // Decode new hot entries while lookups continue, then install the changes
+    // while they are briefly held off
+    TierPlan plan;
+    {
+        std::shared_lock<std::shared_mutex> index_lock(index_mutex_);
+        plan = store_.plan_tiers(config);
+    }
+
+    std::unique_lock<std::shared_mutex> tier_lock(tier_mutex_);
+    std::unique_lock<std::mutex> files_lock(files_mutex_);
+    std::unique_lock<std::shared_mutex> index_lock(index_mutex_);
+    store_.apply_tiers(std::move(plan), config);
+}
+
+size_t FingerprintIndex::register_file(const std::string& file_path, const CompressedFingerprint& compressed_fingerprint,
+                                       const Fingerprint& fingerprint) {
+    const uint64_t content_hash = ContentHash::hash(fingerprint.data.data(), fingerprint.data.size() * sizeof(uint32_t));
+
+    // Every stored blob references the store's dictionary (if any); others are recompressed
+    size_t file_id = 0;
+    if (compressed_fingerprint.getDictionary() != store_.dictionary().get()) {
+        auto recompressed = CompressedFingerprint::compress(
+            fingerprint, compressed_fingerprint.getCodec(), store_.dictionary());
+        file_id = store_.append(file_path, *recompressed, content_hash);
+    } else {
+        file_id = store_.append(file_path, compressed_fingerprint, content_hash);
+    }
+
+    build_hash_index(file_id, fingerprint);
+
+    // Every file gets a singleton online group so ids stay aligned with store_
+    online_groups_.add();
+    group_similarity_sum_.push_back(0.0);
+    group_match_count_.push_back(0);
+
+    return file_id;
+}
+
+void FingerprintIndex::record_online_match(size_t file_id, size_t other_id, double similarity) {
+    size_t root_a = online_groups_.find(file_id);
+    size_t root_b = online_groups_.find(other_id);
+
+    double similarity_sum = group_similarity_sum_[root_a] + similarity;
+    size_t match_count = group_match_count_[root_a] + 1;
+    if (root_a != root_b) {
+        similarity_sum += group_similarity_sum_[root_b];
+        match_count += group_match_count_[root_b];
+    }
+
+    // The matched file's root wins size ties, so joining an existing group keeps its id
+    size_t root = online_groups_.unite(root_b, root_a);
+    group_similarity_sum_[root] = similarity_sum;
+    group_match_count_[root] = match_count;
+}
+
+void FingerprintIndex::build_hash_index(size_t file_id, FingerprintView fingerprint) {
     auto hashes = extract_hashes(fingerprint);
 
     for (size_t pos = 0; pos < hashes.size(); ++pos) {
@@ -192,27 +1074,27 @@ void FingerprintIndex::build_hash_index(size_t file_id, const Fingerprint& finge
     }
 }
 
-std::vector<uint16_t> FingerprintIndex::extract_hashes(const Fingerprint& fingerprint) const {
+std::vector<uint16_t> FingerprintIndex::extract_hashes(FingerprintView fingerprint) const {
     std::vector<uint16_t> hashes;
-    hashes.reserve(fingerprint.data.size());
+    hashes.reserve(fingerprint.size);
 
-    for (uint32_t value : fingerprint.data) {
+    for (size_t i = 0; i < fingerprint.size; ++i) {
         // Extract 16-bit hash from the lower bits of the 32-bit fingerprint value
-        hashes.push_back(static_cast<uint16_t>(value & 0xFFFF));
+        hashes.push_back(static_cast<uint16_t>(fingerprint.data[i] & 0xFFFF));
     }
 
     return hashes;
 }
 
 std::vector<size_t> FingerprintIndex::filter_candidates(const std::vector<size_t>& candidates,
-                                                       const Fingerprint& query_fingerprint) const {
+                                                       FingerprintView query_fingerprint) const {
     std::vector<size_t> filtered;
 
     for (size_t candidate_id : candidates) {
-        if (candidate_id < files_.size() && files_[candidate_id]) {
+        if (candidate_id < store_.size()) {
             // Use quick filter from comparator (decompress temporarily)
-            auto temp_candidate_fp = files_[candidate_id]->compressed_fingerprint->decompress();
-            if (comparator_->quick_filter(query_fingerprint, *temp_candidate_fp)) {
+            auto candidate_fp = store_.frames(candidate_id, candidate_scratch());
+            if (comparator_->quick_filter(query_fingerprint, candidate_fp)) {
                 filtered.push_back(candidate_id);
             }
         }
@@ -224,22 +1106,25 @@ std::vector<size_t> FingerprintIndex::filter_candidates(const std::vector<size_t
 void FingerprintIndex::find_duplicates_for_file(size_t file_id,
                                                std::vector<std::unordered_set<size_t>>& groups,
                                                std::vector<bool>& processed) const {
-    if (processed[file_id] || !files_[file_id]) {
+    if (processed[file_id] || file_id >= store_.size()) {
         return;
     }
 
-    auto temp_fingerprint = files_[file_id]->compressed_fingerprint->decompress();
-    const auto& query_fingerprint = *temp_fingerprint;
-    auto candidates = find_candidates(query_fingerprint);
+    auto query_fingerprint = store_.frames(file_id, query_scratch());
+    std::vector<size_t> candidates;
+    {
+        std::shared_lock<std::shared_mutex> index_lock(index_mutex_);
+        candidates = find_candidates_unlocked(query_fingerprint);
+    }
 
     std::unordered_set<size_t> duplicate_group;
     duplicate_group.insert(file_id);
 
     // Compare with each candidate
     for (size_t candidate_id : candidates) {
-        if (candidate_id != file_id && !processed[candidate_id] && files_[candidate_id]) {
-            auto candidate_fingerprint = files_[candidate_id]->compressed_fingerprint->decompress();
-            auto match_result = comparator_->compare(query_fingerprint, *candidate_fingerprint);
+        if (candidate_id != file_id && !processed[candidate_id] && candidate_id < store_.size()) {
+            auto candidate_fingerprint = store_.frames(candidate_id, candidate_scratch());
+            auto match_result = comparator_->compare(query_fingerprint, candidate_fingerprint);
 
             if (match_result.is_duplicate) {
                 duplicate_group.insert(candidate_id);
@@ -260,7 +1145,88 @@ void FingerprintIndex::find_duplicates_for_file(size_t file_id,
     }
 }
 
-std::vector<DuplicateGroup> FingerprintIndex::merge_duplicate_groups(const std::vector<std::unordered_set<size_t>>& raw_groups) const {
+FingerprintIndex::ExactDuplicateSets FingerprintIndex::collect_exact_duplicates() {
+    ExactDuplicateSets exact;
+    exact.representative.resize(store_.size());
+
+    // Content hash -> representatives with that hash (several only on a hash collision)
+    std::unordered_map<uint64_t, std::vector<size_t>> by_hash;
+    by_hash.reserve(store_.size());
+
+    size_t files_collapsed = 0;
+    for (size_t file_id = 0; file_id < store_.size(); ++file_id) {
+        exact.representative[file_id] = file_id;
+        if (!exact_collapse_) {
+            continue;
+        }
+
+        auto& representatives = by_hash[store_.content_hash(file_id)];
+        for (size_t representative : representatives) {
+            if (same_frames(representative, file_id)) {
+                exact.representative[file_id] = representative;
+                exact.copies[representative].push_back(file_id);
+                files_collapsed++;
+                break;
+            }
+        }
+
+        if (exact.representative[file_id] == file_id) {
+            representatives.push_back(file_id);
+        }
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(stats_mutex_);
+        last_exact_stats_ = {store_.size(), exact.copies.size(), files_collapsed};
+    }
+    return exact;
+}
+
+bool FingerprintIndex::same_frames(size_t file_a, size_t file_b) const {
+    if (store_.frame_count(file_a) != store_.frame_count(file_b)) {
+        return false;
+    }
+
+    auto fp_a = store_.frames(file_a, query_scratch());
+    auto fp_b = store_.frames(file_b, candidate_scratch());
+    return fp_a.size == 0 || std::memcmp(fp_a.data, fp_b.data, fp_a.size * sizeof(uint32_t)) == 0;
+}
+
+std::vector<std::unordered_set<size_t>> FingerprintIndex::expand_exact_duplicates(
+    const std::vector<std::unordered_set<size_t>>& raw_groups, const ExactDuplicateSets& exact) const {
+    if (exact.copies.empty()) {
+        return raw_groups;
+    }
+
+    std::vector<std::unordered_set<size_t>> groups;
+    groups.reserve(raw_groups.size() + exact.copies.size());
+    std::unordered_set<size_t> grouped;
+
+    for (const auto& raw_group : raw_groups) {
+        std::unordered_set<size_t> group = raw_group;
+        for (size_t file_id : raw_group) {
+            grouped.insert(file_id);
+            auto it = exact.copies.find(file_id);
+            if (it != exact.copies.end()) {
+                group.insert(it->second.begin(), it->second.end());
+            }
+        }
+        groups.push_back(std::move(group));
+    }
+
+    for (const auto& entry : exact.copies) {
+        if (grouped.count(entry.first) == 0) {
+            std::unordered_set<size_t> group(entry.second.begin(), entry.second.end());
+            group.insert(entry.first);
+            groups.push_back(std::move(group));
+        }
+    }
+
+    return groups;
+}
+
+std::vector<DuplicateGroup> FingerprintIndex::merge_duplicate_groups(const std::vector<std::unordered_set<size_t>>& raw_groups,
+                                                                     const ExactDuplicateSets& exact) const {
     std::vector<DuplicateGroup> final_groups;
 
     for (const auto& group_set : raw_groups) {
@@ -271,23 +1237,43 @@ std::vector<DuplicateGroup> FingerprintIndex::merge_duplicate_groups(const std::
             // Sort file IDs for consistent output
             std::sort(group.file_ids.begin(), group.file_ids.end());
 
-            // Calculate average similarity within the group
+            // Calculate average similarity within the group. Identical copies score
+            // like their representative, so each pair of representatives is compared
+            // once and weighted by the number of file pairs it stands for
+            std::vector<size_t> representatives;
+            for (size_t file_id : group.file_ids) {
+                if (file_id < store_.size()) {
+                    representatives.push_back(exact.representative[file_id]);
+                }
+            }
+            std::sort(representatives.begin(), representatives.end());
+
+            std::vector<std::pair<size_t, size_t>> weighted; // (representative, members in group)
+            for (size_t id : representatives) {
+                if (weighted.empty() || weighted.back().first != id) {
+                    weighted.emplace_back(id, 0);
+                }
+                weighted.back().second++;
+            }
+
             double total_similarity = 0.0;
             size_t comparison_count = 0;
 
-            for (size_t i = 0; i < group.file_ids.size(); ++i) {
-                for (size_t j = i + 1; j < group.file_ids.size(); ++j) {
-                    size_t id1 = group.file_ids[i];
-                    size_t id2 = group.file_ids[j];
-
-                    if (id1 < files_.size() && id2 < files_.size() &&
-                        files_[id1] && files_[id2]) {
-                        auto fp1 = files_[id1]->compressed_fingerprint->decompress();
-                        auto fp2 = files_[id2]->compressed_fingerprint->decompress();
-                        auto result = comparator_->compare(*fp1, *fp2);
-                        total_similarity += result.similarity_score;
-                        comparison_count++;
-                    }
+            for (size_t i = 0; i < weighted.size(); ++i) {
+                auto fp1 = store_.frames(weighted[i].first, query_scratch());
+
+                const size_t inner_pairs = weighted[i].second * (weighted[i].second - 1) / 2;
+                if (inner_pairs > 0) {
+                    total_similarity += comparator_->compare(fp1, fp1).similarity_score * inner_pairs;
+                    comparison_count += inner_pairs;
+                }
+
+                for (size_t j = i + 1; j < weighted.size(); ++j) {
+                    auto fp2 = store_.frames(weighted[j].first, candidate_scratch());
+                    auto result = comparator_->compare(fp1, fp2);
+                    const size_t pair_count = weighted[i].second * weighted[j].second;
+                    total_similarity += result.similarity_score * pair_count;
+                    comparison_count += pair_count;
                 }
             }
 
@@ -310,73 +1296,110 @@ std::vector<DuplicateGroup> FingerprintIndex::find_all_duplicates_parallel(size_
         omp_set_num_threads(static_cast<int>(num_threads));
     }
 
-    if (files_.empty()) {
+    std::shared_lock<std::shared_mutex> tier_lock(tier_mutex_);
+
+    if (store_.empty()) {
         return {};
     }
 
     std::vector<std::unordered_set<size_t>> raw_groups;
-    std::vector<bool> processed(files_.size(), false);
+    std::vector<bool> processed(store_.size(), false);
     std::mutex groups_mutex;
     std::mutex processed_mutex;
 
-    // Process files in parallel using OpenMP
+    // Identical copies take part only through their representative
+    auto exact = collect_exact_duplicates();
+    for (size_t file_id = 0; file_id < store_.size(); ++file_id) {
+        processed[file_id] = exact.representative[file_id] != file_id;
+    }
+
+    // Process blocks of files in parallel using OpenMP; candidates for a block
+    // come from one batched posting-major pass over the index
+    const size_t num_blocks = (store_.size() + QUERY_BLOCK_SIZE - 1) / QUERY_BLOCK_SIZE;
+
     #pragma omp parallel
     {
         std::vector<std::unordered_set<size_t>> thread_groups;
 
         #pragma omp for schedule(dynamic)
-        for (size_t file_id = 0; file_id < files_.size(); ++file_id) {
-            bool skip = false;
+        for (size_t block = 0; block < num_blocks; ++block) {
+            const size_t block_begin = block * QUERY_BLOCK_SIZE;
+            const size_t block_end = std::min(store_.size(), block_begin + QUERY_BLOCK_SIZE);
 
-            // Check if already processed
+            // Collect the files of this block that still need processing
+            std::vector<size_t> block_ids;
             {
                 std::lock_guard<std::mutex> lock(processed_mutex);
-                if (processed[file_id] || !files_[file_id]) {
-                    skip = true;
+                for (size_t file_id = block_begin; file_id < block_end; ++file_id) {
+                    if (!processed[file_id]) {
+                        block_ids.push_back(file_id);
+                    }
                 }
             }
 
-            if (skip) continue;
+            if (block_ids.empty()) continue;
+
+            std::vector<std::unique_ptr<Fingerprint>> block_fingerprints;
+            std::vector<const Fingerprint*> block_queries;
+            block_fingerprints.reserve(block_ids.size());
+            block_queries.reserve(block_ids.size());
+            for (size_t file_id : block_ids) {
+                store_.record_access(file_id);
+                block_fingerprints.push_back(store_.fingerprint(file_id).decompress());
+                block_queries.push_back(block_fingerprints.back().get());
+            }
 
-            auto temp_fingerprint = files_[file_id]->compressed_fingerprint->decompress();
-            const auto& query_fingerprint = *temp_fingerprint;
-            auto candidates = find_candidates(query_fingerprint);
+            auto block_candidates = find_candidates_batch(block_queries);
 
-            std::unordered_set<size_t> duplicate_group;
-            duplicate_group.insert(file_id);
+            for (size_t q = 0; q < block_ids.size(); ++q) {
+                const size_t file_id = block_ids[q];
 
-            // Compare with each candidate
-            for (size_t candidate_id : candidates) {
-                if (candidate_id != file_id && candidate_id < files_.size() && files_[candidate_id]) {
-                    bool candidate_processed = false;
-                    {
-                        std::lock_guard<std::mutex> lock(processed_mutex);
-                        candidate_processed = processed[candidate_id];
+                // Check if processed by another query since the block was collected
+                {
+                    std::lock_guard<std::mutex> lock(processed_mutex);
+                    if (processed[file_id]) {
+                        continue;
                     }
+                }
+
+                const auto& query_fingerprint = *block_fingerprints[q];
+
+                std::unordered_set<size_t> duplicate_group;
+                duplicate_group.insert(file_id);
 
-                    if (!candidate_processed) {
-                        auto candidate_fingerprint = files_[candidate_id]->compressed_fingerprint->decompress();
-                        auto match_result = comparator_->compare(query_fingerprint, *candidate_fingerprint);
+                // Compare with each candidate
+                for (size_t candidate_id : block_candidates[q]) {
+                    if (candidate_id != file_id && candidate_id < store_.size()) {
+                        bool candidate_processed = false;
+                        {
+                            std::lock_guard<std::mutex> lock(processed_mutex);
+                            candidate_processed = processed[candidate_id];
+                        }
+
+                        if (!candidate_processed) {
+                            auto candidate_fingerprint = store_.frames(candidate_id, candidate_scratch());
+                            auto match_result = comparator_->compare(query_fingerprint, candidate_fingerprint);
 
-                        if (match_result.is_duplicate) {
-                            duplicate_group.insert(candidate_id);
+                            if (match_result.is_duplicate) {
+                                duplicate_group.insert(candidate_id);
+                            }
                         }
                     }
                 }
-            }
 
-            // Only create group if we found duplicates
-            if (duplicate_group.size() > 1) {
-                thread_groups.push_back(duplicate_group);
+                // Only create group if we found duplicates
+                if (duplicate_group.size() > 1) {
+                    thread_groups.push_back(duplicate_group);
 
-                // Mark all files in this group as processed
-                std::lock_guard<std::mutex> lock(processed_mutex);
-                for (size_t id : duplicate_group) {
-                    processed[id] = true;
+                    // Mark all files in this group as processed
+                    std::lock_guard<std::mutex> lock(processed_mutex);
+                    for (size_t id : duplicate_group) {
+                        processed[id] = true;
+                    }
+                } else {
+                    std::lock_guard<std::mutex> lock(processed_mutex);
+                    processed[file_id] = true;
                 }
-            } else {
-                std::lock_guard<std::mutex> lock(processed_mutex);
-                processed[file_id] = true;
             }
         }
 
@@ -388,7 +1411,7 @@ std::vector<DuplicateGroup> FingerprintIndex::find_all_duplicates_parallel(size_
     }
 
     // Merge overlapping groups and convert to final format
-    return merge_duplicate_groups(raw_groups);
+    return merge_duplicate_groups(expand_exact_duplicates(raw_groups, exact), exact);
 }
 
 }
\ No newline at end of file
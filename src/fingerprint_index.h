@@ -7,10 +7,19 @@
 #include <memory>
 #include <mutex>
 #include <shared_mutex>
+#include <optional>
+#include <atomic>
+#include <thread>
+#include <condition_variable>
+#include <chrono>
 #include <omp.h>
 #include "chromaprint_wrapper.h"
 #include "fingerprint_comparator.h"
 #include "compressed_fingerprint.h"
+#include "fingerprint_store.h"
+#include "disjoint_set.h"
+#include "self_join.h"
+#include "similarity_join.h"
 
 namespace AudioDuplicates {
 
@@ -21,12 +30,16 @@ struct IndexEntry {
     IndexEntry(size_t fid, size_t pos) : file_id(fid), position(pos) {}
 };
 
+// View of one indexed file in the index's FingerprintStore; valid until the index is modified
 struct FileEntry {
-    std::string file_path;
-    std::unique_ptr<CompressedFingerprint> compressed_fingerprint;
+    const FingerprintStore* store;
+    size_t file_id;
+
+    FileEntry(const FingerprintStore* s, size_t fid) : store(s), file_id(fid) {}
 
-    FileEntry(const std::string& path, std::unique_ptr<CompressedFingerprint> cfp)
-        : file_path(path), compressed_fingerprint(std::move(cfp)) {}
+    std::string file_path() const { return store->path(file_id); }
+    CompressedFingerprint compressed_fingerprint() const { return store->fingerprint(file_id); }
+    double duration() const { return store->duration(file_id); }
 };
 
 struct DuplicateGroup {
@@ -36,6 +49,64 @@ struct DuplicateGroup {
     DuplicateGroup() : avg_similarity(0.0) {}
 };
 
+struct TopKMatch {
+    size_t file_id;
+    double similarity;
+    double bit_error_rate;
+    int offset;
+
+    TopKMatch(size_t fid, double sim, double ber, int off)
+        : file_id(fid), similarity(sim), bit_error_rate(ber), offset(off) {}
+};
+
+struct BulkVerifyStats {
+    size_t pairs_verified;
+    size_t blocks_decoded; // Fingerprint blocks decoded while verifying candidate pairs
+    size_t blocks_total;   // Blocks full decodes of the same pairs would have touched
+};
+
+// Bit-identical fingerprints collapsed before pairwise verification
+struct ExactDuplicateStats {
+    size_t files;
+    size_t exact_sets;      // Sets of two or more files with identical frames
+    size_t files_collapsed; // Set members verified through their representative instead of directly
+};
+
+// Work skipped by the duration-ratio window since it was last configured
+struct DurationFilterStats {
+    double min_ratio;           // 0 when the window is disabled
+    size_t queries;             // Candidate lookups the window was applied to
+    size_t votes_pruned;        // Posting entries (per query hash) skipped during vote accumulation
+    size_t comparisons_pruned;  // Files that would have passed the vote threshold and been compared
+};
+
+// Compression totals for files in one duration range
+struct CompressionBucket {
+    std::string label;
+    size_t files;
+    size_t original_bytes;
+    size_t bytes_before; // Compressed size before the dictionary was applied
+    size_t bytes_after;  // Compressed size with the dictionary
+
+    CompressionBucket(const std::string& l) : label(l), files(0), original_bytes(0), bytes_before(0), bytes_after(0) {}
+};
+
+struct DictionaryReport {
+    size_t dictionary_size;
+    size_t samples;
+    std::vector<CompressionBucket> buckets;
+
+    DictionaryReport() : dictionary_size(0), samples(0) {}
+};
+
+struct InsertMatchResult {
+    size_t file_id;
+    size_t group_id; // Root of the online group the file belongs to after insertion
+    std::vector<std::pair<size_t, MatchResult>> matches; // Verified duplicates among previously indexed files
+
+    InsertMatchResult() : file_id(0), group_id(0) {}
+};
+
 class FingerprintIndex {
 public:
     FingerprintIndex();
@@ -44,29 +115,98 @@ public:
     // Add a file and its fingerprint to the index
     size_t add_file(const std::string& file_path, std::unique_ptr<CompressedFingerprint> compressed_fingerprint);
 
+    // Add a file known to be byte-identical to an indexed one (e.g. found by
+    // IdenticalFileFinder) without decoding it; it shares the source's fingerprint
+    // and joins its online duplicate group
+    size_t add_identical_file(const std::string& file_path, size_t source_file_id);
+
     // Add multiple files in parallel (thread-safe)
     std::vector<size_t> add_files_batch(std::vector<std::pair<std::string, std::unique_ptr<CompressedFingerprint>>>& files);
 
+    // Add a file, verify its candidates against existing files and update the
+    // online duplicate groups in one step (cost is O(candidates), not O(N))
+    InsertMatchResult add_and_match(const std::string& file_path, std::unique_ptr<CompressedFingerprint> compressed_fingerprint);
+
     // Find potential duplicates for a given file ID
     std::vector<size_t> find_candidates(size_t file_id) const;
 
     // Find potential duplicates for a given fingerprint
     std::vector<size_t> find_candidates(const Fingerprint& fingerprint) const;
 
+    // Find potential duplicates for a block of fingerprints at once; each posting
+    // list is walked once per block instead of once per query
+    std::vector<std::vector<size_t>> find_candidates_batch(const std::vector<const Fingerprint*>& queries) const;
+
+    // Find the k best verified matches for a fingerprint, best first. With
+    // vote_cutoff 0 every candidate over the hash threshold is verified and the
+    // result is exact. A positive vote_cutoff trades that for latency: once k
+    // results are held, verification stops at the first candidate whose votes
+    // fall below that fraction of the weakest result's votes. Votes do not bound
+    // similarity, so a better match further down the vote order can be missed
+    std::vector<TopKMatch> query_top_k(const Fingerprint& fingerprint, size_t k, double min_similarity = 0.0,
+                                       double vote_cutoff = 0.0) const;
+
     // Get all duplicate groups
     std::vector<DuplicateGroup> find_all_duplicates();
 
     // Find all duplicate groups in parallel
     std::vector<DuplicateGroup> find_all_duplicates_parallel(size_t num_threads = 0);
 
+    // Find all duplicate groups for batch jobs with the sort-merge self-join
+    // instead of per-file index queries (min_votes and max_offset follow the
+    // index's hash threshold and comparator configuration)
+    std::vector<DuplicateGroup> find_all_duplicates_bulk(const SelfJoinConfig& config = SelfJoinConfig{});
+    SelfJoinEngine::Stats get_last_bulk_stats() const;
+    BulkVerifyStats get_last_bulk_verify_stats() const;
+
+    // The self-join's candidate pairs for find_all_duplicates_bulk, before verification
+    std::vector<CandidatePair> find_bulk_candidate_pairs(const SelfJoinConfig& config = SelfJoinConfig{});
+
+    // Exact-duplicate collapsing done by the last find_all_duplicates* run
+    ExactDuplicateStats get_last_exact_duplicate_stats() const;
+
+    // All file pairs quick_filter accepts, found with the prefix-filtering join
+    // without enumerating pairs that cannot reach the quick filter threshold
+    std::vector<SimilarPair> find_quick_filter_pairs();
+    PrefixFilterJoin::Stats get_last_prefix_join_stats() const;
+
+    // Same pairs via per-file find_candidates + quick_filter (limited to indexed candidates)
+    std::vector<SimilarPair> find_quick_filter_pairs_indexed();
+
+    // Same pairs by running quick_filter on every file pair; the exhaustive reference
+    std::vector<SimilarPair> find_quick_filter_pairs_all();
+
+    // Train a shared compression dictionary from up to max_samples indexed files,
+    // recompress every file with it and keep it for files added afterwards
+    DictionaryReport train_dictionary(size_t max_samples = 1000);
+    size_t get_dictionary_size() const;
+
+    // Get the duplicate groups maintained incrementally by add_and_match
+    std::vector<DuplicateGroup> get_online_groups() const;
+
     // Get file information
-    const FileEntry* get_file(size_t file_id) const;
+    std::optional<FileEntry> get_file(size_t file_id) const;
     size_t get_file_count() const;
 
+    // Decoded frames of one indexed file, read through whichever tier holds it
+    // (reported in tier when given); counts as an access for tiering
+    std::unique_ptr<Fingerprint> get_fingerprint(size_t file_id, StorageTier* tier = nullptr) const;
+    FingerprintStoreStats get_storage_stats() const;
+
     // Index statistics
     size_t get_index_size() const;
     double get_load_factor() const;
 
+    // Whole-file duplicate mode: candidates whose frame count differs from the
+    // query's by more than this ratio (shorter / longer) receive no votes.
+    // 0 disables the window (default), which keeps partial and padded matches
+    void set_duration_ratio_window(double min_ratio);
+    DurationFilterStats get_duration_filter_stats() const;
+
+    // Collapse bit-identical fingerprints to one representative before pairwise
+    // verification (default); disabling it verifies every file directly
+    void set_exact_duplicate_collapse(bool enabled);
+
     // Configuration
     void set_hash_threshold(size_t threshold);
     void set_comparator(std::unique_ptr<FingerprintComparator> comparator);
@@ -76,6 +216,14 @@ public:
     void set_max_alignment_offset(int max_offset);
     void set_bit_error_threshold(double threshold);
 
+    // Move fingerprints between the hot, warm and cold tiers every interval on a
+    // background thread; calling again replaces the running configuration
+    void configure_tiering(const TierConfig& config, std::chrono::milliseconds interval = DEFAULT_TIER_INTERVAL);
+    void stop_tiering();
+
+    // Run one tiering epoch now
+    void rebalance_tiers();
+
     // Clear the index
     void clear();
 
@@ -83,12 +231,18 @@ private:
     // Inverted index: hash -> list of (file_id, position)
     std::unordered_map<uint16_t, std::vector<IndexEntry>> hash_index_;
 
-    // File storage
-    std::vector<std::unique_ptr<FileEntry>> files_;
+    // File storage: compressed fingerprints, metadata and paths by file id; also
+    // holds the shared compression dictionary the blobs reference
+    FingerprintStore store_;
 
     // Fingerprint comparator
     std::unique_ptr<FingerprintComparator> comparator_;
 
+    // Online duplicate groups (one slot per file id) and per-root similarity totals
+    DisjointSet online_groups_;
+    std::vector<double> group_similarity_sum_;
+    std::vector<size_t> group_match_count_;
+
     // Thread synchronization
     mutable std::shared_mutex index_mutex_;
     mutable std::mutex files_mutex_;
@@ -96,23 +250,102 @@ private:
     // Configuration
     size_t hash_threshold_;
 
+    // Whether find_all_duplicates* collapse bit-identical fingerprints first
+    bool exact_collapse_;
+
+    // Duration-ratio window over the store's frame-count column, and what it pruned
+    double duration_min_ratio_;
+    mutable std::atomic<size_t> duration_queries_;
+    mutable std::atomic<size_t> duration_votes_pruned_;
+    mutable std::atomic<size_t> duration_comparisons_pruned_;
+
+    // Scans write the statistics below under a shared lock (or none), so they
+    // have their own mutex
+    mutable std::mutex stats_mutex_;
+
+    // Statistics from the last find_all_duplicates_bulk run
+    SelfJoinEngine::Stats last_bulk_stats_;
+    BulkVerifyStats last_bulk_verify_stats_;
+
+    // Statistics from the last exact-duplicate pass
+    ExactDuplicateStats last_exact_stats_;
+
+    // Statistics from the last find_quick_filter_pairs run
+    PrefixFilterJoin::Stats last_prefix_join_stats_;
+
+    // Background tiering. Scans that read store_ without index_mutex_ hold
+    // tier_mutex_ shared; applying tier changes takes it exclusively
+    mutable std::shared_mutex tier_mutex_;
+    std::mutex tier_plan_mutex_;
+    mutable std::mutex tier_thread_mutex_;
+    std::condition_variable tier_cv_;
+    std::thread tier_thread_;
+    TierConfig tier_config_;
+    bool tier_stop_;
+    std::chrono::milliseconds tier_interval_;
+    // Epochs the background thread could not apply, guarded by tier_thread_mutex_
+    size_t tier_errors_;
+    std::string last_tier_error_;
+
     static constexpr size_t DEFAULT_HASH_THRESHOLD = 5; // Minimum hash matches to consider as candidate
+    static constexpr size_t QUERY_BLOCK_SIZE = 64; // Queries per batched candidate pass in parallel detection
+    static constexpr std::chrono::milliseconds DEFAULT_TIER_INTERVAL{5000};
 
     // Index building helpers
-    void build_hash_index(size_t file_id, const Fingerprint& fingerprint);
-    std::vector<uint16_t> extract_hashes(const Fingerprint& fingerprint) const;
+    void build_hash_index(size_t file_id, FingerprintView fingerprint);
+    std::vector<uint16_t> extract_hashes(FingerprintView fingerprint) const;
+    size_t register_file(const std::string& file_path, const CompressedFingerprint& compressed_fingerprint,
+                         const Fingerprint& fingerprint);
+
+    // Merge file_id into other_id's online group, counting one verified match
+    void record_online_match(size_t file_id, size_t other_id, double similarity);
+
+    // Candidate lookup without taking index_mutex_ (caller holds it)
+    std::vector<size_t> find_candidates_unlocked(FingerprintView fingerprint) const;
+
+    std::vector<std::vector<size_t>> find_candidates_batch_unlocked(const std::vector<const Fingerprint*>& queries) const;
+
+    // (file_id, vote count) pairs above hash_threshold_, highest votes first
+    std::vector<std::pair<size_t, size_t>> collect_candidate_votes(FingerprintView fingerprint) const;
+
+    // Frame counts a candidate may have for a query of query_frames frames
+    struct FrameWindow {
+        uint32_t min_frames;
+        uint32_t max_frames;
+
+        bool contains(uint32_t frames) const { return frames >= min_frames && frames <= max_frames; }
+    };
+    FrameWindow duration_window(size_t query_frames) const;
 
     // Candidate filtering
     std::vector<size_t> filter_candidates(const std::vector<size_t>& candidates,
-                                         const Fingerprint& query_fingerprint) const;
+                                         FingerprintView query_fingerprint) const;
 
     // Duplicate detection helpers
     void find_duplicates_for_file(size_t file_id,
                                  std::vector<std::unordered_set<size_t>>& groups,
                                  std::vector<bool>& processed) const;
 
+    // Files with bit-identical frames; each set is represented by its lowest file id
+    struct ExactDuplicateSets {
+        std::vector<size_t> representative; // By file id
+        std::unordered_map<size_t, std::vector<size_t>> copies; // Representative -> the other files of its set
+    };
+
+    // Group files by content hash (confirmed frame by frame) before any pairwise work
+    ExactDuplicateSets collect_exact_duplicates();
+
+    // Self-join over the representatives of exact; the caller holds index_mutex_
+    std::vector<CandidatePair> run_self_join(const SelfJoinConfig& config, const ExactDuplicateSets& exact);
+    bool same_frames(size_t file_a, size_t file_b) const;
+
+    // Add every representative's copies to its groups; sets that matched nothing else become groups of their own
+    std::vector<std::unordered_set<size_t>> expand_exact_duplicates(const std::vector<std::unordered_set<size_t>>& raw_groups,
+                                                                    const ExactDuplicateSets& exact) const;
+
     // Merge overlapping duplicate groups
-    std::vector<DuplicateGroup> merge_duplicate_groups(const std::vector<std::unordered_set<size_t>>& raw_groups) const;
+    std::vector<DuplicateGroup> merge_duplicate_groups(const std::vector<std::unordered_set<size_t>>& raw_groups,
+                                                       const ExactDuplicateSets& exact) const;
 };
 
 }
\ No newline at end of file
@@ -0,0 +1,518 @@
+#include "fingerprint_pipeline.h"
+#include "bounded_queue.h"
+#include "pcm_decoder.h"
+#include "wav_file.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cerrno>
+#include <cstdio>
+#include <condition_variable>
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+#include <thread>
+#include <sndfile.h>
+#include <chromaprint.h>
+
+namespace AudioDuplicates {
+
+namespace {
+
+// One file on its way through the stages; each stage releases what the next no longer needs
+struct PipelineItem {
+    size_t index;
+    std::string path;
+
+    // I/O: a validated WAV mapping, or the raw file bytes for libsndfile
+    std::unique_ptr<WavFile> wav;
+    std::vector<uint8_t> bytes;
+
+    // Decode: interleaved frames (views into wav, or owned buffers)
+    int source_rate = 0;
+    int channels = 0;
+    size_t frames = 0;
+    const int16_t* int16_frames = nullptr;
+    const float* float_frames = nullptr;
+    std::vector<int16_t> owned_int16;
+    std::vector<float> owned_float;
+
+    // DSP: mono int16 at the fingerprint rate
+    std::vector<int16_t> samples;
+
+    // Heap bytes charged to the ByteBudget (mappings are not counted)
+    size_t charged = 0;
+
+    size_t buffered_bytes() const {
+        return bytes.capacity() + owned_int16.capacity() * sizeof(int16_t) +
+               owned_float.capacity() * sizeof(float) + samples.capacity() * sizeof(int16_t);
+    }
+};
+
+// Bytes held by items past the I/O stage. Only the I/O stage waits on it, before
+// taking a new file, so a later stage never blocks on memory that a waiting
+// stage holds; the overshoot is at most one file per I/O thread plus what
+// admitted files grow to while decoding
+class ByteBudget {
+public:
+    explicit ByteBudget(size_t limit) : limit_(limit), held_(0), peak_(0) {}
+
+    // Wait while the held bytes are at the limit; with nothing held a file larger
+    // than the limit still goes through on its own
+    void wait_for_room() {
+        std::unique_lock<std::mutex> lock(mutex_);
+        room_cv_.wait(lock, [this] { return held_ == 0 || held_ < limit_; });
+    }
+
+    // Bring item's charge in line with the buffers it holds now
+    void settle(PipelineItem& item) {
+        const size_t bytes = item.buffered_bytes();
+        if (bytes == item.charged) {
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            held_ = held_ + bytes - item.charged;
+            peak_ = std::max(peak_, held_);
+        }
+        if (bytes < item.charged) {
+            room_cv_.notify_all();
+        }
+        item.charged = bytes;
+    }
+
+    void release(PipelineItem& item) {
+        if (item.charged == 0) {
+            return;
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex_);
+            held_ -= item.charged;
+        }
+        room_cv_.notify_all();
+        item.charged = 0;
+    }
+
+    size_t peak() const {
+        std::lock_guard<std::mutex> lock(mutex_);
+        return peak_;
+    }
+
+private:
+    const size_t limit_;
+    size_t held_;
+    size_t peak_;
+    mutable std::mutex mutex_;
+    std::condition_variable room_cv_;
+};
+
+using ItemPtr = std::unique_ptr<PipelineItem>;
+
+struct StageCounters {
+    std::atomic<uint64_t> busy_nanoseconds{0};
+    std::atomic<size_t> items{0};
+};
+
+struct DepthSamples {
+    size_t max_depth = 0;
+    size_t full = 0;
+    double sum = 0.0;
+    size_t samples = 0;
+
+    void add(size_t depth, size_t capacity) {
+        max_depth = std::max(max_depth, depth);
+        full += depth >= capacity ? 1 : 0;
+        sum += static_cast<double>(depth);
+        samples++;
+    }
+};
+
+template <typename T>
+void release(std::vector<T>& buffer) {
+    std::vector<T>().swap(buffer);
+}
+
+void read_file(PipelineItem& item) {
+    std::FILE* file = std::fopen(item.path.c_str(), "rb");
+    if (!file) {
+        throw std::runtime_error("Failed to open audio file: " + item.path);
+    }
+
+    std::fseek(file, 0, SEEK_END);
+    const long size = std::ftell(file);
+    std::fseek(file, 0, SEEK_SET);
+    if (size < 0) {
+        std::fclose(file);
+        throw std::runtime_error("Failed to read audio file: " + item.path);
+    }
+
+    item.bytes.resize(static_cast<size_t>(size));
+    const size_t read = item.bytes.empty() ? 0 : std::fread(item.bytes.data(), 1, item.bytes.size(), file);
+    std::fclose(file);
+    if (read != item.bytes.size()) {
+        throw std::runtime_error("Failed to read audio file: " + item.path);
+    }
+}
+
+void decode_bytes(PipelineItem& item, int max_duration_seconds) {
+    MemoryAudioFile memory(item.bytes.data(), item.bytes.size());
+
+    SF_INFO sf_info;
+    std::memset(&sf_info, 0, sizeof(sf_info));
+    SNDFILE* file = memory.open(&sf_info);
+    if (!file) {
+        throw std::runtime_error("Failed to open audio file: " + item.path + " - " + sf_strerror(nullptr));
+    }
+
+    sf_count_t frames = sf_info.frames;
+    if (max_duration_seconds > 0) {
+        frames = std::min(frames, static_cast<sf_count_t>(max_duration_seconds) * sf_info.samplerate);
+    }
+
+    item.source_rate = sf_info.samplerate;
+    item.channels = sf_info.channels;
+    sf_count_t read = 0;
+    if (PcmDecoder::is_integer_pcm(sf_info.format)) {
+        item.owned_int16.resize(static_cast<size_t>(frames) * sf_info.channels);
+        read = sf_readf_short(file, item.owned_int16.data(), frames);
+        item.int16_frames = item.owned_int16.data();
+    } else {
+        item.owned_float.resize(static_cast<size_t>(frames) * sf_info.channels);
+        read = sf_readf_float(file, item.owned_float.data(), frames);
+        item.float_frames = item.owned_float.data();
+    }
+    sf_close(file);
+
+    item.frames = static_cast<size_t>(std::max<sf_count_t>(0, read));
+    release(item.bytes);
+}
+
+} // namespace
+
+FingerprintPipeline::FingerprintPipeline(const PipelineConfig& config)
+    : config_(config) {
+    config_.io_threads = std::max<size_t>(1, config_.io_threads);
+    config_.queue_capacity = std::max<size_t>(1, config_.queue_capacity);
+    config_.max_buffered_bytes = std::max<size_t>(1, config_.max_buffered_bytes);
+    if (config_.algorithm < 0) {
+        config_.algorithm = CHROMAPRINT_ALGORITHM_DEFAULT;
+    }
+
+    // Fingerprinting is the heaviest stage, so it gets whatever decode and DSP leave
+    const size_t hardware = std::max<size_t>(1, std::thread::hardware_concurrency());
+    const size_t compute = hardware > config_.io_threads ? hardware - config_.io_threads : 1;
+    if (config_.decode_threads == 0) {
+        config_.decode_threads = std::max<size_t>(1, compute / 4);
+    }
+    if (config_.dsp_threads == 0) {
+        config_.dsp_threads = std::max<size_t>(1, compute / 4);
+    }
+    if (config_.fingerprint_threads == 0) {
+        const size_t used = config_.decode_threads + config_.dsp_threads;
+        config_.fingerprint_threads = compute > used ? compute - used : 1;
+    }
+}
+
+PipelineResult FingerprintPipeline::run(const std::vector<std::string>& paths, FingerprintIndex& index) {
+    const auto start = std::chrono::steady_clock::now();
+
+    PipelineResult result;
+    result.file_ids.assign(paths.size(), SIZE_MAX);
+    result.bytes_read = 0;
+    result.peak_buffered_bytes = 0;
+    result.prefetched = false;
+    result.prefetch = PrefetchStats{};
+    result.disk_ordered = config_.disk_order;
+    result.disk_order = DiskOrderStats{};
+
+    // Input positions in the order the I/O stage reads them
+    std::vector<size_t> schedule(paths.size());
+    if (config_.disk_order) {
+        DiskOrderResult planned = DiskOrderPlanner().plan(paths);
+        schedule = std::move(planned.order);
+        result.disk_order = planned.stats;
+    } else {
+        for (size_t i = 0; i < paths.size(); ++i) {
+            schedule[i] = i;
+        }
+    }
+
+    BoundedQueue<ItemPtr> to_decode(config_.queue_capacity);
+    BoundedQueue<ItemPtr> to_dsp(config_.queue_capacity);
+    BoundedQueue<ItemPtr> to_fingerprint(config_.queue_capacity);
+
+    StageCounters io_counters, decode_counters, dsp_counters, fingerprint_counters;
+    std::atomic<size_t> io_remaining(config_.io_threads);
+    std::atomic<size_t> decode_remaining(config_.decode_threads);
+    std::atomic<size_t> dsp_remaining(config_.dsp_threads);
+    std::atomic<size_t> fingerprint_remaining(config_.fingerprint_threads);
+    std::atomic<size_t> next_path(0);
+    std::atomic<size_t> bytes_read(0);
+    ByteBudget budget(config_.max_buffered_bytes);
+
+    std::mutex errors_mutex;
+    auto fail = [&](const PipelineItem& item, const char* stage, const std::string& message) {
+        std::lock_guard<std::mutex> lock(errors_mutex);
+        result.errors.push_back({item.index, stage, message});
+    };
+
+    // Pop, process and pass on until the input is drained; the stage's last thread
+    // to finish closes its output so the next stage can drain in turn
+    auto stage_loop = [&](BoundedQueue<ItemPtr>& in, BoundedQueue<ItemPtr>* out, StageCounters& counters,
+                          std::atomic<size_t>& remaining, const char* stage, auto&& process) {
+        ItemPtr item;
+        while (in.pop(item)) {
+            const auto begin = std::chrono::steady_clock::now();
+            bool ok = true;
+            try {
+                process(*item);
+            } catch (const std::exception& e) {
+                fail(*item, stage, e.what());
+                ok = false;
+            }
+            counters.busy_nanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - begin).count();
+            counters.items++;
+
+            if (ok && out) {
+                budget.settle(*item);
+                out->push(item);
+            }
+            if (item) {
+                budget.release(*item);
+                item.reset();
+            }
+        }
+        if (--remaining == 0 && out) {
+            out->close();
+        }
+    };
+
+    std::vector<std::thread> threads;
+
+    // With a prefetcher the I/O threads only collect files whose reads it already
+    // has in flight; without one each thread maps or reads its next path itself
+    std::unique_ptr<FilePrefetcher> prefetcher;
+    if (config_.prefetch_depth > 0) {
+        PrefetchConfig prefetch;
+        prefetch.depth = config_.prefetch_depth;
+        prefetch.backend = config_.prefetch_backend;
+        prefetch.threads = config_.io_threads;
+        std::vector<std::string> scheduled_paths;
+        scheduled_paths.reserve(paths.size());
+        for (size_t i : schedule) {
+            scheduled_paths.push_back(paths[i]);
+        }
+        prefetcher.reset(new FilePrefetcher(scheduled_paths, prefetch));
+    }
+
+    // The item exists before a path is claimed, so every failure after the claim
+    // has an item to report against
+    auto next_item = [&](ItemPtr& item) {
+        item.reset(new PipelineItem());
+        if (prefetcher) {
+            PrefetchedFile file;
+            if (!prefetcher->next(file)) {
+                return false;
+            }
+            item->index = schedule[file.index];
+            item->path = paths[item->index];
+            if (file.error != 0) {
+                throw std::runtime_error("Failed to read audio file: " + item->path + " - " + std::strerror(file.error));
+            }
+            item->bytes = std::move(file.bytes);
+            bytes_read += item->bytes.size();
+            return true;
+        }
+
+        const size_t position = next_path++;
+        if (position >= paths.size()) {
+            return false;
+        }
+        item->index = schedule[position];
+        item->path = paths[item->index];
+
+        // WAVs the mapping can serve are faulted in here; anything else is read whole
+        item->wav = WavFile::open(item->path);
+        if (item->wav) {
+            bytes_read += item->wav->prefetch();
+        } else {
+            read_file(*item);
+            bytes_read += item->bytes.size();
+        }
+        return true;
+    };
+
+    for (size_t t = 0; t < config_.io_threads; ++t) {
+        threads.emplace_back([&] {
+            for (;;) {
+                budget.wait_for_room();
+
+                ItemPtr item;
+                const auto begin = std::chrono::steady_clock::now();
+                bool ok = true;
+                try {
+                    if (!next_item(item)) {
+                        break;
+                    }
+                } catch (const std::exception& e) {
+                    // Without an item nothing was claimed: the item itself could not be allocated
+                    if (!item) {
+                        break;
+                    }
+                    fail(*item, "io", e.what());
+                    ok = false;
+                }
+                io_counters.busy_nanoseconds += std::chrono::duration_cast<std::chrono::nanoseconds>(
+                    std::chrono::steady_clock::now() - begin).count();
+                io_counters.items++;
+
+                if (ok) {
+                    budget.settle(*item);
+                    to_decode.push(item);
+                }
+            }
+            if (--io_remaining == 0) {
+                to_decode.close();
+            }
+        });
+    }
+
+    const int max_duration = config_.max_duration_seconds;
+    for (size_t t = 0; t < config_.decode_threads; ++t) {
+        threads.emplace_back([&] {
+            stage_loop(to_decode, &to_dsp, decode_counters, decode_remaining, "decode", [&](PipelineItem& item) {
+                if (!item.wav) {
+                    decode_bytes(item, max_duration);
+                    return;
+                }
+
+                // Mapped WAVs need no decoding: the frames are views of the mapping
+                item.source_rate = item.wav->sample_rate();
+                item.channels = item.wav->channels();
+                item.frames = static_cast<size_t>(item.wav->frames());
+                if (max_duration > 0) {
+                    item.frames = std::min(item.frames, static_cast<size_t>(max_duration) * item.source_rate);
+                }
+                if (item.wav->format() == WavSampleFormat::Int16) {
+                    item.int16_frames = item.wav->int16_frames();
+                } else {
+                    item.float_frames = item.wav->float_frames();
+                }
+            });
+        });
+    }
+
+    for (size_t t = 0; t < config_.dsp_threads; ++t) {
+        threads.emplace_back([&] {
+            PcmDecoder decoder;
+            stage_loop(to_dsp, &to_fingerprint, dsp_counters, dsp_remaining, "dsp", [&](PipelineItem& item) {
+                auto append = [&item](const int16_t* samples, size_t count, const PcmDecodeProgress&) {
+                    item.samples.insert(item.samples.end(), samples, samples + count);
+                };
+
+                item.samples.reserve(static_cast<size_t>(
+                    static_cast<uint64_t>(item.frames) * FINGERPRINT_SAMPLE_RATE / std::max(1, item.source_rate)) + 2);
+                if (item.int16_frames) {
+                    decoder.convert(item.int16_frames, item.frames, item.channels, item.source_rate,
+                                    FINGERPRINT_SAMPLE_RATE, PcmDecoder::DEFAULT_CHUNK_BYTES, append);
+                } else {
+                    decoder.convert(item.float_frames, item.frames, item.channels, item.source_rate,
+                                    FINGERPRINT_SAMPLE_RATE, PcmDecoder::DEFAULT_CHUNK_BYTES, append);
+                }
+
+                item.int16_frames = nullptr;
+                item.float_frames = nullptr;
+                item.wav.reset();
+                release(item.owned_int16);
+                release(item.owned_float);
+            });
+        });
+    }
+
+    const int algorithm = config_.algorithm;
+    for (size_t t = 0; t < config_.fingerprint_threads; ++t) {
+        threads.emplace_back([&] {
+            // One context per thread, restarted for every file
+            std::unique_ptr<ChromaprintContext, void (*)(ChromaprintContext*)> ctx(
+                chromaprint_new(algorithm), chromaprint_free);
+
+            stage_loop(to_fingerprint, nullptr, fingerprint_counters, fingerprint_remaining, "fingerprint",
+                       [&](PipelineItem& item) {
+                if (item.samples.empty()) {
+                    throw std::runtime_error("Empty audio data");
+                }
+
+                Fingerprint fingerprint;
+                run_chromaprint(ctx.get(), FINGERPRINT_SAMPLE_RATE, fingerprint.data, [&](const auto& feed) {
+                    feed(item.samples.data(), item.samples.size());
+                });
+                fingerprint.sample_rate = FINGERPRINT_SAMPLE_RATE;
+                fingerprint.duration = static_cast<double>(item.frames) / item.source_rate;
+                fingerprint.file_path = item.path;
+                release(item.samples);
+
+                // Distinct inputs write distinct slots
+                result.file_ids[item.index] = index.add_file(item.path, CompressedFingerprint::compress(fingerprint));
+            });
+        });
+    }
+
+    // Sample queue depths until the last stage drains
+    const BoundedQueue<ItemPtr>* queues[] = {&to_decode, &to_dsp, &to_fingerprint};
+    DepthSamples depths[3];
+    while (fingerprint_remaining.load() > 0) {
+        for (size_t q = 0; q < 3; ++q) {
+            depths[q].add(queues[q]->depth(), queues[q]->capacity());
+        }
+        std::this_thread::sleep_for(std::chrono::microseconds(DEPTH_SAMPLE_MICROSECONDS));
+    }
+
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    result.wall_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    result.bytes_read = bytes_read.load();
+    result.peak_buffered_bytes = budget.peak();
+    result.prefetched = prefetcher != nullptr;
+    if (prefetcher) {
+        result.prefetch = prefetcher->stats();
+    }
+
+    const std::pair<const char*, size_t> stage_threads[] = {
+        {"io", config_.io_threads},
+        {"decode", config_.decode_threads},
+        {"dsp", config_.dsp_threads},
+        {"fingerprint", config_.fingerprint_threads}
+    };
+    const StageCounters* counters[] = {&io_counters, &decode_counters, &dsp_counters, &fingerprint_counters};
+    for (size_t s = 0; s < 4; ++s) {
+        PipelineStageStats stage;
+        stage.name = stage_threads[s].first;
+        stage.threads = stage_threads[s].second;
+        stage.items = counters[s]->items.load();
+        stage.busy_seconds = counters[s]->busy_nanoseconds.load() / 1e9;
+        stage.utilisation = result.wall_seconds > 0.0
+            ? stage.busy_seconds / (stage.threads * result.wall_seconds)
+            : 0.0;
+        result.stages.push_back(stage);
+    }
+
+    const char* queue_names[] = {"io->decode", "decode->dsp", "dsp->fingerprint"};
+    for (size_t q = 0; q < 3; ++q) {
+        PipelineQueueStats queue;
+        queue.name = queue_names[q];
+        queue.capacity = queues[q]->capacity();
+        queue.max_depth = depths[q].max_depth;
+        queue.mean_depth = depths[q].samples > 0 ? depths[q].sum / depths[q].samples : 0.0;
+        queue.full_ratio = depths[q].samples > 0 ? static_cast<double>(depths[q].full) / depths[q].samples : 0.0;
+        result.queues.push_back(queue);
+    }
+
+    std::sort(result.errors.begin(), result.errors.end(),
+              [](const PipelineError& a, const PipelineError& b) { return a.input_index < b.input_index; });
+    return result;
+}
+
+} // namespace AudioDuplicates
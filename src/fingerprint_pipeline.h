@@ -0,0 +1,94 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+#include "fingerprint_index.h"
+#include "file_prefetcher.h"
+#include "disk_order.h"
+
+namespace AudioDuplicates {
+
+struct PipelineConfig {
+    size_t io_threads = 2;          // Read-ahead: map or read whole files
+    size_t decode_threads = 0;      // Container/codec decode to interleaved frames
+    size_t dsp_threads = 0;         // Downmix and resample to the fingerprint rate
+    size_t fingerprint_threads = 0; // Chromaprint, compression and index insertion
+    size_t queue_capacity = 8;      // Files in flight between two stages (rounded up to a power of two)
+    size_t max_buffered_bytes = size_t(512) << 20; // Read and decoded bytes held past the I/O stage before it waits
+    int max_duration_seconds = 0;   // <= 0 fingerprints whole files
+    int algorithm = -1;             // Chromaprint algorithm; < 0 = default
+    size_t prefetch_depth = 0;      // > 0 reads this many files ahead through a FilePrefetcher
+    PrefetchBackend prefetch_backend = PrefetchBackend::Auto;
+    bool disk_order = false;        // Read files in on-disk order (DiskOrderPlanner) instead of input order
+    // Stages left at 0 threads share the hardware threads not given to I/O
+};
+
+struct PipelineStageStats {
+    std::string name;
+    size_t threads;
+    size_t items;        // Files that left the stage (failures included)
+    double busy_seconds; // Summed across the stage's threads, excluding queue waits
+    double utilisation;  // busy_seconds / (threads * wall time)
+};
+
+struct PipelineQueueStats {
+    std::string name;    // "<producer>-><consumer>"
+    size_t capacity;
+    size_t max_depth;
+    double mean_depth;   // Time-averaged over the run
+    double full_ratio;   // Fraction of samples at capacity (the consumer is the bottleneck)
+};
+
+struct PipelineError {
+    size_t input_index;
+    std::string stage;
+    std::string message;
+};
+
+struct PipelineResult {
+    // Index file id per input path, or SIZE_MAX when the file failed
+    std::vector<size_t> file_ids;
+    std::vector<PipelineError> errors;
+    std::vector<PipelineStageStats> stages;
+    std::vector<PipelineQueueStats> queues;
+    size_t bytes_read;
+    size_t peak_buffered_bytes;  // Most read and decoded bytes held between the stages at once
+    double wall_seconds;
+    bool prefetched;             // Whether a FilePrefetcher fed the I/O stage
+    PrefetchStats prefetch;
+    bool disk_ordered;
+    DiskOrderStats disk_order;   // Planning time is included in wall_seconds
+};
+
+/**
+ * Staged fingerprinting engine feeding a FingerprintIndex
+ * I/O, decode, DSP and fingerprint stages each run their own thread pool and
+ * pass whole files through bounded lock-free queues, so disk waits in one stage
+ * overlap CPU work in the others and a slow stage backs up instead of piling
+ * up memory. Since one file can decode to hundreds of megabytes, the I/O stage
+ * also stops admitting files while the buffers held downstream exceed
+ * max_buffered_bytes. 16-bit and float WAVs are handed on as views of their mapping;
+ * other formats are read into memory and decoded by libsndfile from there.
+ * With prefetch_depth set every file is read ahead by a FilePrefetcher and
+ * decoded from memory
+ */
+class FingerprintPipeline {
+public:
+    explicit FingerprintPipeline(const PipelineConfig& config = PipelineConfig{});
+
+    // Fingerprint every path and add it to index (which may already hold files)
+    PipelineResult run(const std::vector<std::string>& paths, FingerprintIndex& index);
+
+    const PipelineConfig& config() const { return config_; }
+
+    static constexpr int FINGERPRINT_SAMPLE_RATE = 11025;
+    static constexpr size_t DEPTH_SAMPLE_MICROSECONDS = 1000;
+
+private:
+    PipelineConfig config_;
+};
+
+} // namespace AudioDuplicates
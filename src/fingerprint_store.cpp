@@ -0,0 +1,517 @@
+#include "fingerprint_store.h"
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+
+namespace AudioDuplicates {
+
+namespace {
+
+std::atomic<unsigned> g_cold_file_sequence{0};
+
+} // namespace
+
+FingerprintStore::FingerprintStore()
+    : hot_bytes_(0), dead_slab_bytes_(0), dead_cold_bytes_(0), generation_(0), promotions_(0), demotions_(0), tier_epochs_(0),
+      path_count_(0), raw_path_bytes_(0) {
+}
+
+size_t FingerprintStore::append(const std::string& file_path, const CompressedFingerprint& fingerprint,
+                                uint64_t content_hash) {
+    if (!fingerprint.isValid()) {
+        throw std::invalid_argument("Cannot store invalid fingerprint");
+    }
+
+    if (fingerprint.usesDictionary() && fingerprint.getDictionary() != dictionary_.get()) {
+        throw std::invalid_argument("Fingerprint was compressed against a different dictionary");
+    }
+
+    if (fingerprint.getCompressedSize() > std::numeric_limits<uint32_t>::max() ||
+        fingerprint.getFrameCount() > std::numeric_limits<uint32_t>::max()) {
+        throw std::length_error("Fingerprint too large for the store");
+    }
+
+    const uint32_t path_id = intern_path(file_path);
+
+    offsets_.push_back(slab_.size());
+    lengths_.push_back(static_cast<uint32_t>(fingerprint.getCompressedSize()));
+    frame_counts_.push_back(static_cast<uint32_t>(fingerprint.getFrameCount()));
+    durations_.push_back(fingerprint.getDuration());
+    sample_rates_.push_back(fingerprint.getSampleRate());
+    path_ids_.push_back(path_id);
+    content_hashes_.push_back(content_hash);
+
+    tiers_.push_back(static_cast<uint8_t>(StorageTier::Warm));
+    access_counts_.emplace_back(0);
+    heat_.push_back(0);
+    idle_epochs_.push_back(0);
+
+    slab_.insert(slab_.end(), fingerprint.getData(), fingerprint.getData() + fingerprint.getCompressedSize());
+
+    return offsets_.size() - 1;
+}
+
+size_t FingerprintStore::append_alias(const std::string& file_path, size_t source_id) {
+    if (source_id >= offsets_.size()) {
+        throw std::out_of_range("File id out of range");
+    }
+
+    const uint32_t path_id = intern_path(file_path);
+
+    // Shared blobs stay shared through slab compaction; they are only split when
+    // one entry comes back from the cold file or the store is recompressed
+    offsets_.push_back(offsets_[source_id]);
+    lengths_.push_back(lengths_[source_id]);
+    frame_counts_.push_back(frame_counts_[source_id]);
+    durations_.push_back(durations_[source_id]);
+    sample_rates_.push_back(sample_rates_[source_id]);
+    path_ids_.push_back(path_id);
+    content_hashes_.push_back(content_hashes_[source_id]);
+
+    // The alias starts warm even when its source is hot or cold
+    tiers_.push_back(static_cast<uint8_t>(StorageTier::Warm));
+    access_counts_.emplace_back(0);
+    heat_.push_back(0);
+    idle_epochs_.push_back(0);
+
+    if (tier(source_id) == StorageTier::Cold) {
+        offsets_.back() = slab_.size();
+        const uint8_t* data = blob(source_id);
+        slab_.insert(slab_.end(), data, data + lengths_[source_id]);
+    }
+
+    return offsets_.size() - 1;
+}
+
+CompressedFingerprint FingerprintStore::fingerprint(size_t file_id) const {
+    if (file_id >= offsets_.size()) {
+        throw std::out_of_range("File id out of range");
+    }
+
+    return CompressedFingerprint::view(blob(file_id), lengths_[file_id],
+                                       original_size(file_id), sample_rates_[file_id],
+                                       durations_[file_id], dictionary_.get());
+}
+
+FingerprintView FingerprintStore::frames(size_t file_id, std::vector<uint32_t>& buffer) const {
+    if (file_id >= offsets_.size()) {
+        throw std::out_of_range("File id out of range");
+    }
+
+    record_access(file_id);
+
+    if (tier(file_id) == StorageTier::Hot) {
+        const auto& hot = hot_frames_.at(static_cast<uint32_t>(file_id));
+        return FingerprintView(hot.data(), hot.size(), sample_rates_[file_id], durations_[file_id]);
+    }
+
+    return fingerprint(file_id).decompress_view(buffer);
+}
+
+const uint8_t* FingerprintStore::blob(size_t file_id) const {
+    if (tier(file_id) == StorageTier::Cold) {
+        return cold_file_->data() + offsets_[file_id];
+    }
+    return slab_.data() + offsets_[file_id];
+}
+
+std::string FingerprintStore::path(size_t file_id) const {
+    if (file_id >= path_ids_.size()) {
+        throw std::out_of_range("File id out of range");
+    }
+    return decode_path(path_ids_[file_id]);
+}
+
+void FingerprintStore::replace_all(const std::vector<std::unique_ptr<CompressedFingerprint>>& fingerprints,
+                                   std::shared_ptr<const FingerprintDictionary> dictionary) {
+    if (fingerprints.size() != offsets_.size()) {
+        throw std::invalid_argument("Replacement count does not match the store");
+    }
+
+    size_t total = 0;
+    for (const auto& fingerprint : fingerprints) {
+        if (!fingerprint || !fingerprint->isValid()) {
+            throw std::invalid_argument("Cannot store invalid fingerprint");
+        }
+        if (fingerprint->usesDictionary() && fingerprint->getDictionary() != dictionary.get()) {
+            throw std::invalid_argument("Fingerprint was compressed against a different dictionary");
+        }
+        total += fingerprint->getCompressedSize();
+    }
+
+    // Every blob comes back into the slab; hot frames are unchanged by recompression
+    std::vector<uint8_t> slab;
+    slab.reserve(total);
+    for (size_t file_id = 0; file_id < fingerprints.size(); ++file_id) {
+        const auto& fingerprint = *fingerprints[file_id];
+        offsets_[file_id] = slab.size();
+        lengths_[file_id] = static_cast<uint32_t>(fingerprint.getCompressedSize());
+        slab.insert(slab.end(), fingerprint.getData(), fingerprint.getData() + fingerprint.getCompressedSize());
+
+        if (tier(file_id) == StorageTier::Cold) {
+            tiers_[file_id] = static_cast<uint8_t>(StorageTier::Warm);
+        }
+    }
+
+    slab_ = std::move(slab);
+    dictionary_ = std::move(dictionary);
+    cold_file_.reset();
+    dead_slab_bytes_ = 0;
+    dead_cold_bytes_ = 0;
+    generation_++;
+}
+
+void FingerprintStore::reserve(size_t files, size_t slab_bytes) {
+    slab_.reserve(slab_bytes);
+    offsets_.reserve(files);
+    lengths_.reserve(files);
+    frame_counts_.reserve(files);
+    durations_.reserve(files);
+    sample_rates_.reserve(files);
+    path_ids_.reserve(files);
+    content_hashes_.reserve(files);
+    tiers_.reserve(files);
+    heat_.reserve(files);
+    idle_epochs_.reserve(files);
+}
+
+void FingerprintStore::clear() {
+    slab_.clear();
+    offsets_.clear();
+    lengths_.clear();
+    frame_counts_.clear();
+    durations_.clear();
+    sample_rates_.clear();
+    path_ids_.clear();
+    content_hashes_.clear();
+    dictionary_.reset();
+    tiers_.clear();
+    access_counts_.clear();
+    heat_.clear();
+    idle_epochs_.clear();
+    hot_frames_.clear();
+    hot_bytes_ = 0;
+    cold_file_.reset();
+    dead_slab_bytes_ = 0;
+    dead_cold_bytes_ = 0;
+    generation_++;
+    promotions_ = 0;
+    demotions_ = 0;
+    tier_epochs_ = 0;
+    path_data_.clear();
+    path_block_offsets_.clear();
+    last_path_.clear();
+    path_count_ = 0;
+    raw_path_bytes_ = 0;
+    path_lookup_.clear();
+}
+
+FingerprintStoreStats FingerprintStore::getStats() const {
+    FingerprintStoreStats stats;
+    stats.files = offsets_.size();
+    stats.slab_bytes = slab_.size();
+    stats.slab_capacity = slab_.capacity();
+    stats.metadata_bytes = offsets_.size() * (sizeof(uint64_t) * 2 + sizeof(uint32_t) * 3 + sizeof(double) + sizeof(int32_t));
+    stats.unique_paths = path_count_;
+    stats.path_bytes = path_data_.size() + path_block_offsets_.size() * sizeof(uint64_t);
+    stats.raw_path_bytes = raw_path_bytes_;
+
+    stats.hot_files = hot_frames_.size();
+    stats.hot_bytes = hot_bytes_;
+    stats.cold_files = static_cast<size_t>(std::count(tiers_.begin(), tiers_.end(), static_cast<uint8_t>(StorageTier::Cold)));
+    stats.warm_files = stats.files - stats.hot_files - stats.cold_files;
+    stats.cold_bytes = cold_file_ ? cold_file_->size() : 0;
+    stats.promotions = promotions_;
+    stats.demotions = demotions_;
+    stats.tier_epochs = tier_epochs_;
+    return stats;
+}
+
+TierPlan FingerprintStore::plan_tiers(const TierConfig& config) {
+    TierPlan plan;
+    plan.generation = generation_;
+
+    // Age every entry: heat halves each epoch and gains this epoch's accesses
+    std::vector<uint32_t> candidates;
+    for (size_t file_id = 0; file_id < offsets_.size(); ++file_id) {
+        const uint32_t accesses = access_counts_[file_id].exchange(0, std::memory_order_relaxed);
+        heat_[file_id] = heat_[file_id] / 2 + accesses;
+        idle_epochs_[file_id] = accesses > 0 ? 0 : static_cast<uint8_t>(std::min(idle_epochs_[file_id] + 1, 255));
+
+        if (heat_[file_id] >= config.hot_min_heat) {
+            candidates.push_back(static_cast<uint32_t>(file_id));
+        } else if (accesses > 0 && tier(file_id) == StorageTier::Cold) {
+            plan.make_warm.push_back(static_cast<uint32_t>(file_id));
+        }
+    }
+
+    // Hottest entries first until the budget is spent
+    std::sort(candidates.begin(), candidates.end(),
+              [this](uint32_t a, uint32_t b) { return heat_[a] != heat_[b] ? heat_[a] > heat_[b] : a < b; });
+
+    std::vector<uint8_t> keep_hot(offsets_.size(), 0);
+    size_t budget_used = 0;
+    for (uint32_t file_id : candidates) {
+        const size_t bytes = original_size(file_id);
+        if (budget_used + bytes > config.hot_budget_bytes) {
+            // Hot candidates that do not fit still leave the cold file
+            if (tier(file_id) == StorageTier::Cold) {
+                plan.make_warm.push_back(file_id);
+            }
+            continue;
+        }
+
+        budget_used += bytes;
+        keep_hot[file_id] = 1;
+
+        if (tier(file_id) != StorageTier::Hot) {
+            if (tier(file_id) == StorageTier::Cold) {
+                plan.make_warm.push_back(file_id);
+            }
+            std::vector<uint32_t> decoded(frame_counts_[file_id]);
+            fingerprint(file_id).decompress_into(decoded.data(), decoded.size());
+            plan.make_hot.emplace_back(file_id, std::move(decoded));
+        }
+    }
+
+    for (const auto& entry : hot_frames_) {
+        if (!keep_hot[entry.first]) {
+            plan.evict_hot.push_back(entry.first);
+        }
+    }
+
+    // Long-idle warm entries leave RAM, a bounded amount per epoch
+    if (!config.cold_directory.empty()) {
+        size_t cold_bytes = 0;
+        for (size_t file_id = 0; file_id < offsets_.size() && cold_bytes < MAX_COLD_BYTES_PER_EPOCH; ++file_id) {
+            if (tier(file_id) == StorageTier::Warm && !keep_hot[file_id] &&
+                idle_epochs_[file_id] >= config.cold_after_epochs) {
+                plan.make_cold.push_back(static_cast<uint32_t>(file_id));
+                cold_bytes += lengths_[file_id];
+            }
+        }
+    }
+
+    return plan;
+}
+
+void FingerprintStore::apply_tiers(TierPlan&& plan, const TierConfig& config) {
+    if (plan.generation != generation_) {
+        return;
+    }
+
+    for (uint32_t file_id : plan.evict_hot) {
+        auto it = hot_frames_.find(file_id);
+        if (it != hot_frames_.end()) {
+            hot_bytes_ -= it->second.size() * sizeof(uint32_t);
+            hot_frames_.erase(it);
+            tiers_[file_id] = static_cast<uint8_t>(StorageTier::Warm);
+            demotions_++;
+        }
+    }
+
+    // Cold entries that were read again move back into the slab
+    for (uint32_t file_id : plan.make_warm) {
+        if (tier(file_id) == StorageTier::Cold) {
+            const uint8_t* data = cold_file_->data() + offsets_[file_id];
+            offsets_[file_id] = slab_.size();
+            slab_.insert(slab_.end(), data, data + lengths_[file_id]);
+            tiers_[file_id] = static_cast<uint8_t>(StorageTier::Warm);
+            dead_cold_bytes_ += lengths_[file_id];
+            promotions_++;
+        }
+    }
+
+    for (auto& entry : plan.make_hot) {
+        const uint32_t file_id = entry.first;
+        if (tier(file_id) == StorageTier::Warm) {
+            hot_bytes_ += entry.second.size() * sizeof(uint32_t);
+            hot_frames_[file_id] = std::move(entry.second);
+            tiers_[file_id] = static_cast<uint8_t>(StorageTier::Hot);
+            promotions_++;
+        }
+    }
+
+    if (!plan.make_cold.empty()) {
+        if (cold_file_ && dead_cold_bytes_ > cold_file_->size() / 2) {
+            compact_cold_file(config);
+        }
+        if (!cold_file_) {
+            cold_file_ = create_cold_file(config);
+        }
+        cold_file_->set_max_size(config.max_cold_bytes);
+
+        // Until the cold file is remapped the new entries cannot be read from it, so
+        // a failed write puts them back on their slab blobs, which are still intact
+        std::vector<std::pair<uint32_t, uint64_t>> moved;
+        try {
+            for (uint32_t file_id : plan.make_cold) {
+                if (tier(file_id) == StorageTier::Warm) {
+                    const uint64_t slab_offset = offsets_[file_id];
+                    offsets_[file_id] = cold_file_->append(slab_.data() + slab_offset, lengths_[file_id]);
+                    tiers_[file_id] = static_cast<uint8_t>(StorageTier::Cold);
+                    moved.emplace_back(file_id, slab_offset);
+                }
+            }
+            cold_file_->remap();
+        } catch (...) {
+            // Blobs already appended stay in the file, unreferenced, until it is compacted
+            for (const auto& entry : moved) {
+                dead_cold_bytes_ += lengths_[entry.first];
+                offsets_[entry.first] = entry.second;
+                tiers_[entry.first] = static_cast<uint8_t>(StorageTier::Warm);
+            }
+            throw;
+        }
+        demotions_ += moved.size();
+
+        // Aliases share their source's blob, so a blob is only dead once every
+        // entry pointing at it has left the slab
+        dead_slab_bytes_ = slab_.size() - live_slab_bytes();
+    }
+
+    // Give the space of demoted blobs back once it is a sizeable share of the slab
+    if (dead_slab_bytes_ > slab_.size() / 4) {
+        compact_slab();
+    }
+
+    tier_epochs_++;
+}
+
+std::unique_ptr<MappedFile> FingerprintStore::create_cold_file(const TierConfig& config) {
+    auto file = std::make_unique<MappedFile>(config.cold_directory + "/audio-duplicates-cold-" +
+                                             std::to_string(g_cold_file_sequence.fetch_add(1)) + ".bin");
+    file->set_max_size(config.max_cold_bytes);
+    return file;
+}
+
+void FingerprintStore::compact_cold_file(const TierConfig& config) {
+    auto cold_file = create_cold_file(config);
+
+    // Offsets only change once the new file is readable, so a failure keeps the old one
+    std::vector<uint64_t> offsets(offsets_);
+    for (size_t file_id = 0; file_id < offsets_.size(); ++file_id) {
+        if (tier(file_id) == StorageTier::Cold) {
+            offsets[file_id] = cold_file->append(cold_file_->data() + offsets_[file_id], lengths_[file_id]);
+        }
+    }
+
+    cold_file->remap();
+    offsets_ = std::move(offsets);
+    cold_file_ = std::move(cold_file);
+    dead_cold_bytes_ = 0;
+}
+
+size_t FingerprintStore::live_slab_bytes() const {
+    std::vector<std::pair<uint64_t, uint32_t>> blobs;
+    for (size_t file_id = 0; file_id < offsets_.size(); ++file_id) {
+        if (tier(file_id) != StorageTier::Cold) {
+            blobs.emplace_back(offsets_[file_id], lengths_[file_id]);
+        }
+    }
+    std::sort(blobs.begin(), blobs.end());
+    blobs.erase(std::unique(blobs.begin(), blobs.end()), blobs.end());
+
+    size_t live = 0;
+    for (const auto& entry : blobs) {
+        live += entry.second;
+    }
+    return live;
+}
+
+void FingerprintStore::compact_slab() {
+    std::vector<uint8_t> slab;
+    slab.reserve(live_slab_bytes());
+
+    // Entries that shared a blob (aliases) keep sharing its new copy
+    std::unordered_map<uint64_t, uint64_t> moved;
+    for (size_t file_id = 0; file_id < offsets_.size(); ++file_id) {
+        if (tier(file_id) != StorageTier::Cold) {
+            auto it = moved.find(offsets_[file_id]);
+            if (it != moved.end()) {
+                offsets_[file_id] = it->second;
+                continue;
+            }
+            const uint8_t* data = slab_.data() + offsets_[file_id];
+            moved.emplace(offsets_[file_id], slab.size());
+            offsets_[file_id] = slab.size();
+            slab.insert(slab.end(), data, data + lengths_[file_id]);
+        }
+    }
+
+    slab_ = std::move(slab);
+    dead_slab_bytes_ = 0;
+}
+
+uint32_t FingerprintStore::intern_path(const std::string& file_path) {
+    const size_t hash = std::hash<std::string>{}(file_path);
+
+    auto range = path_lookup_.equal_range(hash);
+    for (auto it = range.first; it != range.second; ++it) {
+        if (decode_path(it->second) == file_path) {
+            return it->second;
+        }
+    }
+
+    const uint32_t path_id = static_cast<uint32_t>(path_count_);
+
+    size_t shared = 0;
+    if (path_count_ % PATH_BLOCK_SIZE == 0) {
+        path_block_offsets_.push_back(path_data_.size());
+    } else {
+        const size_t limit = std::min(last_path_.size(), file_path.size());
+        while (shared < limit && last_path_[shared] == file_path[shared]) {
+            ++shared;
+        }
+    }
+
+    write_varint(path_data_, shared);
+    write_varint(path_data_, file_path.size() - shared);
+    path_data_.insert(path_data_.end(), file_path.begin() + shared, file_path.end());
+
+    last_path_ = file_path;
+    path_count_++;
+    raw_path_bytes_ += file_path.size();
+    path_lookup_.emplace(hash, path_id);
+
+    return path_id;
+}
+
+std::string FingerprintStore::decode_path(uint32_t path_id) const {
+    // Replay the block from its restart point up to the requested path
+    const char* in = path_data_.data() + path_block_offsets_[path_id / PATH_BLOCK_SIZE];
+    std::string path;
+
+    for (size_t i = 0; i <= path_id % PATH_BLOCK_SIZE; ++i) {
+        const size_t shared = read_varint(in);
+        const size_t suffix = read_varint(in);
+        path.resize(shared);
+        path.append(in, suffix);
+        in += suffix;
+    }
+
+    return path;
+}
+
+void FingerprintStore::write_varint(std::vector<char>& out, size_t value) {
+    while (value >= 0x80) {
+        out.push_back(static_cast<char>((value & 0x7F) | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<char>(value));
+}
+
+size_t FingerprintStore::read_varint(const char*& in) {
+    size_t value = 0;
+    unsigned shift = 0;
+    uint8_t byte;
+    do {
+        byte = static_cast<uint8_t>(*in++);
+        value |= static_cast<size_t>(byte & 0x7F) << shift;
+        shift += 7;
+    } while (byte & 0x80);
+    return value;
+}
+
+} // namespace AudioDuplicates
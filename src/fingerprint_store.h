@@ -0,0 +1,191 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <unordered_map>
+#include <deque>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include "compressed_fingerprint.h"
+#include "mapped_file.h"
+
+namespace AudioDuplicates {
+
+// Where a file's fingerprint currently lives
+enum class StorageTier : uint8_t {
+    Hot = 0,  // Decoded frames in memory (compressed blob kept in the slab)
+    Warm = 1, // Compressed blob in the slab
+    Cold = 2  // Compressed blob only in the memory-mapped cold file
+};
+
+struct TierConfig {
+    size_t hot_budget_bytes;     // Decoded frames held in the hot tier
+    uint32_t hot_min_heat;       // Decayed access count needed to become hot
+    uint32_t cold_after_epochs;  // Untouched epochs before a warm entry moves to the cold file
+    std::string cold_directory;  // Where the cold file is created; empty disables the cold tier
+    size_t max_cold_bytes;       // Cold file size cap; demotions that would pass it fail (0: unlimited)
+
+    TierConfig() : hot_budget_bytes(64 * 1024 * 1024), hot_min_heat(4), cold_after_epochs(8), max_cold_bytes(0) {}
+};
+
+struct FingerprintStoreStats {
+    size_t files;
+    size_t slab_bytes;      // Compressed blob bytes in the slab
+    size_t slab_capacity;   // Bytes reserved by the slab
+    size_t metadata_bytes;  // Per-file metadata columns
+    size_t unique_paths;
+    size_t path_bytes;      // Front-coded path table
+    size_t raw_path_bytes;  // What the interned paths would take as plain strings
+
+    // Tier occupancy
+    size_t hot_files;
+    size_t hot_bytes;       // Decoded frame bytes
+    size_t warm_files;
+    size_t cold_files;
+    size_t cold_bytes;      // Cold file size, including blobs since promoted back until it is compacted
+    size_t promotions;      // Entries moved to a hotter tier
+    size_t demotions;       // Entries moved to a colder tier
+    size_t tier_epochs;
+
+    // Tiering epochs that failed on the background thread, filled in by FingerprintIndex
+    size_t tier_errors = 0;
+    std::string last_tier_error;
+};
+
+// Tier changes decided from one epoch of access counts, applied by FingerprintStore::apply_tiers
+struct TierPlan {
+    uint64_t generation;
+    std::vector<std::pair<uint32_t, std::vector<uint32_t>>> make_hot; // With their decoded frames
+    std::vector<uint32_t> evict_hot;
+    std::vector<uint32_t> make_warm; // Cold entries accessed again
+    std::vector<uint32_t> make_cold;
+
+    TierPlan() : generation(0) {}
+};
+
+/**
+ * Arena storage for the index's compressed fingerprints
+ * Blobs are appended to one growable slab, per-file metadata lives in parallel
+ * columns and paths are interned in a front-coded table, so a file costs no
+ * allocations of its own. Frequently read entries are also kept decoded (hot) and
+ * long-untouched ones move to a memory-mapped cold file
+ */
+class FingerprintStore {
+public:
+    FingerprintStore();
+
+    // Copy the blob into the slab and return the new file id; content_hash is the
+    // ContentHash of the decoded frames, used to find bit-identical fingerprints
+    size_t append(const std::string& file_path, const CompressedFingerprint& fingerprint, uint64_t content_hash);
+
+    // Add a file whose content is identical to source_id's; the new entry shares
+    // source_id's blob instead of copying it
+    size_t append_alias(const std::string& file_path, size_t source_id);
+
+    // Non-owning view of a file's blob; invalidated by the next append, replace or apply_tiers
+    CompressedFingerprint fingerprint(size_t file_id) const;
+
+    // Decoded frames: hot entries are viewed in place, others are decoded into
+    // buffer (grown when too small). Counts as an access for tiering
+    FingerprintView frames(size_t file_id, std::vector<uint32_t>& buffer) const;
+
+    // Count an access that bypassed frames() (e.g. a compressed-domain comparison)
+    void record_access(size_t file_id) const {
+        access_counts_[file_id].fetch_add(1, std::memory_order_relaxed);
+    }
+
+    StorageTier tier(size_t file_id) const { return static_cast<StorageTier>(tiers_[file_id]); }
+
+    std::string path(size_t file_id) const;
+    double duration(size_t file_id) const { return durations_[file_id]; }
+    int sample_rate(size_t file_id) const { return sample_rates_[file_id]; }
+    size_t compressed_size(size_t file_id) const { return lengths_[file_id]; }
+    size_t original_size(size_t file_id) const { return static_cast<size_t>(frame_counts_[file_id]) * sizeof(uint32_t); }
+    size_t frame_count(size_t file_id) const { return frame_counts_[file_id]; }
+    uint64_t content_hash(size_t file_id) const { return content_hashes_[file_id]; }
+
+    size_t size() const { return offsets_.size(); }
+    bool empty() const { return offsets_.empty(); }
+
+    // Dictionary referenced by blobs that were compressed against one
+    const std::shared_ptr<const FingerprintDictionary>& dictionary() const { return dictionary_; }
+
+    // Swap in a new blob for every file (same order, same metadata) and the
+    // dictionary they were compressed against; the slab is rebuilt in one pass
+    void replace_all(const std::vector<std::unique_ptr<CompressedFingerprint>>& fingerprints,
+                     std::shared_ptr<const FingerprintDictionary> dictionary);
+
+    void reserve(size_t files, size_t slab_bytes);
+    void clear();
+
+    FingerprintStoreStats getStats() const;
+
+    // Tiering runs in two steps so readers are only blocked while changes are
+    // installed: plan_tiers ages the access counts and decodes new hot entries
+    // (callers hold a shared lock and serialize planning), apply_tiers moves
+    // blobs between the slab and the cold file (callers hold an exclusive lock).
+    // Plans made before a replace_all or clear are ignored
+    TierPlan plan_tiers(const TierConfig& config);
+    void apply_tiers(TierPlan&& plan, const TierConfig& config);
+
+    static constexpr size_t PATH_BLOCK_SIZE = 16; // Paths per front-coding restart point
+    static constexpr size_t MAX_COLD_BYTES_PER_EPOCH = 64 * 1024 * 1024; // Bounds the exclusive-lock write time
+
+private:
+    // Blob slab and struct-of-arrays metadata, indexed by file id
+    std::vector<uint8_t> slab_;
+    std::vector<uint64_t> offsets_;
+    std::vector<uint32_t> lengths_;
+    std::vector<uint32_t> frame_counts_;
+    std::vector<double> durations_;
+    std::vector<int32_t> sample_rates_;
+    std::vector<uint32_t> path_ids_;
+    std::vector<uint64_t> content_hashes_;
+
+    std::shared_ptr<const FingerprintDictionary> dictionary_;
+
+    // Tiering: offsets_ point into the cold file for cold entries. Access counts
+    // are bumped by readers; heat and idle epochs belong to the planning step
+    std::vector<uint8_t> tiers_;
+    mutable std::deque<std::atomic<uint32_t>> access_counts_;
+    std::vector<uint32_t> heat_;
+    std::vector<uint8_t> idle_epochs_;
+    std::unordered_map<uint32_t, std::vector<uint32_t>> hot_frames_;
+    size_t hot_bytes_;
+    std::unique_ptr<MappedFile> cold_file_;
+    size_t dead_slab_bytes_; // Slab bytes no longer referenced by a hot or warm entry
+    size_t dead_cold_bytes_; // Cold file bytes of entries promoted back
+    uint64_t generation_;
+    size_t promotions_;
+    size_t demotions_;
+    size_t tier_epochs_;
+
+    // Front-coded path table: every PATH_BLOCK_SIZE-th path is stored whole, the
+    // rest as (shared prefix length, suffix length, suffix) against their predecessor
+    std::vector<char> path_data_;
+    std::vector<uint64_t> path_block_offsets_;
+    std::string last_path_;
+    size_t path_count_;
+    size_t raw_path_bytes_;
+
+    // Path hash -> path ids with that hash, for interning
+    std::unordered_multimap<size_t, uint32_t> path_lookup_;
+
+    const uint8_t* blob(size_t file_id) const;
+    void compact_slab();
+
+    // Bytes of distinct slab blobs still referenced by hot or warm entries
+    size_t live_slab_bytes() const;
+    void compact_cold_file(const TierConfig& config);
+    static std::unique_ptr<MappedFile> create_cold_file(const TierConfig& config);
+
+    uint32_t intern_path(const std::string& file_path);
+    std::string decode_path(uint32_t path_id) const;
+
+    static void write_varint(std::vector<char>& out, size_t value);
+    static size_t read_varint(const char*& in);
+};
+
+} // namespace AudioDuplicates
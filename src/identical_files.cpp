@@ -0,0 +1,273 @@
+#include "identical_files.h"
+#include "content_hash.h"
+#include <algorithm>
+#include <cstring>
+#include <map>
+#include <omp.h>
+#include <sys/types.h>
+#include <sys/stat.h>
+
+namespace AudioDuplicates {
+
+IdenticalFileFinder::IdenticalFileFinder(const IdenticalFileConfig& config)
+    : config_(config) {
+    config_.sample_block_bytes = std::max<size_t>(1, config_.sample_block_bytes);
+    config_.full_hash_chunk_bytes = std::max<size_t>(1, config_.full_hash_chunk_bytes);
+}
+
+IdenticalFileResult IdenticalFileFinder::find(const std::vector<std::string>& paths) const {
+    IdenticalFileResult result;
+    result.stats = IdenticalFileStats{};
+    result.stats.files = paths.size();
+
+    const int threads = config_.num_threads > 0 ? static_cast<int>(config_.num_threads) : omp_get_max_threads();
+
+    // Only files that share their size with another file can be copies
+    std::vector<int64_t> sizes(paths.size());
+    #pragma omp parallel for num_threads(threads) schedule(dynamic, 64)
+    for (int64_t i = 0; i < static_cast<int64_t>(paths.size()); ++i) {
+        sizes[i] = file_size(paths[i]);
+    }
+
+    // Empty files carry no audio, so they are left to the decoder to reject
+    std::map<int64_t, std::vector<size_t>> by_size;
+    for (size_t i = 0; i < paths.size(); ++i) {
+        if (sizes[i] < 0) {
+            result.stats.unreadable++;
+        } else if (sizes[i] > 0) {
+            by_size[sizes[i]].push_back(i);
+        }
+    }
+
+    std::vector<size_t> candidates;
+    for (const auto& entry : by_size) {
+        if (entry.second.size() > 1) {
+            candidates.insert(candidates.end(), entry.second.begin(), entry.second.end());
+        }
+    }
+    result.stats.size_matches = candidates.size();
+
+    // Sampled blocks first; for small files this is already the full content
+    std::vector<uint64_t> sampled(paths.size(), 0);
+    std::vector<uint8_t> readable(paths.size(), 0);
+    size_t bytes_read = 0;
+    #pragma omp parallel for num_threads(threads) schedule(dynamic, 16) reduction(+:bytes_read)
+    for (int64_t c = 0; c < static_cast<int64_t>(candidates.size()); ++c) {
+        const size_t i = candidates[c];
+        size_t read = 0;
+        readable[i] = sampled_hash(paths[i], static_cast<uint64_t>(sizes[i]), sampled[i], read) ? 1 : 0;
+        bytes_read += read;
+    }
+    result.stats.sampled_hashes = candidates.size();
+
+    std::map<std::pair<int64_t, uint64_t>, std::vector<size_t>> by_sample;
+    for (size_t i : candidates) {
+        if (readable[i]) {
+            by_sample[{sizes[i], sampled[i]}].push_back(i);
+        } else {
+            result.stats.unreadable++;
+        }
+    }
+
+    // Whole-file hashes only where the sampled hashes still collide
+    std::vector<size_t> collisions;
+    for (const auto& entry : by_sample) {
+        if (entry.second.size() > 1 && static_cast<uint64_t>(entry.first.first) > sampled_coverage()) {
+            collisions.insert(collisions.end(), entry.second.begin(), entry.second.end());
+        }
+    }
+
+    std::vector<uint64_t> full(paths.size(), 0);
+    #pragma omp parallel for num_threads(threads) schedule(dynamic, 4) reduction(+:bytes_read)
+    for (int64_t c = 0; c < static_cast<int64_t>(collisions.size()); ++c) {
+        const size_t i = collisions[c];
+        size_t read = 0;
+        readable[i] = full_hash(paths[i], static_cast<uint64_t>(sizes[i]), full[i], read) ? 1 : 0;
+        bytes_read += read;
+    }
+    result.stats.full_hashes = collisions.size();
+
+    std::map<std::pair<int64_t, uint64_t>, std::vector<size_t>> by_content;
+    for (const auto& entry : by_sample) {
+        if (entry.second.size() < 2) {
+            continue;
+        }
+
+        const bool sample_is_full = static_cast<uint64_t>(entry.first.first) <= sampled_coverage();
+        for (size_t i : entry.second) {
+            if (!readable[i]) {
+                result.stats.unreadable++;
+                continue;
+            }
+            by_content[{sizes[i], sample_is_full ? sampled[i] : full[i]}].push_back(i);
+        }
+    }
+
+    std::vector<std::vector<size_t>> hashed;
+    for (auto& entry : by_content) {
+        if (entry.second.size() > 1) {
+            std::sort(entry.second.begin(), entry.second.end());
+            hashed.push_back(std::move(entry.second));
+        }
+    }
+
+    // Equal hashes are confirmed byte for byte: each file joins the first subgroup
+    // whose representative it matches, or starts a subgroup of its own
+    std::vector<std::vector<std::vector<size_t>>> confirmed(hashed.size());
+    size_t hash_collisions = 0;
+    #pragma omp parallel for num_threads(threads) schedule(dynamic, 1) reduction(+:bytes_read, hash_collisions)
+    for (int64_t g = 0; g < static_cast<int64_t>(hashed.size()); ++g) {
+        auto& subgroups = confirmed[g];
+        for (size_t i : hashed[g]) {
+            bool placed = false;
+            for (auto& subgroup : subgroups) {
+                size_t read = 0;
+                placed = same_content(paths[subgroup.front()], paths[i], static_cast<uint64_t>(sizes[i]), read);
+                bytes_read += read;
+                if (placed) {
+                    subgroup.push_back(i);
+                    break;
+                }
+            }
+            if (!placed) {
+                hash_collisions += subgroups.empty() ? 0 : 1;
+                subgroups.push_back({i});
+            }
+        }
+    }
+    result.stats.hash_collisions = hash_collisions;
+    result.stats.bytes_read = bytes_read;
+
+    for (auto& subgroups : confirmed) {
+        for (auto& subgroup : subgroups) {
+            if (subgroup.size() > 1) {
+                result.stats.identical_files += subgroup.size() - 1;
+                result.groups.push_back(std::move(subgroup));
+            }
+        }
+    }
+
+    std::sort(result.groups.begin(), result.groups.end(),
+              [](const std::vector<size_t>& a, const std::vector<size_t>& b) { return a.front() < b.front(); });
+    result.stats.groups = result.groups.size();
+
+    return result;
+}
+
+int64_t IdenticalFileFinder::file_size(const std::string& path) {
+#ifdef _WIN32
+    struct _stat64 info;
+    if (_stat64(path.c_str(), &info) != 0 || (info.st_mode & _S_IFREG) == 0) {
+        return -1;
+    }
+#else
+    struct stat info;
+    if (stat(path.c_str(), &info) != 0 || !S_ISREG(info.st_mode)) {
+        return -1;
+    }
+#endif
+    return static_cast<int64_t>(info.st_size);
+}
+
+bool IdenticalFileFinder::sampled_hash(const std::string& path, uint64_t size, uint64_t& hash, size_t& bytes_read) const {
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+    if (!file) {
+        return false;
+    }
+
+    bool ok = true;
+    hash = size;
+
+    if (size <= sampled_coverage()) {
+        std::vector<uint8_t> buffer(static_cast<size_t>(size));
+        ok = read_at(file, 0, buffer.data(), buffer.size());
+        hash = ContentHash::hash(buffer.data(), buffer.size(), hash);
+        bytes_read += buffer.size();
+    } else {
+        const uint64_t block = config_.sample_block_bytes;
+        const uint64_t offsets[SAMPLE_BLOCKS] = {0, (size - block) / 2, size - block};
+
+        std::vector<uint8_t> buffer(config_.sample_block_bytes);
+        for (size_t b = 0; b < SAMPLE_BLOCKS && ok; ++b) {
+            ok = read_at(file, offsets[b], buffer.data(), buffer.size());
+            hash = ContentHash::hash(buffer.data(), buffer.size(), hash);
+            bytes_read += buffer.size();
+        }
+    }
+
+    std::fclose(file);
+    return ok;
+}
+
+bool IdenticalFileFinder::full_hash(const std::string& path, uint64_t size, uint64_t& hash, size_t& bytes_read) const {
+    std::FILE* file = std::fopen(path.c_str(), "rb");
+    if (!file) {
+        return false;
+    }
+
+    // Chain chunk hashes so the whole file is covered without holding it in memory
+    std::vector<uint8_t> buffer(config_.full_hash_chunk_bytes);
+    hash = size;
+    uint64_t remaining = size;
+    bool ok = true;
+
+    while (remaining > 0 && ok) {
+        const size_t chunk = static_cast<size_t>(std::min<uint64_t>(remaining, buffer.size()));
+        ok = std::fread(buffer.data(), 1, chunk, file) == chunk;
+        hash = ContentHash::hash(buffer.data(), chunk, hash);
+        bytes_read += chunk;
+        remaining -= chunk;
+    }
+
+    // A file that grew since it was stat'ed is not comparable by size any more
+    ok = ok && std::fgetc(file) == EOF;
+
+    std::fclose(file);
+    return ok;
+}
+
+bool IdenticalFileFinder::same_content(const std::string& path_a, const std::string& path_b, uint64_t size,
+                                       size_t& bytes_read) const {
+    std::FILE* file_a = std::fopen(path_a.c_str(), "rb");
+    if (!file_a) {
+        return false;
+    }
+    std::FILE* file_b = std::fopen(path_b.c_str(), "rb");
+    if (!file_b) {
+        std::fclose(file_a);
+        return false;
+    }
+
+    std::vector<uint8_t> buffer_a(config_.full_hash_chunk_bytes);
+    std::vector<uint8_t> buffer_b(config_.full_hash_chunk_bytes);
+    uint64_t remaining = size;
+    bool same = true;
+
+    while (remaining > 0 && same) {
+        const size_t chunk = static_cast<size_t>(std::min<uint64_t>(remaining, buffer_a.size()));
+        same = std::fread(buffer_a.data(), 1, chunk, file_a) == chunk &&
+               std::fread(buffer_b.data(), 1, chunk, file_b) == chunk &&
+               std::memcmp(buffer_a.data(), buffer_b.data(), chunk) == 0;
+        bytes_read += 2 * chunk;
+        remaining -= chunk;
+    }
+
+    std::fclose(file_a);
+    std::fclose(file_b);
+    return same;
+}
+
+bool IdenticalFileFinder::read_at(std::FILE* file, uint64_t offset, uint8_t* buffer, size_t size) {
+#ifdef _WIN32
+    if (_fseeki64(file, static_cast<__int64>(offset), SEEK_SET) != 0) {
+        return false;
+    }
+#else
+    if (fseeko(file, static_cast<off_t>(offset), SEEK_SET) != 0) {
+        return false;
+    }
+#endif
+    return std::fread(buffer, 1, size, file) == size;
+}
+
+} // namespace AudioDuplicates
@@ -0,0 +1,71 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstdio>
+#include <cstddef>
+
+namespace AudioDuplicates {
+
+struct IdenticalFileConfig {
+    size_t sample_block_bytes = 64 * 1024; // Bytes hashed at the head, middle and tail of each file
+    size_t full_hash_chunk_bytes = 1 << 20; // Read size while hashing whole files
+    size_t num_threads = 0;                 // 0 = OpenMP default
+};
+
+struct IdenticalFileStats {
+    size_t files;
+    size_t size_matches;    // Files sharing their size with another file
+    size_t sampled_hashes;  // Files whose sampled blocks were hashed
+    size_t full_hashes;     // Files hashed in full after a sampled-hash collision
+    size_t bytes_read;
+    size_t groups;          // Sets of two or more byte-identical files
+    size_t hash_collisions; // Files whose hashes matched a group but whose bytes did not
+    size_t identical_files; // Files in those sets besides the representative (decodes that can be skipped)
+    size_t unreadable;      // Files that could not be opened or read (never grouped)
+};
+
+struct IdenticalFileResult {
+    // Indices into the input paths; each group is sorted and its first entry is the representative
+    std::vector<std::vector<size_t>> groups;
+    IdenticalFileStats stats;
+};
+
+/**
+ * Byte-level exact-copy detection that runs before any audio is decoded
+ * Files are grouped by size, then by a hash of a few sampled blocks, and only
+ * files that still collide are hashed in full, so unique files cost a stat and
+ * at most three small reads. Files left with equal hashes are compared byte for
+ * byte against their group's representative before being reported. Empty files
+ * are never grouped
+ */
+class IdenticalFileFinder {
+public:
+    explicit IdenticalFileFinder(const IdenticalFileConfig& config = IdenticalFileConfig{});
+
+    IdenticalFileResult find(const std::vector<std::string>& paths) const;
+
+private:
+    IdenticalFileConfig config_;
+
+    static constexpr size_t SAMPLE_BLOCKS = 3;
+
+    // File size, or -1 when the file cannot be stat'ed
+    static int64_t file_size(const std::string& path);
+
+    // Hash of the sampled blocks (the whole file when it is no larger than the
+    // samples); returns false on read errors
+    bool sampled_hash(const std::string& path, uint64_t size, uint64_t& hash, size_t& bytes_read) const;
+    bool full_hash(const std::string& path, uint64_t size, uint64_t& hash, size_t& bytes_read) const;
+
+    // Whether two files of the given size hold the same bytes; false on read errors
+    bool same_content(const std::string& path_a, const std::string& path_b, uint64_t size, size_t& bytes_read) const;
+
+    // Files no larger than this are covered entirely by their sampled hash
+    uint64_t sampled_coverage() const { return static_cast<uint64_t>(config_.sample_block_bytes) * SAMPLE_BLOCKS; }
+
+    static bool read_at(std::FILE* file, uint64_t offset, uint8_t* buffer, size_t size);
+};
+
+} // namespace AudioDuplicates
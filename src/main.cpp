@@ -2,6 +2,8 @@
 #include <memory>
 #include <vector>
 #include <string>
+#include <chrono>
+#include <algorithm>
 #include "chromaprint_wrapper.h"
 #include "fingerprint_comparator.h"
 #include "fingerprint_index.h"
@@ -9,6 +11,11 @@
 #include "compressed_fingerprint.h"
 #include "audio_memory_pool.h"
 #include "streaming_audio_loader.h"
+#include "identical_files.h"
+#include "pcm_decoder.h"
+#include "fingerprint_pipeline.h"
+#include "disk_order.h"
+#include "two_tier_scan.h"
 
 using namespace Napi;
 using namespace AudioDuplicates;
@@ -66,11 +73,83 @@ Object CompressedFingerprintToJS(Env env, const CompressedFingerprint& cfp) {
     jsFingerprint.Set("sampleRate", Number::New(env, cfp.getSampleRate()));
     jsFingerprint.Set("duration", Number::New(env, cfp.getDuration()));
     jsFingerprint.Set("filePath", String::New(env, cfp.getFilePath()));
+    jsFingerprint.Set("codec", String::New(env, cfp.getCodec() == FingerprintCodec::XorDelta ? "xor-delta" : "lz4"));
     jsFingerprint.Set("isCompressed", Boolean::New(env, true));
 
     return jsFingerprint;
 }
 
+// Helper function to convert a sampled fingerprint to JS object
+Object SampledFingerprintToJS(Env env, const SampledFingerprint& fp) {
+    Object jsFingerprint = Object::New(env);
+
+    Array jsData = Array::New(env, fp.data.size());
+    for (size_t i = 0; i < fp.data.size(); ++i) {
+        jsData[i] = Number::New(env, fp.data[i]);
+    }
+    Array jsOffsets = Array::New(env, fp.span_offsets.size());
+    for (size_t i = 0; i < fp.span_offsets.size(); ++i) {
+        jsOffsets[i] = Number::New(env, fp.span_offsets[i]);
+    }
+    Array jsStarts = Array::New(env, fp.span_starts.size());
+    for (size_t i = 0; i < fp.span_starts.size(); ++i) {
+        jsStarts[i] = Number::New(env, fp.span_starts[i]);
+    }
+
+    jsFingerprint.Set("data", jsData);
+    jsFingerprint.Set("spanOffsets", jsOffsets);
+    jsFingerprint.Set("spanStarts", jsStarts);
+    jsFingerprint.Set("itemsPerSecond", Number::New(env, fp.items_per_second));
+    jsFingerprint.Set("sampleRate", Number::New(env, fp.sample_rate));
+    jsFingerprint.Set("duration", Number::New(env, fp.duration));
+    jsFingerprint.Set("decodedSeconds", Number::New(env, fp.decoded_seconds));
+    jsFingerprint.Set("filePath", String::New(env, fp.file_path));
+    jsFingerprint.Set("isSampled", Boolean::New(env, true));
+
+    return jsFingerprint;
+}
+
+// Helper function to convert JS sampled fingerprint object to C++
+std::unique_ptr<SampledFingerprint> JSToSampledFingerprint(const Object& jsFingerprint) {
+    auto fp = std::make_unique<SampledFingerprint>();
+
+    Array jsData = jsFingerprint.Get("data").As<Array>();
+    fp->data.reserve(jsData.Length());
+    for (uint32_t i = 0; i < jsData.Length(); ++i) {
+        fp->data.push_back(jsData.Get(i).As<Number>().Uint32Value());
+    }
+    Array jsOffsets = jsFingerprint.Get("spanOffsets").As<Array>();
+    for (uint32_t i = 0; i < jsOffsets.Length(); ++i) {
+        fp->span_offsets.push_back(jsOffsets.Get(i).As<Number>().Uint32Value());
+    }
+    Array jsStarts = jsFingerprint.Get("spanStarts").As<Array>();
+    for (uint32_t i = 0; i < jsStarts.Length(); ++i) {
+        fp->span_starts.push_back(jsStarts.Get(i).As<Number>().DoubleValue());
+    }
+
+    if (fp->span_offsets.size() != fp->span_starts.size() + 1 ||
+        (!fp->span_offsets.empty() && fp->span_offsets.back() != fp->data.size())) {
+        throw std::invalid_argument("Sampled fingerprint spans do not match its data");
+    }
+    for (size_t i = 1; i < fp->span_offsets.size(); ++i) {
+        if (fp->span_offsets[i] < fp->span_offsets[i - 1]) {
+            throw std::invalid_argument("Sampled fingerprint span offsets must be ascending");
+        }
+    }
+
+    fp->items_per_second = jsFingerprint.Get("itemsPerSecond").As<Number>().DoubleValue();
+    if (fp->items_per_second <= 0.0) {
+        throw std::invalid_argument("Sampled fingerprint needs a positive itemsPerSecond");
+    }
+    fp->sample_rate = jsFingerprint.Get("sampleRate").As<Number>().Int32Value();
+    fp->duration = jsFingerprint.Get("duration").As<Number>().DoubleValue();
+    fp->decoded_seconds = jsFingerprint.Has("decodedSeconds")
+        ? jsFingerprint.Get("decodedSeconds").As<Number>().DoubleValue() : 0.0;
+    fp->file_path = jsFingerprint.Get("filePath").As<String>().Utf8Value();
+
+    return fp;
+}
+
 // Helper function to get fingerprint from JS object (handles both regular and compressed)
 std::unique_ptr<Fingerprint> JSToFingerprintAny(const Object& jsFingerprint) {
     // Check if this is a compressed fingerprint
@@ -206,6 +285,119 @@ Value GenerateFingerprintLimited(const CallbackInfo& info) {
     }
 }
 
+// Fingerprint long recordings as overlapping segments on several threads
+Value ConfigureSegmentedFingerprinting(const CallbackInfo& info) {
+    Env env = info.Env();
+
+    if (!g_streaming_loader) {
+        g_streaming_loader = std::make_unique<StreamingAudioLoader>();
+    }
+
+    StreamingAudioLoader::SegmentConfig config = g_streaming_loader->getSegmentConfig();
+    config.enabled = true;
+
+    if (info.Length() > 0 && info[0].IsObject()) {
+        Object options = info[0].As<Object>();
+        if (options.Has("enabled")) {
+            config.enabled = options.Get("enabled").As<Boolean>().Value();
+        }
+        if (options.Has("minFileSeconds")) {
+            config.min_file_seconds = options.Get("minFileSeconds").As<Number>().DoubleValue();
+        }
+        if (options.Has("segmentSeconds")) {
+            config.segment_seconds = options.Get("segmentSeconds").As<Number>().DoubleValue();
+        }
+        if (options.Has("overlapSeconds")) {
+            config.overlap_seconds = options.Get("overlapSeconds").As<Number>().DoubleValue();
+        }
+        if (options.Has("maxThreads")) {
+            config.max_threads = options.Get("maxThreads").As<Number>().Uint32Value();
+        }
+    }
+
+    g_streaming_loader->setSegmentConfig(config);
+    return Boolean::New(env, true);
+}
+
+// Coarse fingerprint of short spans around fixed positions (head/middle/tail by default)
+Value GenerateSampledFingerprint(const CallbackInfo& info) {
+    Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsString()) {
+        TypeError::New(env, "Expected string file path").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    std::string filePath = info[0].As<String>().Utf8Value();
+
+    StreamingAudioLoader::SampleConfig config;
+    if (info.Length() > 1 && info[1].IsObject()) {
+        Object options = info[1].As<Object>();
+        if (options.Has("positions")) {
+            Array positions = options.Get("positions").As<Array>();
+            config.positions.clear();
+            for (uint32_t i = 0; i < positions.Length(); ++i) {
+                config.positions.push_back(positions.Get(i).As<Number>().DoubleValue());
+            }
+        }
+        if (options.Has("spanSeconds")) {
+            config.span_seconds = options.Get("spanSeconds").As<Number>().DoubleValue();
+        }
+    }
+
+    try {
+        if (!g_streaming_loader) {
+            g_streaming_loader = std::make_unique<StreamingAudioLoader>();
+        }
+
+        auto sampled = g_streaming_loader->generateSampledFingerprint(filePath, config);
+        return SampledFingerprintToJS(env, *sampled);
+    } catch (const std::exception& e) {
+        Error::New(env, e.what()).ThrowAsJavaScriptException();
+        return env.Null();
+    }
+}
+
+// Compare two sampled fingerprints span by span
+Value CompareSampledFingerprints(const CallbackInfo& info) {
+    Env env = info.Env();
+
+    if (info.Length() < 2 || !info[0].IsObject() || !info[1].IsObject()) {
+        TypeError::New(env, "Expected two sampled fingerprint objects").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    try {
+        auto fp1 = JSToSampledFingerprint(info[0].As<Object>());
+        auto fp2 = JSToSampledFingerprint(info[1].As<Object>());
+
+        FingerprintComparator comparator;
+        MatchResult result = comparator.compare_sampled(*fp1, *fp2);
+
+        Object jsResult = Object::New(env);
+        jsResult.Set("similarityScore", Number::New(env, result.similarity_score));
+        jsResult.Set("bestOffset", Number::New(env, result.best_offset));
+        jsResult.Set("matchedSegments", Number::New(env, result.matched_segments));
+        jsResult.Set("bitErrorRate", Number::New(env, result.bit_error_rate));
+        jsResult.Set("isDuplicate", Boolean::New(env, result.is_duplicate));
+        jsResult.Set("coverageRatio", Number::New(env, result.coverage_ratio));
+
+        Array segmentMatches = Array::New(env, result.segment_matches.size());
+        for (size_t i = 0; i < result.segment_matches.size(); ++i) {
+            Object match = Object::New(env);
+            match.Set("offset", Number::New(env, result.segment_matches[i].first));
+            match.Set("similarity", Number::New(env, result.segment_matches[i].second));
+            segmentMatches[i] = match;
+        }
+        jsResult.Set("segmentMatches", segmentMatches);
+
+        return jsResult;
+    } catch (const std::exception& e) {
+        Error::New(env, e.what()).ThrowAsJavaScriptException();
+        return env.Null();
+    }
+}
+
 // Generate fingerprint with preprocessing
 Value GenerateFingerprintWithPreprocessing(const CallbackInfo& info) {
     Env env = info.Env();
@@ -231,100 +423,1084 @@ Value GenerateFingerprintWithPreprocessing(const CallbackInfo& info) {
         Error::New(env, e.what()).ThrowAsJavaScriptException();
         return env.Null();
     }
-}
-
-// Test preprocessing on audio file
-Value TestPreprocessing(const CallbackInfo& info) {
-    Env env = info.Env();
+}
+
+// Test preprocessing on audio file
+Value TestPreprocessing(const CallbackInfo& info) {
+    Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsString()) {
+        TypeError::New(env, "Expected string file path").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    std::string filePath = info[0].As<String>().Utf8Value();
+    PreprocessConfig config; // Use default config
+
+    // Check if preprocessing config is provided
+    if (info.Length() >= 2 && info[1].IsObject()) {
+        config = JSToPreprocessConfig(info[1].As<Object>());
+    }
+
+    try {
+        AudioLoader loader;
+        auto original = loader.load(filePath);
+        auto processed = loader.load_with_preprocessing(filePath, &config);
+
+        Object result = Object::New(env);
+
+        // Original audio info
+        Object originalInfo = Object::New(env);
+        originalInfo.Set("sampleRate", Number::New(env, original->sample_rate));
+        originalInfo.Set("duration", Number::New(env, original->duration));
+        originalInfo.Set("samples", Number::New(env, original->samples.size()));
+
+        // Processed audio info
+        Object processedInfo = Object::New(env);
+        processedInfo.Set("sampleRate", Number::New(env, processed->sample_rate));
+        processedInfo.Set("duration", Number::New(env, processed->duration));
+        processedInfo.Set("samples", Number::New(env, processed->samples.size()));
+
+        result.Set("original", originalInfo);
+        result.Set("processed", processedInfo);
+
+        return result;
+    } catch (const std::exception& e) {
+        Error::New(env, e.what()).ThrowAsJavaScriptException();
+        return env.Null();
+    }
+}
+
+// Compare two fingerprints
+Value CompareFingerprints(const CallbackInfo& info) {
+    Env env = info.Env();
+
+    if (info.Length() < 2 || !info[0].IsObject() || !info[1].IsObject()) {
+        TypeError::New(env, "Expected two fingerprint objects").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    try {
+        auto fp1 = JSToFingerprintAny(info[0].As<Object>());
+        auto fp2 = JSToFingerprintAny(info[1].As<Object>());
+
+        FingerprintComparator comparator;
+        auto result = comparator.compare(*fp1, *fp2);
+
+        Object jsResult = Object::New(env);
+        jsResult.Set("similarityScore", Number::New(env, result.similarity_score));
+        jsResult.Set("bestOffset", Number::New(env, result.best_offset));
+        jsResult.Set("matchedSegments", Number::New(env, result.matched_segments));
+        jsResult.Set("bitErrorRate", Number::New(env, result.bit_error_rate));
+        jsResult.Set("isDuplicate", Boolean::New(env, result.is_duplicate));
+        jsResult.Set("coverageRatio", Number::New(env, result.coverage_ratio));
+
+        return jsResult;
+    } catch (const std::exception& e) {
+        Error::New(env, e.what()).ThrowAsJavaScriptException();
+        return env.Null();
+    }
+}
+
+// Compare two fingerprints near a known offset, optionally on their compressed blocks
+Value CompareFingerprintsAtOffset(const CallbackInfo& info) {
+    Env env = info.Env();
+
+    if (info.Length() < 3 || !info[0].IsObject() || !info[1].IsObject() || !info[2].IsNumber()) {
+        TypeError::New(env, "Expected two fingerprint objects and an offset hint").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    bool compressed = false;
+    if (info.Length() > 3 && info[3].IsObject()) {
+        Object options = info[3].As<Object>();
+        if (options.Has("compressed")) {
+            compressed = options.Get("compressed").As<Boolean>().Value();
+        }
+    }
+
+    try {
+        auto fp1 = JSToFingerprintAny(info[0].As<Object>());
+        auto fp2 = JSToFingerprintAny(info[1].As<Object>());
+        const int offsetHint = info[2].As<Number>().Int32Value();
+
+        FingerprintComparator comparator;
+        MatchResult result;
+        size_t blocksDecoded = 0;
+        if (compressed) {
+            auto cfp1 = CompressedFingerprint::compress(*fp1);
+            auto cfp2 = CompressedFingerprint::compress(*fp2);
+            result = comparator.compare_compressed(*cfp1, *cfp2, offsetHint, &blocksDecoded);
+        } else {
+            result = comparator.compare_with_offset_hint(*fp1, *fp2, offsetHint);
+        }
+
+        Object jsResult = Object::New(env);
+        jsResult.Set("similarityScore", Number::New(env, result.similarity_score));
+        jsResult.Set("bestOffset", Number::New(env, result.best_offset));
+        jsResult.Set("matchedSegments", Number::New(env, result.matched_segments));
+        jsResult.Set("bitErrorRate", Number::New(env, result.bit_error_rate));
+        jsResult.Set("isDuplicate", Boolean::New(env, result.is_duplicate));
+        if (compressed) {
+            jsResult.Set("blocksDecoded", Number::New(env, blocksDecoded));
+        }
+
+        return jsResult;
+    } catch (const std::exception& e) {
+        Error::New(env, e.what()).ThrowAsJavaScriptException();
+        return env.Null();
+    }
+}
+
+// Every block decoded on its own matches the same slice of the full decode
+bool BlocksMatchDecode(const CompressedFingerprint& compressed, const std::vector<uint32_t>& frames) {
+    const size_t block_frames = CompressedFingerprint::BLOCK_FRAMES;
+    std::vector<uint32_t> block(block_frames);
+    for (size_t b = 0; b < compressed.getBlockCount(); ++b) {
+        const size_t first = b * block_frames;
+        const size_t count = std::min(block_frames, frames.size() - first);
+        compressed.decompress_block(b, block.data());
+        if (!std::equal(block.begin(), block.begin() + count, frames.begin() + first)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Ranges straddling every block boundary, inside the partial last block and past
+// the end match the same (clamped) slices of the full decode
+bool RangesMatchDecode(const CompressedFingerprint& compressed, const std::vector<uint32_t>& frames) {
+    const size_t block_frames = CompressedFingerprint::BLOCK_FRAMES;
+    const size_t n = frames.size();
+    if (n == 0) {
+        return true;
+    }
+    const size_t last_block = (compressed.getBlockCount() - 1) * block_frames;
+
+    std::vector<std::pair<size_t, size_t>> ranges = {
+        {0, n}, {n / 3, n / 3}, {n - 1, 1}, {n - std::min<size_t>(n, 5), 10}, {n, 4},
+        {last_block, n - last_block}, {last_block + (n - last_block) / 2, block_frames}
+    };
+    for (size_t boundary = block_frames; boundary < n; boundary += block_frames) {
+        ranges.push_back({boundary - 1, 2});
+        ranges.push_back({boundary - 3, block_frames + 4});
+        ranges.push_back({boundary, block_frames});
+    }
+
+    std::vector<uint32_t> out;
+    for (const auto& range : ranges) {
+        const size_t start = std::min(range.first, n);
+        const size_t expected = std::min(range.second, n - start);
+        if (compressed.decompress_range(range.first, range.second, out) != expected || out.size() != expected ||
+            !std::equal(out.begin(), out.end(), frames.begin() + start)) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Moving a blob hands its bytes to the destination and leaves the source empty
+// (isValid() false), through both the move constructor and move assignment
+bool MovesLeaveSourceEmpty(CompressedFingerprint& source, const std::vector<uint32_t>& frames) {
+    if (!source.isValid()) {
+        return false;
+    }
+
+    CompressedFingerprint constructed(std::move(source));
+    if (source.isValid() || source.getCompressedSize() != 0 || constructed.decompress()->data != frames) {
+        return false;
+    }
+
+    CompressedFingerprint assigned;
+    assigned = std::move(constructed);
+    return !constructed.isValid() && constructed.getCompressedSize() == 0 && assigned.decompress()->data == frames;
+}
+
+// Compare fingerprint codecs on one fingerprint: compressed size and decode throughput
+Value BenchmarkFingerprintCodecs(const CallbackInfo& info) {
+    Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsObject()) {
+        TypeError::New(env, "Expected fingerprint object").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    size_t iterations = 100;
+    if (info.Length() > 1 && info[1].IsNumber()) {
+        iterations = std::max<size_t>(1, info[1].As<Number>().Uint32Value());
+    }
+
+    try {
+        auto fingerprint = JSToFingerprintAny(info[0].As<Object>());
+
+        const std::pair<FingerprintCodec, const char*> codecs[] = {
+            {FingerprintCodec::LZ4, "lz4"},
+            {FingerprintCodec::XorDelta, "xor-delta"}
+        };
+
+        Array jsResults = Array::New(env, 2);
+        for (size_t i = 0; i < 2; ++i) {
+            auto compressed = CompressedFingerprint::compress(*fingerprint, codecs[i].first);
+            const bool lossless = compressed->decompress()->data == fingerprint->data;
+
+            auto start = std::chrono::steady_clock::now();
+            for (size_t iter = 0; iter < iterations; ++iter) {
+                compressed->decompress();
+            }
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+            double decoded_bytes = static_cast<double>(compressed->getOriginalSize()) * iterations;
+
+            Object jsResult = Object::New(env);
+            jsResult.Set("codec", String::New(env, codecs[i].second));
+            jsResult.Set("compressedSize", Number::New(env, compressed->getCompressedSize()));
+            jsResult.Set("originalSize", Number::New(env, compressed->getOriginalSize()));
+            jsResult.Set("compressionRatio", Number::New(env, compressed->getCompressionRatio()));
+            jsResult.Set("decodeGBps", Number::New(env, seconds > 0.0 ? decoded_bytes / seconds / 1e9 : 0.0));
+            jsResult.Set("lossless", Boolean::New(env, lossless));
+            jsResult.Set("blocksMatch", Boolean::New(env, lossless && BlocksMatchDecode(*compressed, fingerprint->data)));
+            jsResult.Set("rangesMatch", Boolean::New(env, lossless && RangesMatchDecode(*compressed, fingerprint->data)));
+
+            // Owned blobs and views over someone else's bytes both move out completely
+            auto moved = CompressedFingerprint::compress(*fingerprint, codecs[i].first);
+            CompressedFingerprint moved_view = CompressedFingerprint::view(
+                compressed->getData(), compressed->getCompressedSize(), compressed->getOriginalSize(),
+                compressed->getSampleRate(), compressed->getDuration());
+            jsResult.Set("movesLeaveSourceEmpty", Boolean::New(env, lossless &&
+                MovesLeaveSourceEmpty(*moved, fingerprint->data) && MovesLeaveSourceEmpty(moved_view, fingerprint->data)));
+
+            // A blob written against a trained dictionary must decode through a
+            // store-style view given that dictionary
+            auto dictionary = FingerprintDictionary::train({fingerprint.get()}, codecs[i].first);
+            if (dictionary) {
+                auto with_dictionary = CompressedFingerprint::compress(*fingerprint, codecs[i].first, dictionary);
+                const CompressedFingerprint view = CompressedFingerprint::view(
+                    with_dictionary->getData(), with_dictionary->getCompressedSize(), with_dictionary->getOriginalSize(),
+                    with_dictionary->getSampleRate(), with_dictionary->getDuration(), dictionary.get());
+                const bool dictionary_lossless = with_dictionary->usesDictionary() &&
+                    view.decompress()->data == fingerprint->data &&
+                    RangesMatchDecode(view, fingerprint->data);
+                jsResult.Set("dictionaryLossless", Boolean::New(env, dictionary_lossless));
+            } else {
+                jsResult.Set("dictionaryLossless", env.Null());
+            }
+            jsResults[i] = jsResult;
+        }
+
+        return jsResults;
+    } catch (const std::exception& e) {
+        Error::New(env, e.what()).ThrowAsJavaScriptException();
+        return env.Null();
+    }
+}
+
+// Benchmark PCM decoding through the WAV mapping against libsndfile
+Value BenchmarkPcmReaders(const CallbackInfo& info) {
+    Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsArray()) {
+        TypeError::New(env, "Expected array of file paths").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    Array filePaths = info[0].As<Array>();
+    bool coldCache = false;
+    if (info.Length() > 1 && info[1].IsBoolean()) {
+        coldCache = info[1].As<Boolean>().Value();
+    }
+
+    try {
+        std::vector<std::string> paths;
+        paths.reserve(filePaths.Length());
+        for (uint32_t i = 0; i < filePaths.Length(); ++i) {
+            paths.push_back(filePaths.Get(i).As<String>().Utf8Value());
+        }
+
+        const std::pair<bool, const char*> readers[] = {
+            {true, "mapped"},
+            {false, "sndfile"}
+        };
+
+        Array jsResults = Array::New(env, 2);
+        for (size_t r = 0; r < 2; ++r) {
+            PcmDecoder decoder;
+            decoder.set_mapped_reader(readers[r].first);
+
+            size_t files = 0;
+            size_t mappedFiles = 0;
+            size_t evicted = 0;
+            double bytes = 0.0;
+            double seconds = 0.0;
+            for (const auto& path : paths) {
+                if (coldCache && WavFile::evict_page_cache(path)) {
+                    evicted++;
+                }
+
+                try {
+                    auto start = std::chrono::steady_clock::now();
+                    PcmDecodeProgress progress = decoder.decode(
+                        path, 11025, 0, PcmDecoder::DEFAULT_CHUNK_BYTES,
+                        [](const int16_t*, size_t, const PcmDecodeProgress&) {});
+                    seconds += std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+                    files++;
+                    mappedFiles += progress.mapped ? 1 : 0;
+                    bytes += static_cast<double>(progress.bytes_decoded);
+                } catch (const std::exception&) {
+                    // Unreadable files are left out of both readers' totals alike
+                }
+            }
+
+            Object jsResult = Object::New(env);
+            jsResult.Set("reader", String::New(env, readers[r].second));
+            jsResult.Set("files", Number::New(env, files));
+            jsResult.Set("mappedFiles", Number::New(env, mappedFiles));
+            jsResult.Set("evictedFiles", Number::New(env, evicted));
+            jsResult.Set("bytes", Number::New(env, bytes));
+            jsResult.Set("seconds", Number::New(env, seconds));
+            jsResult.Set("MBps", Number::New(env, seconds > 0.0 ? bytes / seconds / 1e6 : 0.0));
+            jsResults[r] = jsResult;
+        }
+
+        return jsResults;
+    } catch (const std::exception& e) {
+        Error::New(env, e.what()).ThrowAsJavaScriptException();
+        return env.Null();
+    }
+}
+
+// Decode a file to int16 mono through PcmDecoder, with the reader, integer path
+// and chunk size selectable so the paths can be checked against each other
+Value DecodePcm(const CallbackInfo& info) {
+    Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsString()) {
+        TypeError::New(env, "Expected file path string").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    std::string path = info[0].As<String>().Utf8Value();
+    int sampleRate = 11025;
+    int maxDuration = 0;
+    size_t chunkBytes = PcmDecoder::DEFAULT_CHUNK_BYTES;
+    PcmDecoder decoder;
+    if (info.Length() > 1 && info[1].IsObject()) {
+        Object options = info[1].As<Object>();
+        if (options.Has("sampleRate")) {
+            sampleRate = options.Get("sampleRate").As<Number>().Int32Value();
+        }
+        if (options.Has("maxDuration")) {
+            maxDuration = options.Get("maxDuration").As<Number>().Int32Value();
+        }
+        if (options.Has("chunkBytes")) {
+            chunkBytes = std::max<size_t>(1, options.Get("chunkBytes").As<Number>().Uint32Value());
+        }
+        if (options.Has("integerPath")) {
+            decoder.set_integer_path(options.Get("integerPath").As<Boolean>().Value());
+        }
+        if (options.Has("mappedReader")) {
+            decoder.set_mapped_reader(options.Get("mappedReader").As<Boolean>().Value());
+        }
+    }
+
+    if (sampleRate <= 0) {
+        TypeError::New(env, "sampleRate must be positive").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    try {
+        std::vector<int16_t> samples;
+        PcmDecodeProgress progress = decoder.decode(
+            path, sampleRate, maxDuration, chunkBytes,
+            [&samples](const int16_t* chunk, size_t count, const PcmDecodeProgress&) {
+                samples.insert(samples.end(), chunk, chunk + count);
+            });
+
+        Int16Array jsSamples = Int16Array::New(env, samples.size());
+        std::copy(samples.begin(), samples.end(), jsSamples.Data());
+
+        Object jsResult = Object::New(env);
+        jsResult.Set("samples", jsSamples);
+        jsResult.Set("sampleRate", Number::New(env, sampleRate));
+        jsResult.Set("sourceRate", Number::New(env, progress.source_rate));
+        jsResult.Set("channels", Number::New(env, progress.channels));
+        jsResult.Set("integerPath", Boolean::New(env, progress.integer_path));
+        jsResult.Set("mapped", Boolean::New(env, progress.mapped));
+        return jsResult;
+    } catch (const std::exception& e) {
+        Error::New(env, e.what()).ThrowAsJavaScriptException();
+        return env.Null();
+    }
+}
+
+// Initialize index
+Value InitializeIndex(const CallbackInfo& info) {
+    Env env = info.Env();
+
+    try {
+        g_index = std::make_unique<FingerprintIndex>();
+        return Boolean::New(env, true);
+    } catch (const std::exception& e) {
+        Error::New(env, e.what()).ThrowAsJavaScriptException();
+        return Boolean::New(env, false);
+    }
+}
+
+// Add file to index
+Value AddFileToIndex(const CallbackInfo& info) {
+    Env env = info.Env();
+
+    if (!g_index) {
+        Error::New(env, "Index not initialized").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    if (info.Length() < 1 || !info[0].IsString()) {
+        TypeError::New(env, "Expected string file path").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    std::string filePath = info[0].As<String>().Utf8Value();
+
+    try {
+        // Use streaming loader to generate compressed fingerprint
+        if (!g_streaming_loader) {
+            g_streaming_loader = std::make_unique<StreamingAudioLoader>();
+        }
+
+        auto compressed_fp = g_streaming_loader->generateStreamingFingerprint(filePath);
+        if (!compressed_fp || !compressed_fp->isValid()) {
+            Error::New(env, "Failed to generate fingerprint for " + filePath).ThrowAsJavaScriptException();
+            return env.Null();
+        }
+
+        size_t fileId = g_index->add_file(filePath, std::move(compressed_fp));
+        return Number::New(env, fileId);
+    } catch (const std::exception& e) {
+        Error::New(env, e.what()).ThrowAsJavaScriptException();
+        return env.Null();
+    }
+}
+
+// Add a file that is byte-identical to an indexed file without decoding it
+Value AddIdenticalFileToIndex(const CallbackInfo& info) {
+    Env env = info.Env();
+
+    if (!g_index) {
+        Error::New(env, "Index not initialized").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    if (info.Length() < 2 || !info[0].IsString() || !info[1].IsNumber()) {
+        TypeError::New(env, "Expected string file path and source file id").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    std::string filePath = info[0].As<String>().Utf8Value();
+    size_t sourceFileId = info[1].As<Number>().Uint32Value();
+
+    try {
+        size_t fileId = g_index->add_identical_file(filePath, sourceFileId);
+        return Number::New(env, fileId);
+    } catch (const std::exception& e) {
+        Error::New(env, e.what()).ThrowAsJavaScriptException();
+        return env.Null();
+    }
+}
+
+// Group byte-identical files by size, sampled hash and full hash before any decoding
+Value FindIdenticalFiles(const CallbackInfo& info) {
+    Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsArray()) {
+        TypeError::New(env, "First argument must be an array of file paths").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    Array filePaths = info[0].As<Array>();
+    std::vector<std::string> paths;
+    paths.reserve(filePaths.Length());
+    for (uint32_t i = 0; i < filePaths.Length(); ++i) {
+        paths.push_back(filePaths.Get(i).As<String>().Utf8Value());
+    }
+
+    IdenticalFileConfig config;
+    if (info.Length() > 1 && info[1].IsObject()) {
+        Object options = info[1].As<Object>();
+        if (options.Has("sampleBlockBytes")) {
+            config.sample_block_bytes = options.Get("sampleBlockBytes").As<Number>().Uint32Value();
+        }
+        if (options.Has("numThreads")) {
+            config.num_threads = options.Get("numThreads").As<Number>().Uint32Value();
+        }
+    }
+
+    try {
+        auto result = IdenticalFileFinder(config).find(paths);
+
+        Array jsGroups = Array::New(env, result.groups.size());
+        for (size_t i = 0; i < result.groups.size(); ++i) {
+            const auto& group = result.groups[i];
+            Array jsGroup = Array::New(env, group.size());
+            for (size_t j = 0; j < group.size(); ++j) {
+                jsGroup[j] = String::New(env, paths[group[j]]);
+            }
+            jsGroups[i] = jsGroup;
+        }
+
+        Object jsStats = Object::New(env);
+        jsStats.Set("files", Number::New(env, result.stats.files));
+        jsStats.Set("sizeMatches", Number::New(env, result.stats.size_matches));
+        jsStats.Set("sampledHashes", Number::New(env, result.stats.sampled_hashes));
+        jsStats.Set("fullHashes", Number::New(env, result.stats.full_hashes));
+        jsStats.Set("bytesRead", Number::New(env, result.stats.bytes_read));
+        jsStats.Set("groups", Number::New(env, result.stats.groups));
+        jsStats.Set("hashCollisions", Number::New(env, result.stats.hash_collisions));
+        jsStats.Set("identicalFiles", Number::New(env, result.stats.identical_files));
+        jsStats.Set("unreadable", Number::New(env, result.stats.unreadable));
+
+        Object jsResult = Object::New(env);
+        jsResult.Set("groups", jsGroups);
+        jsResult.Set("stats", jsStats);
+        return jsResult;
+    } catch (const std::exception& e) {
+        Error::New(env, e.what()).ThrowAsJavaScriptException();
+        return env.Null();
+    }
+}
+
+// Helper function to convert disk-order statistics to a JS object
+Object DiskOrderStatsToJS(Env env, const DiskOrderStats& stats) {
+    Object jsStats = Object::New(env);
+    jsStats.Set("files", Number::New(env, stats.files));
+    jsStats.Set("extentFiles", Number::New(env, stats.extent_files));
+    jsStats.Set("inodeFiles", Number::New(env, stats.inode_files));
+    jsStats.Set("unknownFiles", Number::New(env, stats.unknown_files));
+    jsStats.Set("seconds", Number::New(env, stats.seconds));
+    return jsStats;
+}
+
+// Order files by their location on disk (first extent, or inode number)
+Value OrderFilesByDiskLayout(const CallbackInfo& info) {
+    Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsArray()) {
+        TypeError::New(env, "First argument must be an array of file paths").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    Array filePaths = info[0].As<Array>();
+    std::vector<std::string> paths;
+    paths.reserve(filePaths.Length());
+    for (uint32_t i = 0; i < filePaths.Length(); ++i) {
+        paths.push_back(filePaths.Get(i).As<String>().Utf8Value());
+    }
+
+    DiskOrderConfig config;
+    if (info.Length() > 1 && info[1].IsObject()) {
+        Object options = info[1].As<Object>();
+        if (options.Has("useExtents")) {
+            config.use_extents = options.Get("useExtents").As<Boolean>().Value();
+        }
+        if (options.Has("numThreads")) {
+            config.num_threads = options.Get("numThreads").As<Number>().Uint32Value();
+        }
+    }
+
+    try {
+        auto result = DiskOrderPlanner(config).plan(paths);
+
+        Array jsFiles = Array::New(env, result.order.size());
+        for (size_t i = 0; i < result.order.size(); ++i) {
+            jsFiles[i] = String::New(env, paths[result.order[i]]);
+        }
+
+        Object jsResult = Object::New(env);
+        jsResult.Set("files", jsFiles);
+        jsResult.Set("stats", DiskOrderStatsToJS(env, result.stats));
+        return jsResult;
+    } catch (const std::exception& e) {
+        Error::New(env, e.what()).ThrowAsJavaScriptException();
+        return env.Null();
+    }
+}
+
+// Drop files from the page cache so the next read comes from the device (benchmarking helper)
+Value EvictPageCache(const CallbackInfo& info) {
+    Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsArray()) {
+        TypeError::New(env, "First argument must be an array of file paths").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    Array filePaths = info[0].As<Array>();
+    size_t evicted = 0;
+    for (uint32_t i = 0; i < filePaths.Length(); ++i) {
+        if (WavFile::evict_page_cache(filePaths.Get(i).As<String>().Utf8Value())) {
+            evicted++;
+        }
+    }
+    return Number::New(env, evicted);
+}
+
+// Fingerprint files through the staged pipeline straight into the index
+Value AddFilesToIndexPipeline(const CallbackInfo& info) {
+    Env env = info.Env();
+
+    if (!g_index) {
+        Error::New(env, "Index not initialized").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    if (info.Length() < 1 || !info[0].IsArray()) {
+        TypeError::New(env, "First argument must be an array of file paths").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    Array filePaths = info[0].As<Array>();
+    std::vector<std::string> paths;
+    paths.reserve(filePaths.Length());
+    for (uint32_t i = 0; i < filePaths.Length(); ++i) {
+        paths.push_back(filePaths.Get(i).As<String>().Utf8Value());
+    }
+
+    PipelineConfig config;
+    if (info.Length() > 1 && info[1].IsObject()) {
+        Object options = info[1].As<Object>();
+        if (options.Has("ioThreads")) {
+            config.io_threads = options.Get("ioThreads").As<Number>().Uint32Value();
+        }
+        if (options.Has("decodeThreads")) {
+            config.decode_threads = options.Get("decodeThreads").As<Number>().Uint32Value();
+        }
+        if (options.Has("dspThreads")) {
+            config.dsp_threads = options.Get("dspThreads").As<Number>().Uint32Value();
+        }
+        if (options.Has("fingerprintThreads")) {
+            config.fingerprint_threads = options.Get("fingerprintThreads").As<Number>().Uint32Value();
+        }
+        if (options.Has("queueCapacity")) {
+            config.queue_capacity = options.Get("queueCapacity").As<Number>().Uint32Value();
+        }
+        if (options.Has("maxBufferedMB")) {
+            config.max_buffered_bytes = static_cast<size_t>(options.Get("maxBufferedMB").As<Number>().DoubleValue() * 1024 * 1024);
+        }
+        if (options.Has("maxDuration")) {
+            config.max_duration_seconds = options.Get("maxDuration").As<Number>().Int32Value();
+        }
+        if (options.Has("prefetchDepth")) {
+            config.prefetch_depth = options.Get("prefetchDepth").As<Number>().Uint32Value();
+        }
+        if (options.Has("prefetchBackend")) {
+            std::string backend = options.Get("prefetchBackend").As<String>().Utf8Value();
+            if (backend == "io_uring") {
+                config.prefetch_backend = PrefetchBackend::IoUring;
+            } else if (backend == "threads") {
+                config.prefetch_backend = PrefetchBackend::Threads;
+            } else if (backend != "auto") {
+                TypeError::New(env, "prefetchBackend must be 'auto', 'io_uring' or 'threads'").ThrowAsJavaScriptException();
+                return env.Null();
+            }
+        }
+        if (options.Has("diskOrder")) {
+            config.disk_order = options.Get("diskOrder").As<Boolean>().Value();
+        }
+    }
+
+    try {
+        FingerprintPipeline pipeline(config);
+        auto result = pipeline.run(paths, *g_index);
+
+        Array jsFileIds = Array::New(env, result.file_ids.size());
+        for (size_t i = 0; i < result.file_ids.size(); ++i) {
+            if (result.file_ids[i] == SIZE_MAX) {
+                jsFileIds[i] = env.Null();
+            } else {
+                jsFileIds[i] = Number::New(env, result.file_ids[i]);
+            }
+        }
+
+        Array jsErrors = Array::New(env, result.errors.size());
+        for (size_t i = 0; i < result.errors.size(); ++i) {
+            const auto& error = result.errors[i];
+            Object jsError = Object::New(env);
+            jsError.Set("filePath", String::New(env, paths[error.input_index]));
+            jsError.Set("stage", String::New(env, error.stage));
+            jsError.Set("error", String::New(env, error.message));
+            jsErrors[i] = jsError;
+        }
+
+        Array jsStages = Array::New(env, result.stages.size());
+        for (size_t i = 0; i < result.stages.size(); ++i) {
+            const auto& stage = result.stages[i];
+            Object jsStage = Object::New(env);
+            jsStage.Set("name", String::New(env, stage.name));
+            jsStage.Set("threads", Number::New(env, stage.threads));
+            jsStage.Set("items", Number::New(env, stage.items));
+            jsStage.Set("busySeconds", Number::New(env, stage.busy_seconds));
+            jsStage.Set("utilisation", Number::New(env, stage.utilisation));
+            jsStages[i] = jsStage;
+        }
+
+        Array jsQueues = Array::New(env, result.queues.size());
+        for (size_t i = 0; i < result.queues.size(); ++i) {
+            const auto& queue = result.queues[i];
+            Object jsQueue = Object::New(env);
+            jsQueue.Set("name", String::New(env, queue.name));
+            jsQueue.Set("capacity", Number::New(env, queue.capacity));
+            jsQueue.Set("maxDepth", Number::New(env, queue.max_depth));
+            jsQueue.Set("meanDepth", Number::New(env, queue.mean_depth));
+            jsQueue.Set("fullRatio", Number::New(env, queue.full_ratio));
+            jsQueues[i] = jsQueue;
+        }
+
+        Object jsStats = Object::New(env);
+        jsStats.Set("wallSeconds", Number::New(env, result.wall_seconds));
+        jsStats.Set("bytesRead", Number::New(env, result.bytes_read));
+        jsStats.Set("peakBufferedBytes", Number::New(env, result.peak_buffered_bytes));
+        jsStats.Set("stages", jsStages);
+        jsStats.Set("queues", jsQueues);
+        if (result.prefetched) {
+            Object jsPrefetch = Object::New(env);
+            jsPrefetch.Set("backend", String::New(env,
+                result.prefetch.backend == PrefetchBackend::IoUring ? "io_uring" : "threads"));
+            jsPrefetch.Set("files", Number::New(env, result.prefetch.files));
+            jsPrefetch.Set("bytes", Number::New(env, result.prefetch.bytes));
+            jsPrefetch.Set("readRequests", Number::New(env, result.prefetch.read_requests));
+            jsPrefetch.Set("consumerWaits", Number::New(env, result.prefetch.consumer_waits));
+            jsPrefetch.Set("consumerWaitSeconds", Number::New(env, result.prefetch.consumer_wait_seconds));
+            jsStats.Set("prefetch", jsPrefetch);
+        }
+        if (result.disk_ordered) {
+            jsStats.Set("diskOrder", DiskOrderStatsToJS(env, result.disk_order));
+        }
+
+        Object jsResult = Object::New(env);
+        jsResult.Set("fileIds", jsFileIds);
+        jsResult.Set("errors", jsErrors);
+        jsResult.Set("stats", jsStats);
+        return jsResult;
+    } catch (const std::exception& e) {
+        Error::New(env, e.what()).ThrowAsJavaScriptException();
+        return env.Null();
+    }
+}
+
+// Two-tier duplicate scan: prefix fingerprints for every file, full ones only for candidates
+Value FindDuplicatesTwoTier(const CallbackInfo& info) {
+    Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsArray()) {
+        TypeError::New(env, "First argument must be an array of file paths").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    Array filePaths = info[0].As<Array>();
+    std::vector<std::string> paths;
+    paths.reserve(filePaths.Length());
+    for (uint32_t i = 0; i < filePaths.Length(); ++i) {
+        paths.push_back(filePaths.Get(i).As<String>().Utf8Value());
+    }
+
+    TwoTierConfig config;
+    auto comparator = std::make_unique<FingerprintComparator>();
+    if (info.Length() > 1 && info[1].IsObject()) {
+        Object options = info[1].As<Object>();
+        if (options.Has("prefixSeconds")) {
+            config.prefix_seconds = options.Get("prefixSeconds").As<Number>().DoubleValue();
+        }
+        if (options.Has("minVotes")) {
+            config.min_votes = options.Get("minVotes").As<Number>().Uint32Value();
+        }
+        if (options.Has("maxRunLength")) {
+            config.max_run_length = options.Get("maxRunLength").As<Number>().Uint32Value();
+        }
+        if (options.Has("numThreads")) {
+            config.num_threads = options.Get("numThreads").As<Number>().Uint32Value();
+        }
+        if (options.Has("similarityThreshold")) {
+            comparator->set_similarity_threshold(options.Get("similarityThreshold").As<Number>().DoubleValue());
+        }
+        if (options.Has("bitErrorThreshold")) {
+            comparator->set_bit_error_threshold(options.Get("bitErrorThreshold").As<Number>().DoubleValue());
+        }
+        if (options.Has("maxAlignmentOffset")) {
+            comparator->set_max_alignment_offset(options.Get("maxAlignmentOffset").As<Number>().Int32Value());
+        }
+    }
+
+    try {
+        TwoTierScanner scanner(config);
+        scanner.set_comparator(std::move(comparator));
+        auto result = scanner.run(paths);
+
+        Array jsGroups = Array::New(env, result.groups.size());
+        for (size_t i = 0; i < result.groups.size(); ++i) {
+            const auto& group = result.groups[i];
+            Array jsFileIds = Array::New(env, group.file_ids.size());
+            Array jsGroupPaths = Array::New(env, group.file_ids.size());
+            for (size_t j = 0; j < group.file_ids.size(); ++j) {
+                jsFileIds[j] = Number::New(env, group.file_ids[j]);
+                jsGroupPaths[j] = String::New(env, paths[group.file_ids[j]]);
+            }
+
+            Object jsGroup = Object::New(env);
+            jsGroup.Set("fileIds", jsFileIds);
+            jsGroup.Set("filePaths", jsGroupPaths);
+            jsGroup.Set("avgSimilarity", Number::New(env, group.avg_similarity));
+            jsGroups[i] = jsGroup;
+        }
+
+        Array jsErrors = Array::New(env, result.errors.size());
+        for (size_t i = 0; i < result.errors.size(); ++i) {
+            const auto& error = result.errors[i];
+            Object jsError = Object::New(env);
+            jsError.Set("filePath", String::New(env, paths[error.input_index]));
+            jsError.Set("stage", String::New(env, error.stage));
+            jsError.Set("error", String::New(env, error.message));
+            jsErrors[i] = jsError;
+        }
+
+        const auto& stats = result.stats;
+        Object jsJoin = Object::New(env);
+        jsJoin.Set("tuplesEmitted", Number::New(env, stats.join.tuples_emitted));
+        jsJoin.Set("runsSkipped", Number::New(env, stats.join.runs_skipped));
+        jsJoin.Set("pairVotes", Number::New(env, stats.join.pair_votes));
+
+        Object jsStats = Object::New(env);
+        jsStats.Set("files", Number::New(env, stats.files));
+        jsStats.Set("prefixCandidatePairs", Number::New(env, stats.prefix_candidate_pairs));
+        jsStats.Set("completedFiles", Number::New(env, stats.completed_files));
+        jsStats.Set("verifiedPairs", Number::New(env, stats.verified_pairs));
+        jsStats.Set("audioSeconds", Number::New(env, stats.audio_seconds));
+        jsStats.Set("prefixDecodedSeconds", Number::New(env, stats.prefix_decoded_seconds));
+        jsStats.Set("fullDecodedSeconds", Number::New(env, stats.full_decoded_seconds));
+        jsStats.Set("decodeSecondsSaved", Number::New(env, stats.decode_seconds_saved));
+        jsStats.Set("wallSeconds", Number::New(env, stats.wall_seconds));
+        jsStats.Set("join", jsJoin);
+
+        Object jsResult = Object::New(env);
+        jsResult.Set("groups", jsGroups);
+        jsResult.Set("errors", jsErrors);
+        jsResult.Set("stats", jsStats);
+        return jsResult;
+    } catch (const std::exception& e) {
+        Error::New(env, e.what()).ThrowAsJavaScriptException();
+        return env.Null();
+    }
+}
+
+// Add file to index and match it against existing files in one step
+Value AddFileAndMatch(const CallbackInfo& info) {
+    Env env = info.Env();
+
+    if (!g_index) {
+        Error::New(env, "Index not initialized").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    if (info.Length() < 1 || !info[0].IsString()) {
+        TypeError::New(env, "Expected string file path").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    std::string filePath = info[0].As<String>().Utf8Value();
+
+    try {
+        if (!g_streaming_loader) {
+            g_streaming_loader = std::make_unique<StreamingAudioLoader>();
+        }
+
+        auto compressed_fp = g_streaming_loader->generateStreamingFingerprint(filePath);
+        if (!compressed_fp || !compressed_fp->isValid()) {
+            Error::New(env, "Failed to generate fingerprint for " + filePath).ThrowAsJavaScriptException();
+            return env.Null();
+        }
+
+        auto insertResult = g_index->add_and_match(filePath, std::move(compressed_fp));
+
+        Array jsMatches = Array::New(env, insertResult.matches.size());
+        for (size_t i = 0; i < insertResult.matches.size(); ++i) {
+            const auto& match = insertResult.matches[i];
+            Object jsMatch = Object::New(env);
+
+            jsMatch.Set("fileId", Number::New(env, match.first));
+            auto fileEntry = g_index->get_file(match.first);
+            if (fileEntry) {
+                jsMatch.Set("filePath", String::New(env, fileEntry->file_path()));
+            }
+            jsMatch.Set("similarityScore", Number::New(env, match.second.similarity_score));
+            jsMatch.Set("bitErrorRate", Number::New(env, match.second.bit_error_rate));
+            jsMatch.Set("bestOffset", Number::New(env, match.second.best_offset));
+
+            jsMatches[i] = jsMatch;
+        }
+
+        Object result = Object::New(env);
+        result.Set("fileId", Number::New(env, insertResult.file_id));
+        result.Set("groupId", Number::New(env, insertResult.group_id));
+        result.Set("isDuplicate", Boolean::New(env, !insertResult.matches.empty()));
+        result.Set("matches", jsMatches);
+
+        return result;
+    } catch (const std::exception& e) {
+        Error::New(env, e.what()).ThrowAsJavaScriptException();
+        return env.Null();
+    }
+}
+
+// Get duplicate groups maintained by addFileAndMatch
+Value GetOnlineDuplicateGroups(const CallbackInfo& info) {
+    Env env = info.Env();
+
+    if (!g_index) {
+        Error::New(env, "Index not initialized").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    try {
+        auto duplicateGroups = g_index->get_online_groups();
+        Array jsGroups = Array::New(env, duplicateGroups.size());
+
+        for (size_t i = 0; i < duplicateGroups.size(); ++i) {
+            const auto& group = duplicateGroups[i];
+            Object jsGroup = Object::New(env);
+
+            Array jsFileIds = Array::New(env, group.file_ids.size());
+            Array jsFilePaths = Array::New(env, group.file_ids.size());
+            for (size_t j = 0; j < group.file_ids.size(); ++j) {
+                jsFileIds[j] = Number::New(env, group.file_ids[j]);
+
+                auto fileEntry = g_index->get_file(group.file_ids[j]);
+                if (fileEntry) {
+                    jsFilePaths[j] = String::New(env, fileEntry->file_path());
+                } else {
+                    jsFilePaths[j] = env.Null();
+                }
+            }
+
+            jsGroup.Set("fileIds", jsFileIds);
+            jsGroup.Set("filePaths", jsFilePaths);
+            jsGroup.Set("avgSimilarity", Number::New(env, group.avg_similarity));
+
+            jsGroups[i] = jsGroup;
+        }
+
+        return jsGroups;
+    } catch (const std::exception& e) {
+        Error::New(env, e.what()).ThrowAsJavaScriptException();
+        return env.Null();
+    }
+}
+
+// Query the k best matches for a fingerprint object or file path
+Value QueryTopK(const CallbackInfo& info) {
+    Env env = info.Env();
+
+    if (!g_index) {
+        Error::New(env, "Index not initialized").ThrowAsJavaScriptException();
+        return env.Null();
+    }
 
-    if (info.Length() < 1 || !info[0].IsString()) {
-        TypeError::New(env, "Expected string file path").ThrowAsJavaScriptException();
+    if (info.Length() < 1 || !(info[0].IsObject() || info[0].IsString())) {
+        TypeError::New(env, "Expected fingerprint object or string file path").ThrowAsJavaScriptException();
         return env.Null();
     }
 
-    std::string filePath = info[0].As<String>().Utf8Value();
-    PreprocessConfig config; // Use default config
+    size_t k = 10;
+    if (info.Length() > 1 && info[1].IsNumber()) {
+        k = info[1].As<Number>().Uint32Value();
+    }
 
-    // Check if preprocessing config is provided
-    if (info.Length() >= 2 && info[1].IsObject()) {
-        config = JSToPreprocessConfig(info[1].As<Object>());
+    double minSimilarity = 0.0;
+    if (info.Length() > 2 && info[2].IsNumber()) {
+        minSimilarity = info[2].As<Number>().DoubleValue();
+    }
+
+    double voteCutoff = 0.0;
+    if (info.Length() > 3 && info[3].IsNumber()) {
+        voteCutoff = info[3].As<Number>().DoubleValue();
     }
 
     try {
-        AudioLoader loader;
-        auto original = loader.load(filePath);
-        auto processed = loader.load_with_preprocessing(filePath, &config);
+        std::unique_ptr<Fingerprint> query;
+        if (info[0].IsString()) {
+            std::string filePath = info[0].As<String>().Utf8Value();
 
-        Object result = Object::New(env);
+            if (!g_streaming_loader) {
+                g_streaming_loader = std::make_unique<StreamingAudioLoader>();
+            }
 
-        // Original audio info
-        Object originalInfo = Object::New(env);
-        originalInfo.Set("sampleRate", Number::New(env, original->sample_rate));
-        originalInfo.Set("duration", Number::New(env, original->duration));
-        originalInfo.Set("samples", Number::New(env, original->samples.size()));
+            auto compressed_fp = g_streaming_loader->generateStreamingFingerprint(filePath);
+            if (!compressed_fp || !compressed_fp->isValid()) {
+                Error::New(env, "Failed to generate fingerprint for " + filePath).ThrowAsJavaScriptException();
+                return env.Null();
+            }
+            query = compressed_fp->decompress();
+        } else {
+            query = JSToFingerprintAny(info[0].As<Object>());
+        }
 
-        // Processed audio info
-        Object processedInfo = Object::New(env);
-        processedInfo.Set("sampleRate", Number::New(env, processed->sample_rate));
-        processedInfo.Set("duration", Number::New(env, processed->duration));
-        processedInfo.Set("samples", Number::New(env, processed->samples.size()));
+        auto matches = g_index->query_top_k(*query, k, minSimilarity, voteCutoff);
 
-        result.Set("original", originalInfo);
-        result.Set("processed", processedInfo);
+        Array jsMatches = Array::New(env, matches.size());
+        for (size_t i = 0; i < matches.size(); ++i) {
+            const auto& match = matches[i];
+            Object jsMatch = Object::New(env);
 
-        return result;
+            jsMatch.Set("fileId", Number::New(env, match.file_id));
+            auto fileEntry = g_index->get_file(match.file_id);
+            if (fileEntry) {
+                jsMatch.Set("filePath", String::New(env, fileEntry->file_path()));
+            }
+            jsMatch.Set("similarity", Number::New(env, match.similarity));
+            jsMatch.Set("bitErrorRate", Number::New(env, match.bit_error_rate));
+            jsMatch.Set("offset", Number::New(env, match.offset));
+
+            jsMatches[i] = jsMatch;
+        }
+
+        return jsMatches;
     } catch (const std::exception& e) {
         Error::New(env, e.what()).ThrowAsJavaScriptException();
         return env.Null();
     }
 }
 
-// Compare two fingerprints
-Value CompareFingerprints(const CallbackInfo& info) {
+// Read an indexed file's fingerprint back from the index, with the tier it was read from
+Value GetIndexedFingerprint(const CallbackInfo& info) {
     Env env = info.Env();
 
-    if (info.Length() < 2 || !info[0].IsObject() || !info[1].IsObject()) {
-        TypeError::New(env, "Expected two fingerprint objects").ThrowAsJavaScriptException();
+    if (!g_index) {
+        Error::New(env, "Index not initialized").ThrowAsJavaScriptException();
         return env.Null();
     }
 
-    try {
-        auto fp1 = JSToFingerprintAny(info[0].As<Object>());
-        auto fp2 = JSToFingerprintAny(info[1].As<Object>());
-
-        FingerprintComparator comparator;
-        auto result = comparator.compare(*fp1, *fp2);
-
-        Object jsResult = Object::New(env);
-        jsResult.Set("similarityScore", Number::New(env, result.similarity_score));
-        jsResult.Set("bestOffset", Number::New(env, result.best_offset));
-        jsResult.Set("matchedSegments", Number::New(env, result.matched_segments));
-        jsResult.Set("bitErrorRate", Number::New(env, result.bit_error_rate));
-        jsResult.Set("isDuplicate", Boolean::New(env, result.is_duplicate));
-        jsResult.Set("coverageRatio", Number::New(env, result.coverage_ratio));
-
-        return jsResult;
-    } catch (const std::exception& e) {
-        Error::New(env, e.what()).ThrowAsJavaScriptException();
+    if (info.Length() < 1 || !info[0].IsNumber()) {
+        TypeError::New(env, "Expected file id").ThrowAsJavaScriptException();
         return env.Null();
     }
-}
-
-// Initialize index
-Value InitializeIndex(const CallbackInfo& info) {
-    Env env = info.Env();
 
     try {
-        g_index = std::make_unique<FingerprintIndex>();
-        return Boolean::New(env, true);
+        StorageTier tier = StorageTier::Warm;
+        auto fingerprint = g_index->get_fingerprint(info[0].As<Number>().Uint32Value(), &tier);
+        if (!fingerprint) {
+            return env.Null();
+        }
+
+        Object jsFingerprint = FingerprintToJS(env, *fingerprint);
+        jsFingerprint.Set("tier", String::New(env, tier == StorageTier::Hot ? "hot" :
+                                                   tier == StorageTier::Cold ? "cold" : "warm"));
+        return jsFingerprint;
     } catch (const std::exception& e) {
         Error::New(env, e.what()).ThrowAsJavaScriptException();
-        return Boolean::New(env, false);
+        return env.Null();
     }
 }
 
-// Add file to index
-Value AddFileToIndex(const CallbackInfo& info) {
+// Candidate file ids for each fingerprint, from one batched lookup or one lookup per fingerprint
+Value FindCandidates(const CallbackInfo& info) {
     Env env = info.Env();
 
     if (!g_index) {
@@ -332,27 +1508,51 @@ Value AddFileToIndex(const CallbackInfo& info) {
         return env.Null();
     }
 
-    if (info.Length() < 1 || !info[0].IsString()) {
-        TypeError::New(env, "Expected string file path").ThrowAsJavaScriptException();
+    if (info.Length() < 1 || !info[0].IsArray()) {
+        TypeError::New(env, "Expected array of fingerprint objects").ThrowAsJavaScriptException();
         return env.Null();
     }
 
-    std::string filePath = info[0].As<String>().Utf8Value();
+    bool batched = true;
+    if (info.Length() > 1 && info[1].IsObject()) {
+        Object options = info[1].As<Object>();
+        if (options.Has("batched")) {
+            batched = options.Get("batched").As<Boolean>().Value();
+        }
+    }
 
     try {
-        // Use streaming loader to generate compressed fingerprint
-        if (!g_streaming_loader) {
-            g_streaming_loader = std::make_unique<StreamingAudioLoader>();
+        Array jsQueries = info[0].As<Array>();
+        std::vector<std::unique_ptr<Fingerprint>> queries;
+        queries.reserve(jsQueries.Length());
+        for (uint32_t i = 0; i < jsQueries.Length(); ++i) {
+            queries.push_back(JSToFingerprintAny(jsQueries.Get(i).As<Object>()));
         }
 
-        auto compressed_fp = g_streaming_loader->generateStreamingFingerprint(filePath);
-        if (!compressed_fp || !compressed_fp->isValid()) {
-            Error::New(env, "Failed to generate fingerprint for " + filePath).ThrowAsJavaScriptException();
-            return env.Null();
+        std::vector<std::vector<size_t>> candidates;
+        if (batched) {
+            std::vector<const Fingerprint*> pointers;
+            pointers.reserve(queries.size());
+            for (const auto& query : queries) {
+                pointers.push_back(query.get());
+            }
+            candidates = g_index->find_candidates_batch(pointers);
+        } else {
+            for (const auto& query : queries) {
+                candidates.push_back(g_index->find_candidates(*query));
+            }
         }
 
-        size_t fileId = g_index->add_file(filePath, std::move(compressed_fp));
-        return Number::New(env, fileId);
+        Array jsCandidates = Array::New(env, candidates.size());
+        for (size_t q = 0; q < candidates.size(); ++q) {
+            Array jsIds = Array::New(env, candidates[q].size());
+            for (size_t i = 0; i < candidates[q].size(); ++i) {
+                jsIds[i] = Number::New(env, candidates[q][i]);
+            }
+            jsCandidates[q] = jsIds;
+        }
+
+        return jsCandidates;
     } catch (const std::exception& e) {
         Error::New(env, e.what()).ThrowAsJavaScriptException();
         return env.Null();
@@ -383,9 +1583,9 @@ Value FindAllDuplicates(const CallbackInfo& info) {
 
             Array jsFilePaths = Array::New(env, group.file_ids.size());
             for (size_t j = 0; j < group.file_ids.size(); ++j) {
-                const auto* fileEntry = g_index->get_file(group.file_ids[j]);
+                auto fileEntry = g_index->get_file(group.file_ids[j]);
                 if (fileEntry) {
-                    jsFilePaths[j] = String::New(env, fileEntry->file_path);
+                    jsFilePaths[j] = String::New(env, fileEntry->file_path());
                 } else {
                     jsFilePaths[j] = env.Null();
                 }
@@ -418,6 +1618,64 @@ Value GetIndexStats(const CallbackInfo& info) {
     stats.Set("fileCount", Number::New(env, g_index->get_file_count()));
     stats.Set("indexSize", Number::New(env, g_index->get_index_size()));
     stats.Set("loadFactor", Number::New(env, g_index->get_load_factor()));
+    stats.Set("dictionarySize", Number::New(env, g_index->get_dictionary_size()));
+
+    auto bulkStats = g_index->get_last_bulk_stats();
+    Object bulkJoin = Object::New(env);
+    bulkJoin.Set("tuplesEmitted", Number::New(env, bulkStats.tuples_emitted));
+    bulkJoin.Set("bytesSpilled", Number::New(env, bulkStats.bytes_spilled));
+    bulkJoin.Set("runsSkipped", Number::New(env, bulkStats.runs_skipped));
+    bulkJoin.Set("pairVotes", Number::New(env, bulkStats.pair_votes));
+    bulkJoin.Set("candidatePairs", Number::New(env, bulkStats.candidate_pairs));
+
+    auto verifyStats = g_index->get_last_bulk_verify_stats();
+    bulkJoin.Set("pairsVerified", Number::New(env, verifyStats.pairs_verified));
+    bulkJoin.Set("blocksDecoded", Number::New(env, verifyStats.blocks_decoded));
+    bulkJoin.Set("blocksTotal", Number::New(env, verifyStats.blocks_total));
+    stats.Set("bulkJoin", bulkJoin);
+
+    auto durationStats = g_index->get_duration_filter_stats();
+    Object durationFilter = Object::New(env);
+    durationFilter.Set("minRatio", Number::New(env, durationStats.min_ratio));
+    durationFilter.Set("queries", Number::New(env, durationStats.queries));
+    durationFilter.Set("votesPruned", Number::New(env, durationStats.votes_pruned));
+    durationFilter.Set("comparisonsPruned", Number::New(env, durationStats.comparisons_pruned));
+    stats.Set("durationFilter", durationFilter);
+
+    auto exactStats = g_index->get_last_exact_duplicate_stats();
+    Object exactDuplicates = Object::New(env);
+    exactDuplicates.Set("files", Number::New(env, exactStats.files));
+    exactDuplicates.Set("exactSets", Number::New(env, exactStats.exact_sets));
+    exactDuplicates.Set("filesCollapsed", Number::New(env, exactStats.files_collapsed));
+    stats.Set("exactDuplicates", exactDuplicates);
+
+    auto prefixStats = g_index->get_last_prefix_join_stats();
+    Object prefixJoin = Object::New(env);
+    prefixJoin.Set("records", Number::New(env, prefixStats.records));
+    prefixJoin.Set("prefixEntries", Number::New(env, prefixStats.prefix_entries));
+    prefixJoin.Set("candidates", Number::New(env, prefixStats.candidates));
+    prefixJoin.Set("verifiedPairs", Number::New(env, prefixStats.verified_pairs));
+    stats.Set("prefixJoin", prefixJoin);
+
+    auto storageStats = g_index->get_storage_stats();
+    Object storage = Object::New(env);
+    storage.Set("slabBytes", Number::New(env, storageStats.slab_bytes));
+    storage.Set("slabCapacity", Number::New(env, storageStats.slab_capacity));
+    storage.Set("metadataBytes", Number::New(env, storageStats.metadata_bytes));
+    storage.Set("uniquePaths", Number::New(env, storageStats.unique_paths));
+    storage.Set("pathBytes", Number::New(env, storageStats.path_bytes));
+    storage.Set("rawPathBytes", Number::New(env, storageStats.raw_path_bytes));
+    storage.Set("hotFiles", Number::New(env, storageStats.hot_files));
+    storage.Set("hotBytes", Number::New(env, storageStats.hot_bytes));
+    storage.Set("warmFiles", Number::New(env, storageStats.warm_files));
+    storage.Set("coldFiles", Number::New(env, storageStats.cold_files));
+    storage.Set("coldBytes", Number::New(env, storageStats.cold_bytes));
+    storage.Set("promotions", Number::New(env, storageStats.promotions));
+    storage.Set("demotions", Number::New(env, storageStats.demotions));
+    storage.Set("tierEpochs", Number::New(env, storageStats.tier_epochs));
+    storage.Set("tierErrors", Number::New(env, storageStats.tier_errors));
+    storage.Set("lastTierError", String::New(env, storageStats.last_tier_error));
+    stats.Set("storage", storage);
 
     return stats;
 }
@@ -476,6 +1734,42 @@ Value SetBitErrorThreshold(const CallbackInfo& info) {
     return Boolean::New(env, true);
 }
 
+// Configure the duration-ratio window for whole-file duplicate mode (0 disables it)
+Value SetDurationRatioWindow(const CallbackInfo& info) {
+    Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsNumber()) {
+        TypeError::New(env, "Expected number ratio").ThrowAsJavaScriptException();
+        return Boolean::New(env, false);
+    }
+
+    if (!g_index) {
+        Error::New(env, "Index not initialized").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    g_index->set_duration_ratio_window(info[0].As<Number>().DoubleValue());
+    return Boolean::New(env, true);
+}
+
+// Enable or disable collapsing bit-identical fingerprints before verification
+Value SetExactDuplicateCollapse(const CallbackInfo& info) {
+    Env env = info.Env();
+
+    if (info.Length() < 1 || !info[0].IsBoolean()) {
+        TypeError::New(env, "Expected boolean").ThrowAsJavaScriptException();
+        return Boolean::New(env, false);
+    }
+
+    if (!g_index) {
+        Error::New(env, "Index not initialized").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    g_index->set_exact_duplicate_collapse(info[0].As<Boolean>().Value());
+    return Boolean::New(env, true);
+}
+
 // Compare fingerprints using sliding window approach
 Value CompareFingerprintsSlidingWindow(const CallbackInfo& info) {
     Env env = info.Env();
@@ -615,9 +1909,106 @@ Value FindAllDuplicatesParallel(const CallbackInfo& info) {
             for (size_t j = 0; j < group.file_ids.size(); ++j) {
                 jsFileIds[j] = Number::New(env, group.file_ids[j]);
 
-                const auto* file_entry = g_index->get_file(group.file_ids[j]);
+                auto file_entry = g_index->get_file(group.file_ids[j]);
+                if (file_entry) {
+                    jsFilePaths[j] = String::New(env, file_entry->file_path());
+                }
+            }
+
+            jsGroup.Set("fileIds", jsFileIds);
+            jsGroup.Set("filePaths", jsFilePaths);
+            jsGroup.Set("avgSimilarity", Number::New(env, group.avg_similarity));
+
+            jsDuplicateGroups[i] = jsGroup;
+        }
+
+        return jsDuplicateGroups;
+    } catch (const std::exception& e) {
+        Error::New(env, e.what()).ThrowAsJavaScriptException();
+        return env.Null();
+    }
+}
+
+// Self-join options shared by the bulk scan and its candidate pairs
+SelfJoinConfig JSToSelfJoinConfig(const CallbackInfo& info) {
+    SelfJoinConfig config;
+    if (info.Length() > 0 && info[0].IsObject()) {
+        Object options = info[0].As<Object>();
+
+        if (options.Has("numThreads")) {
+            config.num_threads = options.Get("numThreads").As<Number>().Uint32Value();
+        }
+        if (options.Has("spillDirectory")) {
+            config.spill_directory = options.Get("spillDirectory").As<String>().Utf8Value();
+        }
+        if (options.Has("spillBufferTuples")) {
+            config.spill_buffer_tuples = options.Get("spillBufferTuples").As<Number>().Uint32Value();
+        }
+        if (options.Has("maxRunLength")) {
+            config.max_run_length = options.Get("maxRunLength").As<Number>().Uint32Value();
+        }
+    }
+    return config;
+}
+
+// Candidate pairs of the bulk self-join, before verification
+Value FindBulkCandidatePairs(const CallbackInfo& info) {
+    Env env = info.Env();
+
+    if (!g_index) {
+        Error::New(env, "Index not initialized").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    try {
+        auto pairs = g_index->find_bulk_candidate_pairs(JSToSelfJoinConfig(info));
+
+        Array jsPairs = Array::New(env, pairs.size());
+        for (size_t i = 0; i < pairs.size(); ++i) {
+            Object jsPair = Object::New(env);
+            jsPair.Set("fileA", Number::New(env, pairs[i].file_a));
+            jsPair.Set("fileB", Number::New(env, pairs[i].file_b));
+            jsPair.Set("votes", Number::New(env, pairs[i].votes));
+            jsPair.Set("offsetHint", Number::New(env, pairs[i].offset_hint));
+            jsPairs[i] = jsPair;
+        }
+
+        return jsPairs;
+    } catch (const std::exception& e) {
+        Error::New(env, e.what()).ThrowAsJavaScriptException();
+        return env.Null();
+    }
+}
+
+// Find all duplicates using the bulk sort-merge self-join
+Value FindAllDuplicatesBulk(const CallbackInfo& info) {
+    Env env = info.Env();
+
+    if (!g_index) {
+        Error::New(env, "Index not initialized").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    SelfJoinConfig config = JSToSelfJoinConfig(info);
+
+    try {
+        auto duplicateGroups = g_index->find_all_duplicates_bulk(config);
+
+        Array jsDuplicateGroups = Array::New(env, duplicateGroups.size());
+
+        for (size_t i = 0; i < duplicateGroups.size(); ++i) {
+            const auto& group = duplicateGroups[i];
+
+            Object jsGroup = Object::New(env);
+            Array jsFileIds = Array::New(env, group.file_ids.size());
+            Array jsFilePaths = Array::New(env, group.file_ids.size());
+
+            for (size_t j = 0; j < group.file_ids.size(); ++j) {
+                jsFileIds[j] = Number::New(env, group.file_ids[j]);
+
+                auto file_entry = g_index->get_file(group.file_ids[j]);
                 if (file_entry) {
-                    jsFilePaths[j] = String::New(env, file_entry->file_path);
+                    jsFilePaths[j] = String::New(env, file_entry->file_path());
                 }
             }
 
@@ -635,6 +2026,144 @@ Value FindAllDuplicatesParallel(const CallbackInfo& info) {
     }
 }
 
+// Find all file pairs accepted by the quick filter
+Value FindQuickFilterPairs(const CallbackInfo& info) {
+    Env env = info.Env();
+
+    if (!g_index) {
+        Error::New(env, "Index not initialized").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    std::string method = "prefix";
+    if (info.Length() > 0 && info[0].IsString()) {
+        method = info[0].As<String>().Utf8Value();
+    }
+
+    try {
+        std::vector<SimilarPair> pairs;
+        if (method == "prefix") {
+            pairs = g_index->find_quick_filter_pairs();
+        } else if (method == "indexed") {
+            pairs = g_index->find_quick_filter_pairs_indexed();
+        } else if (method == "all") {
+            pairs = g_index->find_quick_filter_pairs_all();
+        } else {
+            throw std::invalid_argument("Unknown quick filter pair method: " + method);
+        }
+
+        Array jsPairs = Array::New(env, pairs.size());
+        for (size_t i = 0; i < pairs.size(); ++i) {
+            Object jsPair = Object::New(env);
+            jsPair.Set("fileA", Number::New(env, pairs[i].record_a));
+            jsPair.Set("fileB", Number::New(env, pairs[i].record_b));
+            jsPair.Set("overlap", Number::New(env, pairs[i].jaccard));
+            jsPairs[i] = jsPair;
+        }
+
+        return jsPairs;
+    } catch (const std::exception& e) {
+        Error::New(env, e.what()).ThrowAsJavaScriptException();
+        return env.Null();
+    }
+}
+
+// Train the shared compression dictionary and report per-duration compression ratios
+Value TrainCompressionDictionary(const CallbackInfo& info) {
+    Env env = info.Env();
+
+    if (!g_index) {
+        Error::New(env, "Index not initialized").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    size_t maxSamples = 1000;
+    if (info.Length() > 0 && info[0].IsNumber()) {
+        maxSamples = info[0].As<Number>().Uint32Value();
+    }
+
+    try {
+        auto report = g_index->train_dictionary(maxSamples);
+
+        Object jsReport = Object::New(env);
+        jsReport.Set("dictionarySize", Number::New(env, report.dictionary_size));
+        jsReport.Set("samples", Number::New(env, report.samples));
+
+        Array jsBuckets = Array::New(env, report.buckets.size());
+        for (size_t i = 0; i < report.buckets.size(); ++i) {
+            const auto& bucket = report.buckets[i];
+            const double original = bucket.original_bytes > 0 ? static_cast<double>(bucket.original_bytes) : 1.0;
+
+            Object jsBucket = Object::New(env);
+            jsBucket.Set("label", String::New(env, bucket.label));
+            jsBucket.Set("files", Number::New(env, bucket.files));
+            jsBucket.Set("originalBytes", Number::New(env, bucket.original_bytes));
+            jsBucket.Set("bytesBefore", Number::New(env, bucket.bytes_before));
+            jsBucket.Set("bytesAfter", Number::New(env, bucket.bytes_after));
+            jsBucket.Set("ratioBefore", Number::New(env, bucket.bytes_before / original));
+            jsBucket.Set("ratioAfter", Number::New(env, bucket.bytes_after / original));
+            jsBuckets[i] = jsBucket;
+        }
+        jsReport.Set("buckets", jsBuckets);
+
+        return jsReport;
+    } catch (const std::exception& e) {
+        Error::New(env, e.what()).ThrowAsJavaScriptException();
+        return env.Null();
+    }
+}
+
+// Start, reconfigure or stop background hot/warm/cold tiering of indexed fingerprints
+Value ConfigureTiering(const CallbackInfo& info) {
+    Env env = info.Env();
+
+    if (!g_index) {
+        Error::New(env, "Index not initialized").ThrowAsJavaScriptException();
+        return env.Null();
+    }
+
+    TierConfig config;
+    uint32_t intervalMs = 5000;
+    bool enabled = true;
+
+    if (info.Length() > 0 && info[0].IsObject()) {
+        Object options = info[0].As<Object>();
+        if (options.Has("enabled")) {
+            enabled = options.Get("enabled").As<Boolean>().Value();
+        }
+        if (options.Has("hotBudgetMB")) {
+            config.hot_budget_bytes = static_cast<size_t>(options.Get("hotBudgetMB").As<Number>().DoubleValue() * 1024 * 1024);
+        }
+        if (options.Has("hotMinAccesses")) {
+            config.hot_min_heat = options.Get("hotMinAccesses").As<Number>().Uint32Value();
+        }
+        if (options.Has("coldAfterEpochs")) {
+            config.cold_after_epochs = options.Get("coldAfterEpochs").As<Number>().Uint32Value();
+        }
+        if (options.Has("coldDirectory")) {
+            config.cold_directory = options.Get("coldDirectory").As<String>().Utf8Value();
+        }
+        if (options.Has("maxColdMB")) {
+            config.max_cold_bytes = static_cast<size_t>(options.Get("maxColdMB").As<Number>().DoubleValue() * 1024 * 1024);
+        }
+        if (options.Has("intervalMs")) {
+            intervalMs = std::max<uint32_t>(1, options.Get("intervalMs").As<Number>().Uint32Value());
+        }
+    }
+
+    try {
+        if (enabled) {
+            g_index->configure_tiering(config, std::chrono::milliseconds(intervalMs));
+        } else {
+            g_index->stop_tiering();
+        }
+        return Boolean::New(env, true);
+    } catch (const std::exception& e) {
+        Error::New(env, e.what()).ThrowAsJavaScriptException();
+        return env.Null();
+    }
+}
+
 // Get memory pool statistics
 Value GetMemoryPoolStats(const CallbackInfo& info) {
     Env env = info.Env();
@@ -684,6 +2213,8 @@ Value GetStreamingStats(const CallbackInfo& info) {
         jsStats.Set("peakMemoryUsage", Number::New(env, stats.peak_memory_usage));
         jsStats.Set("compressionRatio", Number::New(env, stats.compression_ratio));
         jsStats.Set("processingTimeSeconds", Number::New(env, stats.processing_time_seconds));
+        jsStats.Set("segments", Number::New(env, stats.segments));
+        jsStats.Set("seamBitError", Number::New(env, stats.seam_bit_error));
 
         return jsStats;
     } catch (const std::exception& e) {
@@ -705,25 +2236,50 @@ Napi::Object Init(Napi::Env env, Napi::Object exports) {
     // Core fingerprinting functions
     exports.Set("generateFingerprint", Function::New(env, GenerateFingerprint));
     exports.Set("generateFingerprintLimited", Function::New(env, GenerateFingerprintLimited));
+    exports.Set("configureSegmentedFingerprinting", Function::New(env, ConfigureSegmentedFingerprinting));
+    exports.Set("generateSampledFingerprint", Function::New(env, GenerateSampledFingerprint));
+    exports.Set("compareSampledFingerprints", Function::New(env, CompareSampledFingerprints));
     exports.Set("generateFingerprintWithPreprocessing", Function::New(env, GenerateFingerprintWithPreprocessing));
     exports.Set("testPreprocessing", Function::New(env, TestPreprocessing));
     exports.Set("compareFingerprints", Function::New(env, CompareFingerprints));
+    exports.Set("compareFingerprintsAtOffset", Function::New(env, CompareFingerprintsAtOffset));
+    exports.Set("benchmarkFingerprintCodecs", Function::New(env, BenchmarkFingerprintCodecs));
+    exports.Set("benchmarkPcmReaders", Function::New(env, BenchmarkPcmReaders));
+    exports.Set("decodePcm", Function::New(env, DecodePcm));
 
     // Index management functions
     exports.Set("initializeIndex", Function::New(env, InitializeIndex));
     exports.Set("addFileToIndex", Function::New(env, AddFileToIndex));
+    exports.Set("addIdenticalFileToIndex", Function::New(env, AddIdenticalFileToIndex));
+    exports.Set("addFilesToIndexPipeline", Function::New(env, AddFilesToIndexPipeline));
+    exports.Set("findDuplicatesTwoTier", Function::New(env, FindDuplicatesTwoTier));
+    exports.Set("addFileAndMatch", Function::New(env, AddFileAndMatch));
+    exports.Set("getOnlineDuplicateGroups", Function::New(env, GetOnlineDuplicateGroups));
+    exports.Set("queryTopK", Function::New(env, QueryTopK));
+    exports.Set("findCandidates", Function::New(env, FindCandidates));
+    exports.Set("getIndexedFingerprint", Function::New(env, GetIndexedFingerprint));
     exports.Set("findAllDuplicates", Function::New(env, FindAllDuplicates));
     exports.Set("getIndexStats", Function::New(env, GetIndexStats));
+    exports.Set("trainCompressionDictionary", Function::New(env, TrainCompressionDictionary));
+    exports.Set("configureTiering", Function::New(env, ConfigureTiering));
     exports.Set("clearIndex", Function::New(env, ClearIndex));
 
     // Parallel processing functions
     exports.Set("generateFingerprintsBatch", Function::New(env, GenerateFingerprintsBatch));
+    exports.Set("findIdenticalFiles", Function::New(env, FindIdenticalFiles));
+    exports.Set("orderFilesByDiskLayout", Function::New(env, OrderFilesByDiskLayout));
+    exports.Set("evictPageCache", Function::New(env, EvictPageCache));
     exports.Set("findAllDuplicatesParallel", Function::New(env, FindAllDuplicatesParallel));
+    exports.Set("findAllDuplicatesBulk", Function::New(env, FindAllDuplicatesBulk));
+    exports.Set("findBulkCandidatePairs", Function::New(env, FindBulkCandidatePairs));
+    exports.Set("findQuickFilterPairs", Function::New(env, FindQuickFilterPairs));
 
     // Configuration functions
     exports.Set("setSimilarityThreshold", Function::New(env, SetSimilarityThreshold));
     exports.Set("setMaxAlignmentOffset", Function::New(env, SetMaxAlignmentOffset));
     exports.Set("setBitErrorThreshold", Function::New(env, SetBitErrorThreshold));
+    exports.Set("setDurationRatioWindow", Function::New(env, SetDurationRatioWindow));
+    exports.Set("setExactDuplicateCollapse", Function::New(env, SetExactDuplicateCollapse));
 
     // Enhanced comparison functions
     exports.Set("compareFingerprintsSlidingWindow", Function::New(env, CompareFingerprintsSlidingWindow));
@@ -0,0 +1,131 @@
+#include "mapped_file.h"
+#include <stdexcept>
+#include <algorithm>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <io.h>
+#else
+#include <sys/mman.h>
+#include <sys/types.h>
+#include <unistd.h>
+#endif
+
+namespace AudioDuplicates {
+
+MappedFile::MappedFile(const std::string& path)
+    : path_(path), file_(nullptr), data_(nullptr), size_(0), mapped_size_(0), max_size_(0)
+#ifdef _WIN32
+    , mapping_(nullptr)
+#endif
+{
+    file_ = std::fopen(path_.c_str(), "w+b");
+    if (!file_) {
+        throw std::runtime_error("Failed to create mapped file: " + path_);
+    }
+}
+
+MappedFile::~MappedFile() {
+    unmap();
+    if (file_) {
+        std::fclose(file_);
+        std::remove(path_.c_str());
+    }
+}
+
+size_t MappedFile::append(const uint8_t* data, size_t size) {
+    const size_t offset = size_;
+    if (size == 0) {
+        return offset;
+    }
+
+    // Past the cap only the bytes that fit are written, like a device running out of space
+    const size_t room = max_size_ == 0 ? size : (max_size_ > size_ ? std::min(size, max_size_ - size_) : 0);
+    const size_t written = room > 0 ? std::fwrite(data, 1, room, file_) : 0;
+    if (written != size) {
+        // Bytes of a short write would otherwise shift every later blob away from
+        // the offset recorded for it
+        discard_tail();
+        throw std::runtime_error("Failed to write mapped file: " + path_ +
+                                 (room < size ? " (size limit reached)" : ""));
+    }
+
+    size_ += size;
+    return offset;
+}
+
+void MappedFile::discard_tail() {
+    std::clearerr(file_);
+#ifdef _WIN32
+    _fseeki64(file_, static_cast<__int64>(size_), SEEK_SET);
+    _chsize_s(_fileno(file_), static_cast<__int64>(size_));
+#else
+    fseeko(file_, static_cast<off_t>(size_), SEEK_SET);
+    // The write position alone decides where the next append lands, so a failed
+    // truncate only leaves unreferenced bytes past size_
+    const int truncated = ftruncate(fileno(file_), static_cast<off_t>(size_));
+    (void)truncated;
+#endif
+}
+
+void MappedFile::remap() {
+    if (std::fflush(file_) != 0) {
+        throw std::runtime_error("Failed to flush mapped file: " + path_);
+    }
+
+    if (size_ == 0) {
+        unmap();
+        return;
+    }
+
+    // Map the new view before dropping the old one so a failure leaves the
+    // earlier mapping readable
+#ifdef _WIN32
+    HANDLE handle = reinterpret_cast<HANDLE>(_get_osfhandle(_fileno(file_)));
+    HANDLE mapping = CreateFileMappingA(handle, nullptr, PAGE_READONLY, 0, 0, nullptr);
+    if (!mapping) {
+        throw std::runtime_error("Failed to map file: " + path_);
+    }
+
+    void* view = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!view) {
+        CloseHandle(mapping);
+        throw std::runtime_error("Failed to map file: " + path_);
+    }
+
+    unmap();
+    mapping_ = mapping;
+    data_ = static_cast<const uint8_t*>(view);
+#else
+    void* view = mmap(nullptr, size_, PROT_READ, MAP_SHARED, fileno(file_), 0);
+    if (view == MAP_FAILED) {
+        throw std::runtime_error("Failed to map file: " + path_);
+    }
+
+    // Cold entries are read one blob at a time, so readahead is wasted I/O
+    madvise(view, size_, MADV_RANDOM);
+    unmap();
+    data_ = static_cast<const uint8_t*>(view);
+#endif
+
+    mapped_size_ = size_;
+}
+
+void MappedFile::unmap() {
+    if (!data_) {
+        return;
+    }
+
+#ifdef _WIN32
+    UnmapViewOfFile(data_);
+    CloseHandle(static_cast<HANDLE>(mapping_));
+    mapping_ = nullptr;
+#else
+    munmap(const_cast<uint8_t*>(data_), mapped_size_);
+#endif
+
+    data_ = nullptr;
+    mapped_size_ = 0;
+}
+
+} // namespace AudioDuplicates
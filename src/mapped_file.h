@@ -0,0 +1,56 @@
+#pragma once
+
+#include <string>
+#include <cstdio>
+#include <cstdint>
+#include <cstddef>
+
+namespace AudioDuplicates {
+
+/**
+ * Append-only scratch file mapped read-only into memory
+ * Appends go through stdio and become readable once remap() extends the mapping;
+ * the file is removed when the object is destroyed
+ */
+class MappedFile {
+public:
+    // Create (or truncate) the file; throws std::runtime_error on failure
+    explicit MappedFile(const std::string& path);
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    // Write bytes at the end of the file and return their offset. A failed or short
+    // write (including one past max_size) truncates the file back to size() and throws
+    size_t append(const uint8_t* data, size_t size);
+
+    // Cap on the file size in bytes; 0 means unlimited
+    void set_max_size(size_t max_size) { max_size_ = max_size; }
+
+    // Flush pending appends and map the whole file; invalidates earlier data() pointers
+    void remap();
+
+    const uint8_t* data() const { return data_; }
+    size_t size() const { return size_; }
+    size_t mapped_size() const { return mapped_size_; }
+    const std::string& path() const { return path_; }
+
+private:
+    std::string path_;
+    std::FILE* file_;
+    const uint8_t* data_;
+    size_t size_;
+    size_t mapped_size_;
+    size_t max_size_;
+#ifdef _WIN32
+    void* mapping_;
+#endif
+
+    void unmap();
+
+    // Put the write position and the file length back at size_ after a failed append
+    void discard_tail();
+};
+
+} // namespace AudioDuplicates
@@ -0,0 +1,380 @@
+#include "pcm_decoder.h"
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+#include <type_traits>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace AudioDuplicates {
+
+namespace {
+
+// Average the channels of frames [0, count) into out; mono never gets here
+template <int Channels>
+void downmix(const float* frames, size_t count, int channels, float* out) {
+    const float gain = 1.0f / channels;
+#if defined(__SSE2__)
+    if (Channels == 2) {
+        // Deinterleave pairs: even lanes are left, odd lanes right
+        const __m128 half = _mm_set1_ps(0.5f);
+        size_t i = 0;
+        for (; i + 4 <= count; i += 4) {
+            const __m128 lo = _mm_loadu_ps(frames + 2 * i);
+            const __m128 hi = _mm_loadu_ps(frames + 2 * i + 4);
+            const __m128 left = _mm_shuffle_ps(lo, hi, _MM_SHUFFLE(2, 0, 2, 0));
+            const __m128 right = _mm_shuffle_ps(lo, hi, _MM_SHUFFLE(3, 1, 3, 1));
+            _mm_storeu_ps(out + i, _mm_mul_ps(_mm_add_ps(left, right), half));
+        }
+        for (; i < count; ++i) {
+            out[i] = (frames[2 * i] + frames[2 * i + 1]) * 0.5f;
+        }
+        return;
+    }
+#endif
+
+    const int stride = Channels > 0 ? Channels : channels;
+    for (size_t i = 0; i < count; ++i) {
+        const float* frame = frames + i * stride;
+        float sum = 0.0f;
+        for (int ch = 0; ch < stride; ++ch) {
+            sum += frame[ch];
+        }
+        out[i] = sum * gain;
+    }
+}
+
+// Integer average; stereo halves the 17-bit sum with an arithmetic shift
+template <int Channels>
+void downmix(const int16_t* frames, size_t count, int channels, int16_t* out) {
+    if (Channels == 2) {
+        size_t i = 0;
+#if defined(__SSE2__)
+        // madd against ones adds each left/right pair into an int32 lane
+        const __m128i ones = _mm_set1_epi16(1);
+        for (; i + 8 <= count; i += 8) {
+            const __m128i lo = _mm_loadu_si128(reinterpret_cast<const __m128i*>(frames + 2 * i));
+            const __m128i hi = _mm_loadu_si128(reinterpret_cast<const __m128i*>(frames + 2 * i + 8));
+            const __m128i sum_lo = _mm_srai_epi32(_mm_madd_epi16(lo, ones), 1);
+            const __m128i sum_hi = _mm_srai_epi32(_mm_madd_epi16(hi, ones), 1);
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(out + i), _mm_packs_epi32(sum_lo, sum_hi));
+        }
+#endif
+        for (; i < count; ++i) {
+            out[i] = static_cast<int16_t>((static_cast<int32_t>(frames[2 * i]) + frames[2 * i + 1]) >> 1);
+        }
+        return;
+    }
+
+    const int stride = Channels > 0 ? Channels : channels;
+    for (size_t i = 0; i < count; ++i) {
+        const int16_t* frame = frames + i * stride;
+        int32_t sum = 0;
+        for (int ch = 0; ch < stride; ++ch) {
+            sum += frame[ch];
+        }
+        out[i] = static_cast<int16_t>(sum / stride);
+    }
+}
+
+} // namespace
+
+PcmDecoder::PcmDecoder()
+    : integer_path_enabled_(true), mapped_reader_enabled_(true) {}
+
+bool PcmDecoder::is_integer_pcm(int format) {
+    switch (format & SF_FORMAT_SUBMASK) {
+    case SF_FORMAT_PCM_S8:
+    case SF_FORMAT_PCM_U8:
+    case SF_FORMAT_PCM_16:
+    case SF_FORMAT_PCM_24:
+    case SF_FORMAT_PCM_32:
+    case SF_FORMAT_ULAW:
+    case SF_FORMAT_ALAW:
+        return true;
+    default:
+        return false;
+    }
+}
+
+size_t PcmDecoder::buffer_bytes() const {
+    return float_frames_.capacity() * sizeof(float) +
+           pcm_frames_.capacity() * sizeof(int16_t) +
+           output_.capacity() * sizeof(int16_t);
+}
+
+PcmDecodeProgress PcmDecoder::decode(const std::string& path, int output_rate, int max_duration_seconds,
+                                     size_t chunk_bytes, const Sink& sink) {
+    return decode_frames(path, output_rate, 0, -1, max_duration_seconds, chunk_bytes, sink);
+}
+
+PcmDecodeProgress PcmDecoder::decode_range(const std::string& path, int output_rate, sf_count_t start_frame,
+                                           sf_count_t frame_count, size_t chunk_bytes, const Sink& sink) {
+    return decode_frames(path, output_rate, std::max<sf_count_t>(0, start_frame), frame_count, 0, chunk_bytes, sink);
+}
+
+PcmDecodeProgress PcmDecoder::decode_frames(const std::string& path, int output_rate, sf_count_t start_frame,
+                                            sf_count_t frame_count, int max_duration_seconds,
+                                            size_t chunk_bytes, const Sink& sink) {
+    if (mapped_reader_enabled_) {
+        // int16 WAVs with the integer path disabled still need libsndfile's float conversion
+        auto wav = WavFile::open(path);
+        if (wav && (wav->format() == WavSampleFormat::Float32 || integer_path_enabled_)) {
+            return decode_mapped(*wav, output_rate, start_frame, frame_count, max_duration_seconds, chunk_bytes, sink);
+        }
+    }
+
+    return decode_sndfile(path, output_rate, start_frame, frame_count, max_duration_seconds, chunk_bytes, sink);
+}
+
+PcmDecodeProgress PcmDecoder::probe(const std::string& path) {
+    PcmDecodeProgress info{};
+
+    auto wav = WavFile::open(path);
+    if (wav) {
+        info.source_rate = wav->sample_rate();
+        info.channels = wav->channels();
+        info.total_frames = static_cast<sf_count_t>(wav->frames());
+        info.mapped = true;
+        return info;
+    }
+
+    SF_INFO sf_info;
+    std::memset(&sf_info, 0, sizeof(sf_info));
+    SNDFILE* file = sf_open(path.c_str(), SFM_READ, &sf_info);
+    if (!file) {
+        throw std::runtime_error("Failed to open audio file: " + path);
+    }
+    sf_close(file);
+
+    info.source_rate = sf_info.samplerate;
+    info.channels = sf_info.channels;
+    info.total_frames = sf_info.frames;
+    return info;
+}
+
+size_t PcmDecoder::prepare(int source_rate, int output_rate, int channels, size_t chunk_bytes) {
+    const size_t chunk_frames = std::max<size_t>(1, chunk_bytes / (channels * sizeof(float)));
+
+    // Size the output once; it only grows, so chunks never allocate
+    resampler_.configure(source_rate, output_rate);
+    const size_t max_outputs = std::max(resampler_.max_output(chunk_frames), resampler_.max_flush_output());
+    if (output_.size() < max_outputs) {
+        output_.resize(max_outputs);
+    }
+    return chunk_frames;
+}
+
+PcmDecodeProgress PcmDecoder::decode_mapped(const WavFile& wav, int output_rate, sf_count_t start_frame,
+                                            sf_count_t frame_count, int max_duration_seconds,
+                                            size_t chunk_bytes, const Sink& sink) {
+    const size_t start = std::min(static_cast<size_t>(start_frame), static_cast<size_t>(wav.frames()));
+    size_t frames = static_cast<size_t>(wav.frames()) - start;
+    if (frame_count >= 0) {
+        frames = std::min(frames, static_cast<size_t>(frame_count));
+    }
+    if (max_duration_seconds > 0) {
+        frames = std::min(frames, static_cast<size_t>(max_duration_seconds) * wav.sample_rate());
+    }
+
+    const size_t offset = start * wav.channels();
+    PcmDecodeProgress progress = wav.format() == WavSampleFormat::Int16
+        ? convert_frames(wav.int16_frames() + offset, frames, wav.channels(), wav.sample_rate(), output_rate, chunk_bytes, sink)
+        : convert_frames(wav.float_frames() + offset, frames, wav.channels(), wav.sample_rate(), output_rate, chunk_bytes, sink);
+    progress.mapped = true;
+    return progress;
+}
+
+PcmDecodeProgress PcmDecoder::convert(const int16_t* frames, size_t frame_count, int channels, int source_rate,
+                                      int output_rate, size_t chunk_bytes, const Sink& sink) {
+    return convert_frames(frames, frame_count, channels, source_rate, output_rate, chunk_bytes, sink);
+}
+
+PcmDecodeProgress PcmDecoder::convert(const float* frames, size_t frame_count, int channels, int source_rate,
+                                      int output_rate, size_t chunk_bytes, const Sink& sink) {
+    return convert_frames(frames, frame_count, channels, source_rate, output_rate, chunk_bytes, sink);
+}
+
+template <typename Sample>
+PcmDecodeProgress PcmDecoder::convert_frames(const Sample* frames, size_t frame_count, int channels, int source_rate,
+                                             int output_rate, size_t chunk_bytes, const Sink& sink) {
+    PcmDecodeProgress progress{};
+    progress.source_rate = source_rate;
+    progress.channels = channels;
+    progress.total_frames = static_cast<sf_count_t>(frame_count);
+    progress.integer_path = std::is_same<Sample, int16_t>::value;
+
+    const size_t chunk_frames = prepare(source_rate, output_rate, channels, chunk_bytes);
+
+    // The frames are already in memory: chunks only bound how much output each sink call sees
+    while (progress.frames_decoded < progress.total_frames) {
+        const size_t count = std::min(chunk_frames, frame_count - static_cast<size_t>(progress.frames_decoded));
+        const Sample* chunk = frames + static_cast<size_t>(progress.frames_decoded) * channels;
+
+        const size_t samples = channels == 1
+            ? resampler_.process(chunk, count, output_.data())
+            : convert_chunk(chunk, count, channels);
+
+        progress.frames_decoded += count;
+        progress.bytes_decoded += count * channels * sizeof(Sample);
+        sink(output_.data(), samples, progress);
+    }
+
+    // Drain the resampler's filter delay
+    const size_t tail = resampler_.flush(output_.data());
+    if (tail > 0) {
+        sink(output_.data(), tail, progress);
+    }
+    return progress;
+}
+
+PcmDecodeProgress PcmDecoder::decode_sndfile(const std::string& path, int output_rate, sf_count_t start_frame,
+                                             sf_count_t frame_count, int max_duration_seconds,
+                                             size_t chunk_bytes, const Sink& sink) {
+    SF_INFO sf_info;
+    std::memset(&sf_info, 0, sizeof(sf_info));
+
+    SNDFILE* file = sf_open(path.c_str(), SFM_READ, &sf_info);
+    if (!file) {
+        throw std::runtime_error("Failed to open audio file: " + path);
+    }
+
+    if (start_frame > 0 && sf_seek(file, std::min(start_frame, sf_info.frames), SEEK_SET) < 0) {
+        sf_close(file);
+        throw std::runtime_error("Failed to seek in audio file: " + path);
+    }
+
+    PcmDecodeProgress progress{};
+    progress.source_rate = sf_info.samplerate;
+    progress.channels = sf_info.channels;
+    progress.total_frames = std::max<sf_count_t>(0, sf_info.frames - start_frame);
+    if (frame_count >= 0) {
+        progress.total_frames = std::min(progress.total_frames, frame_count);
+    }
+    if (max_duration_seconds > 0) {
+        progress.total_frames = std::min(
+            progress.total_frames,
+            static_cast<sf_count_t>(max_duration_seconds) * sf_info.samplerate
+        );
+    }
+    progress.integer_path = integer_path_enabled_ && is_integer_pcm(sf_info.format);
+
+    const int channels = sf_info.channels;
+    const size_t sample_bytes = progress.integer_path ? sizeof(int16_t) : sizeof(float);
+
+    try {
+        const size_t chunk_frames = prepare(sf_info.samplerate, output_rate, channels, chunk_bytes);
+
+        // Mono is read straight into the resampler, so only downmixing needs frame buffers
+        if (channels > 1) {
+            if (progress.integer_path && pcm_frames_.size() < chunk_frames * channels) {
+                pcm_frames_.resize(chunk_frames * channels);
+            } else if (!progress.integer_path && float_frames_.size() < chunk_frames * channels) {
+                float_frames_.resize(chunk_frames * channels);
+            }
+        }
+
+        while (progress.frames_decoded < progress.total_frames) {
+            const sf_count_t frames_to_read = std::min(
+                static_cast<sf_count_t>(chunk_frames),
+                progress.total_frames - progress.frames_decoded
+            );
+
+            sf_count_t frames_read = 0;
+            size_t samples = 0;
+            if (progress.integer_path && channels == 1) {
+                frames_read = sf_readf_short(file, resampler_.pcm_input_buffer(frames_to_read), frames_to_read);
+                samples = frames_read > 0 ? resampler_.process_pcm_input(frames_read, output_.data()) : 0;
+            } else if (progress.integer_path) {
+                frames_read = sf_readf_short(file, pcm_frames_.data(), frames_to_read);
+                samples = frames_read > 0 ? convert_chunk(pcm_frames_.data(), frames_read, channels) : 0;
+            } else if (channels == 1) {
+                frames_read = sf_readf_float(file, resampler_.input_buffer(frames_to_read), frames_to_read);
+                samples = frames_read > 0 ? resampler_.process_input(frames_read, output_.data()) : 0;
+            } else {
+                frames_read = sf_readf_float(file, float_frames_.data(), frames_to_read);
+                samples = frames_read > 0 ? convert_chunk(float_frames_.data(), frames_read, channels) : 0;
+            }
+            if (frames_read <= 0) {
+                break; // End of file or error
+            }
+
+            progress.frames_decoded += frames_read;
+            progress.bytes_decoded += static_cast<size_t>(frames_read) * channels * sample_bytes;
+            sink(output_.data(), samples, progress);
+        }
+
+        // Drain the resampler's filter delay
+        const size_t tail = resampler_.flush(output_.data());
+        if (tail > 0) {
+            sink(output_.data(), tail, progress);
+        }
+    } catch (...) {
+        sf_close(file);
+        throw;
+    }
+
+    sf_close(file);
+    return progress;
+}
+
+std::vector<int16_t> PcmDecoder::decode_all(const std::string& path, int output_rate, int max_duration_seconds,
+                                            PcmDecodeProgress* progress) {
+    std::vector<int16_t> samples;
+    auto append = [&samples, output_rate](const int16_t* data, size_t count, const PcmDecodeProgress& p) {
+        if (samples.empty() && p.source_rate > 0) {
+            samples.reserve(static_cast<size_t>(static_cast<uint64_t>(p.total_frames) * output_rate / p.source_rate) + 2);
+        }
+        samples.insert(samples.end(), data, data + count);
+    };
+
+    const PcmDecodeProgress result = decode(path, output_rate, max_duration_seconds, DEFAULT_CHUNK_BYTES, append);
+    if (progress) {
+        *progress = result;
+    }
+    return samples;
+}
+
+size_t PcmDecoder::convert_chunk(const float* frames, size_t frame_count, int channels) {
+    size_t written = 0;
+
+    for (size_t offset = 0; offset < frame_count; offset += DSP_BLOCK_FRAMES) {
+        const size_t count = std::min(DSP_BLOCK_FRAMES, frame_count - offset);
+        const float* block = frames + offset * channels;
+        float* mono = resampler_.input_buffer(count);
+
+        if (channels == 2) {
+            downmix<2>(block, count, channels, mono);
+        } else {
+            downmix<0>(block, count, channels, mono);
+        }
+
+        written += resampler_.process_input(count, output_.data() + written);
+    }
+
+    return written;
+}
+
+size_t PcmDecoder::convert_chunk(const int16_t* frames, size_t frame_count, int channels) {
+    size_t written = 0;
+
+    for (size_t offset = 0; offset < frame_count; offset += DSP_BLOCK_FRAMES) {
+        const size_t count = std::min(DSP_BLOCK_FRAMES, frame_count - offset);
+        const int16_t* block = frames + offset * channels;
+        int16_t* mono = resampler_.pcm_input_buffer(count);
+
+        if (channels == 2) {
+            downmix<2>(block, count, channels, mono);
+        } else {
+            downmix<0>(block, count, channels, mono);
+        }
+
+        written += resampler_.process_pcm_input(count, output_.data() + written);
+    }
+
+    return written;
+}
+
+} // namespace AudioDuplicates
@@ -0,0 +1,112 @@
+#pragma once
+
+#include <string>
+#include <vector>
+#include <functional>
+#include <cstdint>
+#include <cstddef>
+#include <sndfile.h>
+#include "streaming_resampler.h"
+#include "wav_file.h"
+
+namespace AudioDuplicates {
+
+struct PcmDecodeProgress {
+    int source_rate;
+    int channels;
+    sf_count_t total_frames;   // Frames to decode, after any duration limit
+    sf_count_t frames_decoded;
+    size_t bytes_decoded;      // Decoded interleaved sample bytes (2 per sample on the integer path, 4 otherwise)
+    bool integer_path;         // int16 samples filtered in fixed point
+    bool mapped;               // Read through the WavFile mapping instead of libsndfile
+};
+
+/**
+ * Chunked decoder producing int16 mono at a target rate for fingerprinting
+ * Integer PCM sources are read as int16 and downmixed and resampled in fixed
+ * point; other formats go through float. 16-bit and float WAV/RF64 files are
+ * read from a memory map without libsndfile. Stage buffers are reused across files
+ */
+class PcmDecoder {
+public:
+    // Receives each chunk's output; the samples are only valid during the call
+    using Sink = std::function<void(const int16_t* samples, size_t count, const PcmDecodeProgress& progress)>;
+
+    PcmDecoder();
+
+    // Decode path to int16 mono at output_rate, chunk_bytes of float frames per read
+    // (half that on the integer path). max_duration_seconds <= 0 decodes everything.
+    // Throws if the file cannot be opened
+    PcmDecodeProgress decode(const std::string& path, int output_rate, int max_duration_seconds,
+                             size_t chunk_bytes, const Sink& sink);
+
+    // Decode frame_count source frames from start_frame (sf_seek, or an offset into
+    // the mapping); frame_count < 0 decodes to the end. The resampler starts fresh
+    PcmDecodeProgress decode_range(const std::string& path, int output_rate, sf_count_t start_frame,
+                                   sf_count_t frame_count, size_t chunk_bytes, const Sink& sink);
+
+    // Source rate, channels and length without decoding; throws if the file cannot be opened
+    static PcmDecodeProgress probe(const std::string& path);
+
+    // Downmix and resample interleaved frames already in memory (a decode stage's
+    // output), with the same chunking and sink contract as decode()
+    PcmDecodeProgress convert(const int16_t* frames, size_t frame_count, int channels, int source_rate,
+                              int output_rate, size_t chunk_bytes, const Sink& sink);
+    PcmDecodeProgress convert(const float* frames, size_t frame_count, int channels, int source_rate,
+                              int output_rate, size_t chunk_bytes, const Sink& sink);
+
+    // Whole signal in one buffer
+    std::vector<int16_t> decode_all(const std::string& path, int output_rate, int max_duration_seconds,
+                                    PcmDecodeProgress* progress = nullptr);
+
+    // Disable to force the float path (comparisons and benchmarks)
+    void set_integer_path(bool enabled) { integer_path_enabled_ = enabled; }
+    bool integer_path_enabled() const { return integer_path_enabled_; }
+
+    // Disable to always decode through libsndfile
+    void set_mapped_reader(bool enabled) { mapped_reader_enabled_ = enabled; }
+    bool mapped_reader_enabled() const { return mapped_reader_enabled_; }
+
+    // Bytes held by the stage buffers
+    size_t buffer_bytes() const;
+
+    // Subtypes libsndfile decodes losslessly to int16 (scaled down for 24/32-bit)
+    static bool is_integer_pcm(int format);
+
+    static constexpr size_t DSP_BLOCK_FRAMES = 4096;
+    static constexpr size_t DEFAULT_CHUNK_BYTES = 1024 * 1024;
+
+private:
+    bool integer_path_enabled_;
+    bool mapped_reader_enabled_;
+    std::vector<float> float_frames_;
+    std::vector<int16_t> pcm_frames_;
+    std::vector<int16_t> output_;
+    StreamingResampler resampler_;
+
+    // Frames [start_frame, start_frame + frame_count) capped at max_duration_seconds
+    // (<= 0: no cap); frame_count < 0 runs to the end of the file
+    PcmDecodeProgress decode_mapped(const WavFile& wav, int output_rate, sf_count_t start_frame,
+                                    sf_count_t frame_count, int max_duration_seconds,
+                                    size_t chunk_bytes, const Sink& sink);
+    PcmDecodeProgress decode_sndfile(const std::string& path, int output_rate, sf_count_t start_frame,
+                                     sf_count_t frame_count, int max_duration_seconds,
+                                     size_t chunk_bytes, const Sink& sink);
+    PcmDecodeProgress decode_frames(const std::string& path, int output_rate, sf_count_t start_frame,
+                                    sf_count_t frame_count, int max_duration_seconds,
+                                    size_t chunk_bytes, const Sink& sink);
+
+    // Configure the resampler for a new file and size output_ for chunk_frames; returns chunk_frames
+    size_t prepare(int source_rate, int output_rate, int channels, size_t chunk_bytes);
+
+    // Downmix one chunk into the resampler a block at a time, so the mono samples
+    // are still in cache when the filter reads them; returns samples written to output_
+    size_t convert_chunk(const float* frames, size_t frame_count, int channels);
+    size_t convert_chunk(const int16_t* frames, size_t frame_count, int channels);
+
+    template <typename Sample>
+    PcmDecodeProgress convert_frames(const Sample* frames, size_t frame_count, int channels, int source_rate,
+                                     int output_rate, size_t chunk_bytes, const Sink& sink);
+};
+
+} // namespace AudioDuplicates
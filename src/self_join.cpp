@@ -0,0 +1,452 @@
+#include "self_join.h"
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <exception>
+#include <stdexcept>
+#include <queue>
+#include <omp.h>
+
+namespace AudioDuplicates {
+
+namespace {
+
+constexpr unsigned HASH_SHIFT = SelfJoinEngine::FILE_ID_BITS + SelfJoinEngine::POSITION_BITS;
+constexpr uint64_t FILE_ID_MASK = (uint64_t{1} << SelfJoinEngine::FILE_ID_BITS) - 1;
+constexpr uint64_t POSITION_MASK = (uint64_t{1} << SelfJoinEngine::POSITION_BITS) - 1;
+
+inline uint16_t tuple_hash(uint64_t tuple) {
+    return static_cast<uint16_t>(tuple >> HASH_SHIFT);
+}
+
+inline uint32_t tuple_file(uint64_t tuple) {
+    return static_cast<uint32_t>((tuple >> SelfJoinEngine::POSITION_BITS) & FILE_ID_MASK);
+}
+
+inline int32_t tuple_position(uint64_t tuple) {
+    return static_cast<int32_t>(tuple & POSITION_MASK);
+}
+
+std::atomic<unsigned> g_spill_sequence{0};
+
+} // namespace
+
+SelfJoinEngine::SelfJoinEngine(const SelfJoinConfig& config)
+    : config_(config), vote_spill_file_(nullptr), votes_spilled_(0), stats_{} {
+    config_.partition_bits = std::min<size_t>(config_.partition_bits, 16);
+    config_.spill_buffer_tuples = std::max<size_t>(config_.spill_buffer_tuples, 1024);
+    partitions_.resize(size_t{1} << config_.partition_bits);
+}
+
+SelfJoinEngine::~SelfJoinEngine() {
+    release_partitions();
+    release_vote_spill();
+}
+
+void SelfJoinEngine::add(uint32_t file_id, const uint32_t* frames, size_t frame_count) {
+    if (file_id > FILE_ID_MASK) {
+        throw std::out_of_range("File id exceeds self-join tuple capacity");
+    }
+
+    // Positions past 2^20 frames (~37 hours of audio) are not representable and are dropped
+    frame_count = std::min<size_t>(frame_count, POSITION_MASK + 1);
+
+    const unsigned partition_shift = 16 - static_cast<unsigned>(config_.partition_bits);
+    const uint64_t file_bits = static_cast<uint64_t>(file_id) << POSITION_BITS;
+
+    for (size_t pos = 0; pos < frame_count; ++pos) {
+        const uint16_t hash = static_cast<uint16_t>(frames[pos] & 0xFFFF);
+        const size_t partition = hash >> partition_shift;
+
+        partitions_[partition].buffer.push_back(
+            (static_cast<uint64_t>(hash) << HASH_SHIFT) | file_bits | pos);
+
+        if (!config_.spill_directory.empty() &&
+            partitions_[partition].buffer.size() >= config_.spill_buffer_tuples) {
+            flush_partition(partition);
+        }
+    }
+
+    stats_.tuples_emitted += frame_count;
+}
+
+std::vector<CandidatePair> SelfJoinEngine::run() {
+    const int threads = config_.num_threads > 0 ? static_cast<int>(config_.num_threads) : omp_get_max_threads();
+
+    std::vector<VoteRun> runs;
+    size_t runs_skipped = 0;
+    size_t pair_votes = 0;
+    std::exception_ptr failure;
+
+    // Partitions hold disjoint hash ranges, so each is sorted and scanned independently
+    #pragma omp parallel for num_threads(threads) schedule(dynamic) reduction(+:runs_skipped, pair_votes)
+    for (int p = 0; p < static_cast<int>(partitions_.size()); ++p) {
+        try {
+            std::vector<Tuple> tuples = load_partition(static_cast<size_t>(p));
+            if (tuples.size() < 2) {
+                continue;
+            }
+
+            radix_sort_hash(tuples);
+            auto votes = scan_runs(tuples, runs_skipped, pair_votes);
+            std::vector<Tuple>().swap(tuples);
+
+            if (!votes.empty()) {
+                #pragma omp critical
+                {
+                    store_run(std::move(votes), runs);
+                }
+            }
+        } catch (...) {
+            #pragma omp critical
+            {
+                if (!failure) {
+                    failure = std::current_exception();
+                }
+            }
+        }
+    }
+
+    release_partitions();
+
+    if (failure) {
+        release_vote_spill();
+        std::rethrow_exception(failure);
+    }
+
+    stats_.runs_skipped = runs_skipped;
+    stats_.pair_votes = pair_votes;
+
+    std::vector<CandidatePair> pairs;
+    try {
+        pairs = merge_runs(runs);
+    } catch (...) {
+        release_vote_spill();
+        throw;
+    }
+    release_vote_spill();
+
+    stats_.candidate_pairs = pairs.size();
+    return pairs;
+}
+
+void SelfJoinEngine::store_run(std::vector<PairVote>&& votes, std::vector<VoteRun>& runs) {
+    VoteRun run;
+    if (config_.spill_directory.empty()) {
+        run.votes = std::move(votes);
+        runs.push_back(std::move(run));
+        return;
+    }
+
+    if (!vote_spill_file_) {
+        vote_spill_path_ = config_.spill_directory + "/audio-duplicates-votes-" +
+                           std::to_string(g_spill_sequence.fetch_add(1)) + ".tmp";
+        vote_spill_file_ = std::fopen(vote_spill_path_.c_str(), "w+b");
+        if (!vote_spill_file_) {
+            throw std::runtime_error("Failed to create spill file: " + vote_spill_path_);
+        }
+    }
+
+    size_t written = std::fwrite(votes.data(), sizeof(PairVote), votes.size(), vote_spill_file_);
+    if (written != votes.size()) {
+        throw std::runtime_error("Failed to write spill file: " + vote_spill_path_);
+    }
+
+    run.file_offset = votes_spilled_;
+    run.unread = votes.size();
+    votes_spilled_ += votes.size();
+    stats_.bytes_spilled += votes.size() * sizeof(PairVote);
+    runs.push_back(std::move(run));
+}
+
+bool SelfJoinEngine::refill_run(VoteRun& run, size_t window) {
+    run.votes.clear();
+    run.next = 0;
+    if (run.unread == 0) {
+        return false;
+    }
+
+    const size_t count = std::min(window, run.unread);
+    run.votes.resize(count);
+
+    const uint64_t byte_offset = run.file_offset * sizeof(PairVote);
+#ifdef _WIN32
+    const bool positioned = _fseeki64(vote_spill_file_, static_cast<__int64>(byte_offset), SEEK_SET) == 0;
+#else
+    const bool positioned = fseeko(vote_spill_file_, static_cast<off_t>(byte_offset), SEEK_SET) == 0;
+#endif
+    if (!positioned || std::fread(run.votes.data(), sizeof(PairVote), count, vote_spill_file_) != count) {
+        throw std::runtime_error("Failed to read spill file: " + vote_spill_path_);
+    }
+
+    run.file_offset += count;
+    run.unread -= count;
+    return true;
+}
+
+std::vector<CandidatePair> SelfJoinEngine::merge_runs(std::vector<VoteRun>& runs) {
+    // Spilled runs share the tuple buffer budget as read windows
+    const size_t window = runs.empty() ? 0 :
+        std::max<size_t>(64, config_.spill_buffer_tuples * sizeof(Tuple) / sizeof(PairVote) / runs.size());
+    if (vote_spill_file_ && std::fflush(vote_spill_file_) != 0) {
+        throw std::runtime_error("Failed to flush spill file: " + vote_spill_path_);
+    }
+    for (auto& run : runs) {
+        if (run.votes.empty()) {
+            refill_run(run, window);
+        }
+    }
+
+    auto vote_greater = [&runs](size_t a, size_t b) {
+        const PairVote& x = runs[a].votes[runs[a].next];
+        const PairVote& y = runs[b].votes[runs[b].next];
+        if (x.file_a != y.file_a) return x.file_a > y.file_a;
+        if (x.file_b != y.file_b) return x.file_b > y.file_b;
+        return x.delta > y.delta;
+    };
+    std::priority_queue<size_t, std::vector<size_t>, decltype(vote_greater)> heap(vote_greater);
+    for (size_t r = 0; r < runs.size(); ++r) {
+        if (!runs[r].votes.empty()) {
+            heap.push(r);
+        }
+    }
+
+    // The merged stream is sorted by (a, b, delta); the same (a, b, delta) can come
+    // from several partitions, so counts are summed before the modal offset is chosen
+    std::vector<CandidatePair> pairs;
+    bool pair_open = false;
+    bool delta_open = false;
+    CandidatePair current{};
+    uint32_t best_count = 0;
+    int32_t delta = 0;
+    uint32_t delta_count = 0;
+
+    auto close_delta = [&]() {
+        if (!delta_open) {
+            return;
+        }
+        current.votes += delta_count;
+        if (delta_count > best_count ||
+            (delta_count == best_count && std::abs(delta) < std::abs(current.offset_hint))) {
+            best_count = delta_count;
+            current.offset_hint = delta;
+        }
+        delta_open = false;
+    };
+    auto close_pair = [&]() {
+        close_delta();
+        if (pair_open && current.votes >= config_.min_votes) {
+            pairs.push_back(current);
+        }
+        pair_open = false;
+    };
+
+    while (!heap.empty()) {
+        const size_t r = heap.top();
+        heap.pop();
+        VoteRun& run = runs[r];
+        const PairVote vote = run.votes[run.next++];
+        if (run.next < run.votes.size() || refill_run(run, window)) {
+            heap.push(r);
+        }
+
+        if (pair_open && (vote.file_a != current.file_a || vote.file_b != current.file_b)) {
+            close_pair();
+        }
+        if (!pair_open) {
+            current = {vote.file_a, vote.file_b, 0, 0};
+            best_count = 0;
+            pair_open = true;
+        }
+        if (delta_open && vote.delta == delta) {
+            delta_count += vote.count;
+        } else {
+            close_delta();
+            delta = vote.delta;
+            delta_count = vote.count;
+            delta_open = true;
+        }
+    }
+    close_pair();
+
+    return pairs;
+}
+
+void SelfJoinEngine::flush_partition(size_t index) {
+    Partition& partition = partitions_[index];
+    if (partition.buffer.empty()) {
+        return;
+    }
+
+    if (!partition.spill_file) {
+        partition.spill_path = config_.spill_directory + "/audio-duplicates-join-" +
+                               std::to_string(g_spill_sequence.fetch_add(1)) + "-" +
+                               std::to_string(index) + ".tmp";
+        partition.spill_file = std::fopen(partition.spill_path.c_str(), "w+b");
+        if (!partition.spill_file) {
+            throw std::runtime_error("Failed to create spill file: " + partition.spill_path);
+        }
+    }
+
+    size_t written = std::fwrite(partition.buffer.data(), sizeof(Tuple), partition.buffer.size(), partition.spill_file);
+    if (written != partition.buffer.size()) {
+        throw std::runtime_error("Failed to write spill file: " + partition.spill_path);
+    }
+
+    partition.spilled_tuples += written;
+    stats_.bytes_spilled += written * sizeof(Tuple);
+    partition.buffer.clear();
+}
+
+std::vector<SelfJoinEngine::Tuple> SelfJoinEngine::load_partition(size_t index) {
+    Partition& partition = partitions_[index];
+
+    std::vector<Tuple> tuples;
+    tuples.reserve(partition.spilled_tuples + partition.buffer.size());
+
+    if (partition.spill_file) {
+        tuples.resize(partition.spilled_tuples);
+        std::rewind(partition.spill_file);
+        size_t read = std::fread(tuples.data(), sizeof(Tuple), partition.spilled_tuples, partition.spill_file);
+        if (read != partition.spilled_tuples) {
+            throw std::runtime_error("Failed to read spill file: " + partition.spill_path);
+        }
+    }
+
+    tuples.insert(tuples.end(), partition.buffer.begin(), partition.buffer.end());
+    std::vector<Tuple>().swap(partition.buffer);
+
+    return tuples;
+}
+
+void SelfJoinEngine::release_partitions() {
+    for (auto& partition : partitions_) {
+        if (partition.spill_file) {
+            std::fclose(partition.spill_file);
+            std::remove(partition.spill_path.c_str());
+            partition.spill_file = nullptr;
+        }
+        partition.spilled_tuples = 0;
+        std::vector<Tuple>().swap(partition.buffer);
+    }
+}
+
+void SelfJoinEngine::release_vote_spill() {
+    if (vote_spill_file_) {
+        std::fclose(vote_spill_file_);
+        std::remove(vote_spill_path_.c_str());
+        vote_spill_file_ = nullptr;
+    }
+    votes_spilled_ = 0;
+}
+
+void SelfJoinEngine::radix_sort_hash(std::vector<Tuple>& tuples) const {
+    // The partition already fixes the top hash bits; sort the rest 8 bits per pass
+    const unsigned sort_bits = 16 - static_cast<unsigned>(config_.partition_bits);
+    if (sort_bits == 0) {
+        return;
+    }
+
+    std::vector<Tuple> scratch(tuples.size());
+
+    for (unsigned shift = 0; shift < sort_bits; shift += 8) {
+        const unsigned digit_bits = std::min(8u, sort_bits - shift);
+        const uint64_t digit_mask = (uint64_t{1} << digit_bits) - 1;
+        const unsigned digit_shift = HASH_SHIFT + shift;
+
+        size_t counts[257] = {0};
+        for (Tuple tuple : tuples) {
+            counts[((tuple >> digit_shift) & digit_mask) + 1]++;
+        }
+        for (size_t d = 1; d < 257; ++d) {
+            counts[d] += counts[d - 1];
+        }
+        for (Tuple tuple : tuples) {
+            scratch[counts[(tuple >> digit_shift) & digit_mask]++] = tuple;
+        }
+
+        tuples.swap(scratch);
+    }
+}
+
+std::vector<SelfJoinEngine::PairVote> SelfJoinEngine::scan_runs(const std::vector<Tuple>& tuples,
+                                                                size_t& runs_skipped,
+                                                                size_t& pair_votes) const {
+    std::vector<PairVote> votes;
+    size_t reduce_at = size_t{1} << 20;
+
+    size_t run_start = 0;
+    while (run_start < tuples.size()) {
+        const uint16_t hash = tuple_hash(tuples[run_start]);
+        size_t run_end = run_start + 1;
+        while (run_end < tuples.size() && tuple_hash(tuples[run_end]) == hash) {
+            ++run_end;
+        }
+
+        if (run_end - run_start > config_.max_run_length) {
+            runs_skipped++;
+            run_start = run_end;
+            continue;
+        }
+
+        for (size_t i = run_start; i < run_end; ++i) {
+            for (size_t j = i + 1; j < run_end; ++j) {
+                uint32_t file_i = tuple_file(tuples[i]);
+                uint32_t file_j = tuple_file(tuples[j]);
+                if (file_i == file_j) {
+                    continue;
+                }
+
+                int32_t pos_i = tuple_position(tuples[i]);
+                int32_t pos_j = tuple_position(tuples[j]);
+                if (file_i > file_j) {
+                    std::swap(file_i, file_j);
+                    std::swap(pos_i, pos_j);
+                }
+
+                const int32_t delta = pos_j - pos_i;
+                if (std::abs(delta) > config_.max_offset) {
+                    continue;
+                }
+
+                votes.push_back({file_i, file_j, delta, 1});
+                pair_votes++;
+            }
+        }
+
+        // Keep the partition's vote table bounded by reducing as it grows
+        if (votes.size() >= reduce_at) {
+            reduce_votes(votes);
+            reduce_at = std::max(reduce_at, votes.size() * 2);
+        }
+
+        run_start = run_end;
+    }
+
+    reduce_votes(votes);
+    return votes;
+}
+
+void SelfJoinEngine::reduce_votes(std::vector<PairVote>& votes) {
+    std::sort(votes.begin(), votes.end(),
+              [](const PairVote& a, const PairVote& b) {
+                  if (a.file_a != b.file_a) return a.file_a < b.file_a;
+                  if (a.file_b != b.file_b) return a.file_b < b.file_b;
+                  return a.delta < b.delta;
+              });
+
+    size_t out = 0;
+    for (size_t i = 0; i < votes.size(); ++i) {
+        if (out > 0 &&
+            votes[out - 1].file_a == votes[i].file_a &&
+            votes[out - 1].file_b == votes[i].file_b &&
+            votes[out - 1].delta == votes[i].delta) {
+            votes[out - 1].count += votes[i].count;
+        } else {
+            votes[out++] = votes[i];
+        }
+    }
+    votes.resize(out);
+}
+
+} // namespace AudioDuplicates
@@ -0,0 +1,118 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <cstdint>
+#include <cstdio>
+#include <cstddef>
+
+namespace AudioDuplicates {
+
+// Candidate pair produced by the self-join, with an alignment hint for the comparator
+struct CandidatePair {
+    uint32_t file_a;     // Always smaller than file_b
+    uint32_t file_b;
+    uint32_t votes;      // Hash matches at any accepted offset
+    int32_t offset_hint; // Most voted (position in b - position in a)
+};
+
+struct SelfJoinConfig {
+    size_t min_votes = 5;                 // Minimum hash matches for a pair to be emitted
+    int max_offset = 360;                 // Offset deltas beyond this are not counted
+    size_t max_run_length = 4096;         // Skip hashes shared by more tuples than this (stop words)
+    size_t partition_bits = 8;            // Tuples are partitioned by the top bits of the hash
+    std::string spill_directory;          // Spill tuple partitions and vote runs here when set (empty = in memory)
+    size_t spill_buffer_tuples = 1 << 16; // Per-partition buffer before flushing to disk; also the merge's read budget
+    size_t num_threads = 0;               // 0 = OpenMP default
+};
+
+/**
+ * Sort-merge self-join for bulk all-pairs candidate discovery
+ * Emits (hash, file_id, position) tuples for every fingerprint, radix sorts them
+ * partition by partition (optionally spilled to disk) and scans equal-hash runs
+ * to vote on (file_a, file_b, offset delta), replacing one index query per file.
+ * Each partition's reduced votes form a sorted run (spilled too when spilling),
+ * and the runs are k-way merged into pairs, so no global vote table is built
+ */
+class SelfJoinEngine {
+public:
+    explicit SelfJoinEngine(const SelfJoinConfig& config = SelfJoinConfig{});
+    ~SelfJoinEngine();
+
+    // Emit tuples for one fingerprint (ids must fit in 28 bits, positions in 20 bits)
+    void add(uint32_t file_id, const uint32_t* frames, size_t frame_count);
+
+    // Sort, scan and reduce all tuples into candidate pairs sorted by (file_a, file_b)
+    std::vector<CandidatePair> run();
+
+    struct Stats {
+        size_t tuples_emitted;
+        size_t bytes_spilled;
+        size_t runs_skipped;   // Equal-hash runs dropped by max_run_length
+        size_t pair_votes;     // (file_a, file_b, delta) votes before reduction
+        size_t candidate_pairs;
+    };
+    Stats getStats() const { return stats_; }
+
+    static constexpr unsigned FILE_ID_BITS = 28;
+    static constexpr unsigned POSITION_BITS = 20;
+
+private:
+    // Packed tuple: hash (16) | file_id (28) | position (20)
+    using Tuple = uint64_t;
+
+    struct Partition {
+        std::vector<Tuple> buffer;
+        std::FILE* spill_file = nullptr;
+        std::string spill_path;
+        size_t spilled_tuples = 0;
+    };
+
+    struct PairVote {
+        uint32_t file_a;
+        uint32_t file_b;
+        int32_t delta;
+        uint32_t count;
+    };
+
+    // One partition's votes sorted by (a, b, delta): held in memory, or read back
+    // from the vote spill file a window at a time during the merge
+    struct VoteRun {
+        std::vector<PairVote> votes;
+        size_t next = 0;
+        uint64_t file_offset = 0; // Next unread vote in the spill file, in votes
+        size_t unread = 0;        // Votes still in the spill file
+    };
+
+    SelfJoinConfig config_;
+    std::vector<Partition> partitions_;
+    std::FILE* vote_spill_file_;
+    std::string vote_spill_path_;
+    uint64_t votes_spilled_;
+    Stats stats_;
+
+    void flush_partition(size_t index);
+    std::vector<Tuple> load_partition(size_t index);
+    void release_partitions();
+    void release_vote_spill();
+
+    // Keep a partition's reduced votes as a run, writing them out when spilling
+    void store_run(std::vector<PairVote>&& votes, std::vector<VoteRun>& runs);
+
+    // Read the next window of a spilled run; false once it is exhausted
+    bool refill_run(VoteRun& run, size_t window);
+
+    // Merge the sorted runs into one candidate per pair with its modal offset
+    std::vector<CandidatePair> merge_runs(std::vector<VoteRun>& runs);
+
+    // LSD radix sort on the hash bits below the partition prefix
+    void radix_sort_hash(std::vector<Tuple>& tuples) const;
+
+    // Scan equal-hash runs of a sorted partition into reduced (a, b, delta) votes
+    std::vector<PairVote> scan_runs(const std::vector<Tuple>& tuples, size_t& runs_skipped, size_t& pair_votes) const;
+
+    // Sort votes by (a, b, delta) and merge duplicates
+    static void reduce_votes(std::vector<PairVote>& votes);
+};
+
+} // namespace AudioDuplicates
@@ -0,0 +1,218 @@
+#include "similarity_join.h"
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <numeric>
+
+namespace AudioDuplicates {
+
+namespace {
+
+// Prefix bounds are derived with a slightly lowered threshold so floating point
+// rounding can only make the filter more permissive; verification is exact
+constexpr double THRESHOLD_SLACK = 1e-9;
+
+inline double jaccard_of(size_t overlap, size_t size_a, size_t size_b) {
+    size_t union_size = size_a + size_b - overlap;
+    return union_size > 0 ? static_cast<double>(overlap) / union_size : 0.0;
+}
+
+} // namespace
+
+PrefixFilterJoin::PrefixFilterJoin(double threshold)
+    : threshold_(threshold), stats_{} {
+}
+
+uint32_t PrefixFilterJoin::add(const uint16_t* hashes, size_t count) {
+    std::vector<uint16_t> record(hashes, hashes + count);
+    std::sort(record.begin(), record.end());
+    record.erase(std::unique(record.begin(), record.end()), record.end());
+
+    records_.push_back(std::move(record));
+    return static_cast<uint32_t>(records_.size() - 1);
+}
+
+std::vector<SimilarPair> PrefixFilterJoin::run() {
+    stats_ = {};
+    stats_.records = records_.size();
+
+    // Without a positive threshold every pair qualifies and no filter applies
+    if (threshold_ <= 0.0) {
+        auto pairs = run_all_pairs();
+        stats_.candidates = pairs.size();
+        stats_.verified_pairs = pairs.size();
+        return pairs;
+    }
+
+    // Global token order: rarest hash first, so prefixes hold the most selective tokens
+    std::array<uint32_t, 65536> frequency{};
+    for (const auto& record : records_) {
+        for (uint16_t hash : record) {
+            frequency[hash]++;
+        }
+    }
+
+    std::vector<uint16_t> order(65536);
+    std::iota(order.begin(), order.end(), 0);
+    std::stable_sort(order.begin(), order.end(),
+                     [&frequency](uint16_t a, uint16_t b) { return frequency[a] < frequency[b]; });
+
+    std::vector<uint16_t> rank(65536);
+    for (size_t i = 0; i < order.size(); ++i) {
+        rank[order[i]] = static_cast<uint16_t>(i);
+    }
+
+    // Re-express every record as sorted ranks
+    std::vector<std::vector<uint16_t>> ranked(records_.size());
+    for (size_t r = 0; r < records_.size(); ++r) {
+        ranked[r].reserve(records_[r].size());
+        for (uint16_t hash : records_[r]) {
+            ranked[r].push_back(rank[hash]);
+        }
+        std::sort(ranked[r].begin(), ranked[r].end());
+    }
+
+    // Probe records in ascending size so every indexed record is no larger
+    std::vector<uint32_t> by_size(records_.size());
+    std::iota(by_size.begin(), by_size.end(), 0);
+    std::stable_sort(by_size.begin(), by_size.end(),
+                     [&ranked](uint32_t a, uint32_t b) { return ranked[a].size() < ranked[b].size(); });
+
+    std::vector<std::vector<Posting>> inverted(65536);
+    std::vector<size_t> list_start(65536, 0);
+
+    // Per-probe accumulated overlap; -1 marks a candidate pruned by the positional filter
+    std::vector<int32_t> overlap(records_.size(), 0);
+    std::vector<uint32_t> touched;
+
+    std::vector<SimilarPair> pairs;
+    const double t = threshold_ - THRESHOLD_SLACK;
+
+    for (uint32_t x : by_size) {
+        const auto& record_x = ranked[x];
+        const size_t size_x = record_x.size();
+        if (size_x == 0) {
+            continue;
+        }
+
+        const size_t min_size = static_cast<size_t>(std::ceil(t * size_x));
+        const size_t probe_prefix = probe_prefix_length(size_x);
+
+        for (size_t i = 0; i < probe_prefix; ++i) {
+            const uint16_t token = record_x[i];
+            auto& list = inverted[token];
+
+            // Length filter: lists grow in size order, so too-small records drop off the front
+            size_t& start = list_start[token];
+            while (start < list.size() && ranked[list[start].record].size() < min_size) {
+                ++start;
+            }
+
+            for (size_t e = start; e < list.size(); ++e) {
+                const uint32_t y = list[e].record;
+                if (overlap[y] < 0) {
+                    continue;
+                }
+
+                const size_t size_y = ranked[y].size();
+                const size_t alpha = required_overlap(size_x, size_y);
+
+                // Positional filter: tokens left after these positions bound the final overlap
+                const size_t remaining = 1 + std::min(size_x - i - 1, size_y - list[e].position - 1);
+                if (static_cast<size_t>(overlap[y]) + remaining >= alpha) {
+                    if (overlap[y] == 0) {
+                        touched.push_back(y);
+                    }
+                    overlap[y]++;
+                } else {
+                    if (overlap[y] == 0) {
+                        touched.push_back(y);
+                    }
+                    overlap[y] = -1;
+                }
+            }
+        }
+
+        // Verify surviving candidates with an exact overlap count
+        for (uint32_t y : touched) {
+            if (overlap[y] > 0) {
+                stats_.candidates++;
+
+                const auto& record_y = ranked[y];
+                const size_t common = count_overlap(record_x, record_y);
+                const double jaccard = jaccard_of(common, size_x, record_y.size());
+
+                if (jaccard >= threshold_) {
+                    pairs.push_back({std::min(x, y), std::max(x, y), jaccard});
+                }
+            }
+            overlap[y] = 0;
+        }
+        touched.clear();
+
+        // Index only the prefix any future (larger) record could need to meet
+        const size_t index_prefix = index_prefix_length(size_x);
+        for (size_t i = 0; i < index_prefix; ++i) {
+            inverted[record_x[i]].push_back({x, static_cast<uint32_t>(i)});
+        }
+        stats_.prefix_entries += index_prefix;
+    }
+
+    std::sort(pairs.begin(), pairs.end(),
+              [](const SimilarPair& a, const SimilarPair& b) {
+                  return a.record_a != b.record_a ? a.record_a < b.record_a : a.record_b < b.record_b;
+              });
+
+    stats_.verified_pairs = pairs.size();
+    return pairs;
+}
+
+size_t PrefixFilterJoin::probe_prefix_length(size_t size) const {
+    const double t = threshold_ - THRESHOLD_SLACK;
+    const size_t keep = static_cast<size_t>(std::ceil(t * size));
+    return std::min(size, size - std::min(size, keep) + 1);
+}
+
+size_t PrefixFilterJoin::index_prefix_length(size_t size) const {
+    // Against records at least as large, overlap must reach 2t/(1+t) of this size
+    const double t = threshold_ - THRESHOLD_SLACK;
+    const size_t keep = static_cast<size_t>(std::ceil(2.0 * t / (1.0 + t) * size));
+    return std::min(size, size - std::min(size, keep) + 1);
+}
+
+size_t PrefixFilterJoin::required_overlap(size_t size_a, size_t size_b) const {
+    const double t = threshold_ - THRESHOLD_SLACK;
+    return static_cast<size_t>(std::ceil(t / (1.0 + t) * (size_a + size_b)));
+}
+
+size_t PrefixFilterJoin::count_overlap(const std::vector<uint16_t>& a, const std::vector<uint16_t>& b) {
+    size_t common = 0;
+    size_t i = 0;
+    size_t j = 0;
+    while (i < a.size() && j < b.size()) {
+        if (a[i] < b[j]) {
+            ++i;
+        } else if (a[i] > b[j]) {
+            ++j;
+        } else {
+            ++common;
+            ++i;
+            ++j;
+        }
+    }
+    return common;
+}
+
+std::vector<SimilarPair> PrefixFilterJoin::run_all_pairs() const {
+    std::vector<SimilarPair> pairs;
+    for (size_t a = 0; a < records_.size(); ++a) {
+        for (size_t b = a + 1; b < records_.size(); ++b) {
+            size_t common = count_overlap(records_[a], records_[b]);
+            pairs.push_back({static_cast<uint32_t>(a), static_cast<uint32_t>(b),
+                             jaccard_of(common, records_[a].size(), records_[b].size())});
+        }
+    }
+    return pairs;
+}
+
+} // namespace AudioDuplicates
@@ -0,0 +1,61 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace AudioDuplicates {
+
+// Pair of records whose hash sets reach the Jaccard threshold
+struct SimilarPair {
+    uint32_t record_a; // Always smaller than record_b
+    uint32_t record_b;
+    double jaccard;
+};
+
+/**
+ * All-pairs Jaccard join over 16-bit hash sets using prefix filtering (PPJoin)
+ * Tokens are ordered by global rarity and only each set's prefix is indexed, so
+ * pairs that cannot reach the threshold are never enumerated. Produces exactly
+ * the pairs FingerprintComparator::quick_filter accepts for the same threshold
+ */
+class PrefixFilterJoin {
+public:
+    explicit PrefixFilterJoin(double threshold);
+
+    // Add a record's raw hashes (duplicates allowed); returns the record id
+    uint32_t add(const uint16_t* hashes, size_t count);
+
+    // Run the join; pairs are sorted by (record_a, record_b)
+    std::vector<SimilarPair> run();
+
+    struct Stats {
+        size_t records;
+        size_t prefix_entries;     // Inverted list entries actually indexed
+        size_t candidates;         // Pairs surviving length and positional filters
+        size_t verified_pairs;     // Pairs reaching the threshold
+    };
+    Stats getStats() const { return stats_; }
+
+private:
+    double threshold_;
+    std::vector<std::vector<uint16_t>> records_; // Sorted unique hashes per record
+    Stats stats_;
+
+    struct Posting {
+        uint32_t record;
+        uint32_t position;
+    };
+
+    // Number of leading tokens that must be probed / indexed for a set of this size
+    size_t probe_prefix_length(size_t size) const;
+    size_t index_prefix_length(size_t size) const;
+
+    // Minimum overlap for two sets of these sizes to reach the threshold
+    size_t required_overlap(size_t size_a, size_t size_b) const;
+
+    static size_t count_overlap(const std::vector<uint16_t>& a, const std::vector<uint16_t>& b);
+    std::vector<SimilarPair> run_all_pairs() const;
+};
+
+} // namespace AudioDuplicates
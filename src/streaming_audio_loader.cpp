@@ -2,12 +2,69 @@
 #include <chrono>
 #include <stdexcept>
 #include <cstring>
+#include <cmath>
 #include <algorithm>
-#include <sndfile.h>
+#include <atomic>
+#include <exception>
+#include <mutex>
+#include <thread>
 #include <chromaprint.h>
 
 namespace AudioDuplicates {
 
+namespace {
+
+// One overlapping slice of a long file and the raw frames Chromaprint produced for it
+struct Segment {
+    int64_t origin;          // Global item index of the segment's first raw frame
+    sf_count_t start_frame;
+    sf_count_t frame_count;
+    std::vector<uint32_t> raw;
+    size_t bytes_decoded = 0;
+    size_t buffer_bytes = 0;
+    std::exception_ptr error;
+};
+
+// Fraction of differing bits between a and b over global items [begin, end)
+double overlap_bit_error(const Segment& a, const Segment& b, int64_t begin, int64_t end) {
+    begin = std::max({begin, a.origin, b.origin});
+    end = std::min({end, a.origin + static_cast<int64_t>(a.raw.size()), b.origin + static_cast<int64_t>(b.raw.size())});
+    if (end <= begin) {
+        return 1.0;
+    }
+
+    size_t bits = 0;
+    for (int64_t g = begin; g < end; ++g) {
+        uint32_t x = a.raw[g - a.origin] ^ b.raw[g - b.origin];
+        for (; x; x &= x - 1) {
+            bits++;
+        }
+    }
+    return static_cast<double>(bits) / (32.0 * (end - begin));
+}
+
+// Move next.origin up to max_slip items from where it was planned, to where it agrees
+// best with prev over [seam - window, seam + window); returns that bit error
+double align_seam(const Segment& prev, Segment& next, int64_t seam, int64_t window, int64_t max_slip) {
+    const int64_t planned = next.origin;
+    int64_t best_origin = planned;
+    double best_error = overlap_bit_error(prev, next, seam - window, seam + window);
+    for (int64_t slip = 1; slip <= max_slip; ++slip) {
+        for (int64_t origin : {planned - slip, planned + slip}) {
+            next.origin = origin;
+            const double error = overlap_bit_error(prev, next, seam - window, seam + window);
+            if (error < best_error) {
+                best_error = error;
+                best_origin = origin;
+            }
+        }
+    }
+    next.origin = best_origin;
+    return best_error;
+}
+
+} // namespace
+
 StreamingAudioLoader::StreamingAudioLoader()
     : chunk_size_(DEFAULT_CHUNK_SIZE), algorithm_(CHROMAPRINT_ALGORITHM_DEFAULT) {
     validateChunkSize();
@@ -46,189 +103,493 @@ std::unique_ptr<CompressedFingerprint> StreamingAudioLoader::processFileStream(
 
     // Reset stats
     last_stats_ = {};
+    last_stats_.segments = 1;
 
-    // Open audio file
-    SF_INFO sf_info;
-    std::memset(&sf_info, 0, sizeof(sf_info));
-
-    SNDFILE* file = sf_open(file_path.c_str(), SFM_READ, &sf_info);
-    if (!file) {
-        throw std::runtime_error("Failed to open audio file: " + file_path);
+    if (segment_config_.enabled) {
+        const PcmDecodeProgress info = PcmDecoder::probe(file_path);
+        sf_count_t total_frames = info.total_frames;
+        if (max_duration_seconds > 0) {
+            total_frames = std::min(total_frames, static_cast<sf_count_t>(max_duration_seconds) * info.source_rate);
+        }
+        if (info.source_rate > 0 &&
+            static_cast<double>(total_frames) / info.source_rate >= segment_config_.min_file_seconds) {
+            auto compressed_fp = processFileSegmented(file_path, info, total_frames, progress_callback);
+            if (compressed_fp) {
+                auto end_time = std::chrono::high_resolution_clock::now();
+                auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
+                last_stats_.compression_ratio = compressed_fp->getCompressionRatio();
+                last_stats_.processing_time_seconds = duration.count() / 1000.0;
+                return compressed_fp;
+            }
+        }
     }
 
-    // Calculate processing parameters
-    const int channels = sf_info.channels;
-    const int original_sample_rate = sf_info.samplerate;
-    const sf_count_t total_frames = sf_info.frames;
-    const double total_duration = static_cast<double>(total_frames) / original_sample_rate;
+    std::unique_ptr<ChromaprintContext, void (*)(ChromaprintContext*)> ctx(
+        chromaprint_new(algorithm_), chromaprint_free);
+
+    size_t peak_memory = AudioMemoryPool::getInstance().getStats().current_usage;
+    PcmDecodeProgress decoded{};
+
+    Fingerprint temp_fingerprint;
+    run_chromaprint(ctx.get(), CHROMAPRINT_SAMPLE_RATE, temp_fingerprint.data, [&](const auto& feed) {
+        // Decode in chunks; each chunk arrives as int16 mono at the fingerprint rate
+        decoded = decoder_.decode(file_path, CHROMAPRINT_SAMPLE_RATE, max_duration_seconds, chunk_size_,
+            [&](const int16_t* samples, size_t count, const PcmDecodeProgress& progress) {
+                feed(samples, count);
+
+                last_stats_.total_bytes_processed = progress.bytes_decoded;
+
+                // Update peak memory usage
+                size_t current_memory = AudioMemoryPool::getInstance().getStats().current_usage + decoder_.buffer_bytes();
+                peak_memory = std::max(peak_memory, current_memory);
+
+                // Progress callback
+                if (progress_callback && progress.total_frames > 0) {
+                    const size_t sample_bytes = progress.integer_path ? sizeof(int16_t) : sizeof(float);
+                    progress_callback(
+                        progress.bytes_decoded,
+                        progress.total_frames * progress.channels * sample_bytes,
+                        static_cast<double>(progress.frames_decoded) / progress.total_frames
+                    );
+                }
+            });
+    });
+
+    temp_fingerprint.sample_rate = CHROMAPRINT_SAMPLE_RATE;
+    temp_fingerprint.duration = static_cast<double>(decoded.frames_decoded) / decoded.source_rate;
+    temp_fingerprint.file_path = file_path;
+
+    // Compress fingerprint
+    auto compressed_fp = CompressedFingerprint::compress(temp_fingerprint);
+
+    // Update stats
+    auto end_time = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
+
+    last_stats_.peak_memory_usage = peak_memory;
+    last_stats_.compression_ratio = compressed_fp->getCompressionRatio();
+    last_stats_.processing_time_seconds = duration.count() / 1000.0;
 
-    // Calculate frames to process
-    sf_count_t max_frames_to_process = total_frames;
-    if (max_duration_seconds > 0) {
-        max_frames_to_process = std::min(
-            total_frames,
-            static_cast<sf_count_t>(max_duration_seconds * original_sample_rate)
-        );
+    return compressed_fp;
+}
+
+void StreamingAudioLoader::setSegmentConfig(const SegmentConfig& config) {
+    segment_config_ = config;
+    segment_config_.segment_seconds = std::max(1.0, segment_config_.segment_seconds);
+    segment_config_.overlap_seconds = std::max(0.0, segment_config_.overlap_seconds);
+}
+
+std::unique_ptr<CompressedFingerprint> StreamingAudioLoader::processFileSegmented(
+    const std::string& file_path,
+    const PcmDecodeProgress& info,
+    sf_count_t total_frames,
+    ProgressCallback progress_callback) {
+
+    std::unique_ptr<ChromaprintContext, void (*)(ChromaprintContext*)> probe_ctx(
+        chromaprint_new(algorithm_), chromaprint_free);
+    const int item_samples = probe_ctx ? chromaprint_get_item_duration(probe_ctx.get()) : 0;
+    if (item_samples <= 0) {
+        return nullptr;
     }
 
-    // Initialize Chromaprint
-    ChromaprintContext* ctx = chromaprint_new(algorithm_);
-    if (!ctx) {
-        sf_close(file);
-        throw std::runtime_error("Failed to create Chromaprint context");
+    // Plan in Chromaprint items so every segment starts on an item boundary of the
+    // sequential fingerprint (to within one output sample)
+    const double items_per_second = static_cast<double>(CHROMAPRINT_SAMPLE_RATE) / item_samples;
+    const size_t overlap_items = std::max(MIN_OVERLAP_ITEMS,
+        static_cast<size_t>(segment_config_.overlap_seconds * items_per_second));
+    const size_t segment_items = std::max(4 * overlap_items,
+        static_cast<size_t>(segment_config_.segment_seconds * items_per_second));
+    const size_t total_items = static_cast<size_t>(
+        static_cast<double>(total_frames) / info.source_rate * items_per_second);
+    const size_t segment_count = (total_items + segment_items - 1) / segment_items;
+    if (segment_count < 2) {
+        return nullptr; // One segment is just the sequential path
     }
 
-    if (!chromaprint_start(ctx, CHROMAPRINT_SAMPLE_RATE, 1)) {  // Always mono
-        chromaprint_free(ctx);
-        sf_close(file);
-        throw std::runtime_error("Failed to start Chromaprint");
+    auto frame_at = [&](size_t item) {
+        const double seconds = static_cast<double>(item) / items_per_second;
+        return std::min(total_frames, static_cast<sf_count_t>(std::llround(seconds * info.source_rate)));
+    };
+
+    // Segment k owns items [k * segment_items, (k + 1) * segment_items) and decodes
+    // overlap_items more on each side for the seam match
+    std::vector<Segment> segments(segment_count);
+    for (size_t k = 0; k < segment_count; ++k) {
+        const size_t first = k == 0 ? 0 : k * segment_items - overlap_items;
+        const sf_count_t end = k + 1 == segment_count ? total_frames : frame_at((k + 1) * segment_items + overlap_items);
+        segments[k].origin = static_cast<int64_t>(first);
+        segments[k].start_frame = frame_at(first);
+        segments[k].frame_count = end - segments[k].start_frame;
     }
 
-    try {
-        // Calculate chunk size in frames
-        const size_t chunk_frames = chunk_size_ / (channels * sizeof(float));
+    size_t threads = segment_config_.max_threads > 0
+        ? segment_config_.max_threads
+        : std::max<size_t>(1, std::thread::hardware_concurrency());
+    threads = std::min(threads, segment_count);
+
+    std::atomic<size_t> next_segment(0);
+    std::mutex progress_mutex;
+    size_t bytes_decoded = 0;
+    const sf_count_t frames_total = total_frames;
+    const bool integer_decode = decoder_.integer_path_enabled();
+
+    auto worker = [&]() {
+        // Each thread decodes with its own resampler state and Chromaprint context
+        PcmDecoder decoder;
+        decoder.set_integer_path(integer_decode);
+        std::unique_ptr<ChromaprintContext, void (*)(ChromaprintContext*)> ctx(
+            chromaprint_new(algorithm_), chromaprint_free);
+
+        for (size_t k = next_segment++; k < segments.size(); k = next_segment++) {
+            Segment& segment = segments[k];
+            try {
+                size_t reported = 0;
+                const PcmDecodeProgress decoded = fingerprintRange(
+                    ctx.get(), decoder, file_path, segment.start_frame, segment.frame_count, segment.raw,
+                    [&](const PcmDecodeProgress& progress) {
+                        if (progress_callback) {
+                            std::lock_guard<std::mutex> lock(progress_mutex);
+                            bytes_decoded += progress.bytes_decoded - reported;
+                            reported = progress.bytes_decoded;
+                            const size_t sample_bytes = progress.integer_path ? sizeof(int16_t) : sizeof(float);
+                            const size_t total_bytes = static_cast<size_t>(frames_total) * progress.channels * sample_bytes;
+                            progress_callback(bytes_decoded, total_bytes,
+                                              std::min(1.0, static_cast<double>(bytes_decoded) / total_bytes));
+                        }
+                    });
+                segment.bytes_decoded = decoded.bytes_decoded;
+                segment.buffer_bytes = decoder.buffer_bytes();
+            } catch (...) {
+                segment.error = std::current_exception();
+            }
+        }
+    };
 
-        // Allocate buffer from memory pool
-        AudioBuffer audio_buffer(chunk_size_);
-        float* buffer = audio_buffer.as<float>();
+    std::vector<std::thread> pool;
+    for (size_t t = 1; t < threads; ++t) {
+        pool.emplace_back(worker);
+    }
+    worker();
+    for (auto& thread : pool) {
+        thread.join();
+    }
 
-        sf_count_t frames_processed = 0;
-        size_t peak_memory = AudioMemoryPool::getInstance().getStats().current_usage;
+    for (const Segment& segment : segments) {
+        if (segment.error) {
+            std::rethrow_exception(segment.error);
+        }
+    }
 
-        // Process file in chunks
-        while (frames_processed < max_frames_to_process) {
-            // Calculate frames to read this iteration
-            sf_count_t frames_to_read = std::min(
-                static_cast<sf_count_t>(chunk_frames),
-                max_frames_to_process - frames_processed
-            );
+    // Each seam is where the sequential fingerprint's item k * segment_items falls.
+    // Confirm the planned origin against the previous segment over the middle of the
+    // overlap, away from both segments' edge frames, allowing a small slip
+    const int64_t window = static_cast<int64_t>(overlap_items / 2);
+    double seam_error_sum = 0.0;
+    for (size_t k = 1; k < segment_count; ++k) {
+        const int64_t seam = static_cast<int64_t>(k * segment_items);
+        seam_error_sum += align_seam(segments[k - 1], segments[k], seam, window,
+                                     static_cast<int64_t>(SEAM_SEARCH_ITEMS));
+    }
 
-            // Read audio chunk
-            sf_count_t frames_read = sf_read_float(file, buffer, frames_to_read * channels);
-            if (frames_read <= 0) {
-                break; // End of file or error
-            }
+    // Splice: segment k contributes the items between its seams
+    Fingerprint stitched;
+    stitched.data.reserve(total_items + 1);
+    size_t peak_buffers = 0;
+    size_t total_bytes = 0;
+    for (size_t k = 0; k < segment_count; ++k) {
+        const Segment& segment = segments[k];
+        const int64_t from = static_cast<int64_t>(k * segment_items) - segment.origin;
+        const int64_t to = k + 1 == segment_count
+            ? static_cast<int64_t>(segment.raw.size())
+            : static_cast<int64_t>((k + 1) * segment_items) - segment.origin;
+        const size_t begin = static_cast<size_t>(std::max<int64_t>(0, from));
+        const size_t end = static_cast<size_t>(std::min<int64_t>(static_cast<int64_t>(segment.raw.size()), std::max<int64_t>(0, to)));
+        if (end > begin) {
+            stitched.data.insert(stitched.data.end(), segment.raw.begin() + begin, segment.raw.begin() + end);
+        }
+        peak_buffers += segment.buffer_bytes + segment.raw.capacity() * sizeof(uint32_t);
+        total_bytes += segment.bytes_decoded;
+    }
+    stitched.sample_rate = CHROMAPRINT_SAMPLE_RATE;
+    stitched.duration = static_cast<double>(total_frames) / info.source_rate;
+    stitched.file_path = file_path;
 
-            // Convert to mono if needed
-            std::vector<float> mono_samples;
-            if (channels > 1) {
-                mono_samples.reserve(frames_read);
-                for (sf_count_t i = 0; i < frames_read; ++i) {
-                    float sum = 0.0f;
-                    for (int ch = 0; ch < channels; ++ch) {
-                        sum += buffer[i * channels + ch];
-                    }
-                    mono_samples.push_back(sum / channels);
-                }
-            } else {
-                mono_samples.assign(buffer, buffer + frames_read);
-            }
+    last_stats_.total_bytes_processed = total_bytes;
+    last_stats_.peak_memory_usage = AudioMemoryPool::getInstance().getStats().current_usage + peak_buffers;
+    last_stats_.segments = segment_count;
+    last_stats_.seam_bit_error = seam_error_sum / (segment_count - 1);
 
-            // Resample to Chromaprint sample rate if needed
-            if (original_sample_rate != CHROMAPRINT_SAMPLE_RATE) {
-                // Simple linear resampling
-                const double ratio = static_cast<double>(CHROMAPRINT_SAMPLE_RATE) / original_sample_rate;
-                const size_t resampled_size = static_cast<size_t>(mono_samples.size() * ratio);
-
-                std::vector<float> resampled_samples;
-                resampled_samples.reserve(resampled_size);
-
-                for (size_t i = 0; i < resampled_size; ++i) {
-                    const double src_index = i / ratio;
-                    const size_t src_i = static_cast<size_t>(src_index);
-
-                    if (src_i < mono_samples.size() - 1) {
-                        const float frac = src_index - src_i;
-                        const float sample = mono_samples[src_i] * (1.0f - frac) +
-                                           mono_samples[src_i + 1] * frac;
-                        resampled_samples.push_back(sample);
-                    } else if (src_i < mono_samples.size()) {
-                        resampled_samples.push_back(mono_samples[src_i]);
-                    }
-                }
+    return CompressedFingerprint::compress(stitched);
+}
 
-                mono_samples = std::move(resampled_samples);
-            }
+std::unique_ptr<SampledFingerprint> StreamingAudioLoader::generateSampledFingerprint(
+    const std::string& file_path,
+    const SampleConfig& config,
+    ProgressCallback progress_callback) {
 
-            // Convert float samples to int16_t for Chromaprint
-            std::vector<int16_t> int16_samples;
-            int16_samples.reserve(mono_samples.size());
+    if (config.positions.empty() || config.span_seconds <= 0.0) {
+        throw std::invalid_argument("Sampled fingerprint needs at least one position and a positive span");
+    }
 
-            for (float sample : mono_samples) {
-                // Clamp and convert to int16_t
-                sample = std::max(-1.0f, std::min(1.0f, sample));
-                int16_samples.push_back(static_cast<int16_t>(sample * 32767.0f));
-            }
+    auto start_time = std::chrono::high_resolution_clock::now();
 
-            // Feed to Chromaprint
-            if (!chromaprint_feed(ctx, int16_samples.data(), static_cast<int>(int16_samples.size()))) {
-                throw std::runtime_error("Failed to feed audio data to Chromaprint");
-            }
+    last_stats_ = {};
+    last_stats_.segments = 1;
 
-            frames_processed += frames_read / channels;
-            last_stats_.total_bytes_processed += frames_read * channels * sizeof(float);
+    const PcmDecodeProgress info = PcmDecoder::probe(file_path);
+    if (info.source_rate <= 0) {
+        throw std::runtime_error("Invalid sample rate in " + file_path);
+    }
 
-            // Update peak memory usage
-            size_t current_memory = AudioMemoryPool::getInstance().getStats().current_usage;
-            peak_memory = std::max(peak_memory, current_memory);
+    std::unique_ptr<ChromaprintContext, void (*)(ChromaprintContext*)> ctx(
+        chromaprint_new(algorithm_), chromaprint_free);
+    if (!ctx) {
+        throw std::runtime_error("Failed to create Chromaprint context");
+    }
+    const int item_samples = chromaprint_get_item_duration(ctx.get());
+    if (item_samples <= 0) {
+        throw std::runtime_error("Failed to get Chromaprint item duration");
+    }
 
-            // Progress callback
-            if (progress_callback) {
-                const double progress = static_cast<double>(frames_processed) / max_frames_to_process;
-                progress_callback(
-                    last_stats_.total_bytes_processed,
-                    max_frames_to_process * channels * sizeof(float),
-                    progress
-                );
+    auto sampled = std::make_unique<SampledFingerprint>();
+    sampled->items_per_second = static_cast<double>(CHROMAPRINT_SAMPLE_RATE) / item_samples;
+    sampled->sample_rate = CHROMAPRINT_SAMPLE_RATE;
+    sampled->duration = static_cast<double>(info.total_frames) / info.source_rate;
+    sampled->decoded_seconds = 0.0;
+    sampled->file_path = file_path;
+
+    // Plan spans centred on each position and clamped inside the file, in file
+    // order; if any two would overlap the file is sampled whole
+    const sf_count_t span_frames = static_cast<sf_count_t>(config.span_seconds * info.source_rate);
+    std::vector<sf_count_t> starts;
+    if (span_frames * static_cast<sf_count_t>(config.positions.size()) < info.total_frames) {
+        std::vector<double> positions = config.positions;
+        std::sort(positions.begin(), positions.end());
+        for (double position : positions) {
+            const double centre = std::max(0.0, std::min(1.0, position)) * info.total_frames;
+            const sf_count_t start = static_cast<sf_count_t>(centre) - span_frames / 2;
+            starts.push_back(std::max<sf_count_t>(0, std::min(start, info.total_frames - span_frames)));
+        }
+        for (size_t i = 1; i < starts.size(); ++i) {
+            if (starts[i] < starts[i - 1] + span_frames) {
+                starts.clear();
+                break;
             }
         }
+    }
+    const sf_count_t frames_per_span = starts.empty() ? -1 : span_frames;
+    if (starts.empty()) {
+        starts.push_back(0);
+    }
 
-        // Finish fingerprinting
-        if (!chromaprint_finish(ctx)) {
-            throw std::runtime_error("Failed to finish Chromaprint processing");
-        }
+    const sf_count_t frames_total = starts.size() * (frames_per_span < 0 ? info.total_frames : frames_per_span);
+    size_t peak_buffers = 0;
+    sf_count_t frames_done = 0;
+    std::vector<uint32_t> raw;
+    for (sf_count_t start : starts) {
+        const PcmDecodeProgress decoded = fingerprintRange(
+            ctx.get(), decoder_, file_path, start, frames_per_span, raw,
+            [&](const PcmDecodeProgress& progress) {
+                if (progress_callback && frames_total > 0) {
+                    const size_t sample_bytes = progress.integer_path ? sizeof(int16_t) : sizeof(float);
+                    progress_callback(
+                        last_stats_.total_bytes_processed + progress.bytes_decoded,
+                        frames_total * progress.channels * sample_bytes,
+                        std::min(1.0, static_cast<double>(frames_done + progress.frames_decoded) / frames_total)
+                    );
+                }
+            });
+        frames_done += decoded.frames_decoded;
+        last_stats_.total_bytes_processed += decoded.bytes_decoded;
+        peak_buffers = std::max(peak_buffers, decoder_.buffer_bytes());
+
+        sampled->span_offsets.push_back(static_cast<uint32_t>(sampled->data.size()));
+        sampled->data.insert(sampled->data.end(), raw.begin(), raw.end());
+        sampled->span_starts.push_back(static_cast<double>(start) / info.source_rate);
+        sampled->decoded_seconds += static_cast<double>(decoded.frames_decoded) / info.source_rate;
+    }
+    sampled->span_offsets.push_back(static_cast<uint32_t>(sampled->data.size()));
 
-        // Get raw fingerprint
-        uint32_t* raw_fp_data = nullptr;
-        int fp_size = 0;
+    auto end_time = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
+    last_stats_.peak_memory_usage = AudioMemoryPool::getInstance().getStats().current_usage + peak_buffers;
+    last_stats_.compression_ratio = 1.0;
+    last_stats_.processing_time_seconds = duration.count() / 1000.0;
 
-        if (!chromaprint_get_raw_fingerprint(ctx, &raw_fp_data, &fp_size)) {
-            throw std::runtime_error("Failed to get fingerprint");
-        }
+    return sampled;
+}
 
-        // Create regular fingerprint for compression
-        Fingerprint temp_fingerprint;
-        temp_fingerprint.data.assign(raw_fp_data, raw_fp_data + fp_size);
-        temp_fingerprint.sample_rate = CHROMAPRINT_SAMPLE_RATE;
-        temp_fingerprint.duration = static_cast<double>(frames_processed) / original_sample_rate;
-        temp_fingerprint.file_path = file_path;
+std::unique_ptr<PrefixFingerprint> StreamingAudioLoader::generatePrefixFingerprint(
+    const std::string& file_path,
+    double prefix_seconds,
+    ProgressCallback progress_callback) {
 
-        // Free Chromaprint data
-        chromaprint_dealloc(raw_fp_data);
+    if (prefix_seconds <= 0.0) {
+        throw std::invalid_argument("Prefix duration must be positive");
+    }
 
-        // Compress fingerprint
-        auto compressed_fp = CompressedFingerprint::compress(temp_fingerprint);
+    auto start_time = std::chrono::high_resolution_clock::now();
 
-        // Update stats
-        auto end_time = std::chrono::high_resolution_clock::now();
-        auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
+    last_stats_ = {};
+    last_stats_.segments = 1;
 
-        last_stats_.peak_memory_usage = peak_memory;
-        last_stats_.compression_ratio = compressed_fp->getCompressionRatio();
-        last_stats_.processing_time_seconds = duration.count() / 1000.0;
+    const PcmDecodeProgress info = PcmDecoder::probe(file_path);
+    if (info.source_rate <= 0) {
+        throw std::runtime_error("Invalid sample rate in " + file_path);
+    }
 
-        // Cleanup
-        chromaprint_free(ctx);
-        sf_close(file);
+    std::unique_ptr<ChromaprintContext, void (*)(ChromaprintContext*)> ctx(
+        chromaprint_new(algorithm_), chromaprint_free);
+    if (!ctx) {
+        throw std::runtime_error("Failed to create Chromaprint context");
+    }
+
+    const sf_count_t prefix_frames = static_cast<sf_count_t>(std::llround(prefix_seconds * info.source_rate));
+    auto prefix = std::make_unique<PrefixFingerprint>();
+    const PcmDecodeProgress decoded = fingerprintRange(
+        ctx.get(), file_path, 0, prefix_frames, prefix->fingerprint.data, progress_callback);
+
+    // Decoders that cannot tell the length up front stop short at the end of the file
+    prefix->decoded_frames = decoded.frames_decoded;
+    prefix->total_frames = std::max<int64_t>(info.total_frames, decoded.frames_decoded);
+    prefix->source_rate = info.source_rate;
+    prefix->complete = decoded.frames_decoded < prefix_frames ||
+        (info.total_frames > 0 && decoded.frames_decoded >= info.total_frames);
+    if (prefix->complete) {
+        prefix->total_frames = decoded.frames_decoded;
+    }
+    prefix->fingerprint.sample_rate = CHROMAPRINT_SAMPLE_RATE;
+    prefix->fingerprint.duration = static_cast<double>(decoded.frames_decoded) / info.source_rate;
+    prefix->fingerprint.file_path = file_path;
+
+    auto end_time = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
+    last_stats_.total_bytes_processed = decoded.bytes_decoded;
+    last_stats_.peak_memory_usage = AudioMemoryPool::getInstance().getStats().current_usage + decoder_.buffer_bytes();
+    last_stats_.compression_ratio = 1.0;
+    last_stats_.processing_time_seconds = duration.count() / 1000.0;
+
+    return prefix;
+}
 
-        return compressed_fp;
+std::unique_ptr<Fingerprint> StreamingAudioLoader::completeFingerprint(
+    const PrefixFingerprint& prefix,
+    double* decoded_seconds,
+    ProgressCallback progress_callback) {
 
-    } catch (...) {
-        // Cleanup on error
-        chromaprint_free(ctx);
-        sf_close(file);
-        throw;
+    if (decoded_seconds) {
+        *decoded_seconds = 0.0;
     }
+    if (prefix.complete) {
+        return std::make_unique<Fingerprint>(prefix.fingerprint);
+    }
+
+    auto start_time = std::chrono::high_resolution_clock::now();
+
+    last_stats_ = {};
+    last_stats_.segments = 1;
+
+    std::unique_ptr<ChromaprintContext, void (*)(ChromaprintContext*)> ctx(
+        chromaprint_new(algorithm_), chromaprint_free);
+    const int item_samples = ctx ? chromaprint_get_item_duration(ctx.get()) : 0;
+    if (item_samples <= 0) {
+        throw std::runtime_error("Failed to create Chromaprint context");
+    }
+
+    // Same seam plan as a segment boundary: the prefix keeps the items before the
+    // seam, the continuation starts an overlap before it and both are matched over
+    // the middle of that overlap, clear of Chromaprint's edge frames
+    const double items_per_second = static_cast<double>(CHROMAPRINT_SAMPLE_RATE) / item_samples;
+    const int64_t overlap_items = static_cast<int64_t>(MIN_OVERLAP_ITEMS);
+    const int64_t prefix_items = static_cast<int64_t>(
+        static_cast<double>(prefix.decoded_frames) / prefix.source_rate * items_per_second);
+    const int64_t seam = prefix_items - overlap_items;
+
+    Segment head;
+    head.origin = 0;
+    head.raw = prefix.fingerprint.data;
+
+    Segment tail;
+    tail.origin = std::max<int64_t>(0, seam - overlap_items);
+    tail.start_frame = std::min<sf_count_t>(prefix.decoded_frames, static_cast<sf_count_t>(
+        std::llround(static_cast<double>(tail.origin) / items_per_second * prefix.source_rate)));
+    if (tail.origin == 0) {
+        tail.start_frame = 0;
+    }
+
+    const PcmDecodeProgress decoded = fingerprintRange(
+        ctx.get(), prefix.fingerprint.file_path, tail.start_frame, -1, tail.raw, progress_callback);
+    if (decoded_seconds) {
+        *decoded_seconds = static_cast<double>(decoded.frames_decoded) / prefix.source_rate;
+    }
+
+    auto full = std::make_unique<Fingerprint>();
+    if (tail.start_frame == 0) {
+        full->data = std::move(tail.raw);
+    } else {
+        align_seam(head, tail, seam, overlap_items / 2, static_cast<int64_t>(SEAM_SEARCH_ITEMS));
+        const size_t head_end = static_cast<size_t>(std::min<int64_t>(seam, static_cast<int64_t>(head.raw.size())));
+        const size_t tail_begin = static_cast<size_t>(std::min<int64_t>(
+            static_cast<int64_t>(tail.raw.size()), std::max<int64_t>(0, seam - tail.origin)));
+        full->data.reserve(head_end + tail.raw.size() - tail_begin);
+        full->data.assign(head.raw.begin(), head.raw.begin() + head_end);
+        full->data.insert(full->data.end(), tail.raw.begin() + tail_begin, tail.raw.end());
+    }
+    full->sample_rate = CHROMAPRINT_SAMPLE_RATE;
+    full->duration = static_cast<double>(tail.start_frame + decoded.frames_decoded) / prefix.source_rate;
+    full->file_path = prefix.fingerprint.file_path;
+
+    auto end_time = std::chrono::high_resolution_clock::now();
+    auto duration = std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time);
+    last_stats_.total_bytes_processed = decoded.bytes_decoded;
+    last_stats_.peak_memory_usage = AudioMemoryPool::getInstance().getStats().current_usage + decoder_.buffer_bytes();
+    last_stats_.compression_ratio = 1.0;
+    last_stats_.processing_time_seconds = duration.count() / 1000.0;
+
+    return full;
+}
+
+PcmDecodeProgress StreamingAudioLoader::fingerprintRange(
+    ChromaprintContext* ctx,
+    const std::string& file_path,
+    sf_count_t start_frame,
+    sf_count_t frame_count,
+    std::vector<uint32_t>& raw,
+    ProgressCallback progress_callback) {
+
+    return fingerprintRange(ctx, decoder_, file_path, start_frame, frame_count, raw,
+        [&](const PcmDecodeProgress& progress) {
+            if (progress_callback && progress.total_frames > 0) {
+                const size_t sample_bytes = progress.integer_path ? sizeof(int16_t) : sizeof(float);
+                progress_callback(
+                    progress.bytes_decoded,
+                    progress.total_frames * progress.channels * sample_bytes,
+                    static_cast<double>(progress.frames_decoded) / progress.total_frames
+                );
+            }
+        });
+}
+
+PcmDecodeProgress StreamingAudioLoader::fingerprintRange(
+    ChromaprintContext* ctx,
+    PcmDecoder& decoder,
+    const std::string& file_path,
+    sf_count_t start_frame,
+    sf_count_t frame_count,
+    std::vector<uint32_t>& raw,
+    const ChunkCallback& on_chunk) const {
+
+    PcmDecodeProgress decoded{};
+    run_chromaprint(ctx, CHROMAPRINT_SAMPLE_RATE, raw, [&](const auto& feed) {
+        decoded = decoder.decode_range(file_path, CHROMAPRINT_SAMPLE_RATE, start_frame, frame_count, chunk_size_,
+            [&](const int16_t* samples, size_t count, const PcmDecodeProgress& progress) {
+                feed(samples, count);
+                if (on_chunk) {
+                    on_chunk(progress);
+                }
+            });
+    });
+    return decoded;
 }
 
 void StreamingAudioLoader::validateChunkSize() {
@@ -3,10 +3,13 @@
 #include <string>
 #include <memory>
 #include <functional>
+#include <vector>
+#include <cstdint>
 #include "chromaprint_wrapper.h"
 #include "compressed_fingerprint.h"
 #include "audio_memory_pool.h"
 #include "audio_loader.h"
+#include "pcm_decoder.h"
 
 namespace AudioDuplicates {
 
@@ -35,6 +38,38 @@ public:
         ProgressCallback progress_callback = nullptr
     );
 
+    // Head/middle/tail sampling for coarse first-pass triage: only short spans
+    // around each position are decoded (seeking past the rest)
+    struct SampleConfig {
+        std::vector<double> positions = {0.15, 0.5, 0.85};  // Span centres as fractions of the duration
+        double span_seconds = 12.0;                         // Audio decoded per span
+    };
+
+    // Fingerprint of the configured spans; files too short to hold them apart
+    // are fingerprinted whole as a single span
+    std::unique_ptr<SampledFingerprint> generateSampledFingerprint(
+        const std::string& file_path,
+        const SampleConfig& config,
+        ProgressCallback progress_callback = nullptr
+    );
+
+    // Raw frames of the first prefix_seconds of a file, for a cheap first tier
+    std::unique_ptr<PrefixFingerprint> generatePrefixFingerprint(
+        const std::string& file_path,
+        double prefix_seconds,
+        ProgressCallback progress_callback = nullptr
+    );
+
+    // Continue a prefix to the whole file: decoding resumes a seam overlap before the
+    // end of the prefix and the new frames are spliced on where both agree. Prefixes
+    // too short to hold the overlap are decoded again from the start.
+    // decoded_seconds (optional) receives the audio decoded by this call
+    std::unique_ptr<Fingerprint> completeFingerprint(
+        const PrefixFingerprint& prefix,
+        double* decoded_seconds = nullptr,
+        ProgressCallback progress_callback = nullptr
+    );
+
     // Configuration
     void setChunkSize(size_t chunk_size) { chunk_size_ = chunk_size; }
     size_t getChunkSize() const { return chunk_size_; }
@@ -42,12 +77,30 @@ public:
     void setAlgorithm(int algorithm) { algorithm_ = algorithm; }
     int getAlgorithm() const { return algorithm_; }
 
+    // Read integer PCM as int16 (default); disable to force the float decode path
+    void setIntegerDecode(bool enabled) { decoder_.set_integer_path(enabled); }
+    bool getIntegerDecode() const { return decoder_.integer_path_enabled(); }
+
+    // Intra-file parallelism for long recordings: overlapping frame ranges are
+    // fingerprinted concurrently and their raw frames stitched at the overlap
+    struct SegmentConfig {
+        bool enabled = false;
+        double min_file_seconds = 600.0;  // Shorter files are fingerprinted sequentially
+        double segment_seconds = 120.0;   // Audio per segment between seams
+        double overlap_seconds = 8.0;     // Extra audio decoded on each side of a seam
+        size_t max_threads = 0;           // 0 = hardware concurrency
+    };
+    void setSegmentConfig(const SegmentConfig& config);
+    const SegmentConfig& getSegmentConfig() const { return segment_config_; }
+
     // Memory usage statistics
     struct StreamingStats {
         size_t total_bytes_processed;
         size_t peak_memory_usage;
         double compression_ratio;
         double processing_time_seconds;
+        size_t segments;            // 1 unless the last file was fingerprinted in segments
+        double seam_bit_error;      // Mean bit error between neighbouring segments at their seams
     };
     StreamingStats getLastStats() const { return last_stats_; }
 
@@ -61,6 +114,17 @@ private:
     static constexpr size_t MAX_CHUNK_SIZE = 16 * 1024 * 1024; // 16MB
     static constexpr int CHROMAPRINT_SAMPLE_RATE = 11025;
 
+    // Seams are matched over half the overlap, which must clear Chromaprint's
+    // edge frames (about 20 items) on both sides
+    static constexpr size_t MIN_OVERLAP_ITEMS = 48;
+    static constexpr size_t SEAM_SEARCH_ITEMS = 2;
+
+    SegmentConfig segment_config_;
+
+    // Chunked decode to int16 mono at CHROMAPRINT_SAMPLE_RATE; integer PCM skips
+    // float entirely. Its stage buffers are reused across chunks and files
+    PcmDecoder decoder_;
+
     // Internal streaming implementation
     std::unique_ptr<CompressedFingerprint> processFileStream(
         const std::string& file_path,
@@ -68,6 +132,39 @@ private:
         ProgressCallback progress_callback
     );
 
+    // Fingerprint frames [0, total_frames) as overlapping segments on worker threads
+    std::unique_ptr<CompressedFingerprint> processFileSegmented(
+        const std::string& file_path,
+        const PcmDecodeProgress& info,
+        sf_count_t total_frames,
+        ProgressCallback progress_callback
+    );
+
+    // Decode frames [start_frame, start_frame + frame_count) (frame_count < 0: to the
+    // end) through a fresh Chromaprint run on ctx and store its raw frames in raw
+    PcmDecodeProgress fingerprintRange(
+        ChromaprintContext* ctx,
+        const std::string& file_path,
+        sf_count_t start_frame,
+        sf_count_t frame_count,
+        std::vector<uint32_t>& raw,
+        ProgressCallback progress_callback
+    );
+
+    // Decode progress after each chunk fed to Chromaprint
+    using ChunkCallback = std::function<void(const PcmDecodeProgress& progress)>;
+
+    // Same as above with the caller's decoder, so worker threads can each use their own
+    PcmDecodeProgress fingerprintRange(
+        ChromaprintContext* ctx,
+        PcmDecoder& decoder,
+        const std::string& file_path,
+        sf_count_t start_frame,
+        sf_count_t frame_count,
+        std::vector<uint32_t>& raw,
+        const ChunkCallback& on_chunk
+    ) const;
+
     // Validate chunk size
     void validateChunkSize();
 };
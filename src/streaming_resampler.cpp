@@ -0,0 +1,356 @@
+#include "streaming_resampler.h"
+#include <algorithm>
+#include <cmath>
+#include <cstring>
+#include <limits>
+#include <numeric>
+#include <stdexcept>
+
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
+namespace AudioDuplicates {
+
+namespace {
+
+constexpr double PI = 3.14159265358979323846;
+
+// n is a multiple of 4
+inline float dot(const float* c, const float* x, size_t n) {
+#if defined(__SSE2__)
+    __m128 acc0 = _mm_setzero_ps();
+    __m128 acc1 = _mm_setzero_ps();
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+        acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(c + i), _mm_loadu_ps(x + i)));
+        acc1 = _mm_add_ps(acc1, _mm_mul_ps(_mm_loadu_ps(c + i + 4), _mm_loadu_ps(x + i + 4)));
+    }
+    if (i < n) {
+        acc0 = _mm_add_ps(acc0, _mm_mul_ps(_mm_loadu_ps(c + i), _mm_loadu_ps(x + i)));
+    }
+    acc0 = _mm_add_ps(acc0, acc1);
+    __m128 shuffled = _mm_shuffle_ps(acc0, acc0, _MM_SHUFFLE(2, 3, 0, 1));
+    acc0 = _mm_add_ps(acc0, shuffled);
+    shuffled = _mm_movehl_ps(shuffled, acc0);
+    return _mm_cvtss_f32(_mm_add_ss(acc0, shuffled));
+#else
+    float acc[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+    for (size_t i = 0; i < n; i += 4) {
+        acc[0] += c[i] * x[i];
+        acc[1] += c[i + 1] * x[i + 1];
+        acc[2] += c[i + 2] * x[i + 2];
+        acc[3] += c[i + 3] * x[i + 3];
+    }
+    return (acc[0] + acc[1]) + (acc[2] + acc[3]);
+#endif
+}
+
+// Q14 rows against int16 samples; n is a multiple of 8
+inline int32_t dot(const int16_t* c, const int16_t* x, size_t n) {
+#if defined(__SSE2__)
+    __m128i acc = _mm_setzero_si128();
+    for (size_t i = 0; i < n; i += 8) {
+        acc = _mm_add_epi32(acc, _mm_madd_epi16(_mm_loadu_si128(reinterpret_cast<const __m128i*>(c + i)),
+                                                _mm_loadu_si128(reinterpret_cast<const __m128i*>(x + i))));
+    }
+    acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(1, 0, 3, 2)));
+    acc = _mm_add_epi32(acc, _mm_shuffle_epi32(acc, _MM_SHUFFLE(2, 3, 0, 1)));
+    return _mm_cvtsi128_si32(acc);
+#else
+    int32_t acc = 0;
+    for (size_t i = 0; i < n; ++i) {
+        acc += static_cast<int32_t>(c[i]) * x[i];
+    }
+    return acc;
+#endif
+}
+
+inline void store(float* out, float value) {
+    *out = value;
+}
+
+inline void store(int16_t* out, float value) {
+    *out = static_cast<int16_t>(std::max(-32767.0f, std::min(32767.0f, value * 32767.0f)));
+}
+
+inline void store(int16_t* out, int32_t acc) {
+    const int32_t rounded = (acc + (1 << (StreamingResampler::COEFFICIENT_BITS - 1))) >> StreamingResampler::COEFFICIENT_BITS;
+    *out = static_cast<int16_t>(std::max(-32767, std::min(32767, rounded)));
+}
+
+// Equal rates: samples pass through with only a format change
+inline void copy(float* out, float value) {
+    *out = value;
+}
+
+inline void copy(int16_t* out, float value) {
+    store(out, value);
+}
+
+inline void copy(int16_t* out, int16_t value) {
+    *out = value;
+}
+
+} // namespace
+
+StreamingResampler::StreamingResampler()
+    : input_rate_(0), output_rate_(0), up_(1), down_(1), phases_(1), taps_(1), delay_(0),
+      pcm_input_(false), buffered_(0), base_(0), phase_(0), inputs_(0), outputs_(0) {}
+
+StreamingResampler::StreamingResampler(int input_rate, int output_rate)
+    : StreamingResampler() {
+    configure(input_rate, output_rate);
+}
+
+void StreamingResampler::configure(int input_rate, int output_rate) {
+    if (input_rate <= 0 || output_rate <= 0) {
+        throw std::invalid_argument("Sample rates must be positive");
+    }
+
+    if (input_rate != input_rate_ || output_rate != output_rate_) {
+        input_rate_ = input_rate;
+        output_rate_ = output_rate;
+        design_filter();
+    }
+    reset();
+}
+
+void StreamingResampler::reset() {
+    // Zero history, with the first output placed at the filter centre so output
+    // sample n lines up with input time n / output_rate
+    std::fill(buffer_.begin(), buffer_.end(), 0.0f);
+    std::fill(pcm_buffer_.begin(), pcm_buffer_.end(), static_cast<int16_t>(0));
+    if (buffer_.size() < taps_ - 1) {
+        buffer_.resize(taps_ - 1, 0.0f);
+    }
+    if (pcm_buffer_.size() < taps_ - 1) {
+        pcm_buffer_.resize(taps_ - 1, 0);
+    }
+    pcm_input_ = false;
+    buffered_ = taps_ - 1;
+    base_ = taps_ - 1 + static_cast<size_t>(delay_ / up_);
+    phase_ = delay_ % up_;
+    inputs_ = 0;
+    outputs_ = 0;
+}
+
+void StreamingResampler::design_filter() {
+    const uint64_t divisor = std::gcd(static_cast<uint64_t>(input_rate_), static_cast<uint64_t>(output_rate_));
+    up_ = static_cast<uint64_t>(output_rate_) / divisor;
+    down_ = static_cast<uint64_t>(input_rate_) / divisor;
+
+    if (up_ == down_) {
+        phases_ = 1;
+        taps_ = 1;
+        delay_ = 0;
+        coefficients_.assign(1, 1.0f);
+        coefficients_q14_.assign(1, static_cast<int16_t>(1 << COEFFICIENT_BITS));
+        return;
+    }
+
+    // Cutoff in cycles per input sample, below the lower of the two Nyquist frequencies
+    const double cutoff = 0.5 * PASSBAND * std::min(1.0, static_cast<double>(up_) / down_);
+    // Odd span so the centre tap falls on an input sample when there is a single row
+    const size_t span = static_cast<size_t>(std::ceil(ZERO_CROSSINGS / cutoff)) | 1;
+    phases_ = static_cast<size_t>(std::min<uint64_t>(up_, MAX_PHASES));
+    taps_ = (span + 7) & ~static_cast<size_t>(7);
+
+    // Blackman-windowed sinc prototype at phases_ times the input rate
+    const size_t length = phases_ * span;
+    const double centre = (length - 1) / 2.0;
+    std::vector<double> prototype(length);
+    for (size_t n = 0; n < length; ++n) {
+        const double t = (n - centre) / phases_;
+        const double x = 2.0 * cutoff * t;
+        const double sinc = x == 0.0 ? 1.0 : std::sin(PI * x) / (PI * x);
+        const double w = length > 1 ? static_cast<double>(n) / (length - 1) : 0.5;
+        const double window = 0.42 - 0.5 * std::cos(2.0 * PI * w) + 0.08 * std::cos(4.0 * PI * w);
+        prototype[n] = sinc * window;
+    }
+
+    // Row r holds taps r, r + phases_, ... reversed so the dot product runs oldest
+    // input first; the padding taps in front stay zero. Rows are normalised to unity
+    // gain, and the fixed-point rows put their rounding error on the largest tap so
+    // they sum to exactly 1.0 too
+    const int32_t one = 1 << COEFFICIENT_BITS;
+    coefficients_.assign(phases_ * taps_, 0.0f);
+    coefficients_q14_.assign(phases_ * taps_, 0);
+    for (size_t r = 0; r < phases_; ++r) {
+        double sum = 0.0;
+        for (size_t k = 0; k < span; ++k) {
+            sum += prototype[r + k * phases_];
+        }
+        float* row = coefficients_.data() + r * taps_;
+        int16_t* row_q14 = coefficients_q14_.data() + r * taps_;
+        int32_t fixed_sum = 0;
+        size_t largest = taps_ - 1;
+        for (size_t k = 0; k < span; ++k) {
+            const double c = prototype[r + k * phases_] / sum;
+            const size_t j = taps_ - 1 - k;
+            row[j] = static_cast<float>(c);
+            row_q14[j] = static_cast<int16_t>(std::lround(c * one));
+            fixed_sum += row_q14[j];
+            if (std::abs(row_q14[j]) > std::abs(row_q14[largest])) {
+                largest = j;
+            }
+        }
+        row_q14[largest] = static_cast<int16_t>(row_q14[largest] + (one - fixed_sum));
+    }
+
+    delay_ = static_cast<uint64_t>(std::llround(centre * up_ / phases_));
+}
+
+float* StreamingResampler::input_buffer(size_t count) {
+    if (buffer_.size() < buffered_ + count) {
+        buffer_.resize(buffered_ + count);
+    }
+    return buffer_.data() + buffered_;
+}
+
+int16_t* StreamingResampler::pcm_input_buffer(size_t count) {
+    pcm_input_ = true;
+    if (pcm_buffer_.size() < buffered_ + count) {
+        pcm_buffer_.resize(buffered_ + count);
+    }
+    return pcm_buffer_.data() + buffered_;
+}
+
+template <typename Sample, typename Out>
+size_t StreamingResampler::run(const Sample* x, Out* out, uint64_t limit) {
+    const auto* coefficients = rows(x);
+    size_t written = 0;
+
+    if (up_ == down_) {
+        while (base_ < buffered_ && outputs_ < limit) {
+            copy(out + written++, x[base_++]);
+            ++outputs_;
+        }
+        return written;
+    }
+
+    if (up_ == 1) {
+        // Integer decimation (44100 -> 11025 and the like): one row, fixed stride
+        const auto* row = coefficients;
+        while (base_ < buffered_ && outputs_ < limit) {
+            store(out + written++, dot(row, x + base_ + 1 - taps_, taps_));
+            ++outputs_;
+            base_ += static_cast<size_t>(down_);
+        }
+        return written;
+    }
+
+    const size_t whole_step = static_cast<size_t>(down_ / up_);
+    const uint64_t frac_step = down_ % up_;
+    const bool exact_rows = phases_ == up_;
+    while (base_ < buffered_ && outputs_ < limit) {
+        const size_t r = exact_rows ? static_cast<size_t>(phase_) : static_cast<size_t>(phase_ * phases_ / up_);
+        store(out + written++, dot(coefficients + r * taps_, x + base_ + 1 - taps_, taps_));
+        ++outputs_;
+
+        base_ += whole_step;
+        phase_ += frac_step;
+        if (phase_ >= up_) {
+            phase_ -= up_;
+            ++base_;
+        }
+    }
+    return written;
+}
+
+template <typename Sample>
+void StreamingResampler::drop_consumed(std::vector<Sample>& buffer) {
+    // Keep only the history the next outputs can reach
+    const size_t keep = taps_ - 1;
+    if (buffered_ > keep) {
+        const size_t shift = buffered_ - keep;
+        std::memmove(buffer.data(), buffer.data() + shift, keep * sizeof(Sample));
+        base_ -= shift;
+        buffered_ = keep;
+    }
+}
+
+template <typename Sample, typename Out>
+size_t StreamingResampler::process_buffered(std::vector<Sample>& buffer, size_t count, Out* out) {
+    buffered_ += count;
+    inputs_ += count;
+    const size_t written = run(buffer.data(), out, std::numeric_limits<uint64_t>::max());
+    drop_consumed(buffer);
+    return written;
+}
+
+template <typename Sample, typename Out>
+size_t StreamingResampler::flush_buffered(std::vector<Sample>& buffer, Out* out) {
+    const uint64_t expected = inputs_ * up_ / down_;
+    size_t written = 0;
+
+    // Push zeros through until the delayed tail has come out
+    while (outputs_ < expected) {
+        if (buffer.size() < buffered_ + taps_) {
+            buffer.resize(buffered_ + taps_);
+        }
+        std::fill(buffer.begin() + buffered_, buffer.begin() + buffered_ + taps_, static_cast<Sample>(0));
+        buffered_ += taps_;
+        written += run(buffer.data(), out + written, expected);
+        if (outputs_ < expected) {
+            drop_consumed(buffer);
+        }
+    }
+
+    reset();
+    return written;
+}
+
+size_t StreamingResampler::process_input(size_t count, float* out) {
+    return process_buffered(buffer_, count, out);
+}
+
+size_t StreamingResampler::process_input(size_t count, int16_t* out) {
+    return process_buffered(buffer_, count, out);
+}
+
+size_t StreamingResampler::process_pcm_input(size_t count, int16_t* out) {
+    return process_buffered(pcm_buffer_, count, out);
+}
+
+size_t StreamingResampler::process(const float* input, size_t count, float* out) {
+    std::memcpy(input_buffer(count), input, count * sizeof(float));
+    return process_buffered(buffer_, count, out);
+}
+
+size_t StreamingResampler::process(const float* input, size_t count, int16_t* out) {
+    std::memcpy(input_buffer(count), input, count * sizeof(float));
+    return process_buffered(buffer_, count, out);
+}
+
+size_t StreamingResampler::process(const int16_t* input, size_t count, int16_t* out) {
+    std::memcpy(pcm_input_buffer(count), input, count * sizeof(int16_t));
+    return process_buffered(pcm_buffer_, count, out);
+}
+
+size_t StreamingResampler::flush(float* out) {
+    return flush_buffered(buffer_, out);
+}
+
+size_t StreamingResampler::flush(int16_t* out) {
+    return pcm_input_ ? flush_buffered(pcm_buffer_, out) : flush_buffered(buffer_, out);
+}
+
+std::vector<float> StreamingResampler::resample(const std::vector<float>& input, int input_rate, int output_rate) {
+    StreamingResampler resampler(input_rate, output_rate);
+
+    // Blocks keep the filter buffer small instead of copying the whole input into it
+    const size_t block = 64 * 1024;
+    std::vector<float> output(resampler.max_output(input.size()) + resampler.max_flush_output());
+    size_t written = 0;
+    for (size_t offset = 0; offset < input.size(); offset += block) {
+        const size_t count = std::min(block, input.size() - offset);
+        written += resampler.process(input.data() + offset, count, output.data() + written);
+    }
+    written += resampler.flush(output.data() + written);
+
+    output.resize(written);
+    return output;
+}
+
+} // namespace AudioDuplicates
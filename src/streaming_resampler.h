@@ -0,0 +1,112 @@
+#pragma once
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+
+namespace AudioDuplicates {
+
+/**
+ * Streaming polyphase resampler for mono float or int16 audio
+ * An anti-aliased windowed-sinc FIR is split into one coefficient row per output
+ * phase; filter history carries across calls, so chunked input produces the same
+ * samples as resampling the whole signal at once
+ */
+class StreamingResampler {
+public:
+    StreamingResampler();
+    StreamingResampler(int input_rate, int output_rate);
+
+    // Set the conversion; the filter is only rebuilt when the rates change. Always resets state
+    void configure(int input_rate, int output_rate);
+
+    // Drop the filter history and start a new signal
+    void reset();
+
+    int input_rate() const { return input_rate_; }
+    int output_rate() const { return output_rate_; }
+    size_t taps() const { return taps_; }
+    bool passthrough() const { return up_ == down_; }
+
+    // Upper bound on the samples written by one process call (or by any sequence
+    // of calls totalling input_count samples), and by flush()
+    size_t max_output(size_t input_count) const {
+        return static_cast<size_t>(static_cast<uint64_t>(input_count) * up_ / down_) + 2;
+    }
+    size_t max_flush_output() const { return max_output(taps_); }
+
+    // Writable space for count input samples, consumed by the next process_input(count);
+    // lets producers (e.g. downmixers) write straight into the filter's buffer
+    float* input_buffer(size_t count);
+
+    // Resample samples written through input_buffer(). int16 output is scaled by
+    // 32767 and clamped
+    size_t process_input(size_t count, float* out);
+    size_t process_input(size_t count, int16_t* out);
+
+    // Integer path: int16 input filtered with Q14 coefficients straight to int16,
+    // for decoders that already produce PCM. One signal uses one input format
+    int16_t* pcm_input_buffer(size_t count);
+    size_t process_pcm_input(size_t count, int16_t* out);
+
+    // Copy then resample
+    size_t process(const float* input, size_t count, float* out);
+    size_t process(const float* input, size_t count, int16_t* out);
+    size_t process(const int16_t* input, size_t count, int16_t* out);
+
+    // Emit the samples still held back by the filter delay, so the total output is
+    // floor(inputs * output_rate / input_rate) samples. Ends the signal
+    size_t flush(float* out);
+    size_t flush(int16_t* out);
+
+    // Whole-buffer convenience used by the non-streaming loaders
+    static std::vector<float> resample(const std::vector<float>& input, int input_rate, int output_rate);
+
+    static constexpr size_t MAX_PHASES = 512;     // Larger up-factors share the nearest of this many rows
+    static constexpr size_t ZERO_CROSSINGS = 8;   // Sinc lobes on each side of the centre tap
+    static constexpr double PASSBAND = 0.9;       // Cutoff as a fraction of the lower Nyquist frequency
+    static constexpr int COEFFICIENT_BITS = 14;   // Fixed-point scale of the integer rows (headroom for upsampling rows near 1.0)
+
+private:
+    int input_rate_;
+    int output_rate_;
+    uint64_t up_;    // Reduced output/input ratio: up_ / down_
+    uint64_t down_;
+    size_t phases_;  // Coefficient rows
+    size_t taps_;    // Coefficients per row, padded to a multiple of 8
+    uint64_t delay_; // Filter centre, in 1/up_ input samples
+    std::vector<float> coefficients_;       // phases_ rows of taps_, oldest input first
+    std::vector<int16_t> coefficients_q14_; // The same rows in fixed point
+
+    // taps_ - 1 samples of history followed by the unprocessed input; only the
+    // buffer matching the current signal's input format is in use
+    std::vector<float> buffer_;
+    std::vector<int16_t> pcm_buffer_;
+    bool pcm_input_;
+    size_t buffered_;
+    size_t base_;      // Buffer index of the newest input under the next output
+    uint64_t phase_;   // Next output's offset past base_, in 1/up_ input samples
+    uint64_t inputs_;
+    uint64_t outputs_;
+
+    void design_filter();
+
+    // Coefficient rows matching an input sample type
+    const float* rows(const float*) const { return coefficients_.data(); }
+    const int16_t* rows(const int16_t*) const { return coefficients_q14_.data(); }
+
+    // Emit outputs while their newest input is buffered, stopping at limit total outputs
+    template <typename Sample, typename Out>
+    size_t run(const Sample* samples, Out* out, uint64_t limit);
+
+    template <typename Sample, typename Out>
+    size_t process_buffered(std::vector<Sample>& buffer, size_t count, Out* out);
+
+    template <typename Sample>
+    void drop_consumed(std::vector<Sample>& buffer);
+
+    template <typename Sample, typename Out>
+    size_t flush_buffered(std::vector<Sample>& buffer, Out* out);
+};
+
+} // namespace AudioDuplicates
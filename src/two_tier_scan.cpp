@@ -0,0 +1,177 @@
+#include "two_tier_scan.h"
+#include "streaming_audio_loader.h"
+#include "disjoint_set.h"
+#include <algorithm>
+#include <chrono>
+#include <exception>
+#include <unordered_map>
+#include <omp.h>
+
+namespace AudioDuplicates {
+
+TwoTierScanner::TwoTierScanner(const TwoTierConfig& config)
+    : config_(config), comparator_(std::make_unique<FingerprintComparator>()) {
+    config_.prefix_seconds = std::max(1.0, config_.prefix_seconds);
+    config_.min_votes = std::max<size_t>(1, config_.min_votes);
+}
+
+void TwoTierScanner::set_comparator(std::unique_ptr<FingerprintComparator> comparator) {
+    if (comparator) {
+        comparator_ = std::move(comparator);
+    }
+}
+
+TwoTierResult TwoTierScanner::run(const std::vector<std::string>& paths) const {
+    auto start_time = std::chrono::steady_clock::now();
+
+    TwoTierResult result;
+    result.stats = TwoTierStats{};
+    result.stats.files = paths.size();
+
+    const int threads = config_.num_threads > 0 ? static_cast<int>(config_.num_threads) : omp_get_max_threads();
+
+    // Tier one: the first prefix_seconds of every file. Prefixes stay in memory
+    // (a few hundred frames each) so candidates can be continued later
+    std::vector<std::unique_ptr<PrefixFingerprint>> prefixes(paths.size());
+    std::vector<std::string> prefix_errors(paths.size());
+    #pragma omp parallel num_threads(threads)
+    {
+        StreamingAudioLoader loader;
+        if (config_.algorithm >= 0) {
+            loader.setAlgorithm(config_.algorithm);
+        }
+
+        #pragma omp for schedule(dynamic)
+        for (int64_t i = 0; i < static_cast<int64_t>(paths.size()); ++i) {
+            try {
+                prefixes[i] = loader.generatePrefixFingerprint(paths[i], config_.prefix_seconds);
+            } catch (const std::exception& e) {
+                prefix_errors[i] = e.what();
+            }
+        }
+    }
+
+    SelfJoinConfig join_config;
+    join_config.min_votes = config_.min_votes;
+    join_config.max_offset = comparator_->get_max_alignment_offset();
+    join_config.max_run_length = config_.max_run_length;
+    join_config.num_threads = config_.num_threads;
+    SelfJoinEngine engine(join_config);
+
+    for (size_t i = 0; i < paths.size(); ++i) {
+        if (!prefixes[i]) {
+            result.errors.push_back({i, "prefix", prefix_errors[i]});
+            continue;
+        }
+        const PrefixFingerprint& prefix = *prefixes[i];
+        result.stats.audio_seconds += static_cast<double>(prefix.total_frames) / prefix.source_rate;
+        result.stats.prefix_decoded_seconds += static_cast<double>(prefix.decoded_frames) / prefix.source_rate;
+        engine.add(static_cast<uint32_t>(i), prefix.fingerprint.data.data(), prefix.fingerprint.data.size());
+    }
+
+    auto pairs = engine.run();
+    result.stats.join = engine.getStats();
+    result.stats.prefix_candidate_pairs = pairs.size();
+
+    // Tier two: only files in a candidate pair are decoded past their prefix
+    std::vector<size_t> candidates;
+    for (const auto& pair : pairs) {
+        candidates.push_back(pair.file_a);
+        candidates.push_back(pair.file_b);
+    }
+    std::sort(candidates.begin(), candidates.end());
+    candidates.erase(std::unique(candidates.begin(), candidates.end()), candidates.end());
+
+    std::vector<std::unique_ptr<Fingerprint>> full(paths.size());
+    std::vector<std::string> full_errors(paths.size());
+    double full_decoded_seconds = 0.0;
+    #pragma omp parallel num_threads(threads) reduction(+:full_decoded_seconds)
+    {
+        StreamingAudioLoader loader;
+        if (config_.algorithm >= 0) {
+            loader.setAlgorithm(config_.algorithm);
+        }
+
+        #pragma omp for schedule(dynamic)
+        for (int64_t c = 0; c < static_cast<int64_t>(candidates.size()); ++c) {
+            const size_t i = candidates[c];
+            try {
+                double decoded_seconds = 0.0;
+                full[i] = loader.completeFingerprint(*prefixes[i], &decoded_seconds);
+                full_decoded_seconds += decoded_seconds;
+            } catch (const std::exception& e) {
+                full_errors[i] = e.what();
+            }
+        }
+    }
+    result.stats.full_decoded_seconds = full_decoded_seconds;
+
+    for (size_t i : candidates) {
+        if (full[i]) {
+            result.stats.completed_files++;
+        } else {
+            result.errors.push_back({i, "full", full_errors[i]});
+        }
+    }
+    std::sort(result.errors.begin(), result.errors.end(),
+              [](const TwoTierError& a, const TwoTierError& b) { return a.input_index < b.input_index; });
+
+    // Prefix frames line up with the start of the full fingerprints, so the
+    // self-join's offset is a valid alignment hint for the whole file
+    std::vector<double> verified_similarity(pairs.size(), -1.0);
+    #pragma omp parallel for num_threads(threads) schedule(dynamic)
+    for (int64_t p = 0; p < static_cast<int64_t>(pairs.size()); ++p) {
+        const auto& pair = pairs[p];
+        if (!full[pair.file_a] || !full[pair.file_b]) {
+            continue;
+        }
+        auto match_result = comparator_->compare_with_offset_hint(*full[pair.file_a], *full[pair.file_b], pair.offset_hint);
+        if (match_result.is_duplicate) {
+            verified_similarity[p] = match_result.similarity_score;
+        }
+    }
+
+    // Cluster verified pairs; group similarity is the mean over verified edges
+    DisjointSet sets(paths.size());
+    for (size_t p = 0; p < pairs.size(); ++p) {
+        if (verified_similarity[p] >= 0.0) {
+            sets.unite(pairs[p].file_a, pairs[p].file_b);
+            result.stats.verified_pairs++;
+        }
+    }
+
+    std::unordered_map<size_t, DuplicateGroup> groups_by_root;
+    std::unordered_map<size_t, size_t> edges_by_root;
+    for (size_t p = 0; p < pairs.size(); ++p) {
+        if (verified_similarity[p] >= 0.0) {
+            size_t root = sets.find(pairs[p].file_a);
+            groups_by_root[root].avg_similarity += verified_similarity[p];
+            edges_by_root[root]++;
+        }
+    }
+
+    for (size_t i = 0; i < paths.size(); ++i) {
+        auto it = groups_by_root.find(sets.find(i));
+        if (it != groups_by_root.end()) {
+            it->second.file_ids.push_back(i);
+        }
+    }
+
+    result.groups.reserve(groups_by_root.size());
+    for (auto& entry : groups_by_root) {
+        entry.second.avg_similarity /= edges_by_root[entry.first];
+        result.groups.push_back(std::move(entry.second));
+    }
+    std::sort(result.groups.begin(), result.groups.end(),
+              [](const DuplicateGroup& a, const DuplicateGroup& b) {
+                  return a.avg_similarity > b.avg_similarity;
+              });
+
+    result.stats.decode_seconds_saved = std::max(0.0,
+        result.stats.audio_seconds - result.stats.prefix_decoded_seconds - result.stats.full_decoded_seconds);
+    result.stats.wall_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start_time).count();
+
+    return result;
+}
+
+} // namespace AudioDuplicates
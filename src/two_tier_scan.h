@@ -0,0 +1,74 @@
+#pragma once
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+#include "fingerprint_index.h"
+#include "fingerprint_comparator.h"
+#include "self_join.h"
+
+namespace AudioDuplicates {
+
+struct TwoTierConfig {
+    double prefix_seconds = 30.0;  // Audio fingerprinted for every file in the first tier
+    size_t min_votes = 5;          // Prefix hash matches for a pair to become a candidate
+    size_t max_run_length = 4096;  // Prefix hashes shared by more tuples than this are skipped
+    int algorithm = -1;            // Chromaprint algorithm; < 0 = default
+    size_t num_threads = 0;        // 0 = OpenMP default
+};
+
+struct TwoTierError {
+    size_t input_index;
+    std::string stage;  // "prefix" or "full"
+    std::string message;
+};
+
+struct TwoTierStats {
+    size_t files;
+    size_t prefix_candidate_pairs; // Pairs the self-join found among the prefixes
+    size_t completed_files;        // Files with a prefix candidate, fingerprinted in full
+    size_t verified_pairs;         // Candidate pairs confirmed on the full fingerprints
+    double audio_seconds;          // Whole-file duration summed over readable files
+    double prefix_decoded_seconds; // Audio decoded for the first tier
+    double full_decoded_seconds;   // Audio decoded to complete candidates (seam overlap included)
+    double decode_seconds_saved;   // audio_seconds minus everything decoded
+    double wall_seconds;
+    SelfJoinEngine::Stats join;
+};
+
+struct TwoTierResult {
+    // file_ids are indices into the input paths; groups are sorted by average similarity, highest first
+    std::vector<DuplicateGroup> groups;
+    std::vector<TwoTierError> errors;
+    TwoTierStats stats;
+};
+
+/**
+ * Two-tier duplicate scan: every file is fingerprinted over its first seconds
+ * only, candidates are found among those prefixes with the sort-merge self-join,
+ * and only files in a candidate pair are decoded further. Their fingerprints are
+ * continued from the end of the prefix rather than started again, then the
+ * candidate pairs are verified on the full fingerprints around the prefix
+ * alignment. Copies that differ at their start by more than the comparator's
+ * alignment window are not found
+ */
+class TwoTierScanner {
+public:
+    explicit TwoTierScanner(const TwoTierConfig& config = TwoTierConfig{});
+
+    TwoTierResult run(const std::vector<std::string>& paths) const;
+
+    // Thresholds and alignment window for candidate verification
+    void set_comparator(std::unique_ptr<FingerprintComparator> comparator);
+    const FingerprintComparator& comparator() const { return *comparator_; }
+
+    const TwoTierConfig& config() const { return config_; }
+
+private:
+    TwoTierConfig config_;
+    std::unique_ptr<FingerprintComparator> comparator_;
+};
+
+} // namespace AudioDuplicates
@@ -0,0 +1,219 @@
+#include "wav_file.h"
+#include <cstring>
+
+#ifndef _WIN32
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#endif
+
+namespace AudioDuplicates {
+
+namespace {
+
+constexpr uint16_t WAVE_FORMAT_PCM = 0x0001;
+constexpr uint16_t WAVE_FORMAT_IEEE_FLOAT = 0x0003;
+constexpr uint16_t WAVE_FORMAT_EXTENSIBLE = 0xFFFE;
+
+// KSDATAFORMAT_SUBTYPE_* GUIDs share everything after the leading format tag
+constexpr uint8_t SUBFORMAT_GUID_TAIL[14] = {
+    0x00, 0x00, 0x00, 0x00, 0x10, 0x00, 0x80, 0x00, 0x00, 0xAA, 0x00, 0x38, 0x9B, 0x71
+};
+
+inline uint16_t read_u16(const uint8_t* p) {
+    return static_cast<uint16_t>(p[0] | (p[1] << 8));
+}
+
+inline uint32_t read_u32(const uint8_t* p) {
+    return static_cast<uint32_t>(p[0]) | (static_cast<uint32_t>(p[1]) << 8) |
+           (static_cast<uint32_t>(p[2]) << 16) | (static_cast<uint32_t>(p[3]) << 24);
+}
+
+inline uint64_t read_u64(const uint8_t* p) {
+    return static_cast<uint64_t>(read_u32(p)) | (static_cast<uint64_t>(read_u32(p + 4)) << 32);
+}
+
+inline bool has_id(const uint8_t* p, const char* id) {
+    return std::memcmp(p, id, 4) == 0;
+}
+
+} // namespace
+
+WavFile::WavFile()
+    : data_(nullptr), size_(0), samples_(nullptr), frames_(0), sample_rate_(0), channels_(0),
+      format_(WavSampleFormat::Int16) {}
+
+WavFile::~WavFile() {
+#ifndef _WIN32
+    if (data_) {
+        munmap(const_cast<uint8_t*>(data_), size_);
+    }
+#endif
+}
+
+std::unique_ptr<WavFile> WavFile::open(const std::string& path) {
+#ifdef _WIN32
+    (void)path;
+    return nullptr;
+#else
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return nullptr;
+    }
+
+    struct stat st;
+    if (fstat(fd, &st) != 0 || st.st_size < 44) {
+        ::close(fd);
+        return nullptr;
+    }
+
+    void* mapping = mmap(nullptr, static_cast<size_t>(st.st_size), PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapping == MAP_FAILED) {
+        return nullptr;
+    }
+
+    std::unique_ptr<WavFile> wav(new WavFile());
+    wav->data_ = static_cast<const uint8_t*>(mapping);
+    wav->size_ = static_cast<size_t>(st.st_size);
+    if (!wav->parse()) {
+        return nullptr;
+    }
+
+    // The data chunk is read front to back exactly once
+    const size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    const size_t start = static_cast<size_t>(wav->samples_ - wav->data_) & ~(page - 1);
+    madvise(const_cast<uint8_t*>(wav->data_) + start, wav->size_ - start, MADV_SEQUENTIAL);
+
+    return wav;
+#endif
+}
+
+size_t WavFile::prefetch() const {
+    const size_t bytes = static_cast<size_t>(frames_) * channels_ * bytes_per_sample();
+#ifndef _WIN32
+    const size_t page = static_cast<size_t>(sysconf(_SC_PAGESIZE));
+    const size_t start = static_cast<size_t>(samples_ - data_) & ~(page - 1);
+    madvise(const_cast<uint8_t*>(data_) + start, size_ - start, MADV_WILLNEED);
+
+    // One read per page; volatile keeps the loads from being optimised away
+    const volatile uint8_t* p = samples_;
+    uint8_t sink = 0;
+    for (size_t offset = 0; offset < bytes; offset += page) {
+        sink ^= p[offset];
+    }
+    (void)sink;
+#endif
+    return bytes;
+}
+
+bool WavFile::evict_page_cache(const std::string& path) {
+#if defined(_WIN32) || defined(__APPLE__)
+    (void)path;
+    return false;
+#else
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    const bool evicted = posix_fadvise(fd, 0, 0, POSIX_FADV_DONTNEED) == 0;
+    ::close(fd);
+    return evicted;
+#endif
+}
+
+bool WavFile::parse() {
+#if defined(__BYTE_ORDER__) && __BYTE_ORDER__ == __ORDER_BIG_ENDIAN__
+    // The views hand out file bytes as native samples
+    return false;
+#endif
+    const bool rf64 = has_id(data_, "RF64");
+    if (!(has_id(data_, "RIFF") || rf64) || !has_id(data_ + 8, "WAVE")) {
+        return false;
+    }
+
+    uint64_t rf64_data_size = 0;
+    bool have_format = false;
+    size_t pos = 12;
+
+    while (pos + 8 <= size_) {
+        const uint8_t* chunk = data_ + pos;
+        const uint64_t chunk_size = read_u32(chunk + 4);
+        const uint8_t* body = chunk + 8;
+        const size_t available = size_ - pos - 8;
+
+        if (has_id(chunk, "ds64")) {
+            // RF64 keeps the real 64-bit sizes here: riff size, data size, sample count
+            if (!rf64 || chunk_size < 24 || available < 24) {
+                return false;
+            }
+            rf64_data_size = read_u64(body + 8);
+        } else if (has_id(chunk, "fmt ")) {
+            if (chunk_size < 16 || available < chunk_size) {
+                return false;
+            }
+            uint16_t tag = read_u16(body);
+            const uint16_t channels = read_u16(body + 2);
+            const uint32_t rate = read_u32(body + 4);
+            const uint16_t block_align = read_u16(body + 12);
+            const uint16_t bits = read_u16(body + 14);
+
+            if (tag == WAVE_FORMAT_EXTENSIBLE) {
+                if (chunk_size < 40 || std::memcmp(body + 26, SUBFORMAT_GUID_TAIL, sizeof(SUBFORMAT_GUID_TAIL)) != 0) {
+                    return false;
+                }
+                tag = read_u16(body + 24);
+            }
+
+            if (tag == WAVE_FORMAT_PCM && bits == 16) {
+                format_ = WavSampleFormat::Int16;
+            } else if (tag == WAVE_FORMAT_IEEE_FLOAT && bits == 32) {
+                format_ = WavSampleFormat::Float32;
+            } else {
+                return false;
+            }
+
+            if (channels == 0 || rate == 0 || rate > 0x7FFFFFFF ||
+                block_align != channels * bytes_per_sample()) {
+                return false;
+            }
+            channels_ = channels;
+            sample_rate_ = static_cast<int>(rate);
+            have_format = true;
+        } else if (has_id(chunk, "data")) {
+            if (!have_format) {
+                return false;
+            }
+
+            // Views must be aligned for their sample type; the mapping itself is page-aligned
+            const size_t offset = pos + 8;
+            if (offset % bytes_per_sample() != 0) {
+                return false;
+            }
+
+            uint64_t data_size = chunk_size;
+            if (rf64 && chunk_size == 0xFFFFFFFFu) {
+                data_size = rf64_data_size;
+            }
+            if (data_size > available) {
+                data_size = available;
+            }
+
+            samples_ = data_ + offset;
+            frames_ = data_size / (static_cast<uint64_t>(channels_) * bytes_per_sample());
+            return true;
+        }
+
+        // Chunks are padded to an even length
+        const uint64_t advance = 8 + chunk_size + (chunk_size & 1);
+        if (advance > size_ - pos) {
+            return false;
+        }
+        pos += static_cast<size_t>(advance);
+    }
+
+    return false;
+}
+
+} // namespace AudioDuplicates
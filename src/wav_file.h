@@ -0,0 +1,69 @@
+#pragma once
+
+#include <string>
+#include <memory>
+#include <cstdint>
+#include <cstddef>
+
+namespace AudioDuplicates {
+
+enum class WavSampleFormat : uint8_t {
+    Int16 = 0,   // 16-bit signed PCM
+    Float32 = 1  // IEEE float
+};
+
+/**
+ * Read-only memory map of a little-endian WAV or RF64 file
+ * Only the layouts the fingerprint stage can consume as-is are accepted (16-bit
+ * PCM and 32-bit float, plain or WAVE_FORMAT_EXTENSIBLE); the data chunk is
+ * exposed as interleaved frames without copying
+ */
+class WavFile {
+public:
+    // Map path and validate its header; nullptr when the file is not a WAV this
+    // reader handles, so callers fall back to libsndfile
+    static std::unique_ptr<WavFile> open(const std::string& path);
+
+    ~WavFile();
+
+    WavFile(const WavFile&) = delete;
+    WavFile& operator=(const WavFile&) = delete;
+
+    int sample_rate() const { return sample_rate_; }
+    int channels() const { return channels_; }
+    WavSampleFormat format() const { return format_; }
+    size_t bytes_per_sample() const { return format_ == WavSampleFormat::Int16 ? sizeof(int16_t) : sizeof(float); }
+
+    // Whole frames in the data chunk (a truncated file yields the frames present)
+    uint64_t frames() const { return frames_; }
+
+    // Interleaved frames; only the view matching format() is valid
+    const int16_t* int16_frames() const { return reinterpret_cast<const int16_t*>(samples_); }
+    const float* float_frames() const { return reinterpret_cast<const float*>(samples_); }
+
+    size_t file_size() const { return size_; }
+
+    // Fault the data chunk into memory so later readers never wait on the disk;
+    // returns the bytes touched
+    size_t prefetch() const;
+
+    // Ask the kernel to drop path's cached pages so the next read comes from disk
+    // (cold-cache benchmarks); false where unsupported
+    static bool evict_page_cache(const std::string& path);
+
+private:
+    WavFile();
+
+    const uint8_t* data_;
+    size_t size_;
+    const uint8_t* samples_;
+    uint64_t frames_;
+    int sample_rate_;
+    int channels_;
+    WavSampleFormat format_;
+
+    // Parse the RIFF/RF64 chunk list; false when the layout is unsupported
+    bool parse();
+};
+
+} // namespace AudioDuplicates
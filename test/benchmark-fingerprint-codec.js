@@ -0,0 +1,71 @@
+#!/usr/bin/env node
+
+const audioDuplicates = require('../lib/index');
+const fs = require('fs');
+const path = require('path');
+const { collectWavFiles } = require('./helpers');
+
+/**
+ * Benchmark fingerprint storage codecs (LZ4 vs XOR-delta) on real fingerprints
+ * Usage: node test/benchmark-fingerprint-codec.js [directory] [iterations]
+ */
+
+async function benchmarkCodecs() {
+    const directory = process.argv[2] || 'test_scenarios';
+    const iterations = parseInt(process.argv[3] || '200', 10);
+
+    console.log('⚡ Performance Benchmark: Fingerprint Codecs\n');
+
+    if (!fs.existsSync(directory)) {
+        console.log(`⚠️  Directory not available for benchmarking: ${directory}`);
+        return;
+    }
+
+    const files = collectWavFiles(directory);
+    if (files.length === 0) {
+        console.log('⚠️  No audio files found for benchmarking');
+        return;
+    }
+
+    console.log(`📁 Benchmarking ${files.length} files, ${iterations} decodes each\n`);
+
+    const totals = {};
+
+    for (const file of files) {
+        try {
+            const fingerprint = await audioDuplicates.generateFingerprint(file);
+            if (fingerprint.data.length === 0) {
+                continue;
+            }
+
+            const results = await audioDuplicates.benchmarkFingerprintCodecs(fingerprint, iterations);
+            const summary = results
+                .map(r => `${r.codec} ${(r.compressionRatio * 100).toFixed(1)}% @ ${r.decodeGBps.toFixed(2)} GB/s`)
+                .join(', ');
+            console.log(`   ${path.basename(file)} (${fingerprint.data.length} frames): ${summary}`);
+
+            for (const result of results) {
+                const total = totals[result.codec] || { compressed: 0, original: 0, gbps: 0, files: 0 };
+                total.compressed += result.compressedSize;
+                total.original += result.originalSize;
+                total.gbps += result.decodeGBps;
+                total.files++;
+                totals[result.codec] = total;
+            }
+        } catch (error) {
+            console.log(`   Error processing ${path.basename(file)}: ${error.message}`);
+        }
+    }
+
+    console.log('\n📊 Summary:\n');
+    for (const [codec, total] of Object.entries(totals)) {
+        console.log(`🔧 ${codec}:`);
+        console.log(`   Compression ratio: ${(total.compressed / total.original * 100).toFixed(1)}%`);
+        console.log(`   Avg decode throughput: ${(total.gbps / total.files).toFixed(2)} GB/s`);
+    }
+}
+
+benchmarkCodecs().catch(error => {
+    console.error('💥 Codec benchmark failed:', error.message);
+    process.exit(1);
+});
@@ -0,0 +1,79 @@
+#!/usr/bin/env node
+
+const audioDuplicates = require('../lib/index');
+const fs = require('fs');
+const path = require('path');
+const { collectAudioFiles } = require('./helpers');
+
+/**
+ * Compare the staged fingerprinting pipeline with the OpenMP batch and report
+ * per-stage utilisation and queue depths
+ * Usage: node test/benchmark-pipeline.js [directory] [queue capacity] [prefetch depth] [prefetch backend]
+ */
+
+async function benchmarkPipeline() {
+    const directory = process.argv[2] || 'test_scenarios';
+    const queueCapacity = parseInt(process.argv[3] || '8', 10);
+    const prefetchDepth = parseInt(process.argv[4] || '0', 10);
+    const prefetchBackend = process.argv[5] || 'auto';
+
+    console.log('⚡ Performance Benchmark: Fingerprinting Pipeline\n');
+
+    if (!fs.existsSync(directory)) {
+        console.log(`⚠️  Directory not available for benchmarking: ${directory}`);
+        return;
+    }
+
+    const files = collectAudioFiles(directory);
+    if (files.length === 0) {
+        console.log('⚠️  No audio files found for benchmarking');
+        return;
+    }
+
+    console.log(`📁 Benchmarking ${files.length} files\n`);
+
+    // OpenMP batch: every thread reads, decodes and fingerprints one file at a time
+    let start = process.hrtime.bigint();
+    const batch = await audioDuplicates.generateFingerprintsBatch(files);
+    const batchSeconds = Number(process.hrtime.bigint() - start) / 1e9;
+    const batchErrors = batch.filter(result => result.error).length;
+    console.log(`🔧 generateFingerprintsBatch: ${batchSeconds.toFixed(3)}s (${batchErrors} errors)`);
+
+    await audioDuplicates.initializeIndex();
+    start = process.hrtime.bigint();
+    const result = await audioDuplicates.addFilesToIndexPipeline(files, { queueCapacity, prefetchDepth, prefetchBackend });
+    const pipelineSeconds = Number(process.hrtime.bigint() - start) / 1e9;
+    console.log(`🔧 addFilesToIndexPipeline:   ${pipelineSeconds.toFixed(3)}s (${result.errors.length} errors, ` +
+                `${(result.stats.bytesRead / 1e6).toFixed(1)} MB read)`);
+    if (batchSeconds > 0 && pipelineSeconds > 0) {
+        console.log(`   speedup: ${(batchSeconds / pipelineSeconds).toFixed(2)}x (pipeline also indexes)`);
+    }
+
+    if (result.stats.prefetch) {
+        const prefetch = result.stats.prefetch;
+        console.log(`   prefetch: ${prefetch.backend}, depth ${prefetchDepth}, ${prefetch.readRequests} reads, ` +
+                    `I/O stage waited ${prefetch.consumerWaits} times (${prefetch.consumerWaitSeconds.toFixed(3)}s)`);
+    }
+
+    console.log('\n📊 Stages:');
+    for (const stage of result.stats.stages) {
+        console.log(`   ${stage.name.padEnd(12)} ${String(stage.threads).padStart(2)} threads  ` +
+                    `${(stage.utilisation * 100).toFixed(1).padStart(5)}% busy  ` +
+                    `${stage.items} files  ${stage.busySeconds.toFixed(3)}s`);
+    }
+
+    console.log('\n📊 Queues:');
+    for (const queue of result.stats.queues) {
+        console.log(`   ${queue.name.padEnd(17)} mean ${queue.meanDepth.toFixed(2)} / ${queue.capacity}  ` +
+                    `max ${queue.maxDepth}  full ${(queue.fullRatio * 100).toFixed(1)}%`);
+    }
+
+    for (const error of result.errors.slice(0, 5)) {
+        console.log(`   ${error.stage} failed for ${path.basename(error.filePath)}: ${error.error}`);
+    }
+}
+
+benchmarkPipeline().catch(error => {
+    console.error('💥 Pipeline benchmark failed:', error.message);
+    process.exit(1);
+});
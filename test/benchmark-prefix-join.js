@@ -0,0 +1,89 @@
+#!/usr/bin/env node
+
+const audioDuplicates = require('../lib/index');
+const fs = require('fs');
+const path = require('path');
+const { collectWavFiles } = require('./helpers');
+
+/**
+ * Benchmark the prefix-filtering join against per-file find_candidates + quick_filter
+ * Usage: node test/benchmark-prefix-join.js [directory] [threshold]
+ */
+
+function pairKey(pair) {
+    return `${pair.fileA}:${pair.fileB}`;
+}
+
+async function benchmarkPrefixJoin() {
+    const directory = process.argv[2] || 'test_scenarios';
+    const threshold = parseFloat(process.argv[3] || '0.85');
+
+    console.log('⚡ Performance Benchmark: Prefix-Filtering Join\n');
+
+    if (!fs.existsSync(directory)) {
+        console.log(`⚠️  Directory not available for benchmarking: ${directory}`);
+        return;
+    }
+
+    const files = collectWavFiles(directory);
+    if (files.length < 2) {
+        console.log('⚠️  Need at least two audio files for benchmarking');
+        return;
+    }
+
+    await audioDuplicates.initializeIndex();
+    await audioDuplicates.setSimilarityThreshold(threshold);
+
+    console.log(`📁 Indexing ${files.length} files from ${directory}`);
+    const indexStart = Date.now();
+    for (const file of files) {
+        try {
+            await audioDuplicates.addFileToIndex(file);
+        } catch (error) {
+            console.log(`   Skipping ${path.basename(file)}: ${error.message}`);
+        }
+    }
+    console.log(`   Indexed in ${Date.now() - indexStart}ms\n`);
+
+    console.log('📊 Quick filter pair discovery:\n');
+
+    const indexedStart = Date.now();
+    const indexedPairs = await audioDuplicates.findQuickFilterPairs('indexed');
+    const indexedTime = Date.now() - indexedStart;
+    console.log(`🔧 find_candidates + quick_filter: ${indexedPairs.length} pairs in ${indexedTime}ms`);
+
+    const prefixStart = Date.now();
+    const prefixPairs = await audioDuplicates.findQuickFilterPairs('prefix');
+    const prefixTime = Date.now() - prefixStart;
+    console.log(`🔧 Prefix-filtering join:        ${prefixPairs.length} pairs in ${prefixTime}ms`);
+
+    const stats = (await audioDuplicates.getIndexStats()).prefixJoin;
+    const allPairs = (stats.records * (stats.records - 1)) / 2;
+    console.log(`   Prefix entries indexed: ${stats.prefixEntries}`);
+    console.log(`   Candidates verified: ${stats.candidates} of ${allPairs} possible pairs`);
+
+    // The join finds every pair quick_filter accepts; the indexed path only sees
+    // pairs that also clear the index's hash vote threshold
+    const prefixKeys = new Set(prefixPairs.map(pairKey));
+    const missing = indexedPairs.filter(pair => !prefixKeys.has(pairKey(pair)));
+    const extra = prefixPairs.length - (indexedPairs.length - missing.length);
+
+    console.log('');
+    if (missing.length === 0) {
+        console.log(`   ✅ All indexed pairs found by the prefix join (${extra} additional pairs below the vote threshold)`);
+    } else {
+        console.log(`   ❌ ${missing.length} indexed pairs missing from the prefix join`);
+        process.exitCode = 1;
+    }
+
+    if (prefixTime > 0) {
+        console.log(`   Speedup: ${(indexedTime / prefixTime).toFixed(2)}x`);
+    }
+
+    await audioDuplicates.clearIndex();
+}
+
+benchmarkPrefixJoin().catch(error => {
+    console.error('💥 Prefix join benchmark failed:', error.message);
+    process.exit(1);
+});
@@ -0,0 +1,72 @@
+#!/usr/bin/env node
+
+const audioDuplicates = require('../lib/index');
+const fs = require('fs');
+const path = require('path');
+const { collectWavFiles } = require('./helpers');
+
+/**
+ * Compare the two-tier scan (prefix fingerprints, full ones only for candidates)
+ * with fingerprinting every file in full and running the bulk self-join
+ * Usage: node test/benchmark-two-tier.js [directory] [prefixSeconds]
+ */
+
+function groupKeys(groups) {
+    return new Set(groups.map(group => group.filePaths.slice().sort().join('|')));
+}
+
+async function benchmarkTwoTier() {
+    const directory = process.argv[2] || 'test_scenarios';
+    const prefixSeconds = parseFloat(process.argv[3] || '30');
+
+    console.log('⚡ Performance Benchmark: Two-Tier Scan\n');
+
+    if (!fs.existsSync(directory)) {
+        console.log(`⚠️  Directory not available for benchmarking: ${directory}`);
+        return;
+    }
+
+    const files = collectWavFiles(directory);
+    if (files.length < 2) {
+        console.log('⚠️  Need at least two audio files for benchmarking');
+        return;
+    }
+
+    console.log(`📁 ${files.length} files from ${directory}\n`);
+
+    await audioDuplicates.initializeIndex();
+    const fullStart = Date.now();
+    await audioDuplicates.addFilesToIndexPipeline(files);
+    const fullGroups = await audioDuplicates.findAllDuplicatesBulk();
+    const fullTime = Date.now() - fullStart;
+    console.log(`🔧 Full fingerprints + bulk join: ${fullGroups.length} groups in ${fullTime}ms`);
+
+    const tierStart = Date.now();
+    const result = await audioDuplicates.findDuplicatesTwoTier(files, { prefixSeconds });
+    const tierTime = Date.now() - tierStart;
+    const stats = result.stats;
+    console.log(`🔧 Two-tier scan (${prefixSeconds}s prefixes): ${result.groups.length} groups in ${tierTime}ms`);
+    console.log(`   Prefix candidate pairs: ${stats.prefixCandidatePairs}, verified: ${stats.verifiedPairs}`);
+    console.log(`   Files completed in full: ${stats.completedFiles} of ${stats.files}`);
+    console.log(`   Audio: ${stats.audioSeconds.toFixed(1)}s, decoded: ` +
+                `${(stats.prefixDecodedSeconds + stats.fullDecodedSeconds).toFixed(1)}s ` +
+                `(prefix ${stats.prefixDecodedSeconds.toFixed(1)}s, full ${stats.fullDecodedSeconds.toFixed(1)}s)`);
+    const savedPercent = stats.audioSeconds > 0 ? (100 * stats.decodeSecondsSaved / stats.audioSeconds) : 0;
+    console.log(`   Decode seconds saved: ${stats.decodeSecondsSaved.toFixed(1)}s (${savedPercent.toFixed(1)}%)`);
+    for (const error of result.errors) {
+        console.log(`   Skipped ${path.basename(error.filePath)} (${error.stage}): ${error.error}`);
+    }
+
+    // Groups whose copies differ at their start by more than the alignment window
+    // are only found by the full scan
+    const tierKeys = groupKeys(result.groups);
+    const missing = [...groupKeys(fullGroups)].filter(key => !tierKeys.has(key));
+    console.log(`\n📊 Groups found only by the full scan: ${missing.length}`);
+
+    await audioDuplicates.clearIndex();
+}
+
+benchmarkTwoTier().catch(error => {
+    console.error('💥 Two-tier benchmark failed:', error.message);
+    process.exit(1);
+});
@@ -0,0 +1,109 @@
+const fs = require('fs');
+const path = require('path');
+
+/**
+ * Shared helpers for the test and benchmark scripts
+ */
+
+// Tones that change every quarter second, from a fixed seed so runs are repeatable.
+// Different seeds give unrelated signals; noise adds uniform noise of that peak
+// amplitude, so one seed at several levels gives copies of decreasing similarity
+function writeSyntheticWav(filePath, seconds, sampleRate, channels, seed = 0x2545f491, noise = 0) {
+    const frames = Math.floor(seconds * sampleRate);
+    const dataBytes = frames * channels * 2;
+    const buffer = Buffer.alloc(44 + dataBytes);
+
+    buffer.write('RIFF', 0);
+    buffer.writeUInt32LE(36 + dataBytes, 4);
+    buffer.write('WAVE', 8);
+    buffer.write('fmt ', 12);
+    buffer.writeUInt32LE(16, 16);
+    buffer.writeUInt16LE(1, 20);
+    buffer.writeUInt16LE(channels, 22);
+    buffer.writeUInt32LE(sampleRate, 24);
+    buffer.writeUInt32LE(sampleRate * channels * 2, 28);
+    buffer.writeUInt16LE(channels * 2, 32);
+    buffer.writeUInt16LE(16, 34);
+    buffer.write('data', 36);
+    buffer.writeUInt32LE(dataBytes, 40);
+
+    let state = seed >>> 0 || 1;
+    const random = () => {
+        state ^= state << 13;
+        state ^= state >>> 17;
+        state ^= state << 5;
+        return (state >>> 0) / 4294967296;
+    };
+
+    let noiseState = (seed ^ 0x5bd1e995) >>> 0 || 1;
+    const randomNoise = () => {
+        noiseState ^= noiseState << 13;
+        noiseState ^= noiseState >>> 17;
+        noiseState ^= noiseState << 5;
+        return (noiseState >>> 0) / 4294967296 * 2 - 1;
+    };
+
+    const noteFrames = Math.floor(sampleRate / 4);
+    let freqA = 220;
+    let freqB = 330;
+    let phaseA = 0;
+    let phaseB = 0;
+    let offset = 44;
+    for (let i = 0; i < frames; i++) {
+        if (i % noteFrames === 0) {
+            freqA = 110 * Math.pow(2, random() * 5);
+            freqB = 110 * Math.pow(2, random() * 5);
+        }
+        phaseA += 2 * Math.PI * freqA / sampleRate;
+        phaseB += 2 * Math.PI * freqB / sampleRate;
+        const tone = 9000 * Math.sin(phaseA) + 6000 * Math.sin(phaseB);
+        const sample = Math.round(noise > 0 ? tone + noise * randomNoise() : tone);
+        for (let c = 0; c < channels; c++) {
+            buffer.writeInt16LE(sample, offset);
+            offset += 2;
+        }
+    }
+
+    fs.writeFileSync(filePath, buffer);
+}
+
+// Fraction of differing bits over the common length of two frame arrays
+function bitError(a, b) {
+    const length = Math.min(a.length, b.length);
+    let bits = 0;
+    for (let i = 0; i < length; i++) {
+        let x = (a[i] ^ b[i]) >>> 0;
+        while (x) {
+            x &= x - 1;
+            bits++;
+        }
+    }
+    return length > 0 ? bits / (length * 32) : 1;
+}
+
+const AUDIO_EXTENSIONS = new Set(['.wav', '.flac', '.mp3', '.ogg', '.aiff', '.aif']);
+const WAV_EXTENSIONS = new Set(['.wav']);
+
+// Files under dir, recursively, whose extension is in extensions
+function collectAudioFiles(dir, extensions = AUDIO_EXTENSIONS, files = []) {
+    for (const entry of fs.readdirSync(dir)) {
+        const fullPath = path.join(dir, entry);
+        if (fs.statSync(fullPath).isDirectory()) {
+            collectAudioFiles(fullPath, extensions, files);
+        } else if (extensions.has(path.extname(entry).toLowerCase())) {
+            files.push(fullPath);
+        }
+    }
+    return files;
+}
+
+function collectWavFiles(dir) {
+    return collectAudioFiles(dir, WAV_EXTENSIONS);
+}
+
+module.exports = {
+    writeSyntheticWav,
+    bitError,
+    collectAudioFiles,
+    collectWavFiles
+};
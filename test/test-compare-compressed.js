@@ -0,0 +1,115 @@
+#!/usr/bin/env node
+
+const audioDuplicates = require('../lib/index');
+const fs = require('fs');
+const os = require('os');
+const path = require('path');
+const { writeSyntheticWav } = require('./helpers');
+
+/**
+ * Check the compressed comparison agrees with the uncompressed one near an offset hint
+ * Usage: node test/test-compare-compressed.js
+ * Every pair is compared at its true offset, near it and far from it; both
+ * comparisons must agree on isDuplicate, and on the offset and similarity of duplicates
+ */
+
+const SECONDS = 40;
+const SAMPLE_RATE = 22050;
+const NOISE_LEVELS = [0, 300, 900, 1800, 3000];
+const TRIM_SECONDS = 2.3;
+const HINT_DELTAS = [0, 2, -5, 40];
+const EPSILON = 1e-12;
+
+// Drop the first `seconds` of a mono 16-bit WAV with a plain 44-byte header
+function writeTrimmedWav(filePath, sourcePath, seconds) {
+    const source = fs.readFileSync(sourcePath);
+    const data = source.subarray(44 + Math.floor(seconds * SAMPLE_RATE) * 2);
+    const header = Buffer.from(source.subarray(0, 44));
+    header.writeUInt32LE(36 + data.length, 4);
+    header.writeUInt32LE(data.length, 40);
+    fs.writeFileSync(filePath, Buffer.concat([header, data]));
+}
+
+async function testCompareCompressed() {
+    console.log('🗜️  Testing Compressed Comparison Against Uncompressed\n');
+
+    const directory = fs.mkdtempSync(path.join(os.tmpdir(), 'audio-duplicates-compare-compressed-'));
+    let failures = 0;
+    const check = (condition, message) => {
+        if (condition) {
+            console.log(`   ✓ ${message}`);
+        } else {
+            console.log(`   ✗ Failed: ${message}`);
+            failures++;
+        }
+    };
+
+    try {
+        const fingerprintOf = async (name, write) => {
+            const filePath = path.join(directory, name);
+            write(filePath);
+            return audioDuplicates.generateFingerprint(filePath);
+        };
+
+        const sourcePath = path.join(directory, 'source.wav');
+        const source = await fingerprintOf('source.wav', filePath => writeSyntheticWav(filePath, SECONDS, SAMPLE_RATE, 1, 0x2545f491));
+        const others = [];
+        for (const noise of NOISE_LEVELS) {
+            others.push({ name: `noise ${noise}`, fingerprint: await fingerprintOf(`noise_${noise}.wav`,
+                filePath => writeSyntheticWav(filePath, SECONDS, SAMPLE_RATE, 1, 0x2545f491, noise)) });
+        }
+        others.push({ name: `trimmed ${TRIM_SECONDS}s`, fingerprint: await fingerprintOf('trimmed.wav',
+            filePath => writeTrimmedWav(filePath, sourcePath, TRIM_SECONDS)) });
+        others.push({ name: 'unrelated', fingerprint: await fingerprintOf('unrelated.wav',
+            filePath => writeSyntheticWav(filePath, SECONDS, SAMPLE_RATE, 1, 0x9e3779b9)) });
+
+        let duplicates = 0;
+        let rejections = 0;
+        const blocks = {};
+        for (const other of others) {
+            console.log(`🧪 Source vs ${other.name}:`);
+            const trueOffset = (await audioDuplicates.compareFingerprints(source, other.fingerprint)).bestOffset;
+
+            for (const delta of HINT_DELTAS) {
+                const hint = trueOffset + delta;
+                const plain = await audioDuplicates.compareFingerprintsAtOffset(source, other.fingerprint, hint);
+                const compressed = await audioDuplicates.compareFingerprintsAtOffset(source, other.fingerprint, hint, { compressed: true });
+
+                let agrees = plain.isDuplicate === compressed.isDuplicate;
+                if (plain.isDuplicate) {
+                    agrees = agrees && plain.bestOffset === compressed.bestOffset &&
+                        Math.abs(plain.similarityScore - compressed.similarityScore) < EPSILON &&
+                        plain.matchedSegments === compressed.matchedSegments;
+                    duplicates++;
+                } else {
+                    rejections++;
+                }
+                check(agrees, `hint ${hint}: ${plain.isDuplicate ? `duplicate at ${plain.bestOffset}` : 'rejected'} ` +
+                              `(compressed: ${compressed.isDuplicate ? `duplicate at ${compressed.bestOffset}` : 'rejected'}, ` +
+                              `${compressed.blocksDecoded} blocks)`);
+                if (delta === 0) {
+                    blocks[other.name] = compressed.blocksDecoded;
+                }
+            }
+            console.log('');
+        }
+
+        console.log('🧪 Coverage:');
+        check(duplicates > 0 && rejections > 0, `both outcomes were compared (${duplicates} duplicates, ${rejections} rejections)`);
+        check(blocks.unrelated < blocks['noise 0'],
+              `the unrelated pair stops decoding early (${blocks.unrelated} of ${blocks['noise 0']} blocks)`);
+    } finally {
+        fs.rmSync(directory, { recursive: true, force: true });
+    }
+
+    if (failures > 0) {
+        console.log(`❌ ${failures} compressed comparison check(s) failed`);
+        process.exit(1);
+    }
+    console.log('✅ Compressed comparison agrees with the uncompressed one');
+}
+
+testCompareCompressed().catch(error => {
+    console.error('💥 Compressed comparison test failed:', error.message);
+    process.exit(1);
+});
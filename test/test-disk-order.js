@@ -0,0 +1,114 @@
+#!/usr/bin/env node
+
+const audioDuplicates = require('../lib/index');
+const fs = require('fs');
+const os = require('os');
+const path = require('path');
+const { writeSyntheticWav } = require('./helpers');
+
+/**
+ * Check orderFilesByDiskLayout only reorders its input
+ * Usage: node test/test-disk-order.js
+ * The input mixes regular files with paths that have no usable extent (an empty
+ * file, procfs and tmpfs files where FIEMAP is unsupported), paths that do not
+ * exist and a repeated path; every one must come back exactly once per occurrence
+ */
+
+const FILES = 6;
+
+const sorted = paths => [...paths].sort();
+const sameMultiset = (a, b) => JSON.stringify(sorted(a)) === JSON.stringify(sorted(b));
+const groupKeys = groups => groups.map(group => [...group.filePaths].sort().join('|')).sort();
+
+async function testDiskOrder() {
+    console.log('💽 Testing Disk-Layout Ordering\n');
+
+    const directory = fs.mkdtempSync(path.join(os.tmpdir(), 'audio-duplicates-disk-order-'));
+    const shmPath = path.join('/dev/shm', `audio-duplicates-disk-order-${process.pid}.wav`);
+    let failures = 0;
+    const check = (condition, message) => {
+        if (condition) {
+            console.log(`   ✓ ${message}`);
+        } else {
+            console.log(`   ✗ Failed: ${message}`);
+            failures++;
+        }
+    };
+
+    try {
+        const audioFiles = [];
+        for (let i = 0; i < FILES; i++) {
+            const filePath = path.join(directory, `track_${i}.wav`);
+            writeSyntheticWav(filePath, 10, 22050, 1, 0x3c6ef372 + (i % 3) * 0x9e37, i < 3 ? 0 : 400);
+            audioFiles.push(filePath);
+        }
+
+        const noExtent = [path.join(directory, 'empty.wav')];
+        fs.writeFileSync(noExtent[0], Buffer.alloc(0));
+        if (fs.existsSync('/proc/version')) {
+            noExtent.push('/proc/version');
+        }
+        try {
+            writeSyntheticWav(shmPath, 1, 22050, 1);
+            noExtent.push(shmPath);
+        } catch (error) {
+            // No tmpfs here; the other paths still cover the fallback
+        }
+
+        const missing = [path.join(directory, 'missing_a.wav'), path.join(directory, 'missing', 'missing_b.wav')];
+        const input = [missing[0], ...audioFiles.slice(0, 3), ...noExtent, missing[1], ...audioFiles.slice(3), audioFiles[0]];
+
+        for (const useExtents of [true, false]) {
+            console.log(`🧪 ${useExtents ? 'Extents' : 'Inodes only'}:`);
+            const { files, stats } = await audioDuplicates.orderFilesByDiskLayout(input, { useExtents });
+            check(files.length === input.length && sameMultiset(files, input),
+                  `output is a permutation of the input (${files.length} paths)`);
+            check(stats.files === input.length &&
+                  stats.extentFiles + stats.inodeFiles + stats.unknownFiles === input.length,
+                  `stats count every path (${stats.extentFiles} extent, ${stats.inodeFiles} inode, ${stats.unknownFiles} unknown)`);
+            check(stats.unknownFiles === missing.length, 'missing paths are unknown');
+            check(JSON.stringify(files.slice(-missing.length)) === JSON.stringify(missing),
+                  'missing paths come last in input order');
+            check(stats.inodeFiles >= noExtent.length, 'paths without extents fall back to inode order');
+            if (!useExtents) {
+                check(stats.extentFiles === 0, 'no extents are read when disabled');
+            }
+
+            const singleThread = await audioDuplicates.orderFilesByDiskLayout(input, { useExtents, numThreads: 1 });
+            check(JSON.stringify(singleThread.files) === JSON.stringify(files), 'order does not depend on the thread count');
+            console.log('');
+        }
+
+        console.log('🧪 Pipeline in disk order:');
+        await audioDuplicates.clearIndex();
+        await audioDuplicates.initializeIndex();
+        await audioDuplicates.addFilesToIndexPipeline(audioFiles, {});
+        const groups = groupKeys(await audioDuplicates.findAllDuplicates());
+
+        await audioDuplicates.clearIndex();
+        await audioDuplicates.initializeIndex();
+        const ordered = await audioDuplicates.addFilesToIndexPipeline(audioFiles, { diskOrder: true });
+        check(ordered.stats.diskOrder !== undefined && ordered.stats.diskOrder.files === audioFiles.length,
+              'pipeline planned every file');
+        check(ordered.fileIds.every(fileId => fileId !== null) &&
+              sameMultiset(ordered.fileIds.map(String), audioFiles.map((_, i) => String(i))),
+              'every file was indexed once');
+        check(JSON.stringify(groupKeys(await audioDuplicates.findAllDuplicates())) === JSON.stringify(groups),
+              `same duplicate groups as input order (${groups.length})`);
+    } finally {
+        await audioDuplicates.clearIndex();
+        fs.rmSync(directory, { recursive: true, force: true });
+        fs.rmSync(shmPath, { force: true });
+    }
+
+    if (failures > 0) {
+        console.log(`❌ ${failures} disk-order check(s) failed`);
+        process.exit(1);
+    }
+    console.log('✅ Disk-layout ordering only permutes its input');
+}
+
+testDiskOrder().catch(error => {
+    console.error('💥 Disk-order test failed:', error.message);
+    process.exit(1);
+});
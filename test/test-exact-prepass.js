@@ -0,0 +1,106 @@
+#!/usr/bin/env node
+
+const audioDuplicates = require('../lib/index');
+const fs = require('fs');
+const os = require('os');
+const path = require('path');
+const { writeSyntheticWav } = require('./helpers');
+
+/**
+ * Check the exact-file pre-pass of the directory scans
+ * Usage: node test/test-exact-prepass.js
+ * Byte-identical copies must be grouped without decoding them, same-size files
+ * that differ must not be, and the copies indexed from their representative's
+ * fingerprint must end up in the same duplicate groups as a scan without the pre-pass
+ */
+
+const SECONDS = 12;
+const SAMPLE_RATE = 22050;
+
+const setKey = paths => [...paths].sort().join('|');
+const groupKeys = groups => groups.map(group => setKey(group.filePaths)).sort();
+
+async function testExactPrepass() {
+    console.log('🟰 Testing Exact-File Pre-Pass\n');
+
+    const directory = fs.mkdtempSync(path.join(os.tmpdir(), 'audio-duplicates-exact-prepass-'));
+    let failures = 0;
+    const check = (condition, message) => {
+        if (condition) {
+            console.log(`   ✓ ${message}`);
+        } else {
+            console.log(`   ✗ Failed: ${message}`);
+            failures++;
+        }
+    };
+
+    try {
+        const file = name => path.join(directory, name);
+        fs.mkdirSync(file('nested'));
+
+        // Two sets of byte copies, one in a subdirectory
+        writeSyntheticWav(file('a.wav'), SECONDS, SAMPLE_RATE, 1, 0xcc9e2d51);
+        fs.copyFileSync(file('a.wav'), file('a_copy.wav'));
+        fs.copyFileSync(file('a.wav'), file('nested/a_copy.wav'));
+        writeSyntheticWav(file('b.wav'), SECONDS + 3, SAMPLE_RATE, 1, 0x1b873593);
+        fs.copyFileSync(file('b.wav'), file('b_copy.wav'));
+
+        // Same size as a.wav but different bytes: a noisy copy, one with a single
+        // sample changed in the middle, and an unrelated track
+        writeSyntheticWav(file('a_noisy.wav'), SECONDS, SAMPLE_RATE, 1, 0xcc9e2d51, 300);
+        const edited = fs.readFileSync(file('a.wav'));
+        const middle = 44 + Math.floor(edited.length / 4) * 2;
+        edited.writeInt16LE(edited.readInt16LE(middle) ^ 1, middle);
+        fs.writeFileSync(file('a_edited.wav'), edited);
+        writeSyntheticWav(file('unrelated.wav'), SECONDS, SAMPLE_RATE, 1, 0xe6546b64);
+
+        const identical = [
+            [file('a.wav'), file('a_copy.wav'), file('nested/a_copy.wav')],
+            [file('b.wav'), file('b_copy.wav')]
+        ];
+        const allFiles = [
+            ...identical.flat(),
+            file('a_noisy.wav'), file('a_edited.wav'), file('unrelated.wav')
+        ];
+
+        console.log('🧪 findIdenticalFiles:');
+        const { groups, stats } = await audioDuplicates.findIdenticalFiles(allFiles);
+        check(JSON.stringify(groups.map(setKey).sort()) === JSON.stringify(identical.map(setKey).sort()),
+              `only the byte copies are grouped (${groups.length} groups)`);
+        check(groups.every(group => allFiles.includes(group[0])), 'each group starts with its representative');
+        check(stats.groups === identical.length && stats.identicalFiles === 3,
+              `${stats.identicalFiles} decodes can be skipped`);
+        check(stats.sizeMatches === allFiles.length, `every file shares its size with another (${stats.sizeMatches})`);
+        console.log('');
+
+        console.log('🧪 Directory scan with the pre-pass:');
+        await audioDuplicates.clearIndex();
+        const withPrepass = await audioDuplicates.scanDirectoryForDuplicates(directory, { exactFilePrepass: true });
+        check(withPrepass.exactFilePrepass !== undefined && withPrepass.exactFilePrepass.skippedDecodes === 3,
+              `copies were indexed without decoding (${withPrepass.exactFilePrepass ? withPrepass.exactFilePrepass.skippedDecodes : 0} skipped)`);
+        check(identical.every(set => withPrepass.some(group => set.every(filePath => group.filePaths.includes(filePath)))),
+              'every copy is in its representative\'s duplicate group');
+        check(!withPrepass.some(group => group.filePaths.includes(file('unrelated.wav'))),
+              'the unrelated same-size file is not grouped');
+
+        await audioDuplicates.clearIndex();
+        const withoutPrepass = await audioDuplicates.scanDirectoryForDuplicates(directory);
+        check(withoutPrepass.exactFilePrepass === undefined, 'no pre-pass statistics when disabled');
+        check(JSON.stringify(groupKeys(withPrepass)) === JSON.stringify(groupKeys(withoutPrepass)),
+              `same duplicate groups as decoding every file (${withoutPrepass.length})`);
+    } finally {
+        await audioDuplicates.clearIndex();
+        fs.rmSync(directory, { recursive: true, force: true });
+    }
+
+    if (failures > 0) {
+        console.log(`❌ ${failures} exact pre-pass check(s) failed`);
+        process.exit(1);
+    }
+    console.log('✅ Exact-file pre-pass skips only byte-identical copies');
+}
+
+testExactPrepass().catch(error => {
+    console.error('💥 Exact pre-pass test failed:', error.message);
+    process.exit(1);
+});
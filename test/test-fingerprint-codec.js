@@ -0,0 +1,124 @@
+#!/usr/bin/env node
+
+const audioDuplicates = require('../lib/index');
+const fs = require('fs');
+const os = require('os');
+const path = require('path');
+const { writeSyntheticWav } = require('./helpers');
+
+/**
+ * Check that both fingerprint codecs decode exactly what they encoded
+ * Usage: node test/test-fingerprint-codec.js
+ * Covers a real fingerprint and synthetic frame patterns that stress the
+ * XOR-delta bit planes: constants, alternating and random words, and lengths
+ * around the 256-frame block boundaries. Single blocks and ranges (across block
+ * boundaries, in the partial last block, past the end) must match the full decode,
+ * and blobs compressed against a trained dictionary must decode through a view
+ */
+
+function randomFrames(count, seed) {
+    let state = seed >>> 0 || 1;
+    const frames = new Array(count);
+    for (let i = 0; i < count; i++) {
+        state ^= state << 13;
+        state ^= state >>> 17;
+        state ^= state << 5;
+        frames[i] = state >>> 0;
+    }
+    return frames;
+}
+
+// Neighbouring frames differing in a few bits, like a real fingerprint
+function driftingFrames(count, seed) {
+    const noise = randomFrames(count, seed);
+    const frames = new Array(count);
+    let frame = noise[0];
+    for (let i = 0; i < count; i++) {
+        frame = (frame ^ (1 << (noise[i] % 32))) >>> 0;
+        frames[i] = frame;
+    }
+    return frames;
+}
+
+function syntheticCases() {
+    const cases = [
+        { name: 'single frame', data: [0xdeadbeef] },
+        { name: 'all zero', data: new Array(1000).fill(0) },
+        { name: 'all ones', data: new Array(1000).fill(0xffffffff) },
+        { name: 'alternating', data: Array.from({ length: 1000 }, (_, i) => (i % 2 ? 0xaaaaaaaa : 0x55555555)) },
+        { name: 'random', data: randomFrames(5000, 0x9e3779b9) },
+        { name: 'drifting', data: driftingFrames(5000, 0x85ebca6b) }
+    ];
+    for (const length of [1, 2, 255, 256, 257, 511, 512, 513, 1000]) {
+        cases.push({ name: `drifting, ${length} frames`, data: driftingFrames(length, length) });
+    }
+    return cases;
+}
+
+async function testFingerprintCodec() {
+    console.log('🗜️  Testing Fingerprint Codec Round Trips\n');
+
+    const directory = fs.mkdtempSync(path.join(os.tmpdir(), 'audio-duplicates-codec-'));
+    let failures = 0;
+
+    try {
+        const wavPath = path.join(directory, 'tones.wav');
+        writeSyntheticWav(wavPath, 30, 22050, 1);
+        const real = await audioDuplicates.generateFingerprint(wavPath);
+
+        const cases = [{ name: 'real fingerprint', data: Array.from(real.data) }, ...syntheticCases()];
+        let dictionaryCases = 0;
+        for (const testCase of cases) {
+            const fingerprint = { data: testCase.data, sampleRate: 11025, duration: testCase.data.length * 0.124 };
+            const results = await audioDuplicates.benchmarkFingerprintCodecs(fingerprint, 1);
+            for (const result of results) {
+                const label = `${testCase.name} (${result.codec}, ${result.compressedSize}/${result.originalSize} bytes)`;
+                const problems = [];
+                if (!result.lossless || result.originalSize !== testCase.data.length * 4) {
+                    problems.push('did not round-trip');
+                }
+                if (!result.blocksMatch) {
+                    problems.push('single blocks differ from the full decode');
+                }
+                if (!result.rangesMatch) {
+                    problems.push('ranges differ from the full decode');
+                }
+                if (!result.movesLeaveSourceEmpty) {
+                    problems.push('a moved-from blob still looked valid');
+                }
+                if (result.dictionaryLossless === false) {
+                    problems.push('dictionary blob did not decode through a view');
+                }
+                if (result.dictionaryLossless) {
+                    dictionaryCases++;
+                }
+                if (problems.length === 0) {
+                    console.log(`   ✓ ${label}${result.dictionaryLossless ? ', with dictionary' : ''}`);
+                } else {
+                    console.log(`   ✗ Failed: ${label} ${problems.join(', ')}`);
+                    failures++;
+                }
+            }
+        }
+
+        // Repetitive inputs always leave segments for a dictionary
+        if (dictionaryCases === 0) {
+            console.log('   ✗ Failed: no case was compressed against a dictionary');
+            failures++;
+        }
+    } finally {
+        fs.rmSync(directory, { recursive: true, force: true });
+    }
+
+    console.log('');
+    if (failures > 0) {
+        console.log(`❌ ${failures} codec round trip(s) failed`);
+        process.exit(1);
+    }
+    console.log('✅ Both codecs round-trip every case');
+}
+
+testFingerprintCodec().catch(error => {
+    console.error('💥 Codec test failed:', error.message);
+    process.exit(1);
+});
@@ -0,0 +1,271 @@
+#!/usr/bin/env node
+
+const audioDuplicates = require('../lib/index');
+const fs = require('fs');
+const os = require('os');
+const path = require('path');
+const { writeSyntheticWav } = require('./helpers');
+
+/**
+ * Check the index's fast paths against the straightforward ones they replace
+ * Usage: node test/test-index-equivalence.js
+ * Every section indexes the same library of sources, noisy copies, shorter
+ * excerpts, unrelated tracks and byte copies and compares the two paths on all of it
+ */
+
+const SOURCES = 3;
+const SECONDS = 30;
+const NOISE_LEVELS = [0, 400];
+const EXCERPT_SECONDS = 18;
+const UNRELATED = 3;
+const SAMPLE_RATE = 22050;
+const DURATION_RATIO = 0.8;
+const SIMILARITY_THRESHOLDS = [0.85, 0.5, 0.2];
+const TIER_INTERVAL_MS = 10;
+
+const ids = list => JSON.stringify([...list].sort((a, b) => a - b));
+const groupKeys = groups => groups.map(group => ids(group.fileIds)).sort();
+const pairKey = pair => `${Math.min(pair.fileA, pair.fileB)}-${Math.max(pair.fileA, pair.fileB)}`;
+
+function sleep(ms) {
+    return new Promise(resolve => setTimeout(resolve, ms));
+}
+
+async function readAll(count) {
+    const reads = [];
+    for (let fileId = 0; fileId < count; fileId++) {
+        reads.push(await audioDuplicates.getIndexedFingerprint(fileId));
+    }
+    return reads;
+}
+
+async function waitForStorage(predicate, timeoutMs = 3000) {
+    const deadline = Date.now() + timeoutMs;
+    let storage = (await audioDuplicates.getIndexStats()).storage;
+    while (!predicate(storage) && Date.now() < deadline) {
+        await sleep(TIER_INTERVAL_MS * 2);
+        storage = (await audioDuplicates.getIndexStats()).storage;
+    }
+    return storage;
+}
+
+// Keep reading every file, several passes per tiering epoch so their heat builds up,
+// until all of them are read from the hot tier or time runs out
+async function readUntilHot(count, timeoutMs = 3000) {
+    const deadline = Date.now() + timeoutMs;
+    let reads = await readAll(count);
+    while (!reads.every(read => read.tier === 'hot') && Date.now() < deadline) {
+        await sleep(TIER_INTERVAL_MS / 5);
+        reads = await readAll(count);
+    }
+    return reads;
+}
+
+async function indexLibrary(files) {
+    await audioDuplicates.clearIndex();
+    await audioDuplicates.initializeIndex();
+    for (const filePath of files) {
+        await audioDuplicates.addFileToIndex(filePath);
+    }
+}
+
+async function testIndexEquivalence() {
+    console.log('⚖️  Testing Index Fast Paths Against Reference Paths\n');
+
+    const directory = fs.mkdtempSync(path.join(os.tmpdir(), 'audio-duplicates-index-equivalence-'));
+    let failures = 0;
+    const check = (condition, message) => {
+        if (condition) {
+            console.log(`   ✓ ${message}`);
+        } else {
+            console.log(`   ✗ Failed: ${message}`);
+            failures++;
+        }
+    };
+
+    try {
+        const files = [];
+        for (let s = 0; s < SOURCES; s++) {
+            const seed = 0x27d4eb2f + s * 0x9e37;
+            for (const noise of NOISE_LEVELS) {
+                const filePath = path.join(directory, `source_${s}_noise_${noise}.wav`);
+                writeSyntheticWav(filePath, SECONDS, SAMPLE_RATE, 1, seed, noise);
+                files.push(filePath);
+            }
+            // The same seed over fewer seconds is an exact excerpt of the source
+            const excerpt = path.join(directory, `source_${s}_excerpt.wav`);
+            writeSyntheticWav(excerpt, EXCERPT_SECONDS, SAMPLE_RATE, 1, seed);
+            files.push(excerpt);
+        }
+        for (let u = 0; u < UNRELATED; u++) {
+            const filePath = path.join(directory, `unrelated_${u}.wav`);
+            writeSyntheticWav(filePath, SECONDS - u * 5, SAMPLE_RATE, 1, 0x165667b1 + u * 0x7f4a);
+            files.push(filePath);
+        }
+        // Byte copies have bit-identical fingerprints: two of a source, one of an unrelated track
+        for (const [source, copy] of [[files[0], 'source_0_copy_a.wav'], [files[0], 'source_0_copy_b.wav'],
+                                      [path.join(directory, 'unrelated_0.wav'), 'unrelated_0_copy.wav']]) {
+            fs.copyFileSync(source, path.join(directory, copy));
+            files.push(path.join(directory, copy));
+        }
+
+        const fingerprints = [];
+        for (const filePath of files) {
+            fingerprints.push(await audioDuplicates.generateFingerprint(filePath));
+        }
+        await indexLibrary(files);
+
+        // Batched voting walks each posting list once for the whole block; it must
+        // vote for the same files as one lookup per query, with and without the
+        // duration window
+        for (const minRatio of [0, DURATION_RATIO]) {
+            console.log(`🧪 Batched candidates${minRatio > 0 ? `, duration window ${minRatio}` : ''}:`);
+            await audioDuplicates.setDurationRatioWindow(minRatio);
+            const batched = await audioDuplicates.findCandidates(fingerprints);
+            const perQuery = await audioDuplicates.findCandidates(fingerprints, { batched: false });
+            check(batched.length === files.length && perQuery.length === files.length, 'one candidate list per query');
+            check(batched.every((candidates, q) => ids(candidates) === ids(perQuery[q])),
+                  'same candidates as per-query voting');
+            check(perQuery.every((candidates, q) => candidates.includes(q)), 'every file is its own candidate');
+            check(perQuery.some(candidates => candidates.length > 1), 'some queries have other candidates');
+            console.log('');
+        }
+        await audioDuplicates.setDurationRatioWindow(0);
+
+        // The duration window may only drop candidates of a different length: every pair
+        // inside it that the full comparison calls a duplicate, and that the index finds
+        // without the window, must still be found with it
+        console.log(`🧪 Duration window ${DURATION_RATIO}:`);
+        const inWindow = [];
+        const outOfWindow = [];
+        for (let a = 0; a < files.length; a++) {
+            for (let b = a + 1; b < files.length; b++) {
+                const lengths = [fingerprints[a].data.length, fingerprints[b].data.length];
+                const ratio = Math.min(...lengths) / Math.max(...lengths);
+                const comparison = await audioDuplicates.compareFingerprints(fingerprints[a], fingerprints[b]);
+                if (comparison.isDuplicate && ratio >= DURATION_RATIO + 0.01) {
+                    inWindow.push([a, b]);
+                } else if (ratio < DURATION_RATIO - 0.01) {
+                    outOfWindow.push([a, b]);
+                }
+            }
+        }
+        check(inWindow.length > 0, `duplicates inside the window (${inWindow.length})`);
+
+        const grouped = (groups, [a, b]) => groups.some(group => group.fileIds.includes(a) && group.fileIds.includes(b));
+        const scans = [['findAllDuplicates', () => audioDuplicates.findAllDuplicates()],
+                       ['findAllDuplicatesBulk', () => audioDuplicates.findAllDuplicatesBulk()]];
+        const unwindowed = await audioDuplicates.findCandidates(fingerprints);
+        const unwindowedGroups = [];
+        for (const [, scan] of scans) {
+            unwindowedGroups.push(await scan());
+        }
+
+        await audioDuplicates.setDurationRatioWindow(DURATION_RATIO);
+        const windowed = await audioDuplicates.findCandidates(fingerprints);
+        check(inWindow.some(([a, b]) => unwindowed[a].includes(b)), 'some duplicates inside the window are candidates');
+        check(inWindow.every(([a, b]) => (!unwindowed[a].includes(b) || windowed[a].includes(b)) &&
+                                         (!unwindowed[b].includes(a) || windowed[b].includes(a))),
+              'every candidate duplicate inside the window is kept');
+        check(outOfWindow.every(([a, b]) => !windowed[a].includes(b) && !windowed[b].includes(a)),
+              `files of a different length are pruned (${outOfWindow.length} pairs)`);
+        check((await audioDuplicates.getIndexStats()).durationFilter.votesPruned > 0, 'votes were pruned');
+        for (let i = 0; i < scans.length; i++) {
+            const groups = await scans[i][1]();
+            check(inWindow.every(pair => !grouped(unwindowedGroups[i], pair) || grouped(groups, pair)),
+                  `${scans[i][0]} keeps every duplicate inside the window grouped`);
+        }
+        await audioDuplicates.setDurationRatioWindow(0);
+        console.log('');
+
+        // The prefix join only indexes each file's rarest hashes; it must still find
+        // every pair that checking all pairs with the quick filter finds
+        for (const threshold of SIMILARITY_THRESHOLDS) {
+            console.log(`🧪 Prefix join, similarity threshold ${threshold}:`);
+            await audioDuplicates.setSimilarityThreshold(threshold);
+            const joined = new Map((await audioDuplicates.findQuickFilterPairs('prefix')).map(pair => [pairKey(pair), pair]));
+            const all = await audioDuplicates.findQuickFilterPairs('all');
+            const missing = all.filter(pair => !joined.has(pairKey(pair)));
+            check(all.length > 0, `brute force finds pairs (${all.length})`);
+            check(missing.length === 0,
+                  `prefix join finds every brute-force pair (${joined.size} found, ${missing.length} missed)`);
+            check(all.every(pair => !joined.has(pairKey(pair)) || Math.abs(joined.get(pairKey(pair)).overlap - pair.overlap) < 1e-12),
+                  'shared pairs report the same overlap');
+            console.log('');
+        }
+        await audioDuplicates.setSimilarityThreshold(0.85);
+
+        // Bit-identical fingerprints are verified once through a representative and
+        // added back afterwards; every scan must group files as if each were verified.
+        // The bulk scan averages over the edges it verified, so only the per-file
+        // scans, which weigh every file pair, must also keep their similarities
+        for (const [name, scan, allPairs] of [['findAllDuplicates', () => audioDuplicates.findAllDuplicates(), true],
+                                              ['findAllDuplicatesParallel', () => audioDuplicates.findAllDuplicatesParallel(2), true],
+                                              ['findAllDuplicatesBulk', () => audioDuplicates.findAllDuplicatesBulk(), false]]) {
+            console.log(`🧪 Exact-duplicate collapse, ${name}:`);
+            await audioDuplicates.setExactDuplicateCollapse(false);
+            const direct = await scan();
+            const directStats = (await audioDuplicates.getIndexStats()).exactDuplicates;
+            await audioDuplicates.setExactDuplicateCollapse(true);
+            const collapsed = await scan();
+            const collapsedStats = (await audioDuplicates.getIndexStats()).exactDuplicates;
+
+            check(directStats.exactSets === 0 && directStats.filesCollapsed === 0, 'nothing collapsed when disabled');
+            check(collapsedStats.exactSets === 2 && collapsedStats.filesCollapsed === 3,
+                  `copies collapsed (${collapsedStats.exactSets} sets, ${collapsedStats.filesCollapsed} files)`);
+            check(JSON.stringify(groupKeys(collapsed)) === JSON.stringify(groupKeys(direct)),
+                  `same groups as verifying every file (${direct.length})`);
+            if (allPairs) {
+                const similarity = new Map(direct.map(group => [ids(group.fileIds), group.avgSimilarity]));
+                check(collapsed.every(group => Math.abs(group.avgSimilarity - similarity.get(ids(group.fileIds))) < 1e-9),
+                      'same group similarities');
+            }
+            console.log('');
+        }
+
+        // Hot entries are viewed in place, warm ones decoded from the slab and cold
+        // ones from the mapped cold file; all three must give back the stored frames
+        console.log('🧪 Tiered reads:');
+        const stored = await readAll(files.length);
+        check(stored.every(read => read.tier === 'warm'), 'files start in the warm tier');
+        check(stored.every((read, fileId) => read.data.length === fingerprints[fileId].data.length && read.filePath === files[fileId]),
+              'warm reads have the indexed length and path');
+        const sameFrames = reads => reads.every((read, fileId) => JSON.stringify(read.data) === JSON.stringify(stored[fileId].data));
+
+        // Nothing reads the index while idle entries move to the cold file
+        await audioDuplicates.configureTiering({
+            coldDirectory: directory, coldAfterEpochs: 1, hotMinAccesses: 1000000, intervalMs: TIER_INTERVAL_MS
+        });
+        await waitForStorage(storage => storage.coldFiles === files.length);
+        const cold = await readAll(files.length);
+        check(cold.every(read => read.tier === 'cold'), 'every file was read from the cold tier');
+        check(sameFrames(cold), 'cold reads return the stored frames');
+
+        // Reading brings entries back; with one access enough they go straight to the hot tier
+        await audioDuplicates.configureTiering({
+            coldDirectory: directory, coldAfterEpochs: 1000000, hotMinAccesses: 1, hotBudgetMB: 64, intervalMs: TIER_INTERVAL_MS
+        });
+        const hot = await readUntilHot(files.length);
+        check(hot.every(read => read.tier === 'hot'), 'every file was read from the hot tier');
+        check(sameFrames(hot), 'hot reads return the stored frames');
+
+        await audioDuplicates.configureTiering({ enabled: false });
+        check(sameFrames(await readAll(files.length)), 'reads after tiering stops return the stored frames');
+        console.log('');
+    } finally {
+        await audioDuplicates.configureTiering({ enabled: false });
+        await audioDuplicates.clearIndex();
+        fs.rmSync(directory, { recursive: true, force: true });
+    }
+
+    if (failures > 0) {
+        console.log(`❌ ${failures} index equivalence check(s) failed`);
+        process.exit(1);
+    }
+    console.log('✅ Index fast paths agree with the reference paths');
+}
+
+testIndexEquivalence().catch(error => {
+    console.error('💥 Index equivalence test failed:', error.message);
+    process.exit(1);
+});
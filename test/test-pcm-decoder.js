@@ -0,0 +1,286 @@
+#!/usr/bin/env node
+
+const audioDuplicates = require('../lib/index');
+const fs = require('fs');
+const os = require('os');
+const path = require('path');
+const { writeSyntheticWav } = require('./helpers');
+
+/**
+ * Check that PCM decoding does not depend on how the file is read
+ * Usage: node test/test-pcm-decoder.js
+ * The streaming resampler carries its filter state across chunks, so any read
+ * size must produce exactly the samples of a whole-file read (the default 1 MiB
+ * chunk holds each 5-second test file). The integer path only has to track the
+ * float path: its Q14 coefficients round each tap, and the float path truncates
+ * its output, so they differ by a few LSB. The memory-mapped WAV/RF64 reader
+ * must give exactly what libsndfile gives. Multi-channel files are downmixed
+ * inside the conversion pass; they must decode exactly like a mono file holding
+ * the same downmix, computed here in the arithmetic each path uses
+ */
+
+const CHUNK_SIZES = [4096, 7919, 65536];
+const MAX_PATH_DIFF = 16;
+const MAX_PATH_RMS = 4;
+
+const DOWNMIX_SOURCES = [
+    { name: '44.1 kHz stereo', sampleRate: 44100, channels: 2 },
+    { name: '48 kHz 3-channel', sampleRate: 48000, channels: 3 }
+];
+
+const SOURCES = [
+    { name: '44.1 kHz mono', sampleRate: 44100, channels: 1 },
+    { name: '44.1 kHz stereo', sampleRate: 44100, channels: 2 },
+    { name: '48 kHz stereo', sampleRate: 48000, channels: 2 }
+];
+
+// Rewrite a 16-bit PCM WAV from writeSyntheticWav as RF64 (sizes in a ds64 chunk)
+// or as 32-bit float, keeping the samples
+function rewriteWav(sourcePath, targetPath, { rf64 = false, float = false }) {
+    const source = fs.readFileSync(sourcePath);
+    const channels = source.readUInt16LE(22);
+    const sampleRate = source.readUInt32LE(24);
+    const pcm = source.subarray(44);
+    const bytesPerSample = float ? 4 : 2;
+    const dataBytes = (pcm.length / 2) * bytesPerSample;
+    const headerBytes = rf64 ? 80 : 44;
+    const buffer = Buffer.alloc(headerBytes + dataBytes);
+
+    let pos = 0;
+    buffer.write(rf64 ? 'RF64' : 'RIFF', pos);
+    buffer.writeUInt32LE(rf64 ? 0xFFFFFFFF : headerBytes - 8 + dataBytes, pos + 4);
+    buffer.write('WAVE', pos + 8);
+    pos += 12;
+    if (rf64) {
+        buffer.write('ds64', pos);
+        buffer.writeUInt32LE(28, pos + 4);
+        buffer.writeBigUInt64LE(BigInt(buffer.length - 8), pos + 8);
+        buffer.writeBigUInt64LE(BigInt(dataBytes), pos + 16);
+        buffer.writeBigUInt64LE(BigInt(dataBytes / (channels * bytesPerSample)), pos + 24);
+        buffer.writeUInt32LE(0, pos + 32);
+        pos += 36;
+    }
+    buffer.write('fmt ', pos);
+    buffer.writeUInt32LE(16, pos + 4);
+    buffer.writeUInt16LE(float ? 3 : 1, pos + 8);
+    buffer.writeUInt16LE(channels, pos + 10);
+    buffer.writeUInt32LE(sampleRate, pos + 12);
+    buffer.writeUInt32LE(sampleRate * channels * bytesPerSample, pos + 16);
+    buffer.writeUInt16LE(channels * bytesPerSample, pos + 20);
+    buffer.writeUInt16LE(bytesPerSample * 8, pos + 22);
+    pos += 24;
+    buffer.write('data', pos);
+    buffer.writeUInt32LE(rf64 ? 0xFFFFFFFF : dataBytes, pos + 4);
+    pos += 8;
+
+    for (let i = 0; i < pcm.length / 2; i++) {
+        const sample = pcm.readInt16LE(i * 2);
+        if (float) {
+            buffer.writeFloatLE(sample / 32768, pos + i * 4);
+        } else {
+            buffer.writeInt16LE(sample, pos + i * 2);
+        }
+    }
+    fs.writeFileSync(targetPath, buffer);
+}
+
+// Write interleaved samples as a 16-bit PCM or 32-bit float WAV
+function writePcmWav(filePath, sampleRate, channels, samples, float = false) {
+    const bytesPerSample = float ? 4 : 2;
+    const dataBytes = samples.length * bytesPerSample;
+    const buffer = Buffer.alloc(44 + dataBytes);
+    buffer.write('RIFF', 0);
+    buffer.writeUInt32LE(36 + dataBytes, 4);
+    buffer.write('WAVE', 8);
+    buffer.write('fmt ', 12);
+    buffer.writeUInt32LE(16, 16);
+    buffer.writeUInt16LE(float ? 3 : 1, 20);
+    buffer.writeUInt16LE(channels, 22);
+    buffer.writeUInt32LE(sampleRate, 24);
+    buffer.writeUInt32LE(sampleRate * channels * bytesPerSample, 28);
+    buffer.writeUInt16LE(channels * bytesPerSample, 32);
+    buffer.writeUInt16LE(bytesPerSample * 8, 34);
+    buffer.write('data', 36);
+    buffer.writeUInt32LE(dataBytes, 40);
+    for (let i = 0; i < samples.length; i++) {
+        if (float) {
+            buffer.writeFloatLE(samples[i], 44 + i * 4);
+        } else {
+            buffer.writeInt16LE(samples[i], 44 + i * 2);
+        }
+    }
+    fs.writeFileSync(filePath, buffer);
+}
+
+// Downmix interleaved int16 frames the way each path does: the integer path
+// averages in int32 (stereo by an arithmetic shift, wider by truncating division),
+// the float path sums the libsndfile-normalized samples in float and scales by 1/channels
+function downmixInteger(frames, channels) {
+    const mono = new Int16Array(frames.length / channels);
+    for (let i = 0; i < mono.length; i++) {
+        let sum = 0;
+        for (let c = 0; c < channels; c++) {
+            sum += frames[i * channels + c];
+        }
+        mono[i] = channels === 2 ? sum >> 1 : Math.trunc(sum / channels);
+    }
+    return mono;
+}
+
+function downmixFloat(frames, channels) {
+    const gain = Math.fround(1 / channels);
+    const mono = new Float32Array(frames.length / channels);
+    for (let i = 0; i < mono.length; i++) {
+        let sum = 0;
+        for (let c = 0; c < channels; c++) {
+            sum = Math.fround(sum + frames[i * channels + c] / 32768);
+        }
+        mono[i] = Math.fround(sum * (channels === 2 ? 0.5 : gain));
+    }
+    return mono;
+}
+
+// Index of the first differing sample, the largest difference and the RMS difference
+function compareSamples(a, b) {
+    let first = a.length === b.length ? -1 : Math.min(a.length, b.length);
+    let maxDiff = 0;
+    let sumSquares = 0;
+    const length = Math.min(a.length, b.length);
+    for (let i = 0; i < length; i++) {
+        const diff = Math.abs(a[i] - b[i]);
+        if (diff > 0 && first < 0) {
+            first = i;
+        }
+        maxDiff = Math.max(maxDiff, diff);
+        sumSquares += diff * diff;
+    }
+    return { first, maxDiff, rms: length > 0 ? Math.sqrt(sumSquares / length) : 0 };
+}
+
+async function testPcmDecoder() {
+    console.log('🎚️  Testing PCM Decoder\n');
+
+    const directory = fs.mkdtempSync(path.join(os.tmpdir(), 'audio-duplicates-pcm-'));
+    let failures = 0;
+    const check = (condition, message) => {
+        if (condition) {
+            console.log(`   ✓ ${message}`);
+        } else {
+            console.log(`   ✗ Failed: ${message}`);
+            failures++;
+        }
+    };
+
+    try {
+        for (const source of SOURCES) {
+            console.log(`🧪 ${source.name}:`);
+            const filePath = path.join(directory, `${source.sampleRate}_${source.channels}.wav`);
+            writeSyntheticWav(filePath, 5, source.sampleRate, source.channels, 0x1234, 400);
+
+            for (const mappedReader of [true, false]) {
+                const reader = mappedReader ? 'mapped' : 'sndfile';
+                const whole = await audioDuplicates.decodePcm(filePath, { mappedReader });
+                const expected = Math.floor(5 * 11025);
+                check(whole.sourceRate === source.sampleRate && whole.channels === source.channels,
+                      `${reader}: reports ${whole.sourceRate} Hz, ${whole.channels} channel(s)`);
+                check(Math.abs(whole.samples.length - expected) <= expected * 0.01,
+                      `${reader}: ${whole.samples.length} samples at 11025 Hz (expected ~${expected})`);
+
+                for (const chunkBytes of CHUNK_SIZES) {
+                    const chunked = await audioDuplicates.decodePcm(filePath, { mappedReader, chunkBytes });
+                    const { first } = compareSamples(whole.samples, chunked.samples);
+                    check(first < 0, `${reader}: ${chunkBytes}-byte chunks match the whole-file decode` +
+                          (first < 0 ? '' : ` (first difference at ${first})`));
+                }
+            }
+
+            const integer = await audioDuplicates.decodePcm(filePath);
+            const float = await audioDuplicates.decodePcm(filePath, { integerPath: false });
+            check(integer.integerPath && !float.integerPath, 'integerPath selects the fixed-point or float path');
+            const { maxDiff, rms } = compareSamples(integer.samples, float.samples);
+            check(integer.samples.length === float.samples.length, `both paths give ${integer.samples.length} samples`);
+            check(maxDiff <= MAX_PATH_DIFF && rms <= MAX_PATH_RMS,
+                  `integer path within ${MAX_PATH_DIFF} LSB of the float path (max ${maxDiff}, RMS ${rms.toFixed(2)})`);
+
+            const variants = [
+                { name: 'WAV', filePath },
+                { name: 'RF64', filePath: filePath.replace(/\.wav$/, '_rf64.wav'), rf64: true },
+                { name: 'float WAV', filePath: filePath.replace(/\.wav$/, '_float.wav'), float: true },
+                { name: 'float RF64', filePath: filePath.replace(/\.wav$/, '_float_rf64.wav'), rf64: true, float: true }
+            ];
+            for (const variant of variants) {
+                if (variant.filePath !== filePath) {
+                    rewriteWav(filePath, variant.filePath, variant);
+                }
+                const mapped = await audioDuplicates.decodePcm(variant.filePath);
+                const sndfile = await audioDuplicates.decodePcm(variant.filePath, { mappedReader: false });
+                check(mapped.mapped && !sndfile.mapped, `${variant.name}: read through the mapping, and through libsndfile when disabled`);
+                const { first } = compareSamples(mapped.samples, sndfile.samples);
+                check(first < 0 && mapped.samples.length > 0,
+                      `${variant.name}: mapped reader matches libsndfile (${mapped.samples.length} samples` +
+                      (first < 0 ? ')' : `, first difference at ${first})`));
+            }
+            console.log('');
+        }
+
+        for (const source of DOWNMIX_SOURCES) {
+            console.log(`🧪 Downmix, ${source.name}:`);
+
+            // Different signals per channel, so the downmix is not one of them
+            const channelPaths = [];
+            for (let c = 0; c < source.channels; c++) {
+                channelPaths.push(path.join(directory, `channel_${c}.wav`));
+                writeSyntheticWav(channelPaths[c], 5, source.sampleRate, 1, 0x2545f491 + c * 0x9e37, 400);
+            }
+            const channelSamples = channelPaths.map(channelPath => {
+                const data = fs.readFileSync(channelPath).subarray(44);
+                return new Int16Array(data.buffer, data.byteOffset, data.length / 2);
+            });
+            const frames = new Int16Array(channelSamples[0].length * source.channels);
+            for (let i = 0; i < channelSamples[0].length; i++) {
+                for (let c = 0; c < source.channels; c++) {
+                    frames[i * source.channels + c] = channelSamples[c][i];
+                }
+            }
+
+            const multiPath = path.join(directory, `downmix_${source.channels}.wav`);
+            const integerPath = path.join(directory, `downmix_${source.channels}_integer.wav`);
+            const floatPath = path.join(directory, `downmix_${source.channels}_float.wav`);
+            writePcmWav(multiPath, source.sampleRate, source.channels, frames);
+            writePcmWav(integerPath, source.sampleRate, 1, downmixInteger(frames, source.channels));
+            writePcmWav(floatPath, source.sampleRate, 1, downmixFloat(frames, source.channels), true);
+
+            const integerReference = await audioDuplicates.decodePcm(integerPath);
+            const floatReference = await audioDuplicates.decodePcm(floatPath);
+            for (const chunkBytes of [undefined, CHUNK_SIZES[1]]) {
+                const chunks = chunkBytes ? `${chunkBytes}-byte chunks` : 'whole file';
+                for (const mappedReader of [true, false]) {
+                    const reader = mappedReader ? 'mapped' : 'sndfile';
+                    const options = chunkBytes ? { mappedReader, chunkBytes } : { mappedReader };
+                    const integer = compareSamples(integerReference.samples,
+                                                   (await audioDuplicates.decodePcm(multiPath, options)).samples);
+                    check(integer.first < 0, `${reader} integer path, ${chunks}: matches the mono downmix` +
+                          (integer.first < 0 ? '' : ` (first difference at ${integer.first})`));
+                }
+                const float = compareSamples(floatReference.samples, (await audioDuplicates.decodePcm(multiPath,
+                    chunkBytes ? { integerPath: false, chunkBytes } : { integerPath: false })).samples);
+                check(float.first < 0, `float path, ${chunks}: matches the mono downmix` +
+                      (float.first < 0 ? '' : ` (first difference at ${float.first})`));
+            }
+            console.log('');
+        }
+    } finally {
+        fs.rmSync(directory, { recursive: true, force: true });
+    }
+
+    if (failures > 0) {
+        console.log(`❌ ${failures} PCM decoder check(s) failed`);
+        process.exit(1);
+    }
+    console.log('✅ PCM decoding is independent of chunk size, decode path and reader');
+}
+
+testPcmDecoder().catch(error => {
+    console.error('💥 PCM decoder test failed:', error.message);
+    process.exit(1);
+});
@@ -0,0 +1,140 @@
+#!/usr/bin/env node
+
+const audioDuplicates = require('../lib/index');
+const fs = require('fs');
+const os = require('os');
+const path = require('path');
+const { writeSyntheticWav } = require('./helpers');
+
+/**
+ * Check addFilesToIndexPipeline indexes files the same way as sequential addFileToIndex
+ * Usage: node test/test-pipeline.js
+ * The byte budget is smaller than one decoded file, so the I/O stage waits for
+ * room before every read and the back-pressure path runs on each file; the
+ * prefetch runs must not change the ids or groups either
+ */
+
+const SOURCES = 4;
+const NOISE_LEVELS = [0, 400];
+const UNRELATED = 2;
+const TINY_BUFFER_MB = 0.25;
+
+const groupKeys = groups => groups.map(group => [...group.filePaths].sort().join('|')).sort();
+
+async function indexSequentially(files) {
+    await audioDuplicates.clearIndex();
+    await audioDuplicates.initializeIndex();
+    const fileIds = [];
+    for (const filePath of files) {
+        fileIds.push(await audioDuplicates.addFileToIndex(filePath));
+    }
+    return { fileIds, groups: groupKeys(await audioDuplicates.findAllDuplicates()) };
+}
+
+async function indexWithPipeline(files, options) {
+    await audioDuplicates.clearIndex();
+    await audioDuplicates.initializeIndex();
+    const result = await audioDuplicates.addFilesToIndexPipeline(files, options);
+    return { result, groups: groupKeys(await audioDuplicates.findAllDuplicates()) };
+}
+
+async function testPipeline() {
+    console.log('🏭 Testing Pipeline Against Sequential Indexing\n');
+
+    const directory = fs.mkdtempSync(path.join(os.tmpdir(), 'audio-duplicates-pipeline-'));
+    let failures = 0;
+    const check = (condition, message) => {
+        if (condition) {
+            console.log(`   ✓ ${message}`);
+        } else {
+            console.log(`   ✗ Failed: ${message}`);
+            failures++;
+        }
+    };
+
+    try {
+        const files = [];
+        for (let s = 0; s < SOURCES; s++) {
+            for (const noise of NOISE_LEVELS) {
+                const filePath = path.join(directory, `source_${s}_noise_${noise}.wav`);
+                writeSyntheticWav(filePath, 15, 22050, 1, 0x68e31da4 + s * 0x9e37, noise);
+                files.push(filePath);
+            }
+        }
+        for (let u = 0; u < UNRELATED; u++) {
+            const filePath = path.join(directory, `unrelated_${u}.wav`);
+            writeSyntheticWav(filePath, 15, 22050, 1, 0x1b873593 + u * 0x7f4a);
+            files.push(filePath);
+        }
+
+        const sequential = await indexSequentially(files);
+        console.log(`📊 Sequential: ${sequential.groups.length} groups\n`);
+
+        // One thread per stage keeps the files in input order, so the ids must match exactly
+        console.log('🧪 Single thread per stage, tiny byte budget:');
+        const ordered = await indexWithPipeline(files, {
+            ioThreads: 1, decodeThreads: 1, dspThreads: 1, fingerprintThreads: 1,
+            maxBufferedMB: TINY_BUFFER_MB
+        });
+        check(ordered.result.errors.length === 0, `no errors (${ordered.result.errors.length})`);
+        check(JSON.stringify(ordered.result.fileIds) === JSON.stringify(sequential.fileIds),
+              'same file ids as sequential indexing');
+        check(JSON.stringify(ordered.groups) === JSON.stringify(sequential.groups),
+              `same duplicate groups (${ordered.groups.length})`);
+        check(ordered.result.stats.peakBufferedBytes > 0, `bytes were buffered (peak ${ordered.result.stats.peakBufferedBytes})`);
+        console.log('');
+
+        // Several threads may finish files out of order: ids are a permutation, groups are unchanged
+        console.log('🧪 Several threads per stage, tiny byte budget:');
+        const parallel = await indexWithPipeline(files, {
+            ioThreads: 2, decodeThreads: 3, dspThreads: 2, fingerprintThreads: 3, queueCapacity: 2,
+            maxBufferedMB: TINY_BUFFER_MB
+        });
+        check(parallel.result.errors.length === 0, `no errors (${parallel.result.errors.length})`);
+        check(JSON.stringify([...parallel.result.fileIds].sort((a, b) => a - b)) === JSON.stringify(sequential.fileIds),
+              'file ids are a permutation of the sequential ids');
+        check(JSON.stringify(parallel.groups) === JSON.stringify(sequential.groups),
+              `same duplicate groups (${parallel.groups.length})`);
+        console.log('');
+
+        // Read-ahead only changes when bytes arrive, never which bytes the I/O stage sees;
+        // files are handed over as their reads complete, so ids may come out permuted
+        for (const prefetchBackend of ['threads', 'io_uring', 'auto']) {
+            console.log(`🧪 Prefetch through ${prefetchBackend}:`);
+            const prefetched = await indexWithPipeline(files, {
+                ioThreads: 1, decodeThreads: 1, dspThreads: 1, fingerprintThreads: 1,
+                maxBufferedMB: TINY_BUFFER_MB, prefetchDepth: 3, prefetchBackend
+            });
+            const prefetch = prefetched.result.stats.prefetch;
+            check(prefetched.result.errors.length === 0, `no errors (${prefetched.result.errors.length})`);
+            check(prefetch !== undefined && prefetch.files === files.length,
+                  `every file went through the prefetcher (${prefetch ? prefetch.backend : 'none'}, ${prefetch ? prefetch.files : 0} files)`);
+            check(JSON.stringify([...prefetched.result.fileIds].sort((a, b) => a - b)) === JSON.stringify(sequential.fileIds),
+                  'file ids are a permutation of the ids without prefetch');
+            check(JSON.stringify(prefetched.groups) === JSON.stringify(sequential.groups),
+                  `same duplicate groups (${prefetched.groups.length})`);
+            console.log('');
+        }
+
+        console.log('🧪 Default byte budget:');
+        const unbounded = await indexWithPipeline(files, {});
+        check(JSON.stringify(unbounded.groups) === JSON.stringify(sequential.groups),
+              `same duplicate groups (${unbounded.groups.length})`);
+        check(ordered.result.stats.peakBufferedBytes <= unbounded.result.stats.peakBufferedBytes,
+              'tiny budget never holds more than the default one');
+    } finally {
+        await audioDuplicates.clearIndex();
+        fs.rmSync(directory, { recursive: true, force: true });
+    }
+
+    if (failures > 0) {
+        console.log(`❌ ${failures} pipeline check(s) failed`);
+        process.exit(1);
+    }
+    console.log('✅ Pipeline indexes files like sequential indexing');
+}
+
+testPipeline().catch(error => {
+    console.error('💥 Pipeline test failed:', error.message);
+    process.exit(1);
+});
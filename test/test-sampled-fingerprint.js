@@ -0,0 +1,95 @@
+#!/usr/bin/env node
+
+const audioDuplicates = require('../lib/index');
+const fs = require('fs');
+const os = require('os');
+const path = require('path');
+const { writeSyntheticWav } = require('./helpers');
+
+/**
+ * Check sampled fingerprint comparison (compareSampledFingerprints) on synthetic audio
+ * Usage: node test/test-sampled-fingerprint.js
+ * Copies of the same signal must match span for span, a noisy copy must score
+ * below them but above an unrelated signal, and the score must not depend on
+ * argument order
+ */
+
+const SECONDS = 60;
+const SPAN_SECONDS = 8;
+
+async function testSampledFingerprint() {
+    console.log('🎯 Testing Sampled Fingerprint Comparison\n');
+
+    const directory = fs.mkdtempSync(path.join(os.tmpdir(), 'audio-duplicates-sampled-'));
+    let failures = 0;
+    const check = (condition, message) => {
+        if (condition) {
+            console.log(`   ✓ ${message}`);
+        } else {
+            console.log(`   ✗ Failed: ${message}`);
+            failures++;
+        }
+    };
+
+    try {
+        const files = {
+            source: path.join(directory, 'source.wav'),
+            copy: path.join(directory, 'copy.wav'),
+            reencoded: path.join(directory, 'reencoded.wav'),
+            noisy: path.join(directory, 'noisy.wav'),
+            unrelated: path.join(directory, 'unrelated.wav')
+        };
+        writeSyntheticWav(files.source, SECONDS, 22050, 1, 0x1234);
+        fs.copyFileSync(files.source, files.copy);
+        writeSyntheticWav(files.reencoded, SECONDS, 44100, 2, 0x1234);
+        writeSyntheticWav(files.noisy, SECONDS, 22050, 1, 0x1234, 1800);
+        writeSyntheticWav(files.unrelated, SECONDS, 22050, 1, 0x9e3779b9);
+
+        const fingerprints = {};
+        for (const [name, filePath] of Object.entries(files)) {
+            fingerprints[name] = await audioDuplicates.generateSampledFingerprint(filePath, { spanSeconds: SPAN_SECONDS });
+        }
+
+        const source = fingerprints.source;
+        check(source.spanOffsets.length === 4 && source.spanOffsets[3] === source.data.length,
+              `three spans with offsets ending at data.length (${source.spanOffsets.join(', ')})`);
+        check(source.decodedSeconds <= 3 * SPAN_SECONDS + 1,
+              `only the spans are decoded (${source.decodedSeconds.toFixed(1)}s of ${source.duration.toFixed(1)}s)`);
+
+        const compare = name => audioDuplicates.compareSampledFingerprints(source, fingerprints[name]);
+        const copy = await compare('copy');
+        const reencoded = await compare('reencoded');
+        const noisy = await compare('noisy');
+        const unrelated = await compare('unrelated');
+
+        console.log('🧪 Copies:');
+        check(copy.similarityScore > 0.99 && copy.isDuplicate && copy.coverageRatio === 1 && copy.bestOffset === 0,
+              `byte copy matches every span at offset 0 (${copy.similarityScore.toFixed(3)})`);
+        check(reencoded.similarityScore > 0.9 && reencoded.isDuplicate,
+              `44.1 kHz stereo render of the same signal matches (${reencoded.similarityScore.toFixed(3)})`);
+
+        console.log('\n🧪 Ordering:');
+        check(unrelated.similarityScore < 0.75 && !unrelated.isDuplicate && unrelated.matchedSegments === 0,
+              `unrelated signal scores low (${unrelated.similarityScore.toFixed(3)})`);
+        check(noisy.similarityScore > unrelated.similarityScore && noisy.similarityScore < copy.similarityScore,
+              `noisy copy scores between the unrelated signal and the copy (${noisy.similarityScore.toFixed(3)})`);
+
+        const reversed = await audioDuplicates.compareSampledFingerprints(fingerprints.noisy, source);
+        check(Math.abs(reversed.similarityScore - noisy.similarityScore) < 1e-9 && reversed.bestOffset === -noisy.bestOffset,
+              `argument order only flips the offset (${reversed.similarityScore.toFixed(3)}, ${reversed.bestOffset})`);
+    } finally {
+        fs.rmSync(directory, { recursive: true, force: true });
+    }
+
+    console.log('');
+    if (failures > 0) {
+        console.log(`❌ ${failures} sampled fingerprint check(s) failed`);
+        process.exit(1);
+    }
+    console.log('✅ Sampled comparison ranks copies, noisy copies and unrelated audio correctly');
+}
+
+testSampledFingerprint().catch(error => {
+    console.error('💥 Sampled fingerprint test failed:', error.message);
+    process.exit(1);
+});
@@ -0,0 +1,82 @@
+#!/usr/bin/env node
+
+const audioDuplicates = require('../lib/index');
+const fs = require('fs');
+const os = require('os');
+const path = require('path');
+const { writeSyntheticWav, bitError } = require('./helpers');
+
+/**
+ * Check that segmented fingerprinting of long recordings matches the sequential fingerprint
+ * Usage: node test/test-segmented-fingerprint.js [seconds]
+ * Synthetic WAVs are written to a temporary directory; 44.1 kHz decimates with an
+ * integer ratio and should stitch exactly, 48 kHz stereo exercises the fractional resampler
+ */
+
+const MAX_BIT_ERROR = 0.02;
+const MAX_LENGTH_DIFFERENCE = 1;
+
+async function testSegmentedFingerprint() {
+    const seconds = parseInt(process.argv[2] || '240', 10);
+
+    console.log('🧩 Testing Segmented Fingerprinting of Long Recordings\n');
+
+    const directory = fs.mkdtempSync(path.join(os.tmpdir(), 'audio-duplicates-segments-'));
+    const cases = [
+        { name: '44.1kHz mono', sampleRate: 44100, channels: 1 },
+        { name: '48kHz stereo', sampleRate: 48000, channels: 2 }
+    ];
+    let failures = 0;
+
+    try {
+        for (const testCase of cases) {
+            const filePath = path.join(directory, `${testCase.sampleRate}_${testCase.channels}ch.wav`);
+            writeSyntheticWav(filePath, seconds, testCase.sampleRate, testCase.channels);
+
+            await audioDuplicates.configureSegmentedFingerprinting({ enabled: false });
+            const sequential = await audioDuplicates.generateFingerprint(filePath);
+
+            await audioDuplicates.configureSegmentedFingerprinting({
+                minFileSeconds: 60,
+                segmentSeconds: seconds / 4,
+                overlapSeconds: 8
+            });
+            const segmented = await audioDuplicates.generateFingerprint(filePath);
+            const stats = await audioDuplicates.getStreamingStats();
+
+            const lengthDifference = Math.abs(segmented.data.length - sequential.data.length);
+            const error = bitError(sequential.data, segmented.data);
+
+            console.log(`🧪 ${testCase.name}, ${seconds}s:`);
+            console.log(`   Sequential: ${sequential.data.length} items`);
+            console.log(`   Segmented: ${segmented.data.length} items in ${stats.segments} segments ` +
+                        `(seam bit error ${stats.seamBitError.toFixed(4)})`);
+            console.log(`   Bit error against sequential: ${error.toFixed(4)}`);
+
+            if (stats.segments < 2) {
+                console.log('   ✗ Failed: File was not split into segments\n');
+                failures++;
+            } else if (lengthDifference > MAX_LENGTH_DIFFERENCE || error > MAX_BIT_ERROR) {
+                console.log(`   ✗ Failed: Expected at most ${MAX_LENGTH_DIFFERENCE} item and ` +
+                            `${MAX_BIT_ERROR} bit error difference\n`);
+                failures++;
+            } else {
+                console.log('   ✓ Passed\n');
+            }
+        }
+    } finally {
+        await audioDuplicates.configureSegmentedFingerprinting({ enabled: false });
+        fs.rmSync(directory, { recursive: true, force: true });
+    }
+
+    if (failures > 0) {
+        console.log(`❌ ${failures} segmented fingerprint case(s) failed`);
+        process.exit(1);
+    }
+    console.log('✅ Segmented fingerprints match the sequential fingerprints');
+}
+
+testSegmentedFingerprint().catch(error => {
+    console.error('💥 Segmented fingerprint test failed:', error.message);
+    process.exit(1);
+});
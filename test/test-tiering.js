@@ -0,0 +1,127 @@
+#!/usr/bin/env node
+
+const audioDuplicates = require('../lib/index');
+const fs = require('fs');
+const os = require('os');
+const path = require('path');
+const { writeSyntheticWav } = require('./helpers');
+
+/**
+ * Check that tiering moves aliased entries (addIdenticalFileToIndex) through the
+ * cold file and back without losing their fingerprints
+ * Usage: node test/test-tiering.js
+ * Aliases share their source's slab blob, so demoting both must not count the
+ * blob twice when deciding whether to compact the slab. A cold-file cap smaller
+ * than one blob first makes a demotion fail part-way through a write; the blobs
+ * demoted afterwards must still read back intact
+ */
+
+const COPIES_PER_SOURCE = 2;
+const INTERVAL_MS = 10;
+const TINY_COLD_MB = 64 / (1024 * 1024);
+
+function sleep(ms) {
+    return new Promise(resolve => setTimeout(resolve, ms));
+}
+
+async function waitForStorage(predicate, timeoutMs = 2000) {
+    const deadline = Date.now() + timeoutMs;
+    let storage = (await audioDuplicates.getIndexStats()).storage;
+    while (!predicate(storage) && Date.now() < deadline) {
+        await sleep(INTERVAL_MS * 2);
+        storage = (await audioDuplicates.getIndexStats()).storage;
+    }
+    return storage;
+}
+
+async function testTiering() {
+    console.log('🧊 Testing Tiered Storage with Aliased Entries\n');
+
+    const directory = fs.mkdtempSync(path.join(os.tmpdir(), 'audio-duplicates-tiering-'));
+    let failures = 0;
+    const check = (condition, message) => {
+        if (condition) {
+            console.log(`   ✓ ${message}`);
+        } else {
+            console.log(`   ✗ Failed: ${message}`);
+            failures++;
+        }
+    };
+
+    try {
+        await audioDuplicates.initializeIndex();
+
+        const sources = [];
+        for (let s = 0; s < 2; s++) {
+            const filePath = path.join(directory, `source_${s}.wav`);
+            writeSyntheticWav(filePath, 20, 22050, 1, 0x1234 + s * 0x9e37);
+            const fileId = await audioDuplicates.addFileToIndex(filePath);
+            const fileIds = [fileId];
+            for (let c = 0; c < COPIES_PER_SOURCE; c++) {
+                fileIds.push(await audioDuplicates.addIdenticalFileToIndex(path.join(directory, `copy_${s}_${c}.wav`), fileId));
+            }
+            sources.push({ fileIds, fingerprint: await audioDuplicates.generateFingerprint(filePath) });
+        }
+        const totalFiles = sources.length * (COPIES_PER_SOURCE + 1);
+
+        const tiering = {
+            coldDirectory: directory,
+            coldAfterEpochs: 1,
+            hotMinAccesses: 1000000,
+            intervalMs: INTERVAL_MS
+        };
+
+        console.log('🧪 Cold file cap below one blob:');
+        await audioDuplicates.configureTiering({ ...tiering, maxColdMB: TINY_COLD_MB });
+        const failed = await waitForStorage(storage => storage.tierErrors > 0);
+        check(failed.tierErrors > 0 && /size limit/.test(failed.lastTierError),
+              `demotion failed on the short write (${failed.lastTierError})`);
+        check(failed.coldFiles === 0, `failed demotions were rolled back (${failed.coldFiles} cold)`);
+        console.log('');
+
+        // Restarting the tier thread without the cap keeps the same cold file
+        await audioDuplicates.configureTiering(tiering);
+        const baselineErrors = (await audioDuplicates.getIndexStats()).storage.tierErrors;
+
+        for (let round = 1; round <= 3; round++) {
+            console.log(`🧪 Round ${round}:`);
+
+            const cold = await waitForStorage(storage => storage.coldFiles === totalFiles);
+            check(cold.coldFiles === totalFiles, `all ${totalFiles} entries moved to the cold file (${cold.coldFiles})`);
+            check(cold.tierErrors === baselineErrors, `no new tiering errors (${cold.tierErrors - baselineErrors})`);
+
+            // Cold reads must return the stored blobs, not bytes shifted by the failed write
+            for (const source of sources) {
+                const matches = await audioDuplicates.queryTopK(source.fingerprint, source.fileIds.length, 0.5);
+                const exact = matches.filter(match => match.similarity > 0.99).map(match => match.fileId).sort();
+                check(exact.join() === source.fileIds.slice().sort().join(),
+                      `source and copies read back exactly (${exact.join(', ')})`);
+            }
+
+            // Reading every entry brings it back from the cold file on the next epoch
+            const groups = await audioDuplicates.findAllDuplicates();
+            const sizes = groups.map(group => group.fileIds.length).sort();
+            check(groups.length === sources.length && sizes.every(size => size === COPIES_PER_SOURCE + 1),
+                  `each source is grouped with its copies (${sizes.join(', ')})`);
+
+            const warm = await waitForStorage(storage => storage.coldFiles < totalFiles);
+            check(warm.promotions > 0, `entries were promoted back (${warm.promotions} promotions)`);
+            console.log('');
+        }
+    } finally {
+        await audioDuplicates.configureTiering({ enabled: false });
+        await audioDuplicates.clearIndex();
+        fs.rmSync(directory, { recursive: true, force: true });
+    }
+
+    if (failures > 0) {
+        console.log(`❌ ${failures} tiering check(s) failed`);
+        process.exit(1);
+    }
+    console.log('✅ Aliased entries survive tiering');
+}
+
+testTiering().catch(error => {
+    console.error('💥 Tiering test failed:', error.message);
+    process.exit(1);
+});
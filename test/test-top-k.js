@@ -0,0 +1,93 @@
+#!/usr/bin/env node
+
+const audioDuplicates = require('../lib/index');
+const fs = require('fs');
+const os = require('os');
+const path = require('path');
+const { writeSyntheticWav } = require('./helpers');
+
+/**
+ * Check queryTopK against a brute-force comparison with every indexed file
+ * Usage: node test/test-top-k.js
+ * The exact mode (voteCutoff 0) must return the same similarities as ranking
+ * every file by compareFingerprints; the approximate mode may only return
+ * fewer or weaker matches
+ */
+
+const SOURCES = 3;
+const NOISE_LEVELS = [0, 300, 900, 1800];
+const K = 3;
+const MIN_SIMILARITY = 0.75;
+const EPSILON = 1e-9;
+
+async function testTopK() {
+    console.log('🎯 Testing Top-k Queries Against Brute Force\n');
+
+    const directory = fs.mkdtempSync(path.join(os.tmpdir(), 'audio-duplicates-top-k-'));
+    let failures = 0;
+    const check = (condition, message) => {
+        if (condition) {
+            console.log(`   ✓ ${message}`);
+        } else {
+            console.log(`   ✗ Failed: ${message}`);
+            failures++;
+        }
+    };
+
+    try {
+        await audioDuplicates.initializeIndex();
+
+        // Each source with noisy copies, so every query has more matches than k
+        const files = [];
+        for (let s = 0; s < SOURCES; s++) {
+            for (const noise of NOISE_LEVELS) {
+                const filePath = path.join(directory, `source_${s}_noise_${noise}.wav`);
+                writeSyntheticWav(filePath, 20, 22050, 1, 0x1234 + s * 0x9e37, noise);
+                const fileId = await audioDuplicates.addFileToIndex(filePath);
+                files.push({ fileId, filePath, fingerprint: await audioDuplicates.generateFingerprint(filePath) });
+            }
+        }
+
+        for (let s = 0; s < SOURCES; s++) {
+            const query = files[s * NOISE_LEVELS.length];
+            console.log(`🧪 Query ${path.basename(query.filePath)}:`);
+
+            const bruteForce = new Map();
+            for (const file of files) {
+                const similarity = (await audioDuplicates.compareFingerprints(query.fingerprint, file.fingerprint)).similarityScore;
+                bruteForce.set(file.fileId, similarity);
+            }
+            const expected = [...bruteForce.values()]
+                .filter(similarity => similarity > 0 && similarity >= MIN_SIMILARITY)
+                .sort((a, b) => b - a)
+                .slice(0, K);
+
+            const exact = await audioDuplicates.queryTopK(query.fingerprint, K, MIN_SIMILARITY);
+            check(exact.length === expected.length, `exact query returns ${expected.length} matches (${exact.length})`);
+            check(exact.every((match, i) => i >= expected.length || Math.abs(match.similarity - expected[i]) < EPSILON),
+                  `similarities match brute force (${exact.map(match => match.similarity.toFixed(4)).join(', ')})`);
+            check(exact.every(match => Math.abs(match.similarity - bruteForce.get(match.fileId)) < EPSILON),
+                  'each match has its brute-force similarity');
+
+            const approximate = await audioDuplicates.queryTopK(query.fingerprint, K, MIN_SIMILARITY, 0.5);
+            check(approximate.length <= exact.length &&
+                  approximate.every((match, i) => match.similarity <= exact[i].similarity + EPSILON),
+                  `approximate query never beats the exact one (${approximate.length} matches)`);
+            console.log('');
+        }
+    } finally {
+        await audioDuplicates.clearIndex();
+        fs.rmSync(directory, { recursive: true, force: true });
+    }
+
+    if (failures > 0) {
+        console.log(`❌ ${failures} top-k check(s) failed`);
+        process.exit(1);
+    }
+    console.log('✅ Top-k queries match brute force');
+}
+
+testTopK().catch(error => {
+    console.error('💥 Top-k test failed:', error.message);
+    process.exit(1);
+});
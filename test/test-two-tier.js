@@ -0,0 +1,108 @@
+#!/usr/bin/env node
+
+const audioDuplicates = require('../lib/index');
+const fs = require('fs');
+const os = require('os');
+const path = require('path');
+const { writeSyntheticWav } = require('./helpers');
+
+/**
+ * Check the two-tier scan finds planted duplicates and rejects prefix-only matches
+ * Usage: node test/test-two-tier.js
+ * Each source has a noisy copy; one extra file shares only its first seconds with
+ * a source, so the prefix tier pairs it but the full tier must reject the pair
+ */
+
+const SOURCES = 3;
+const UNRELATED = 3;
+const SECONDS = 40;
+const PREFIX_SECONDS = 8;
+const SHARED_SECONDS = 12;
+const SAMPLE_RATE = 22050;
+
+// Write the first `seconds` of a WAV followed by all of another (both mono 16-bit, plain 44-byte headers)
+function writeSplicedWav(filePath, headPath, seconds, tailPath) {
+    const head = fs.readFileSync(headPath).subarray(44, 44 + seconds * SAMPLE_RATE * 2);
+    const tail = fs.readFileSync(tailPath).subarray(44);
+    const header = Buffer.from(fs.readFileSync(headPath).subarray(0, 44));
+    header.writeUInt32LE(36 + head.length + tail.length, 4);
+    header.writeUInt32LE(head.length + tail.length, 40);
+    fs.writeFileSync(filePath, Buffer.concat([header, head, tail]));
+}
+
+const groupKey = paths => [...paths].sort().join('|');
+
+async function testTwoTier() {
+    console.log('🪜 Testing Two-Tier Duplicate Scan\n');
+
+    const directory = fs.mkdtempSync(path.join(os.tmpdir(), 'audio-duplicates-two-tier-'));
+    let failures = 0;
+    const check = (condition, message) => {
+        if (condition) {
+            console.log(`   ✓ ${message}`);
+        } else {
+            console.log(`   ✗ Failed: ${message}`);
+            failures++;
+        }
+    };
+
+    try {
+        const files = [];
+        const planted = [];
+        for (let s = 0; s < SOURCES; s++) {
+            const source = path.join(directory, `source_${s}.wav`);
+            const copy = path.join(directory, `source_${s}_copy.wav`);
+            writeSyntheticWav(source, SECONDS, SAMPLE_RATE, 1, 0x85ebca6b + s * 0x9e37);
+            writeSyntheticWav(copy, SECONDS, SAMPLE_RATE, 1, 0x85ebca6b + s * 0x9e37, 400);
+            files.push(source, copy);
+            planted.push(groupKey([source, copy]));
+        }
+        const unrelated = [];
+        for (let u = 0; u < UNRELATED; u++) {
+            const filePath = path.join(directory, `unrelated_${u}.wav`);
+            writeSyntheticWav(filePath, SECONDS, SAMPLE_RATE, 1, 0xc2b2ae35 + u * 0x7f4a);
+            files.push(filePath);
+            unrelated.push(filePath);
+        }
+
+        // Same opening as source 0, then an unrelated track: a prefix match that is not a duplicate
+        const spliced = path.join(directory, 'source_0_intro_only.wav');
+        writeSplicedWav(spliced, files[0], SHARED_SECONDS, unrelated[0]);
+        files.push(spliced);
+
+        const result = await audioDuplicates.findDuplicatesTwoTier(files, { prefixSeconds: PREFIX_SECONDS });
+        const stats = result.stats;
+        const groups = result.groups.map(group => groupKey(group.filePaths)).sort();
+        console.log(`📊 ${stats.prefixCandidatePairs} prefix candidates, ${stats.verifiedPairs} verified, ` +
+                    `${stats.completedFiles} of ${stats.files} files completed\n`);
+
+        console.log('🧪 Prefix tier:');
+        check(result.errors.length === 0, `no errors (${result.errors.length})`);
+        check(stats.prefixCandidatePairs >= SOURCES + 1,
+              `planted copies and the shared intro are prefix candidates (${stats.prefixCandidatePairs})`);
+        check(stats.completedFiles >= SOURCES * 2 + 1 && stats.completedFiles < files.length,
+              `only files with a candidate are fingerprinted in full (${stats.completedFiles})`);
+        check(stats.decodeSecondsSaved > 0, `unrelated files are never decoded in full (${stats.decodeSecondsSaved.toFixed(1)}s saved)`);
+        console.log('');
+
+        console.log('🧪 Full tier:');
+        check(JSON.stringify(groups) === JSON.stringify([...planted].sort()),
+              `exactly the planted groups are confirmed (${groups.length})`);
+        check(!result.groups.some(group => group.filePaths.includes(spliced)),
+              'the shared-intro file is rejected');
+        check(stats.verifiedPairs === SOURCES, `one verified pair per source (${stats.verifiedPairs})`);
+    } finally {
+        fs.rmSync(directory, { recursive: true, force: true });
+    }
+
+    if (failures > 0) {
+        console.log(`❌ ${failures} two-tier check(s) failed`);
+        process.exit(1);
+    }
+    console.log('✅ Two-tier scan confirms planted duplicates only');
+}
+
+testTwoTier().catch(error => {
+    console.error('💥 Two-tier test failed:', error.message);
+    process.exit(1);
+});
@@ -1,6 +1,8 @@
 const audioDuplicates = require('../lib/index');
 const fs = require('fs');
+const os = require('os');
 const path = require('path');
+const { writeSyntheticWav } = require('./helpers');
 
 console.log('Testing Audio Duplicates addon...\n');
 
@@ -170,6 +172,50 @@ async function runTests() {
         console.log('');
     }
 
+    // Test 9: Online duplicate groups
+    console.log('9. Testing online duplicate groups:');
+    const onlineDirectory = fs.mkdtempSync(path.join(os.tmpdir(), 'audio-duplicates-online-'));
+    try {
+        await audioDuplicates.clearIndex();
+        await audioDuplicates.initializeIndex();
+        const emptyGroups = await audioDuplicates.getOnlineDuplicateGroups();
+
+        // Two copies of the same file must be joined into one group as the second is added
+        const original = path.join(onlineDirectory, 'original.wav');
+        const copy = path.join(onlineDirectory, 'copy.wav');
+        writeSyntheticWav(original, 20, 22050, 1);
+        fs.copyFileSync(original, copy);
+
+        const first = await audioDuplicates.addFileAndMatch(original);
+        const second = await audioDuplicates.addFileAndMatch(copy);
+        const groups = await audioDuplicates.getOnlineDuplicateGroups();
+        console.log('   Groups found:', groups.length);
+
+        const matchesFirst = second.isDuplicate && second.matches.some(match => match.fileId === first.fileId);
+        const sameGroup = second.groupId === first.groupId;
+        const grouped = groups.length === 1 &&
+            groups[0].fileIds.includes(first.fileId) && groups[0].fileIds.includes(second.fileId);
+
+        if (!Array.isArray(emptyGroups) || emptyGroups.length !== 0) {
+            console.log('   ✗ Failed: Expected no groups on an empty index\n');
+        } else if (first.isDuplicate) {
+            console.log('   ✗ Failed: First file matched an empty index\n');
+        } else if (!matchesFirst) {
+            console.log('   ✗ Failed: Copy did not match the original\n');
+        } else if (!sameGroup) {
+            console.log('   ✗ Failed: Copy got group', second.groupId, 'instead of', first.groupId, '\n');
+        } else if (!grouped) {
+            console.log('   ✗ Failed: Expected one group holding both files\n');
+        } else {
+            console.log('   ✓ Passed\n');
+        }
+    } catch (error) {
+        console.log('   ✗ Failed:', error.message, '\n');
+    } finally {
+        await audioDuplicates.clearIndex();
+        fs.rmSync(onlineDirectory, { recursive: true, force: true });
+    }
+
     console.log('📝 Note: Audio file processing tests require:');
     console.log('   1. Chromaprint library installed');
     console.log('   2. libsndfile library installed');